@@ -22,6 +22,8 @@
 #include <utils/Condition.h>
 #include <utils/Mutex.h>
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include <stddef.h>
@@ -30,54 +32,74 @@
 namespace filament::backend {
 
 /*
- * A producer-consumer command queue that uses a CircularBuffer as main storage
+ * A multiple-producers, single-consumer command queue that uses CircularBuffers as main storage.
+ *
+ * Each producer records commands into its own Slice, i.e. its own CircularBuffer, and submits
+ * them with flush(). Submitting is lock-free, the lock is only taken to wake up a sleeping
+ * consumer, or when a producer must wait for space in its Slice. The consumer receives the
+ * command buffers of a given Slice in the order they were flushed, but command buffers of
+ * different Slices can be interleaved arbitrarily.
  */
 class CommandBufferQueue {
+public:
+    class Slice;
+
     struct Range {
         void* begin;
         void* end;
+        Slice* slice;
     };
 
-    const size_t mRequiredSize;
-
-    CircularBuffer mCircularBuffer;
-
-    // space available in the circular buffer
-
-    mutable utils::Mutex mLock;
-    mutable utils::Condition mCondition;
-    mutable std::vector<Range> mCommandBuffersToExecute;
-    size_t mFreeSpace = 0;
-    size_t mHighWatermark = 0;
-    uint32_t mExitRequested = 0;
-    bool mPaused = false;
-
-    static constexpr uint32_t EXIT_REQUESTED = 0x31415926;
+    // A producer's storage. Only one thread at a time can record commands into a Slice.
+    class Slice {
+    public:
+        CircularBuffer& getCircularBuffer() noexcept { return mCircularBuffer; }
+        CircularBuffer const& getCircularBuffer() const noexcept { return mCircularBuffer; }
+
+        // use CommandBufferQueue::createSlice()
+        explicit Slice(size_t bufferSize);
+
+    private:
+        friend class CommandBufferQueue;
+        CircularBuffer mCircularBuffer;
+        // space available in the circular buffer, only increased by the consumer
+        std::atomic<size_t> mFreeSpace;
+        size_t mHighWatermark = 0;
+    };
 
-public:
     // requiredSize: guaranteed available space after flush()
     CommandBufferQueue(size_t requiredSize, size_t bufferSize, bool paused);
     ~CommandBufferQueue();
 
-    CircularBuffer& getCircularBuffer() noexcept { return mCircularBuffer; }
-    CircularBuffer const& getCircularBuffer() const noexcept { return mCircularBuffer; }
+    // the main Slice, typically used by the engine's CommandStream
+    CircularBuffer& getCircularBuffer() noexcept { return mMainSlice.mCircularBuffer; }
+    CircularBuffer const& getCircularBuffer() const noexcept { return mMainSlice.mCircularBuffer; }
 
     size_t getCapacity() const noexcept { return mRequiredSize; }
 
-    size_t getHighWatermark() const noexcept { return mHighWatermark; }
+    size_t getHighWatermark() const noexcept { return mMainSlice.mHighWatermark; }
+
+    // Creates a Slice for an additional producer, it lives as long as this CommandBufferQueue.
+    // Thread-safe.
+    Slice* createSlice(size_t bufferSize);
 
     // wait for commands to be available and returns an array containing these commands
     std::vector<Range> waitForCommands() const;
 
-    // return the memory used by this command buffer to the circular buffer
+    // return the memory used by this command buffer to its circular buffer
     // WARNING: releaseBuffer() must be called in sequence of the Slices returned by
     // waitForCommands()
     void releaseBuffer(Range const& buffer);
 
-    // all commands buffers (Slices) written to this point are returned by waitForCommand(). This
-    // call blocks until the CircularBuffer has at least mRequiredSize bytes available.
+    // All commands buffers written to the main Slice to this point are returned by
+    // waitForCommand(). This call blocks until the CircularBuffer has at least mRequiredSize
+    // bytes available.
     void flush() noexcept;
 
+    // Same as flush() for the given Slice. Thread-safe, but a given Slice must be flushed by the
+    // thread recording into it.
+    void flush(Slice& slice) noexcept;
+
     // returns from waitForCommands() immediately.
     void requestExit();
 
@@ -86,6 +108,34 @@ public:
     void setPaused(bool paused);
 
     bool isExitRequested() const;
+
+private:
+    // A flushed command buffer. Nodes are allocated in the command buffer itself, after its
+    // terminating command, so they're released along with it.
+    struct Node {
+        Range range;
+        Node* next;
+    };
+
+    const size_t mRequiredSize;
+
+    Slice mMainSlice;
+
+    // stack of command buffers flushed since the last waitForCommands(), most recent first
+    mutable std::atomic<Node*> mPendingCommands = { nullptr };
+
+    // only used to sleep and wake up, never to submit commands
+    mutable utils::Mutex mLock;
+    mutable utils::Condition mConsumerCondition;
+    utils::Condition mProducerCondition;
+    mutable std::atomic<bool> mConsumerWaiting = { false };
+    std::atomic<uint32_t> mProducersWaiting = { 0 };
+    std::atomic<uint32_t> mExitRequested = { 0 };
+    std::atomic<bool> mPaused;
+
+    std::vector<std::unique_ptr<Slice>> mSlices;
+
+    static constexpr uint32_t EXIT_REQUESTED = 0x31415926;
 };
 
 } // namespace filament::backend
@@ -185,6 +185,11 @@ class NoopCommand : public CommandBase {
 public:
     inline constexpr explicit NoopCommand(void* next) noexcept
             : CommandBase(execute), mNext(intptr_t((char *)next - (char *)this)) { }
+
+    // changes the command executed after this one
+    inline void setNext(void* next) noexcept {
+        mNext = intptr_t((char *)next - (char *)this);
+    }
 };
 
 // ------------------------------------------------------------------------------------------------
@@ -280,6 +285,21 @@ public:
     inline PodType* allocatePod(
             size_t count = 1, size_t alignment = alignof(PodType)) noexcept;
 
+    /*
+     * Inserts a command that continues execution at `next`, or at the command that follows if
+     * `next` is null. The target can be changed with NoopCommand::setNext() until this
+     * CommandStream is flushed.
+     * This is used to splice commands recorded in a secondary CommandStream: the primary stream
+     * jumps to the secondary stream's commands, which end with a jump back to the command
+     * following the first jump.
+     */
+    inline NoopCommand* jump(void* next = nullptr) noexcept;
+
+    // Size of the command inserted by jump()
+    static constexpr size_t getJumpSize() noexcept {
+        return CommandBase::align(sizeof(NoopCommand));
+    }
+
 private:
     inline void* allocateCommand(size_t size) {
         assert_invariant(utils::ThreadUtils::isThisThread(mThreadId));
@@ -322,6 +342,11 @@ PodType* CommandStream::allocatePod(size_t count, size_t alignment) noexcept {
     return static_cast<PodType*>(allocate(count * sizeof(PodType), alignment));
 }
 
+NoopCommand* CommandStream::jump(void* next) noexcept {
+    char* const p = (char *)allocateCommand(getJumpSize());
+    return new(p) NoopCommand(next ? next : p + getJumpSize());
+}
+
 } // namespace filament::backend
 
 #endif // TNT_FILAMENT_BACKEND_PRIVATE_COMMANDSTREAM_H
@@ -27,8 +27,10 @@
 #include <utils/debug.h>
 
 #include <algorithm>
+#include <atomic>
 #include <mutex>
 #include <iterator>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -39,56 +41,70 @@ using namespace utils;
 
 namespace filament::backend {
 
+CommandBufferQueue::Slice::Slice(size_t bufferSize)
+        : mCircularBuffer(bufferSize),
+          mFreeSpace(mCircularBuffer.size()) {
+}
+
 CommandBufferQueue::CommandBufferQueue(size_t requiredSize, size_t bufferSize, bool paused)
         : mRequiredSize((requiredSize + (CircularBuffer::getBlockSize() - 1u)) & ~(CircularBuffer::getBlockSize() -1u)),
-          mCircularBuffer(bufferSize),
-          mFreeSpace(mCircularBuffer.size()),
+          mMainSlice(bufferSize),
           mPaused(paused) {
-    assert_invariant(mCircularBuffer.size() > requiredSize);
+    assert_invariant(mMainSlice.mCircularBuffer.size() > requiredSize);
 }
 
 CommandBufferQueue::~CommandBufferQueue() {
-    assert_invariant(mCommandBuffersToExecute.empty());
+    assert_invariant(!mPendingCommands.load(std::memory_order_relaxed));
+}
+
+CommandBufferQueue::Slice* CommandBufferQueue::createSlice(size_t bufferSize) {
+    auto slice = std::make_unique<Slice>(bufferSize);
+    FILAMENT_CHECK_PRECONDITION(slice->mCircularBuffer.size() > mRequiredSize)
+            << "Slice size (" << slice->mCircularBuffer.size()
+            << " bytes) must be larger than the required size (" << mRequiredSize << " bytes)";
+    std::lock_guard<utils::Mutex> const lock(mLock);
+    mSlices.push_back(std::move(slice));
+    return mSlices.back().get();
 }
 
 void CommandBufferQueue::requestExit() {
     std::lock_guard<utils::Mutex> const lock(mLock);
     mExitRequested = EXIT_REQUESTED;
-    mCondition.notify_one();
+    mConsumerCondition.notify_one();
 }
 
 bool CommandBufferQueue::isPaused() const noexcept {
-    std::lock_guard<utils::Mutex> const lock(mLock);
-    return mPaused;
+    return mPaused.load(std::memory_order_relaxed);
 }
 
 void CommandBufferQueue::setPaused(bool paused) {
     std::lock_guard<utils::Mutex> const lock(mLock);
-    if (paused) {
-        mPaused = true;
-    } else {
-        mPaused = false;
-        mCondition.notify_one();
+    mPaused = paused;
+    if (!paused) {
+        mConsumerCondition.notify_one();
     }
 }
 
 bool CommandBufferQueue::isExitRequested() const {
-    std::lock_guard<utils::Mutex> const lock(mLock);
-    return (bool)mExitRequested;
+    return (bool)mExitRequested.load(std::memory_order_relaxed);
 }
 
-
 void CommandBufferQueue::flush() noexcept {
+    flush(mMainSlice);
+}
+
+void CommandBufferQueue::flush(Slice& slice) noexcept {
     SYSTRACE_CALL();
 
-    CircularBuffer& circularBuffer = mCircularBuffer;
+    CircularBuffer& circularBuffer = slice.mCircularBuffer;
     if (circularBuffer.empty()) {
         return;
     }
 
-    // add the terminating command
-    // always guaranteed to have enough space for the NoopCommand
+    // add the terminating command, followed by our bookkeeping
+    // always guaranteed to have enough space for the NoopCommand and Node
     new(circularBuffer.allocate(sizeof(NoopCommand))) NoopCommand(nullptr);
+    Node* const node = new(circularBuffer.allocate(sizeof(Node))) Node{};
 
     const size_t requiredSize = mRequiredSize;
 
@@ -101,64 +117,107 @@ void CommandBufferQueue::flush() noexcept {
     size_t const used = std::distance(
             static_cast<char const*>(begin), static_cast<char const*>(end));
 
-
-    std::unique_lock<utils::Mutex> lock(mLock);
+    // the free space can only grow concurrently, so this check is stable
+    size_t const freeSpace = slice.mFreeSpace.load(std::memory_order_relaxed);
 
     // circular buffer is too small, we corrupted the stream
-    FILAMENT_CHECK_POSTCONDITION(used <= mFreeSpace) <<
+    FILAMENT_CHECK_POSTCONDITION(used <= freeSpace) <<
             "Backend CommandStream overflow. Commands are corrupted and unrecoverable.\n"
             "Please increase minCommandBufferSizeMB inside the Config passed to Engine::create.\n"
             "Space used at this time: " << used <<
-            " bytes, overflow: " << used - mFreeSpace << " bytes";
-
-    mFreeSpace -= used;
-    mCommandBuffersToExecute.push_back({ begin, end });
-    mCondition.notify_one();
+            " bytes, overflow: " << used - freeSpace << " bytes";
+
+    size_t const remaining = slice.mFreeSpace.fetch_sub(used, std::memory_order_relaxed) - used;
+
+    // push the command buffer, this publishes its content to the consumer
+    node->range = { begin, end, &slice };
+    Node* head = mPendingCommands.load(std::memory_order_relaxed);
+    do {
+        node->next = head;
+    } while (!mPendingCommands.compare_exchange_weak(head, node,
+            std::memory_order_seq_cst, std::memory_order_relaxed));
+
+    // Wake up the consumer only if it's sleeping. It sets mConsumerWaiting before checking
+    // mPendingCommands under the lock, so either it sees our command buffer, or we see it waiting.
+    if (mConsumerWaiting.load(std::memory_order_seq_cst)) {
+        std::lock_guard<utils::Mutex> const lock(mLock);
+        mConsumerCondition.notify_one();
+    }
 
     // wait until there is enough space in the buffer
-    if (UTILS_UNLIKELY(mFreeSpace < requiredSize)) {
+    if (UTILS_UNLIKELY(remaining < requiredSize)) {
 
 #ifndef NDEBUG
-        size_t const totalUsed = circularBuffer.size() - mFreeSpace;
+        size_t const totalUsed = circularBuffer.size() - remaining;
         slog.d << "CommandStream used too much space (will block): "
-                << "needed space " << requiredSize << " out of " << mFreeSpace
+                << "needed space " << requiredSize << " out of " << remaining
                 << ", totalUsed=" << totalUsed << ", current=" << used
-                << ", queue size=" << mCommandBuffersToExecute.size() << " buffers"
                 << io::endl;
 
-        mHighWatermark = std::max(mHighWatermark, totalUsed);
+        slice.mHighWatermark = std::max(slice.mHighWatermark, totalUsed);
 #endif
 
         SYSTRACE_NAME("waiting: CircularBuffer::flush()");
 
-        FILAMENT_CHECK_POSTCONDITION(!mPaused) <<
+        FILAMENT_CHECK_POSTCONDITION(!mPaused.load(std::memory_order_relaxed)) <<
                 "CommandStream is full, but since the rendering thread is paused, "
                 "the buffer cannot flush and we will deadlock. Instead, abort.";
 
-        mCondition.wait(lock, [this, requiredSize]() -> bool {
+        std::unique_lock<utils::Mutex> lock(mLock);
+        mProducersWaiting.fetch_add(1, std::memory_order_seq_cst);
+        mProducerCondition.wait(lock, [&slice, requiredSize]() -> bool {
             // TODO: on macOS, we need to call pumpEvents from time to time
-            return mFreeSpace >= requiredSize;
+            return slice.mFreeSpace.load(std::memory_order_seq_cst) >= requiredSize;
         });
+        mProducersWaiting.fetch_sub(1, std::memory_order_relaxed);
     }
 }
 
 std::vector<CommandBufferQueue::Range> CommandBufferQueue::waitForCommands() const {
+    auto takePendingCommands = [this]() {
+        std::vector<Range> commands;
+        Node* node = mPendingCommands.exchange(nullptr, std::memory_order_acquire);
+        for (; node; node = node->next) {
+            commands.push_back(node->range);
+        }
+        // the stack is most recent first
+        std::reverse(commands.begin(), commands.end());
+        return commands;
+    };
+
     if (!UTILS_HAS_THREADING) {
-        return std::move(mCommandBuffersToExecute);
+        return takePendingCommands();
     }
-    std::unique_lock<utils::Mutex> lock(mLock);
-    while ((mCommandBuffersToExecute.empty() || mPaused) && !mExitRequested) {
-        mCondition.wait(lock);
+
+    while (true) {
+        // when exiting, return the commands pending even if paused
+        bool const exitRequested = mExitRequested.load(std::memory_order_relaxed);
+        if (!mPaused.load(std::memory_order_relaxed) || exitRequested) {
+            std::vector<Range> commands = takePendingCommands();
+            if (!commands.empty() || exitRequested) {
+                return commands;
+            }
+        }
+
+        std::unique_lock<utils::Mutex> lock(mLock);
+        mConsumerWaiting.store(true, std::memory_order_seq_cst);
+        // check again, now that producers will wake us up
+        if ((mPaused || !mPendingCommands.load(std::memory_order_seq_cst)) && !mExitRequested) {
+            mConsumerCondition.wait(lock);
+        }
+        mConsumerWaiting.store(false, std::memory_order_relaxed);
     }
-    return std::move(mCommandBuffersToExecute);
 }
 
 void CommandBufferQueue::releaseBuffer(CommandBufferQueue::Range const& buffer) {
     size_t const used = std::distance(
             static_cast<char const*>(buffer.begin), static_cast<char const*>(buffer.end));
-    std::lock_guard<utils::Mutex> const lock(mLock);
-    mFreeSpace += used;
-    mCondition.notify_one();
+    buffer.slice->mFreeSpace.fetch_add(used, std::memory_order_seq_cst);
+    // a waiting producer increments mProducersWaiting before checking its free space
+    if (UTILS_UNLIKELY(mProducersWaiting.load(std::memory_order_seq_cst))) {
+        std::lock_guard<utils::Mutex> const lock(mLock);
+        mProducerCondition.notify_all();
+    }
 }
 
 } // namespace filament::backend
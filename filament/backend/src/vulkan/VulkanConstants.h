@@ -212,4 +212,9 @@ constexpr static const int FVK_MAX_PIPELINE_AGE = FVK_MAX_COMMAND_BUFFERS;
 // destroying any unused pipeline object.
 static_assert(FVK_MAX_PIPELINE_AGE >= FVK_MAX_COMMAND_BUFFERS);
 
+// Number of command buffer submissions without any new pipeline after which the VkPipelineCache is
+// saved to the platform's blob cache. It is also saved upon termination, but that might never
+// happen, e.g. when the process is killed.
+constexpr static const int FVK_PIPELINE_CACHE_SAVE_DELAY = 2 * FVK_MAX_COMMAND_BUFFERS;
+
 #endif
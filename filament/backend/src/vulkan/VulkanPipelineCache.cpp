@@ -18,6 +18,8 @@
 #include "VulkanMemory.h"
 #include "caching/VulkanDescriptorSetManager.h"
 
+#include <backend/Platform.h>
+
 #include <utils/Log.h>
 #include <utils/Panic.h>
 
@@ -26,6 +28,10 @@
 #include "VulkanTexture.h"
 #include "VulkanUtility.h"
 
+#include <vector>
+
+#include <string.h>
+
 // Vulkan functions often immediately dereference pointers, so it's fine to pass in a pointer
 // to a stack-allocated variable.
 #pragma clang diagnostic push
@@ -35,9 +41,35 @@ using namespace bluevk;
 
 namespace filament::backend {
 
-VulkanPipelineCache::VulkanPipelineCache(VkDevice device, VmaAllocator allocator)
+namespace {
+
+// Key of the VkPipelineCache data in the platform's blob cache.
+constexpr char PIPELINE_CACHE_KEY[] = "filament.vulkan.pipeline_cache";
+
+// Drivers are required to ignore data created by another device or driver version, but some
+// don't, so we check the header ourselves.
+bool isPipelineCacheCompatible(std::vector<uint8_t> const& data,
+        VkPhysicalDeviceProperties const& properties) noexcept {
+    VkPipelineCacheHeaderVersionOne header;
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    return header.headerSize >= sizeof(header) &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == properties.vendorID &&
+           header.deviceID == properties.deviceID &&
+           !memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+} // anonymous namespace
+
+VulkanPipelineCache::VulkanPipelineCache(VkDevice device, VmaAllocator allocator,
+        Platform* platform, VulkanContext const* context)
     : mDevice(device),
-      mAllocator(allocator) {
+      mAllocator(allocator),
+      mPlatform(platform),
+      mContext(context) {
 }
 
 VulkanPipelineCache::~VulkanPipelineCache() {
@@ -223,6 +255,22 @@ VulkanPipelineCache::PipelineCacheEntry* VulkanPipelineCache::createPipeline() n
         colorBlendState.attachmentCount = 0;
     }
 
+    // Ask the driver whether the pipeline was found in the VkPipelineCache.
+    VkPipelineCreationFeedbackEXT feedback = {};
+    VkPipelineCreationFeedbackEXT stageFeedbacks[SHADER_MODULE_COUNT] = {};
+    VkPipelineCreationFeedbackCreateInfoEXT feedbackInfo = {};
+    feedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+    feedbackInfo.pPipelineCreationFeedback = &feedback;
+    feedbackInfo.pipelineStageCreationFeedbackCount = pipelineCreateInfo.stageCount;
+    feedbackInfo.pPipelineStageCreationFeedbacks = stageFeedbacks;
+    if (mContext->isPipelineCreationFeedbackSupported()) {
+        pipelineCreateInfo.pNext = &feedbackInfo;
+    }
+
+    if (!mPipelineCacheCreated) {
+        createPipelineCache();
+    }
+
     PipelineCacheEntry cacheEntry = {};
 
     #if FVK_ENABLED(FVK_DEBUG_SHADER_MODULE)
@@ -230,7 +278,7 @@ VulkanPipelineCache::PipelineCacheEntry* VulkanPipelineCache::createPipeline() n
                  << shaderStages[0].module << ", " << shaderStages[1].module << ")"
                  << utils::io::endl;
     #endif
-    VkResult error = vkCreateGraphicsPipelines(mDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo,
+    VkResult error = vkCreateGraphicsPipelines(mDevice, mPipelineCache, 1, &pipelineCreateInfo,
             VKALLOC, &cacheEntry.handle);
     assert_invariant(error == VK_SUCCESS);
     if (error != VK_SUCCESS) {
@@ -238,6 +286,15 @@ VulkanPipelineCache::PipelineCacheEntry* VulkanPipelineCache::createPipeline() n
         return nullptr;
     }
 
+    // a pipeline found in the cache doesn't add anything to it
+    bool const cacheHit = (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT) &&
+            (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT);
+    if (mPipelineCache != VK_NULL_HANDLE && !cacheHit) {
+        mPipelineCacheDirty = true;
+        mLastPipelineCreation = mCurrentTime;
+    }
+    updateStats(feedback);
+
     return &mPipelines.emplace(mPipelineRequirements, cacheEntry).first.value();
 }
 
@@ -287,6 +344,93 @@ void VulkanPipelineCache::terminate() noexcept {
     }
     mPipelines.clear();
     mBoundPipeline = {};
+
+    if (mPipelineCache != VK_NULL_HANDLE) {
+        if (mPipelineCacheDirty) {
+            savePipelineCache();
+        }
+        vkDestroyPipelineCache(mDevice, mPipelineCache, VKALLOC);
+        mPipelineCache = VK_NULL_HANDLE;
+    }
+    mPipelineCacheCreated = false;
+}
+
+void VulkanPipelineCache::createPipelineCache() noexcept {
+    mPipelineCacheCreated = true;
+
+    std::vector<uint8_t> data;
+    if (mPlatform->hasRetrieveBlobFunc()) {
+        // always attempt with 64 KiB, like OpenGLBlobCache
+        constexpr size_t DEFAULT_BLOB_SIZE = 65536;
+        data.resize(DEFAULT_BLOB_SIZE);
+        size_t size = mPlatform->retrieveBlob(PIPELINE_CACHE_KEY, sizeof(PIPELINE_CACHE_KEY) - 1,
+                data.data(), data.size());
+        if (size > data.size()) {
+            // our buffer was too small, retry with the correct size
+            data.resize(size);
+            size = mPlatform->retrieveBlob(PIPELINE_CACHE_KEY, sizeof(PIPELINE_CACHE_KEY) - 1,
+                    data.data(), data.size());
+        }
+        // the entry could have been replaced in between
+        data.resize(size <= data.size() ? size : 0);
+        if (!data.empty() &&
+                !isPipelineCacheCompatible(data, mContext->getPhysicalDeviceProperties())) {
+            FVK_LOGW << "Ignoring incompatible pipeline cache data" << utils::io::endl;
+            data.clear();
+        }
+    }
+
+    VkPipelineCacheCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.data();
+    VkResult result = vkCreatePipelineCache(mDevice, &createInfo, VKALLOC, &mPipelineCache);
+    if (result != VK_SUCCESS && !data.empty()) {
+        // the data could be corrupted, start over with an empty cache
+        createInfo.initialDataSize = 0;
+        createInfo.pInitialData = nullptr;
+        result = vkCreatePipelineCache(mDevice, &createInfo, VKALLOC, &mPipelineCache);
+    }
+    if (result != VK_SUCCESS) {
+        // pipelines can still be created without a cache
+        FVK_LOGE << "vkCreatePipelineCache error " << result << utils::io::endl;
+        mPipelineCache = VK_NULL_HANDLE;
+    }
+}
+
+void VulkanPipelineCache::savePipelineCache() noexcept {
+    assert_invariant(mPipelineCache != VK_NULL_HANDLE);
+    mPipelineCacheDirty = false;
+    if (!mPlatform->hasInsertBlobFunc()) {
+        return;
+    }
+    size_t size = 0;
+    VkResult result = vkGetPipelineCacheData(mDevice, mPipelineCache, &size, nullptr);
+    if (result != VK_SUCCESS || !size) {
+        return;
+    }
+    std::vector<uint8_t> data(size);
+    result = vkGetPipelineCacheData(mDevice, mPipelineCache, &size, data.data());
+    if (result == VK_SUCCESS) {
+        mPlatform->insertBlob(PIPELINE_CACHE_KEY, sizeof(PIPELINE_CACHE_KEY) - 1,
+                data.data(), size);
+    }
+}
+
+void VulkanPipelineCache::updateStats(VkPipelineCreationFeedbackEXT const& feedback) noexcept {
+    mStats.created++;
+    if (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT) {
+        if (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT) {
+            mStats.hits++;
+        } else {
+            mStats.misses++;
+        }
+    }
+    if (mPlatform->hasDebugUpdateStatFunc()) {
+        mPlatform->debugUpdateStat("filament.vulkan.pipelines_created", mStats.created);
+        mPlatform->debugUpdateStat("filament.vulkan.pipeline_cache_hits", mStats.hits);
+        mPlatform->debugUpdateStat("filament.vulkan.pipeline_cache_misses", mStats.misses);
+    }
 }
 
 void VulkanPipelineCache::gc() noexcept {
@@ -300,6 +444,11 @@ void VulkanPipelineCache::gc() noexcept {
     // buffer is undefined." Therefore, we need to clear all bindings at this time.
     mBoundPipeline = {};
 
+    if (mPipelineCacheDirty &&
+            mLastPipelineCreation + FVK_PIPELINE_CACHE_SAVE_DELAY < mCurrentTime) {
+        savePipelineCache();
+    }
+
     // NOTE: Due to robin_map restrictions, we cannot use auto or range-based loops.
 
     // Evict any pipelines that have not been used in a while.
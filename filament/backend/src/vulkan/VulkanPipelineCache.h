@@ -18,6 +18,7 @@
 #define TNT_FILAMENT_BACKEND_VULKANPIPELINECACHE_H
 
 #include "VulkanCommands.h"
+#include "VulkanContext.h"
 #include "VulkanMemory.h"
 #include "VulkanUtility.h"
 
@@ -40,6 +41,7 @@
 
 namespace filament::backend {
 
+class Platform;
 struct VulkanProgram;
 struct VulkanBufferObject;
 struct VulkanTexture;
@@ -53,6 +55,10 @@ struct VulkanTexture;
 // - Assumes that viewport and scissor should be dynamic. (not baked into VkPipeline)
 // - Assumes that uniform buffers should be visible across all shader stages.
 //
+// Pipelines are created through a VkPipelineCache, which is loaded from and saved to the platform's
+// blob cache (see Platform::setBlobFunc), so that the driver can skip compiling pipelines that
+// were already created in a previous run.
+//
 class VulkanPipelineCache {
 public:
     VulkanPipelineCache(VulkanPipelineCache const&) = delete;
@@ -109,9 +115,19 @@ public:
         VkDeviceSize size;
     };
 
+    // Pipeline creation statistics, also reported through Platform::debugUpdateStat(). The driver
+    // only tells hits from misses if VK_EXT_pipeline_creation_feedback is supported, otherwise
+    // both stay at zero.
+    struct PipelineStats {
+        uint32_t created = 0;   // number of VkPipeline created
+        uint32_t hits = 0;      // ...of which were found in the VkPipelineCache
+        uint32_t misses = 0;    // ...of which had to be compiled
+    };
+
     // Upon construction, the pipeCache initializes some internal state but does not make any Vulkan
     // calls. On destruction it will free any cached Vulkan objects that haven't already been freed.
-    VulkanPipelineCache(VkDevice device, VmaAllocator allocator);
+    VulkanPipelineCache(VkDevice device, VmaAllocator allocator, Platform* platform,
+            VulkanContext const* context);
     ~VulkanPipelineCache();
 
     void bindLayout(VkPipelineLayout layout) noexcept;
@@ -129,8 +145,11 @@ public:
             VkVertexInputBindingDescription const* bufferDesc, uint8_t count);
 
     // Destroys all managed Vulkan objects. This should be called before changing the VkDevice.
+    // The VkPipelineCache is saved first.
     void terminate() noexcept;
 
+    PipelineStats const& getStats() const noexcept { return mStats; }
+
     static VkPrimitiveTopology getPrimitiveTopology(PrimitiveType pt) noexcept {
         switch (pt) {
             case PrimitiveType::POINTS:
@@ -250,9 +269,26 @@ private:
     PipelineCacheEntry* createPipeline() noexcept;
     PipelineLayoutCacheEntry* getOrCreatePipelineLayout() noexcept;
 
+    // The VkPipelineCache is created along with the first pipeline rather than upon construction,
+    // so that the blob cache functions can be set on the platform after the driver is created.
+    void createPipelineCache() noexcept;
+    void savePipelineCache() noexcept;
+    void updateStats(VkPipelineCreationFeedbackEXT const& feedback) noexcept;
+
     // Immutable state.
     VkDevice mDevice = VK_NULL_HANDLE;
     VmaAllocator mAllocator = VK_NULL_HANDLE;
+    Platform* mPlatform = nullptr;
+    VulkanContext const* mContext = nullptr;
+
+    // The VkPipelineCache, it is saved once no pipeline has been created for
+    // FVK_PIPELINE_CACHE_SAVE_DELAY flushes, and upon termination.
+    VkPipelineCache mPipelineCache = VK_NULL_HANDLE;
+    bool mPipelineCacheCreated = false;
+    bool mPipelineCacheDirty = false;
+    Timestamp mLastPipelineCreation = 0;
+
+    PipelineStats mStats;
 
     // Current requirements for the pipeline layout, pipeline, and descriptor sets.
     PipelineKey mPipelineRequirements = {};
@@ -60,20 +60,28 @@ BackendTest::~BackendTest() {
     if (sBackend == Backend::OPENGL) {
         return;
     }
-    flushAndWait();
-    driver->terminate();
-    delete driver;
+    if (driver) {
+        terminateDriver();
+    }
 }
 
 void BackendTest::initializeDriver() {
     auto backend = static_cast<filament::backend::Backend>(sBackend);
-    Platform* platform = PlatformFactory::create(&backend);
+    platform = PlatformFactory::create(&backend);
     assert_invariant(static_cast<uint8_t>(backend) == static_cast<uint8_t>(sBackend));
     Platform::DriverConfig const driverConfig;
     driver = platform->createDriver(nullptr, driverConfig);
     commandStream = std::make_unique<CommandStream>(*driver, commandBufferQueue.getCircularBuffer());
 }
 
+void BackendTest::terminateDriver() {
+    flushAndWait();
+    driver->terminate();
+    delete driver;
+    driver = nullptr;
+    commandStream.reset();
+}
+
 void BackendTest::executeCommands() {
     commandBufferQueue.flush();
     auto buffers = commandBufferQueue.waitForCommands();
@@ -42,6 +42,7 @@ protected:
     ~BackendTest() override;
 
     void initializeDriver();
+    void terminateDriver();
     void executeCommands();
     void flushAndWait();
 
@@ -70,9 +71,11 @@ protected:
 
     filament::backend::DriverApi& getDriverApi() { return *commandStream; }
     filament::backend::Driver& getDriver() { return *driver; }
+    filament::backend::Platform& getPlatform() { return *platform; }
 
 private:
 
+    filament::backend::Platform* platform = nullptr;
     filament::backend::Driver* driver = nullptr;
     filament::backend::CommandBufferQueue commandBufferQueue;
     std::unique_ptr<filament::backend::DriverApi> commandStream;
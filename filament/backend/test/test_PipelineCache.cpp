@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BackendTest.h"
+
+#include "ShaderGenerator.h"
+#include "TrianglePrimitive.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <string.h>
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Shaders
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string vertex (R"(#version 450 core
+
+layout(location = 0) in vec4 mesh_position;
+
+void main() {
+    gl_Position = vec4(mesh_position.xy, 0.0, 1.0);
+}
+)");
+
+std::string fragment (R"(#version 450 core
+
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+    fragColor = vec4(1.0);
+}
+
+)");
+
+}
+
+namespace test {
+
+using namespace filament;
+using namespace filament::backend;
+
+namespace {
+
+// An in-memory blob cache, which outlives the drivers.
+struct BlobCache {
+    std::unordered_map<std::string, std::vector<uint8_t>> blobs;
+    std::unordered_map<std::string, uint64_t> stats;
+
+    void attach(Platform& platform) {
+        platform.setBlobFunc(
+                [this](void const* key, size_t keySize, void const* value, size_t valueSize) {
+                    auto const* p = static_cast<uint8_t const*>(value);
+                    blobs[{ static_cast<char const*>(key), keySize }].assign(p, p + valueSize);
+                },
+                [this](void const* key, size_t keySize, void* value, size_t valueSize) -> size_t {
+                    auto pos = blobs.find({ static_cast<char const*>(key), keySize });
+                    if (pos == blobs.end()) {
+                        return 0;
+                    }
+                    if (pos->second.size() <= valueSize) {
+                        memcpy(value, pos->second.data(), pos->second.size());
+                    }
+                    return pos->second.size();
+                });
+        platform.setDebugUpdateStatFunc([this](char const* key, uint64_t value) {
+            stats[key] = value;
+        });
+    }
+};
+
+} // anonymous namespace
+
+/**
+ * This test case checks that the Vulkan backend saves its VkPipelineCache through the platform's
+ * blob cache, and that a new driver finds its pipelines in it.
+ */
+TEST_F(BackendTest, VulkanPipelineCache) {
+    if (sBackend != Backend::VULKAN) {
+        GTEST_SKIP();
+    }
+
+    auto renderFrame = [this]() {
+        // The test is executed within this block scope to force destructors to run before
+        // executeCommands().
+        {
+            auto swapChain = createSwapChain();
+            getDriverApi().makeCurrent(swapChain, swapChain);
+
+            ShaderGenerator shaderGen(vertex, fragment, sBackend, sIsMobilePlatform);
+            Program p = shaderGen.getProgram(getDriverApi());
+            auto program = getDriverApi().createProgram(std::move(p));
+            auto defaultRenderTarget = getDriverApi().createDefaultRenderTarget(0);
+            TrianglePrimitive triangle(getDriverApi());
+
+            RenderPassParams params = {};
+            fullViewport(params);
+            params.flags.clear = TargetBufferFlags::COLOR;
+            params.flags.discardStart = TargetBufferFlags::ALL;
+            params.flags.discardEnd = TargetBufferFlags::NONE;
+
+            PipelineState state;
+            state.program = program;
+            state.rasterState.colorWrite = true;
+            state.rasterState.depthWrite = false;
+            state.rasterState.depthFunc = RasterState::DepthFunc::A;
+            state.rasterState.culling = CullingMode::NONE;
+
+            getDriverApi().beginFrame(0, 0, 0);
+            getDriverApi().beginRenderPass(defaultRenderTarget, params);
+            getDriverApi().draw(state, triangle.getRenderPrimitive(), 0, 3, 1);
+            getDriverApi().endRenderPass();
+            getDriverApi().flush();
+            getDriverApi().commit(swapChain);
+            getDriverApi().endFrame(0);
+
+            getDriverApi().destroyProgram(program);
+            getDriverApi().destroySwapChain(swapChain);
+            getDriverApi().destroyRenderTarget(defaultRenderTarget);
+        }
+        executeCommands();
+    };
+
+    BlobCache cache;
+
+    // The cache is loaded when the first pipeline is created, so the blob functions can be set
+    // after the driver is created. It is saved upon termination.
+    cache.attach(getPlatform());
+    renderFrame();
+    terminateDriver();
+    EXPECT_EQ(cache.blobs.size(), 1u);
+    EXPECT_EQ(cache.stats["filament.vulkan.pipelines_created"], 1u);
+    EXPECT_EQ(cache.stats["filament.vulkan.pipeline_cache_hits"], 0u);
+
+    cache.stats.clear();
+    initializeDriver();
+    cache.attach(getPlatform());
+    renderFrame();
+    EXPECT_EQ(cache.stats["filament.vulkan.pipelines_created"], 1u);
+    // Only drivers supporting VK_EXT_pipeline_creation_feedback report hits and misses.
+    uint64_t const hits = cache.stats["filament.vulkan.pipeline_cache_hits"];
+    uint64_t const misses = cache.stats["filament.vulkan.pipeline_cache_misses"];
+    if (hits + misses) {
+        EXPECT_EQ(hits, 1u);
+    }
+}
+
+} // namespace test
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <benchmark/benchmark.h>
+
+#include <filament/Frustum.h>
+#include "Culler.h"
+#include "SceneBvh.h"
+
+#include <utils/Allocator.h>
+
+#include <math/mat4.h>
+#include <math/vec3.h>
+
+#include <random>
+#include <vector>
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+/*
+ * Renderables are scattered uniformly in a large square world, and the camera sees a small
+ * portion of it, which is representative of large open scenes.
+ */
+class FilamentBvhCullingFixture : public benchmark::Fixture {
+protected:
+    Frustum frustum{};
+    std::vector<float3> boxesCenter;
+    std::vector<float3> boxesExtent;
+    Culler::result_type* UTILS_RESTRICT visibles = nullptr;
+    SceneBvh bvh;
+    size_t count = 0;
+
+public:
+    void SetUp(benchmark::State const& state) override {
+        count = size_t(state.range(0));
+
+        std::default_random_engine gen; // NOLINT
+        std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+        std::uniform_real_distribution<float> size(0.5f, 5.0f);
+
+        frustum = Frustum{ mat4f::perspective(45.0f, 1.0f, 0.1f, 250.0f) };
+
+        // the Culler processes multiple of MODULO items
+        size_t const capacity = Culler::round(count);
+        boxesCenter.resize(capacity);
+        boxesExtent.resize(capacity);
+        for (size_t i = 0; i < count; i++) {
+            boxesCenter[i] = { position(gen), position(gen) * 0.05f, position(gen) };
+            boxesExtent[i] = { size(gen), size(gen), size(gen) };
+        }
+
+        visibles = (Culler::result_type*)utils::aligned_alloc(capacity * sizeof(*visibles), 32);
+        std::fill_n(visibles, capacity, 0);
+
+        bvh.update(boxesCenter.data(), boxesExtent.data(), count);
+    }
+
+    void TearDown(benchmark::State const&) override {
+        utils::aligned_free(visibles);
+        visibles = nullptr;
+        bvh.clear();
+    }
+};
+
+BENCHMARK_DEFINE_F(FilamentBvhCullingFixture, flatCulling)(benchmark::State& state) {
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            Culler::Test::intersects(visibles, frustum,
+                    boxesCenter.data(), boxesExtent.data(), count);
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * count));
+    }
+}
+
+BENCHMARK_DEFINE_F(FilamentBvhCullingFixture, bvhCulling)(benchmark::State& state) {
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            bvh.intersects(visibles, frustum, boxesCenter.data(), boxesExtent.data(), 0);
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * count));
+    }
+}
+
+BENCHMARK_DEFINE_F(FilamentBvhCullingFixture, bvhRefit)(benchmark::State& state) {
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            bvh.update(boxesCenter.data(), boxesExtent.data(), count);
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * count));
+    }
+}
+
+BENCHMARK_DEFINE_F(FilamentBvhCullingFixture, bvhRefitAndCulling)(benchmark::State& state) {
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            bvh.update(boxesCenter.data(), boxesExtent.data(), count);
+            bvh.intersects(visibles, frustum, boxesCenter.data(), boxesExtent.data(), 0);
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * count));
+    }
+}
+
+BENCHMARK_REGISTER_F(FilamentBvhCullingFixture, flatCulling)
+        ->Arg(1000)->Arg(10000)->Arg(100000)->Arg(1000000);
+BENCHMARK_REGISTER_F(FilamentBvhCullingFixture, bvhCulling)
+        ->Arg(1000)->Arg(10000)->Arg(100000)->Arg(1000000);
+BENCHMARK_REGISTER_F(FilamentBvhCullingFixture, bvhRefit)
+        ->Arg(1000)->Arg(10000)->Arg(100000)->Arg(1000000);
+BENCHMARK_REGISTER_F(FilamentBvhCullingFixture, bvhRefitAndCulling)
+        ->Arg(1000)->Arg(10000)->Arg(100000)->Arg(1000000);
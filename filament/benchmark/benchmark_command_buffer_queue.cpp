@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <benchmark/benchmark.h>
+
+#include <private/backend/CircularBuffer.h>
+#include <private/backend/CommandBufferQueue.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace filament::backend;
+
+/*
+ * Measures the latency of CommandBufferQueue::flush() while state.range(0) - 1 other threads
+ * flush their own Slice as fast as they can, and a consumer thread releases everything.
+ * state.range(1) is the size of each command buffer.
+ */
+class CommandBufferQueueFixture : public benchmark::Fixture {
+protected:
+    static constexpr size_t REQUIRED_SIZE = 1024 * 1024;
+    static constexpr size_t BUFFER_SIZE = 3 * REQUIRED_SIZE;
+
+    CommandBufferQueue* queue = nullptr;
+    std::thread consumer;
+    std::vector<std::thread> producers;
+    std::atomic<bool> stop = { false };
+
+public:
+    void SetUp(benchmark::State const& state) override {
+        queue = new CommandBufferQueue(REQUIRED_SIZE, BUFFER_SIZE, false);
+        stop = false;
+
+        consumer = std::thread([this]() {
+            while (true) {
+                auto const buffers = queue->waitForCommands();
+                if (buffers.empty()) {
+                    break;
+                }
+                for (auto const& buffer : buffers) {
+                    queue->releaseBuffer(buffer);
+                }
+            }
+        });
+
+        size_t const size = size_t(state.range(1));
+        for (int64_t i = 1; i < state.range(0); i++) {
+            CommandBufferQueue::Slice* const slice = queue->createSlice(BUFFER_SIZE);
+            producers.emplace_back([this, slice, size]() {
+                while (!stop.load(std::memory_order_relaxed)) {
+                    slice->getCircularBuffer().allocate(size);
+                    queue->flush(*slice);
+                }
+            });
+        }
+    }
+
+    void TearDown(benchmark::State const&) override {
+        stop = true;
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        producers.clear();
+        queue->requestExit();
+        consumer.join();
+        delete queue;
+        queue = nullptr;
+    }
+};
+
+BENCHMARK_DEFINE_F(CommandBufferQueueFixture, flush)(benchmark::State& state) {
+    size_t const size = size_t(state.range(1));
+    CircularBuffer& circularBuffer = queue->getCircularBuffer();
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            circularBuffer.allocate(size);
+            queue->flush();
+        }
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations()));
+        state.SetBytesProcessed(int64_t(state.iterations() * size));
+    }
+}
+
+static void producerArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "producers", "size" });
+    for (int64_t const producers : { 1, 2, 4, 8 }) {
+        for (int64_t const size : { 256, 16384 }) {
+            b->Args({ producers, size });
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(CommandBufferQueueFixture, flush)->Apply(producerArgs)->UseRealTime();
@@ -103,3 +103,45 @@ BENCHMARK_F(FilamentCullingFixture, sphereCulling)(benchmark::State& state) {
         state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
     }
 }
+
+// Same as above, with each of the SIMD kernels. The label is the instruction set.
+BENCHMARK_DEFINE_F(FilamentCullingFixture, boxCullingIsa)(benchmark::State& state) {
+    auto const isa = Culler::Isa(state.range(0));
+    state.SetLabel(Culler::getIsaName(isa));
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            Culler::Test::intersects(isa, visibles, frustum, boxesCenter.data(), boxesExtent.data(), BATCH_SIZE);
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+    }
+}
+
+BENCHMARK_DEFINE_F(FilamentCullingFixture, sphereCullingIsa)(benchmark::State& state) {
+    auto const isa = Culler::Isa(state.range(0));
+    state.SetLabel(Culler::getIsaName(isa));
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            Culler::Test::intersects(isa, visibles, frustum, spheres.data(), BATCH_SIZE);
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+    }
+}
+
+// only the instruction sets supported by this CPU are registered
+static void cullingIsaArguments(benchmark::internal::Benchmark* b) {
+    for (auto isa : { Culler::Isa::SCALAR, Culler::Isa::SSE2, Culler::Isa::AVX2,
+            Culler::Isa::NEON }) {
+        if (Culler::isSupported(isa)) {
+            b->Arg(int64_t(isa));
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(FilamentCullingFixture, boxCullingIsa)->Apply(cullingIsaArguments);
+BENCHMARK_REGISTER_F(FilamentCullingFixture, sphereCullingIsa)->Apply(cullingIsaArguments);
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <benchmark/benchmark.h>
+
+#include "Allocators.h"
+#include "Froxelizer.h"
+
+#include "details/Engine.h"
+#include "details/Scene.h"
+#include "details/View.h"
+
+#include <filament/Engine.h>
+#include <filament/Frustum.h>
+#include <filament/LightManager.h>
+#include <filament/Viewport.h>
+
+#include <utils/Entity.h>
+#include <utils/EntityManager.h>
+
+#include <math/mat4.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <random>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+/*
+ * CPU cost of binning state.range(0) point and spot lights (half each) spread in front of the
+ * camera, at a viewport height of state.range(1) with a 16:9 aspect ratio. Each iteration culls
+ * the lights, keeps the CONFIG_MAX_LIGHT_COUNT closest ones and froxelizes them, using the NOOP
+ * backend.
+ */
+class FroxelizerFixture : public benchmark::Fixture {
+protected:
+    static constexpr float NEAR = 0.1f;
+    static constexpr float FAR = 200.0f;
+
+    FEngine* engine = nullptr;
+    Froxelizer* froxelizer = nullptr;
+    LinearAllocatorArena* arena = nullptr;
+    std::vector<Entity> entities;
+    std::vector<float4> spheres;
+    std::vector<float3> directions;
+    std::vector<float> scratch;
+    FScene::LightSoa lightData;
+    Viewport viewport;
+    mat4f projection;
+
+public:
+    void SetUp(benchmark::State const& state) override {
+        engine = downcast(Engine::Builder().backend(Engine::Backend::NOOP).build());
+        froxelizer = new Froxelizer(*engine);
+        arena = new LinearAllocatorArena("froxelizer benchmark", 4 * 1024 * 1024);
+
+        uint32_t const height = uint32_t(state.range(1));
+        uint32_t const width = height * 16 / 9;
+        viewport = { 0, 0, width, height };
+        projection = mat4f::perspective(60.0f, float(width) / float(height), NEAR, FAR);
+
+        size_t const count = size_t(state.range(0));
+        entities.resize(count);
+        EntityManager::get().create(count, entities.data());
+
+        std::default_random_engine gen; // NOLINT
+        std::uniform_real_distribution<float> x(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> y(-10.0f, 10.0f);
+        std::uniform_real_distribution<float> z(-FAR, -1.0f);
+        std::uniform_real_distribution<float> radius(1.0f, 10.0f);
+
+        // the first light is always the directional light, which is skipped
+        spheres.resize(count + FScene::DIRECTIONAL_LIGHTS_COUNT);
+        directions.resize(count + FScene::DIRECTIONAL_LIGHTS_COUNT);
+        for (size_t i = 0; i < count; i++) {
+            bool const spot = i & 1;
+            float const r = radius(gen);
+            LightManager::Builder(spot ? LightManager::Type::SPOT : LightManager::Type::POINT)
+                    .falloff(r)
+                    .spotLightCone(0.4f, 0.6f)
+                    .intensity(1000.0f)
+                    .build(*engine, entities[i]);
+            spheres[i + FScene::DIRECTIONAL_LIGHTS_COUNT] = { x(gen), y(gen), z(gen), r };
+            directions[i + FScene::DIRECTIONAL_LIGHTS_COUNT] = normalize(float3{ 0, -1, -1 });
+        }
+        scratch.resize((spheres.size() + 3u) & ~3u);
+    }
+
+    void TearDown(benchmark::State const&) override {
+        froxelizer->terminate(engine->getDriverApi());
+        delete froxelizer;
+        froxelizer = nullptr;
+        lightData.clear();
+        for (Entity const e : entities) {
+            engine->getLightManager().destroy(e);
+        }
+        EntityManager::get().destroy(entities.size(), entities.data());
+        entities.clear();
+        delete arena;
+        arena = nullptr;
+        Engine* e = engine;
+        Engine::destroy(&e);
+        engine = nullptr;
+    }
+
+    // FView::prepareVisibleLights() is private, only this fixture is a friend
+    void prepareVisibleLights(mat4f const& view, Frustum const& frustum) {
+        FView::prepareVisibleLights(engine->getLightManager(),
+                { scratch.data(), scratch.size() }, view, frustum, lightData);
+    }
+
+    // culling and froxelization modify the lights, so they're reset before each iteration
+    void resetLights() {
+        FLightManager const& lcm = engine->getLightManager();
+        lightData.resize(spheres.size());
+        for (size_t i = FScene::DIRECTIONAL_LIGHTS_COUNT; i < spheres.size(); i++) {
+            lightData.elementAt<FScene::POSITION_RADIUS>(i) = spheres[i];
+            lightData.elementAt<FScene::DIRECTION>(i) = directions[i];
+            lightData.elementAt<FScene::LIGHT_INSTANCE>(i) =
+                    lcm.getInstance(entities[i - FScene::DIRECTIONAL_LIGHTS_COUNT]);
+        }
+    }
+};
+
+BENCHMARK_DEFINE_F(FroxelizerFixture, froxelizeLights)(benchmark::State& state) {
+    FEngine::DriverApi& driver = engine->getDriverApi();
+    mat4f const view;
+    Frustum const frustum{ projection * view };
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            resetLights();
+            RootArenaScope rootArenaScope(*arena);
+            prepareVisibleLights(view, frustum);
+            froxelizer->prepare(driver, rootArenaScope, viewport, projection, NEAR, FAR);
+            froxelizer->froxelizeLights(*engine, view, lightData);
+            froxelizer->commit(driver);
+            engine->flush();
+        }
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * entities.size()));
+    }
+}
+
+static void lightArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "lights", "height" });
+    for (int64_t const lights : { 256, 1024, 4096, 16384 }) {
+        for (int64_t const height : { 1080, 2160 }) {
+            b->Args({ lights, height });
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(FroxelizerFixture, froxelizeLights)->Apply(lightArgs)->UseRealTime();
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <benchmark/benchmark.h>
+
+#include <filament/Box.h>
+#include <filament/Camera.h>
+#include <filament/Engine.h>
+#include <filament/IndexBuffer.h>
+#include <filament/RenderableManager.h>
+#include <filament/Renderer.h>
+#include <filament/Scene.h>
+#include <filament/SwapChain.h>
+#include <filament/TransformManager.h>
+#include <filament/VertexBuffer.h>
+#include <filament/View.h>
+#include <filament/Viewport.h>
+
+#include <utils/Entity.h>
+#include <utils/EntityManager.h>
+
+#include <math/mat4.h>
+#include <math/vec3.h>
+
+#include <random>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+/*
+ * CPU cost of rendering state.range(0) Views, each with its own Scene of RENDERABLE_COUNT
+ * renderables, using the NOOP backend. With state.range(1) set, the Views are rendered with
+ * Renderer::renderViews(), which prepares them concurrently, otherwise with Renderer::render().
+ */
+class RendererFixture : public benchmark::Fixture {
+protected:
+    static constexpr size_t RENDERABLE_COUNT = 4096;
+    static constexpr uint32_t WIDTH = 640;
+    static constexpr uint32_t HEIGHT = 360;
+
+    Engine* engine = nullptr;
+    SwapChain* swapChain = nullptr;
+    Renderer* renderer = nullptr;
+    VertexBuffer* vertexBuffer = nullptr;
+    IndexBuffer* indexBuffer = nullptr;
+    std::vector<View*> views;
+    std::vector<Scene*> scenes;
+    std::vector<Entity> cameras;
+    std::vector<Entity> renderables;
+
+public:
+    void SetUp(benchmark::State const& state) override {
+        engine = Engine::Builder().backend(Engine::Backend::NOOP).build();
+        swapChain = engine->createSwapChain(WIDTH, HEIGHT, 0);
+        renderer = engine->createRenderer();
+
+        static float3 const vertices[] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 } };
+        static uint16_t const indices[] = { 0, 1, 2 };
+        vertexBuffer = VertexBuffer::Builder()
+                .vertexCount(3)
+                .bufferCount(1)
+                .attribute(VertexAttribute::POSITION, 0,
+                        VertexBuffer::AttributeType::FLOAT3)
+                .build(*engine);
+        vertexBuffer->setBufferAt(*engine, 0, { vertices, sizeof(vertices) });
+        indexBuffer = IndexBuffer::Builder()
+                .indexCount(3)
+                .bufferType(IndexBuffer::IndexType::USHORT)
+                .build(*engine);
+        indexBuffer->setBuffer(*engine, { indices, sizeof(indices) });
+
+        std::default_random_engine gen; // NOLINT
+        std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+
+        size_t const viewCount = size_t(state.range(0));
+        cameras.resize(viewCount);
+        EntityManager::get().create(viewCount, cameras.data());
+        renderables.resize(viewCount * RENDERABLE_COUNT);
+        EntityManager::get().create(renderables.size(), renderables.data());
+
+        auto& tcm = engine->getTransformManager();
+        for (size_t v = 0; v < viewCount; v++) {
+            Scene* const scene = engine->createScene();
+            for (size_t i = 0; i < RENDERABLE_COUNT; i++) {
+                Entity const e = renderables[v * RENDERABLE_COUNT + i];
+                RenderableManager::Builder(1)
+                        .boundingBox({{ 0.5f, 0.5f, 0.0f }, { 0.5f, 0.5f, 0.1f }})
+                        .geometry(0, RenderableManager::PrimitiveType::TRIANGLES,
+                                vertexBuffer, indexBuffer)
+                        .castShadows(false)
+                        .build(*engine, e);
+                tcm.create(e, TransformManager::Instance{},
+                        mat4f::translation(float3{ position(gen), position(gen), position(gen) }));
+                scene->addEntity(e);
+            }
+
+            Camera* const camera = engine->createCamera(cameras[v]);
+            camera->setProjection(60.0, double(WIDTH) / double(HEIGHT), 0.1, 500.0);
+            camera->lookAt({ 0, 0, 200 }, { 0, 0, 0 });
+
+            View* const view = engine->createView();
+            view->setScene(scene);
+            view->setCamera(camera);
+            view->setViewport({ 0, 0, WIDTH, HEIGHT });
+            view->setPostProcessingEnabled(false);
+            view->setShadowingEnabled(false);
+            views.push_back(view);
+            scenes.push_back(scene);
+        }
+    }
+
+    void TearDown(benchmark::State const&) override {
+        for (View* view : views) {
+            engine->destroy(view);
+        }
+        for (Scene* scene : scenes) {
+            engine->destroy(scene);
+        }
+        for (Entity const e : renderables) {
+            engine->destroy(e);
+        }
+        for (Entity const e : cameras) {
+            engine->destroyCameraComponent(e);
+        }
+        EntityManager::get().destroy(renderables.size(), renderables.data());
+        EntityManager::get().destroy(cameras.size(), cameras.data());
+        views.clear();
+        scenes.clear();
+        renderables.clear();
+        cameras.clear();
+        engine->destroy(vertexBuffer);
+        engine->destroy(indexBuffer);
+        engine->destroy(renderer);
+        engine->destroy(swapChain);
+        Engine::destroy(&engine);
+        engine = nullptr;
+    }
+};
+
+BENCHMARK_DEFINE_F(RendererFixture, renderViews)(benchmark::State& state) {
+    bool const concurrent = state.range(1) != 0;
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            if (renderer->beginFrame(swapChain)) {
+                if (concurrent) {
+                    renderer->renderViews(views.data(), views.size());
+                } else {
+                    for (View const* view : views) {
+                        renderer->render(view);
+                    }
+                }
+                renderer->endFrame();
+            }
+            // don't let the frame skipper drop frames because the backend fell behind
+            engine->flushAndWait();
+        }
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * views.size()));
+    }
+}
+
+static void viewArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "views", "concurrent" });
+    for (int64_t const views : { 1, 4, 8 }) {
+        for (int64_t const concurrent : { 0, 1 }) {
+            b->Args({ views, concurrent });
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(RendererFixture, renderViews)->Apply(viewArgs)->UseRealTime();
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <benchmark/benchmark.h>
+
+#include "RadixSort.h"
+
+#include <utils/JobSystem.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <stdint.h>
+
+using namespace filament;
+using namespace utils;
+
+/*
+ * Mimics RenderPass::Command, a 64 bytes record sorted by its 64-bits key. Keys are
+ * generated following the layout of RenderPass::CommandKey for a color pass: a few hundred
+ * materials, 10-bits of depth bucket and a few priorities.
+ */
+class FilamentSortFixture : public benchmark::Fixture {
+protected:
+    struct alignas(8) Command {
+        uint64_t key;
+        uint64_t payload[7];
+        bool operator<(Command const& rhs) const noexcept { return key < rhs.key; }
+    };
+    static_assert(sizeof(Command) == 64);
+
+    std::vector<Command> source;
+    std::vector<Command> commands;
+    std::vector<Command> scratch;
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> indices;
+    JobSystem* js = nullptr;
+
+public:
+    void SetUp(benchmark::State const& state) override {
+        size_t const count = size_t(state.range(0));
+
+        std::default_random_engine gen; // NOLINT
+        std::uniform_int_distribution<uint64_t> material(0, 300);
+        std::uniform_int_distribution<uint64_t> instance(0, 15);
+        std::uniform_int_distribution<uint64_t> zbucket(0, 1023);
+        std::uniform_int_distribution<uint64_t> priority(0, 7);
+
+        source.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            uint64_t key = 0;
+            key |= uint64_t(0x01) << 58;                // COLOR pass
+            key |= uint64_t(0x01) << 56;                // CustomCommand::PASS
+            key |= priority(gen) << 50;
+            key |= zbucket(gen) << 32;
+            key |= material(gen) << 20;
+            key |= instance(gen);
+            source[i].key = key;
+            std::fill_n(source[i].payload, 7, i);
+        }
+        commands.resize(count);
+        scratch.resize(count);
+        keys.resize(count * 2);
+        indices.resize(count * 2);
+
+        js = new JobSystem();
+        js->adopt();
+    }
+
+    void TearDown(benchmark::State const&) override {
+        js->emancipate();
+        delete js;
+        js = nullptr;
+    }
+};
+
+BENCHMARK_DEFINE_F(FilamentSortFixture, stdSort)(benchmark::State& state) {
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            state.PauseTiming();
+            std::copy(source.begin(), source.end(), commands.begin());
+            state.ResumeTiming();
+            std::sort(commands.begin(), commands.end());
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * source.size()));
+    }
+}
+
+BENCHMARK_DEFINE_F(FilamentSortFixture, radixSortAndGather)(benchmark::State& state) {
+    {
+        size_t const count = source.size();
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            state.PauseTiming();
+            std::copy(source.begin(), source.end(), commands.begin());
+            state.ResumeTiming();
+            for (size_t i = 0; i < count; i++) {
+                keys[i] = commands[i].key;
+                indices[i] = uint32_t(i);
+            }
+            RadixSort::sort(*js, keys.data(), indices.data(),
+                    keys.data() + count, indices.data() + count, count);
+            for (size_t i = 0; i < count; i++) {
+                scratch[i] = commands[indices[i]];
+            }
+            std::copy(scratch.begin(), scratch.end(), commands.begin());
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * count));
+    }
+}
+
+BENCHMARK_DEFINE_F(FilamentSortFixture, radixSortKeysOnly)(benchmark::State& state) {
+    {
+        size_t const count = source.size();
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            for (size_t i = 0; i < count; i++) {
+                keys[i] = source[i].key;
+                indices[i] = uint32_t(i);
+            }
+            RadixSort::sort(*js, keys.data(), indices.data(),
+                    keys.data() + count, indices.data() + count, count);
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * count));
+    }
+}
+
+BENCHMARK_REGISTER_F(FilamentSortFixture, stdSort)
+        ->Arg(1000)->Arg(5000)->Arg(20000)->Arg(50000)->Arg(100000);
+BENCHMARK_REGISTER_F(FilamentSortFixture, radixSortAndGather)
+        ->Arg(1000)->Arg(5000)->Arg(20000)->Arg(50000)->Arg(100000);
+BENCHMARK_REGISTER_F(FilamentSortFixture, radixSortKeysOnly)
+        ->Arg(1000)->Arg(5000)->Arg(20000)->Arg(50000)->Arg(100000);
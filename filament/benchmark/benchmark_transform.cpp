@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <benchmark/benchmark.h>
+
+#include "components/TransformManager.h"
+
+#include <utils/Entity.h>
+#include <utils/EntityManager.h>
+#include <utils/JobSystem.h>
+
+#include <math/mat4.h>
+#include <math/vec3.h>
+
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+/*
+ * About 200k nodes: 2000 roots with 10 children each, which have 9 children each. Every
+ * iteration animates state.range(0) random nodes of the middle level, which is representative
+ * of a large scene where only a few characters move.
+ */
+class FilamentTransformFixture : public benchmark::Fixture {
+protected:
+    static constexpr size_t ROOTS = 2000;
+    static constexpr size_t CHILDREN = 10;
+    static constexpr size_t GRAND_CHILDREN = 9;
+
+    JobSystem* js = nullptr;
+    std::optional<FTransformManager> tcm;
+    std::vector<Entity> entities;
+    std::vector<Entity> roots;
+    std::vector<Entity> animated;
+
+public:
+    void SetUp(benchmark::State const& state) override {
+        js = new JobSystem();
+        js->adopt();
+        tcm.emplace(js);
+
+        EntityManager& em = EntityManager::get();
+        entities.resize(ROOTS * (1 + CHILDREN * (1 + GRAND_CHILDREN)));
+        em.create(entities.size(), entities.data());
+
+        std::vector<Entity> children;
+        size_t e = 0;
+        tcm->openLocalTransformTransaction();
+        for (size_t r = 0; r < ROOTS; r++) {
+            Entity const root = entities[e++];
+            tcm->create(root, {}, mat4f::translation(float3{ float(r), 0, 0 }));
+            roots.push_back(root);
+            for (size_t c = 0; c < CHILDREN; c++) {
+                Entity const child = entities[e++];
+                tcm->create(child, tcm->getInstance(root),
+                        mat4f::translation(float3{ 0, float(c), 0 }));
+                children.push_back(child);
+                for (size_t g = 0; g < GRAND_CHILDREN; g++) {
+                    tcm->create(entities[e++], tcm->getInstance(child),
+                            mat4f::translation(float3{ 0, 0, float(g) }));
+                }
+            }
+        }
+        tcm->commitLocalTransformTransaction();
+
+        std::default_random_engine gen; // NOLINT
+        std::uniform_int_distribution<size_t> pick(0, children.size() - 1);
+        animated.resize(size_t(state.range(0)));
+        for (auto& a : animated) {
+            a = children[pick(gen)];
+        }
+    }
+
+    void TearDown(benchmark::State const&) override {
+        tcm.reset();
+        EntityManager::get().destroy(entities.size(), entities.data());
+        entities.clear();
+        roots.clear();
+        animated.clear();
+        js->emancipate();
+        delete js;
+        js = nullptr;
+    }
+};
+
+// setTransform() outside of a transaction updates each subtree immediately
+BENCHMARK_DEFINE_F(FilamentTransformFixture, immediate)(benchmark::State& state) {
+    {
+        PerformanceCounters pc(state);
+        float angle = 0.0f;
+        for (auto _ : state) {
+            mat4f const t = mat4f::rotation(angle, float3{ 0, 1, 0 });
+            for (Entity const e : animated) {
+                tcm->setTransform(tcm->getInstance(e), t);
+            }
+            angle += 0.01f;
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * animated.size()));
+    }
+}
+
+// a transaction only updates the dirty subtrees
+BENCHMARK_DEFINE_F(FilamentTransformFixture, transaction)(benchmark::State& state) {
+    {
+        PerformanceCounters pc(state);
+        float angle = 0.0f;
+        for (auto _ : state) {
+            mat4f const t = mat4f::rotation(angle, float3{ 0, 1, 0 });
+            tcm->openLocalTransformTransaction();
+            for (Entity const e : animated) {
+                tcm->setTransform(tcm->getInstance(e), t);
+            }
+            tcm->commitLocalTransformTransaction();
+            angle += 0.01f;
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * animated.size()));
+    }
+}
+
+// When most nodes change, the whole hierarchy is updated linearly, this is also what every
+// transaction cost before dirty tracking.
+BENCHMARK_DEFINE_F(FilamentTransformFixture, transactionAllNodes)(benchmark::State& state) {
+    {
+        PerformanceCounters pc(state);
+        float angle = 0.0f;
+        for (auto _ : state) {
+            mat4f const t = mat4f::rotation(angle, float3{ 0, 1, 0 });
+            tcm->openLocalTransformTransaction();
+            for (Entity const e : entities) {
+                tcm->setTransform(tcm->getInstance(e), t);
+            }
+            tcm->commitLocalTransformTransaction();
+            angle += 0.01f;
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * entities.size()));
+    }
+}
+
+BENCHMARK_REGISTER_F(FilamentTransformFixture, immediate)->Arg(100)->Arg(500)->Arg(2000);
+BENCHMARK_REGISTER_F(FilamentTransformFixture, transaction)->Arg(100)->Arg(500)->Arg(2000);
+BENCHMARK_REGISTER_F(FilamentTransformFixture, transactionAllNodes)->Arg(0);
@@ -394,6 +394,13 @@ public:
          * @deprecated use "backend.opengl.assert_native_window_is_valid" feature flag instead
          */
         bool assertNativeWindowIsValid = false;
+
+        /**
+         * Set to `true` to sort the draw commands of each render pass with a parallel radix sort
+         * on the JobSystem instead of a comparison sort. This is typically faster for passes
+         * with many thousands of draw commands, and has no effect on rendering.
+         */
+        bool radixSortRenderPassCommands = false;
     };
 
 
@@ -1061,6 +1068,37 @@ public:
      */
     Platform* UTILS_NULLABLE getPlatform() const noexcept;
 
+    /**
+     * Writes the program manifest into a buffer. The manifest records which variant of which
+     * Material was needed since this Engine was created, including the content of any manifest
+     * loaded with loadProgramManifest().
+     *
+     * Save it at the end of a session and load it at the start of the next one, so that
+     * programs are compiled before the first frame that needs them.
+     *
+     * @param buffer    where to write the manifest, can be nullptr to only query its size.
+     * @param size      size of buffer in bytes.
+     * @return          the size of the manifest in bytes. Nothing is written if it's larger
+     *                  than size.
+     *
+     * @see loadProgramManifest
+     */
+    size_t saveProgramManifest(void* UTILS_NULLABLE buffer, size_t size) const noexcept;
+
+    /**
+     * Loads a manifest previously returned by saveProgramManifest(), on the same device.
+     *
+     * Every Material listed in the manifest, either already created or created later with this
+     * Engine, starts compiling its listed variants at CompilerPriorityQueue::LOW priority. This
+     * only happens if the backend supports parallel shader compilation (see
+     * Material::compile()), otherwise programs are still compiled on first use.
+     *
+     * @param data      manifest returned by saveProgramManifest()
+     * @param size      size of data in bytes
+     * @return          false if data is not a valid manifest, in which case it is ignored.
+     */
+    bool loadProgramManifest(void const* UTILS_NONNULL data, size_t size) noexcept;
+
     /**
      * Allocate a small amount of memory directly in the command stream. The allocated memory is
      * guaranteed to be preserved until the current command buffer is executed
@@ -112,6 +112,27 @@ public:
          */
         Builder& package(const void* UTILS_NONNULL payload, size_t size);
 
+        using PackageReleaseCallback = void(*)(void const* UTILS_NONNULL payload, size_t size,
+                void* UTILS_NULLABLE user);
+
+        /**
+         * Specifies the material data without copying it, for instance a memory-mapped material
+         * file. The package is parsed in place and each shader is only decoded the first time
+         * it's needed, which saves both the copy and the memory of the decoded shaders that
+         * are never used.
+         *
+         * @param payload Pointer to the material data, must be 8-bytes aligned and stay valid
+         *                until callback is called.
+         * @param size Size of the material data pointed to by "payload" in bytes.
+         * @param callback Called, on the thread that destroys the Material, when the material
+         *                 data is no longer needed. This happens when the Material is destroyed,
+         *                 or when build() fails. Each call to build() results in one call to
+         *                 callback. Can be null if payload outlives the Material.
+         * @param user Opaque pointer passed to callback.
+         */
+        Builder& package(const void* UTILS_NONNULL payload, size_t size,
+                PackageReleaseCallback UTILS_NULLABLE callback, void* UTILS_NULLABLE user = nullptr);
+
         template<typename T>
         using is_supported_constant_parameter_t = typename std::enable_if<
                 std::is_same<int32_t, T>::value ||
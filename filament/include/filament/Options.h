@@ -595,6 +595,31 @@ struct SoftShadowOptions {
     float penumbraRatioScale = 1.0f;
 };
 
+/**
+ * Options for the selection of the level of detail of renderables that have several.
+ * @see setLodOptions(), RenderableManager::Builder::levelOfDetail()
+ */
+struct LodOptions {
+    /**
+     * Largest geometric error allowed on screen, in pixels. Each renderable is drawn with its
+     * coarsest level of detail whose error, projected on the screen, is below this threshold.
+     */
+    float maxScreenSpaceError = 1.0f;
+
+    /**
+     * Fraction of maxScreenSpaceError by which the projected error of a coarser level must be
+     * below the threshold before it replaces the current level, so that renderables near a
+     * transition distance don't switch back and forth every frame. Between 0 and 1.
+     * Switching to a finer level is always immediate.
+     */
+    float hysteresis = 0.1f;
+
+    /**
+     * Whether levels of detail are selected, level 0 is always drawn otherwise.
+     */
+    bool enabled = true;
+};
+
 /**
  * Options for stereoscopic (multi-eye) rendering.
  */
@@ -156,6 +156,12 @@ public:
          */
         static constexpr uint8_t DEFAULT_CHANNEL = 2u;
 
+        /**
+         * Maximum number of levels of detail of a renderable, including level 0
+         * @see Builder::levelOfDetail()
+         */
+        static constexpr uint8_t MAX_LEVEL_COUNT = 8u;
+
         /**
          * Type of geometry for a Renderable
          */
@@ -213,6 +219,42 @@ public:
                 VertexBuffer* UTILS_NONNULL vertices,
                 IndexBuffer* UTILS_NONNULL indices) noexcept; //!< \overload
 
+        /**
+         * Declares a level of detail, a coarser version of the renderable that is drawn in place
+         * of the primitives given to the Builder constructor (level 0) when it covers a small
+         * enough part of the screen.
+         *
+         * Each level has its own list of primitives, specified with the overloads of geometry()
+         * and material() that take a level. Levels must be declared in order and without gaps.
+         * The View draws the coarsest level whose error, projected on the screen, is below
+         * View::LodOptions::maxScreenSpaceError.
+         *
+         * Skinning and morphing apply to all levels, but the bone indices and weights given to
+         * boneIndicesAndWeights() are only used for the primitives of level 0.
+         *
+         * @param level level of detail, between 1 and MAX_LEVEL_COUNT - 1
+         * @param count the number of primitives of this level, which can be 0 to not draw
+         *              the renderable at all past a given distance
+         * @param error geometric error of this level compared to level 0, in object space units.
+         *              Must be strictly larger than the previous level's error.
+         *
+         * @see View::setLodOptions()
+         */
+        Builder& levelOfDetail(uint8_t level, size_t count, float error) noexcept;
+
+        /**
+         * Specifies the geometry data for a primitive of the given level of detail.
+         *
+         * @param level level of detail, 0 or a level declared with levelOfDetail()
+         * @param index zero-based index of the primitive, must be less than the level's count
+         *
+         * @see geometry(size_t, PrimitiveType, VertexBuffer*, IndexBuffer*, size_t, size_t)
+         */
+        Builder& geometry(uint8_t level, size_t index, PrimitiveType type,
+                VertexBuffer* UTILS_NONNULL vertices,
+                IndexBuffer* UTILS_NONNULL indices,
+                size_t offset, size_t count) noexcept;
+
 
         /**
          * Specify the type of geometry for this renderable. DYNAMIC geometry has no restriction,
@@ -242,6 +284,18 @@ public:
         Builder& material(size_t index,
                 MaterialInstance const* UTILS_NONNULL materialInstance) noexcept;
 
+        /**
+         * Binds a material instance to the specified primitive of the given level of detail.
+         *
+         * @param level level of detail, 0 or a level declared with levelOfDetail()
+         * @param index zero-based index of the primitive, must be less than the level's count
+         * @param materialInstance the material to bind
+         *
+         * @see material(size_t, MaterialInstance const*)
+         */
+        Builder& material(uint8_t level, size_t index,
+                MaterialInstance const* UTILS_NONNULL materialInstance) noexcept;
+
         /**
          * The axis-aligned bounding box of the renderable.
          *
@@ -497,8 +551,8 @@ public:
         /**
          * Specifies the the range of the MorphTargetBuffer to use with this primitive.
          *
-         * @param level the level of detail (lod), only 0 can be specified
-         * @param primitiveIndex zero-based index of the primitive, must be less than the count passed to Builder constructor
+         * @param level the level of detail (lod), 0 or a level declared with levelOfDetail()
+         * @param primitiveIndex zero-based index of the primitive, must be less than the level's count
          * @param offset specifies where in the morph target buffer to start reading (expressed as a number of vertices)
          */
         RenderableManager::Builder& morphing(uint8_t level,
@@ -783,6 +837,18 @@ public:
      */
     size_t getPrimitiveCount(Instance instance) const noexcept;
 
+    /**
+     * Gets the immutable number of primitives of the given level of detail, 0 if the renderable
+     * doesn't have this level.
+     */
+    size_t getPrimitiveCount(Instance instance, uint8_t level) const noexcept;
+
+    /**
+     * Gets the immutable number of levels of detail of the given renderable, 1 if none were
+     * declared with Builder::levelOfDetail().
+     */
+    size_t getLevelCount(Instance instance) const noexcept;
+
     /**
      * Changes the material instance binding for the given primitive.
      *
@@ -804,6 +870,20 @@ public:
     MaterialInstance* UTILS_NULLABLE getMaterialInstanceAt(
             Instance instance, size_t primitiveIndex) const noexcept;
 
+    /**
+     * Changes the material instance binding for the given primitive of a level of detail.
+     *
+     * @see setMaterialInstanceAt(Instance, size_t, MaterialInstance const*)
+     */
+    void setMaterialInstanceAt(Instance instance, uint8_t level,
+            size_t primitiveIndex, MaterialInstance const* UTILS_NONNULL materialInstance);
+
+    /**
+     * Retrieves the material instance that is bound to the given primitive of a level of detail.
+     */
+    MaterialInstance* UTILS_NULLABLE getMaterialInstanceAt(
+            Instance instance, uint8_t level, size_t primitiveIndex) const noexcept;
+
     /**
      * Changes the geometry for the given primitive.
      *
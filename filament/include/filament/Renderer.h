@@ -389,6 +389,45 @@ public:
      */
     void render(View const* UTILS_NONNULL view);
 
+    /**
+     * Renders several View objects, this is equivalent to calling render() for each of them, in
+     * order.
+     *
+     * When the "engine.renderer.concurrent_view_prepare" feature flag is enabled (it is disabled
+     * by default), the CPU work needed to prepare the Views (culling, shadow setup, uniform
+     * updates) is done concurrently on the Engine's JobSystem. This helps when rendering several
+     * Views each frame, e.g. for split-screen, picture-in-picture or several cameras. Views are
+     * never prepared concurrently while a local transform transaction is open, see
+     * TransformManager::openLocalTransformTransaction().
+     *
+     * Preparing a View updates the per-frame state of its Scene, so only the first View of each
+     * Scene is prepared concurrently with the others; subsequent Views of the same Scene are
+     * prepared when they are rendered, like with render(). Views without a Scene or a Camera
+     * are skipped.
+     *
+     * The rendering commands of the Views are submitted to the backend in the order of `views`.
+     * The commands that prepare the concurrently prepared Views, e.g. their uniform buffer
+     * updates, are all submitted before the rendering commands of the first View.
+     *
+     * @param views An array of `count` pointers to the views to render.
+     * @param count Number of views in `views`.
+     *
+     * @attention
+     * renderViews() must be called *after* beginFrame() and *before* endFrame().
+     *
+     * @attention
+     * A renderable that uses skinning, morphing or an InstanceBuffer must not be in the Scenes of
+     * two Views prepared concurrently, because preparing a View updates that renderable's state.
+     * Render such Views with render() instead.
+     *
+     * @note
+     * renderViews() must be called from the Engine's main thread, see render().
+     *
+     * @see
+     * render(), beginFrame(), endFrame()
+     */
+    void renderViews(View const* UTILS_NONNULL const* UTILS_NONNULL views, size_t count);
+
     /**
      * Copy the currently rendered view to the indicated swap chain, using the
      * indicated source and destination rectangle.
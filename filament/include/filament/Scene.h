@@ -177,6 +177,29 @@ public:
      */
     void forEach(utils::Invocable<void(utils::Entity entity)>&& functor) const noexcept;
 
+    /**
+     * Enables or disables hierarchical culling for this Scene.
+     *
+     * When enabled, the Scene maintains a bounding volume hierarchy over the world-space
+     * bounding boxes of its renderables, which allows camera and directional shadow culling to
+     * reject or accept whole groups of renderables at once. This is beneficial for scenes with
+     * a large number of mostly static renderables, but adds a small per-frame cost to keep the
+     * hierarchy up to date. Culling results are the same in both modes.
+     *
+     * Hierarchical culling is disabled by default.
+     *
+     * @param enabled true to enable hierarchical culling, false to disable it.
+     */
+    void setHierarchicalCullingEnabled(bool enabled) noexcept;
+
+    /**
+     * Returns whether hierarchical culling is enabled for this Scene.
+     *
+     * @return true if hierarchical culling is enabled.
+     * @see setHierarchicalCullingEnabled
+     */
+    bool isHierarchicalCullingEnabled() const noexcept;
+
 protected:
     // prevent heap allocation
     ~Scene() = default;
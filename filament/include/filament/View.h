@@ -90,6 +90,7 @@ public:
     using ScreenSpaceReflectionsOptions = filament::ScreenSpaceReflectionsOptions;
     using GuardBandOptions = filament::GuardBandOptions;
     using StereoscopicOptions = filament::StereoscopicOptions;
+    using LodOptions = filament::LodOptions;
 
     /**
      * Sets the View's name. Only useful for debugging.
@@ -743,6 +744,35 @@ public:
      */
     StereoscopicOptions const& getStereoscopicOptions() const noexcept;
 
+    /**
+     * Sets how the level of detail of renderables that have several is selected.
+     *
+     * The selection state used for the hysteresis is stored in each renderable, so a
+     * renderable seen by several Views at very different distances doesn't benefit from it.
+     *
+     * @param options The level of detail options to use on this view
+     *
+     * @see RenderableManager::Builder::levelOfDetail()
+     */
+    void setLodOptions(LodOptions const& options) noexcept;
+
+    /**
+     * Returns the level of detail options associated with this View.
+     *
+     * @return value set by setLodOptions().
+     */
+    LodOptions const& getLodOptions() const noexcept;
+
+    /**
+     * Returns the number of triangles drawn by the color pass of the last frame with the given
+     * level of detail, accounting for instancing. Renderables without levels of detail count
+     * as level 0, shadow passes are not included.
+     *
+     * @param level level of detail, less than RenderableManager::Builder::MAX_LEVEL_COUNT
+     * @return number of triangles drawn at this level, 0 if level is out of range
+     */
+    size_t getLodTriangleCount(uint8_t level) const noexcept;
+
     // for debugging...
 
     //! debugging: allows to entirely disable frustum culling. (culling enabled by default).
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CommandStreamPool.h"
+
+#include "private/backend/CircularBuffer.h"
+#include "private/backend/CommandStream.h"
+
+#include <utils/debug.h>
+#include <utils/Mutex.h>
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include <stddef.h>
+
+namespace filament {
+
+using namespace backend;
+
+CommandStreamPool::Stream::Stream(Driver& driver, size_t bufferSize) noexcept
+        : mCircularBuffer(bufferSize),
+          mDriverApi(driver, mCircularBuffer) {
+}
+
+CommandStreamPool::CommandStreamPool(Driver& driver, size_t bufferSize) noexcept
+        : mDriver(driver), mBufferSize(bufferSize) {
+}
+
+CommandStreamPool::~CommandStreamPool() noexcept {
+    // all streams must have been recycled by now
+    assert_invariant(mFreeStreams.size() == mStreams.size());
+}
+
+CommandStreamPool::Stream* CommandStreamPool::acquire() noexcept {
+    Stream* stream;
+    {
+        std::lock_guard<utils::Mutex> const lock(mLock);
+        if (UTILS_UNLIKELY(mFreeStreams.empty())) {
+            mStreams.push_back(std::make_unique<Stream>(mDriver, mBufferSize));
+            mFreeStreams.push_back(mStreams.back().get());
+        }
+        stream = mFreeStreams.back();
+        mFreeStreams.pop_back();
+    }
+    // the stream is now owned by the calling thread
+    stream->mDriverApi.debugThreading();
+    return stream;
+}
+
+void CommandStreamPool::splice(NoopCommand* jump, Stream* stream) noexcept {
+    // jump back to the command following `jump` in the engine's CommandStream
+    stream->mDriverApi.jump((char *)jump + CommandStream::getJumpSize());
+
+    // this retrieves the commands recorded so far and resets the stream
+    auto const [begin, end] = stream->mCircularBuffer.getBuffer();
+    assert_invariant(size_t((char *)end - (char *)begin) <= stream->mCircularBuffer.size());
+
+    jump->setNext(begin);
+}
+
+void CommandStreamPool::recycle(DriverApi& driver, Stream* stream) noexcept {
+    // This command executes after the spliced commands, at which point the stream can be reused
+    driver.queueCommand([this, stream]() {
+        release(stream);
+    });
+}
+
+void CommandStreamPool::release(Stream* stream) noexcept {
+    std::lock_guard<utils::Mutex> const lock(mLock);
+    mFreeStreams.push_back(stream);
+}
+
+} // namespace filament
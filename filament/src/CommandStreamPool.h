@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_COMMANDSTREAMPOOL_H
+#define TNT_FILAMENT_COMMANDSTREAMPOOL_H
+
+#include "private/backend/CircularBuffer.h"
+#include "private/backend/CommandStream.h"
+
+#include "backend/DriverApiForward.h"
+
+#include <utils/Mutex.h>
+
+#include <memory>
+#include <vector>
+
+#include <stddef.h>
+
+namespace filament {
+
+namespace backend {
+class Driver;
+} // namespace backend
+
+/*
+ * A pool of secondary CommandStreams, used to record driver commands concurrently with the
+ * engine's CommandStream.
+ *
+ * A secondary stream's commands are never copied, instead they're spliced in the engine's
+ * CommandStream with a pair of jumps (see CommandStream::jump()). This is important because
+ * commands can point into their own CommandStream (e.g. CommandStream::allocate()).
+ * A secondary stream goes back to the pool once the backend has executed its commands.
+ */
+class CommandStreamPool {
+public:
+    class Stream {
+    public:
+        Stream(backend::Driver& driver, size_t bufferSize) noexcept;
+
+        backend::DriverApi& getDriverApi() noexcept { return mDriverApi; }
+
+    private:
+        friend class CommandStreamPool;
+        backend::CircularBuffer mCircularBuffer;
+        backend::DriverApi mDriverApi;
+    };
+
+    // bufferSize is the capacity of each secondary stream, which must be large enough to hold
+    // everything recorded into it.
+    CommandStreamPool(backend::Driver& driver, size_t bufferSize) noexcept;
+
+    CommandStreamPool(CommandStreamPool const& rhs) = delete;
+    CommandStreamPool& operator=(CommandStreamPool const& rhs) = delete;
+
+    // must be called only once the backend has executed all the commands spliced so far
+    ~CommandStreamPool() noexcept;
+
+    // Returns a secondary stream ready for recording from the calling thread. Thread-safe.
+    Stream* acquire() noexcept;
+
+    /*
+     * Ends the recording of `stream` and splices its commands in place of `jump`, which must have
+     * been created with CommandStream::jump() in the engine's CommandStream, and not flushed yet.
+     * Thread-safe.
+     */
+    static void splice(backend::NoopCommand* jump, Stream* stream) noexcept;
+
+    // Returns `stream` to the pool once `driver` (the engine's CommandStream) has executed all
+    // commands recorded so far. Must be called after splice().
+    void recycle(backend::DriverApi& driver, Stream* stream) noexcept;
+
+private:
+    void release(Stream* stream) noexcept;
+
+    backend::Driver& mDriver;
+    size_t const mBufferSize;
+    utils::Mutex mLock;
+    std::vector<std::unique_ptr<Stream>> mStreams;
+    std::vector<Stream*> mFreeStreams;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_COMMANDSTREAMPOOL_H
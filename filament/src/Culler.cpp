@@ -20,6 +20,23 @@
 
 #include <math/fast.h>
 
+#include <utils/compiler.h>
+#include <utils/debug.h>
+
+#include <cmath>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#   include <immintrin.h>
+#   define FILAMENT_CULLER_HAS_X86 1
+#   define FILAMENT_CULLER_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#   include <arm_neon.h>
+#   define FILAMENT_CULLER_HAS_NEON 1
+#endif
+
 using namespace filament::math;
 
 // use 8 if Culler::result_type is 8-bits, on ARMv8 it allows the compiler to write eight
@@ -31,15 +48,24 @@ namespace filament {
 static_assert(Culler::MODULO % FILAMENT_CULLER_VECTORIZE_HINT == 0,
         "MODULO m=must be a multiple of FILAMENT_CULLER_VECTORIZE_HINT");
 
-void Culler::intersects(
-        result_type* UTILS_RESTRICT results,
-        Frustum const& UTILS_RESTRICT frustum,
-        float4 const* UTILS_RESTRICT b,
-        size_t count) noexcept {
+static_assert(Culler::MODULO == 8,
+        "SIMD kernels process 8 items per iteration");
 
-    float4 const * const UTILS_RESTRICT planes = frustum.mPlanes;
+/*
+ * The SIMD kernels below evaluate the plane equations in the same order as the scalar ones, and
+ * purposely don't use FMA, so that results match. The compiler is still allowed to contract the
+ * scalar code into FMAs, so items within rounding error of a plane can be classified differently.
+ */
 
-    count = round(count);
+// ------------------------------------------------------------------------------------------------
+// Scalar
+// ------------------------------------------------------------------------------------------------
+
+static void intersectsScalar(
+        Culler::result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT const planes,
+        float4 const* UTILS_RESTRICT b,
+        size_t count) noexcept {
     #pragma clang loop vectorize_width(FILAMENT_CULLER_VECTORIZE_HINT)
     for (size_t i = 0; i < count; i++) {
         int visible = ~0;
@@ -55,20 +81,16 @@ void Culler::intersects(
                               planes[j].w - sphere.w;
             visible &= fast::signbit(dot);
         }
-        results[i] = result_type(visible);
+        results[i] = Culler::result_type(visible);
     }
 }
 
-void Culler::intersects(
-        result_type* UTILS_RESTRICT results,
-        Frustum const& UTILS_RESTRICT frustum,
+static void intersectsScalar(
+        Culler::result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT const planes,
         float3 const* UTILS_RESTRICT center,
         float3 const* UTILS_RESTRICT extent,
         size_t count, size_t bit) noexcept {
-
-    float4 const * UTILS_RESTRICT const planes = frustum.mPlanes;
-
-    count = round(count);
     #pragma clang loop vectorize_width(FILAMENT_CULLER_VECTORIZE_HINT)
     for (size_t i = 0; i < count; i++) {
         int visible = ~0;
@@ -87,12 +109,432 @@ void Culler::intersects(
         }
 
         auto r = results[i];
-        r &= ~result_type(1u << bit);
-        r |= result_type(visible);
+        r &= ~Culler::result_type(1u << bit);
+        r |= Culler::result_type(visible);
         results[i] = r;
     }
 }
 
+#if defined(FILAMENT_CULLER_HAS_X86)
+
+// ------------------------------------------------------------------------------------------------
+// SSE2 (always available on x86-64)
+// ------------------------------------------------------------------------------------------------
+
+// Transposes 4 float3 into 3 vectors: x0x1x2x3, y0y1y2y3, z0z1z2z3
+UTILS_ALWAYS_INLINE
+static inline void transpose3x4(float const* UTILS_RESTRICT p,
+        __m128& x, __m128& y, __m128& z) noexcept {
+    __m128 const m03 = _mm_loadu_ps(p + 0);     // x0 y0 z0 x1
+    __m128 const m14 = _mm_loadu_ps(p + 4);     // y1 z1 x2 y2
+    __m128 const m25 = _mm_loadu_ps(p + 8);     // z2 x3 y3 z3
+    __m128 const xy = _mm_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));   // x2 y2 x3 y3
+    __m128 const yz = _mm_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));   // y0 z0 y1 z1
+    x = _mm_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+    z = _mm_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+// Converts 8 lanes of 0/1 to 8 bytes and merges them into results at the given bit
+UTILS_ALWAYS_INLINE
+static inline void storeResultsSSE2(Culler::result_type* UTILS_RESTRICT results,
+        __m128i lo, __m128i hi, size_t bit) noexcept {
+    // values are 0 or 1, so saturation never happens and shifting doesn't cross bytes
+    __m128i v = _mm_packus_epi16(_mm_packs_epi32(lo, hi), _mm_setzero_si128());
+    v = _mm_sll_epi16(v, _mm_cvtsi32_si128(int(bit)));
+    __m128i const mask = _mm_set1_epi8(char(1u << bit));
+    __m128i r = _mm_loadl_epi64((__m128i const*)results);
+    r = _mm_or_si128(_mm_andnot_si128(mask, r), v);
+    _mm_storel_epi64((__m128i*)results, r);
+}
+
+// returns 1 in each lane where all the sign bits are set, 0 otherwise
+UTILS_ALWAYS_INLINE
+static inline __m128i signsSSE2(__m128 visible) noexcept {
+    return _mm_srli_epi32(_mm_castps_si128(visible), 31);
+}
+
+static void intersectsSSE2(
+        Culler::result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT const planes,
+        float4 const* UTILS_RESTRICT b,
+        size_t count) noexcept {
+    __m128 px[6], py[6], pz[6], pw[6];
+    for (size_t j = 0; j < 6; j++) {
+        px[j] = _mm_set1_ps(planes[j].x);
+        py[j] = _mm_set1_ps(planes[j].y);
+        pz[j] = _mm_set1_ps(planes[j].z);
+        pw[j] = _mm_set1_ps(planes[j].w);
+    }
+    auto test = [&](float const* UTILS_RESTRICT p) {
+        __m128 x = _mm_loadu_ps(p + 0);
+        __m128 y = _mm_loadu_ps(p + 4);
+        __m128 z = _mm_loadu_ps(p + 8);
+        __m128 w = _mm_loadu_ps(p + 12);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t j = 0; j < 6; j++) {
+            __m128 dot = _mm_mul_ps(px[j], x);
+            dot = _mm_add_ps(dot, _mm_mul_ps(py[j], y));
+            dot = _mm_add_ps(dot, _mm_mul_ps(pz[j], z));
+            dot = _mm_add_ps(dot, pw[j]);
+            dot = _mm_sub_ps(dot, w);
+            visible = _mm_and_ps(visible, dot);
+        }
+        return signsSSE2(visible);
+    };
+    for (size_t i = 0; i < count; i += 8) {
+        float const* p = &b[i].x;
+        __m128i const lo = test(p);
+        __m128i const hi = test(p + 16);
+        // spheres don't use a bit, results are overwritten
+        __m128i const v = _mm_packus_epi16(_mm_packs_epi32(lo, hi), _mm_setzero_si128());
+        _mm_storel_epi64((__m128i*)(results + i), v);
+    }
+}
+
+static void intersectsSSE2(
+        Culler::result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT const planes,
+        float3 const* UTILS_RESTRICT center,
+        float3 const* UTILS_RESTRICT extent,
+        size_t count, size_t bit) noexcept {
+    __m128 px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+    for (size_t j = 0; j < 6; j++) {
+        px[j] = _mm_set1_ps(planes[j].x);
+        py[j] = _mm_set1_ps(planes[j].y);
+        pz[j] = _mm_set1_ps(planes[j].z);
+        pw[j] = _mm_set1_ps(planes[j].w);
+        ax[j] = _mm_set1_ps(std::abs(planes[j].x));
+        ay[j] = _mm_set1_ps(std::abs(planes[j].y));
+        az[j] = _mm_set1_ps(std::abs(planes[j].z));
+    }
+    auto test = [&](float const* UTILS_RESTRICT c, float const* UTILS_RESTRICT e) {
+        __m128 cx, cy, cz, ex, ey, ez;
+        transpose3x4(c, cx, cy, cz);
+        transpose3x4(e, ex, ey, ez);
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t j = 0; j < 6; j++) {
+            __m128 dot = _mm_mul_ps(px[j], cx);
+            dot = _mm_sub_ps(dot, _mm_mul_ps(ax[j], ex));
+            dot = _mm_add_ps(dot, _mm_mul_ps(py[j], cy));
+            dot = _mm_sub_ps(dot, _mm_mul_ps(ay[j], ey));
+            dot = _mm_add_ps(dot, _mm_mul_ps(pz[j], cz));
+            dot = _mm_sub_ps(dot, _mm_mul_ps(az[j], ez));
+            dot = _mm_add_ps(dot, pw[j]);
+            visible = _mm_and_ps(visible, dot);
+        }
+        return signsSSE2(visible);
+    };
+    for (size_t i = 0; i < count; i += 8) {
+        float const* c = &center[i].x;
+        float const* e = &extent[i].x;
+        __m128i const lo = test(c, e);
+        __m128i const hi = test(c + 12, e + 12);
+        storeResultsSSE2(results + i, lo, hi, bit);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// AVX2
+// ------------------------------------------------------------------------------------------------
+
+// Transposes 8 float3 into 3 vectors: x0...x7, y0...y7, z0...z7
+FILAMENT_CULLER_TARGET_AVX2 UTILS_ALWAYS_INLINE
+static inline void transpose3x8(float const* UTILS_RESTRICT p,
+        __m256& x, __m256& y, __m256& z) noexcept {
+    // same as transpose3x4(), with items 4 to 7 in the high lanes
+    __m256 m03 = _mm256_castps128_ps256(_mm_loadu_ps(p + 0));
+    __m256 m14 = _mm256_castps128_ps256(_mm_loadu_ps(p + 4));
+    __m256 m25 = _mm256_castps128_ps256(_mm_loadu_ps(p + 8));
+    m03 = _mm256_insertf128_ps(m03, _mm_loadu_ps(p + 12), 1);
+    m14 = _mm256_insertf128_ps(m14, _mm_loadu_ps(p + 16), 1);
+    m25 = _mm256_insertf128_ps(m25, _mm_loadu_ps(p + 20), 1);
+    __m256 const xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));
+    __m256 const yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));
+    x = _mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+    z = _mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+FILAMENT_CULLER_TARGET_AVX2
+static void intersectsAVX2(
+        Culler::result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT const planes,
+        float4 const* UTILS_RESTRICT b,
+        size_t count) noexcept {
+    __m256 px[6], py[6], pz[6], pw[6];
+    for (size_t j = 0; j < 6; j++) {
+        px[j] = _mm256_set1_ps(planes[j].x);
+        py[j] = _mm256_set1_ps(planes[j].y);
+        pz[j] = _mm256_set1_ps(planes[j].z);
+        pw[j] = _mm256_set1_ps(planes[j].w);
+    }
+    for (size_t i = 0; i < count; i += 8) {
+        // spheres 0-3 in the low lanes, 4-7 in the high lanes, then a 4x4 transpose per lane
+        float const* p = &b[i].x;
+        __m256 const r0 = _mm256_insertf128_ps(
+                _mm256_castps128_ps256(_mm_loadu_ps(p + 0)), _mm_loadu_ps(p + 16), 1);
+        __m256 const r1 = _mm256_insertf128_ps(
+                _mm256_castps128_ps256(_mm_loadu_ps(p + 4)), _mm_loadu_ps(p + 20), 1);
+        __m256 const r2 = _mm256_insertf128_ps(
+                _mm256_castps128_ps256(_mm_loadu_ps(p + 8)), _mm_loadu_ps(p + 24), 1);
+        __m256 const r3 = _mm256_insertf128_ps(
+                _mm256_castps128_ps256(_mm_loadu_ps(p + 12)), _mm_loadu_ps(p + 28), 1);
+        __m256 const t0 = _mm256_unpacklo_ps(r0, r1);   // x0 x1 y0 y1
+        __m256 const t1 = _mm256_unpacklo_ps(r2, r3);   // x2 x3 y2 y3
+        __m256 const t2 = _mm256_unpackhi_ps(r0, r1);   // z0 z1 w0 w1
+        __m256 const t3 = _mm256_unpackhi_ps(r2, r3);   // z2 z3 w2 w3
+        __m256 const x = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 const y = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 const z = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 const w = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t j = 0; j < 6; j++) {
+            __m256 dot = _mm256_mul_ps(px[j], x);
+            dot = _mm256_add_ps(dot, _mm256_mul_ps(py[j], y));
+            dot = _mm256_add_ps(dot, _mm256_mul_ps(pz[j], z));
+            dot = _mm256_add_ps(dot, pw[j]);
+            dot = _mm256_sub_ps(dot, w);
+            visible = _mm256_and_ps(visible, dot);
+        }
+        __m256i const v = _mm256_srli_epi32(_mm256_castps_si256(visible), 31);
+        __m128i const bytes = _mm_packus_epi16(
+                _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)),
+                _mm_setzero_si128());
+        _mm_storel_epi64((__m128i*)(results + i), bytes);
+    }
+}
+
+FILAMENT_CULLER_TARGET_AVX2
+static void intersectsAVX2(
+        Culler::result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT const planes,
+        float3 const* UTILS_RESTRICT center,
+        float3 const* UTILS_RESTRICT extent,
+        size_t count, size_t bit) noexcept {
+    __m256 px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+    for (size_t j = 0; j < 6; j++) {
+        px[j] = _mm256_set1_ps(planes[j].x);
+        py[j] = _mm256_set1_ps(planes[j].y);
+        pz[j] = _mm256_set1_ps(planes[j].z);
+        pw[j] = _mm256_set1_ps(planes[j].w);
+        ax[j] = _mm256_set1_ps(std::abs(planes[j].x));
+        ay[j] = _mm256_set1_ps(std::abs(planes[j].y));
+        az[j] = _mm256_set1_ps(std::abs(planes[j].z));
+    }
+    for (size_t i = 0; i < count; i += 8) {
+        __m256 cx, cy, cz, ex, ey, ez;
+        transpose3x8(&center[i].x, cx, cy, cz);
+        transpose3x8(&extent[i].x, ex, ey, ez);
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t j = 0; j < 6; j++) {
+            __m256 dot = _mm256_mul_ps(px[j], cx);
+            dot = _mm256_sub_ps(dot, _mm256_mul_ps(ax[j], ex));
+            dot = _mm256_add_ps(dot, _mm256_mul_ps(py[j], cy));
+            dot = _mm256_sub_ps(dot, _mm256_mul_ps(ay[j], ey));
+            dot = _mm256_add_ps(dot, _mm256_mul_ps(pz[j], cz));
+            dot = _mm256_sub_ps(dot, _mm256_mul_ps(az[j], ez));
+            dot = _mm256_add_ps(dot, pw[j]);
+            visible = _mm256_and_ps(visible, dot);
+        }
+        __m256i const v = _mm256_srli_epi32(_mm256_castps_si256(visible), 31);
+        storeResultsSSE2(results + i,
+                _mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1), bit);
+    }
+}
+
+#endif // FILAMENT_CULLER_HAS_X86
+
+#if defined(FILAMENT_CULLER_HAS_NEON)
+
+// ------------------------------------------------------------------------------------------------
+// NEON
+// ------------------------------------------------------------------------------------------------
+
+// Converts 8 lanes of 0/1 to 8 bytes
+UTILS_ALWAYS_INLINE
+static inline uint8x8_t narrowNEON(uint32x4_t lo, uint32x4_t hi) noexcept {
+    return vmovn_u16(vcombine_u16(vmovn_u32(lo), vmovn_u32(hi)));
+}
+
+static void intersectsNEON(
+        Culler::result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT const planes,
+        float4 const* UTILS_RESTRICT b,
+        size_t count) noexcept {
+    auto test = [planes](float const* UTILS_RESTRICT p) {
+        float32x4x4_t const s = vld4q_f32(p);  // deinterleaves x, y, z, w
+        uint32x4_t visible = vdupq_n_u32(~0u);
+        for (size_t j = 0; j < 6; j++) {
+            float32x4_t dot = vmulq_n_f32(s.val[0], planes[j].x);
+            dot = vaddq_f32(dot, vmulq_n_f32(s.val[1], planes[j].y));
+            dot = vaddq_f32(dot, vmulq_n_f32(s.val[2], planes[j].z));
+            dot = vaddq_f32(dot, vdupq_n_f32(planes[j].w));
+            dot = vsubq_f32(dot, s.val[3]);
+            visible = vandq_u32(visible, vreinterpretq_u32_f32(dot));
+        }
+        return vshrq_n_u32(visible, 31);
+    };
+    for (size_t i = 0; i < count; i += 8) {
+        float const* p = &b[i].x;
+        vst1_u8(results + i, narrowNEON(test(p), test(p + 16)));
+    }
+}
+
+static void intersectsNEON(
+        Culler::result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT const planes,
+        float3 const* UTILS_RESTRICT center,
+        float3 const* UTILS_RESTRICT extent,
+        size_t count, size_t bit) noexcept {
+    auto test = [planes](float const* UTILS_RESTRICT pc, float const* UTILS_RESTRICT pe) {
+        float32x4x3_t const c = vld3q_f32(pc);  // deinterleaves x, y, z
+        float32x4x3_t const e = vld3q_f32(pe);
+        uint32x4_t visible = vdupq_n_u32(~0u);
+        for (size_t j = 0; j < 6; j++) {
+            float32x4_t dot = vmulq_n_f32(c.val[0], planes[j].x);
+            dot = vsubq_f32(dot, vmulq_n_f32(e.val[0], std::abs(planes[j].x)));
+            dot = vaddq_f32(dot, vmulq_n_f32(c.val[1], planes[j].y));
+            dot = vsubq_f32(dot, vmulq_n_f32(e.val[1], std::abs(planes[j].y)));
+            dot = vaddq_f32(dot, vmulq_n_f32(c.val[2], planes[j].z));
+            dot = vsubq_f32(dot, vmulq_n_f32(e.val[2], std::abs(planes[j].z)));
+            dot = vaddq_f32(dot, vdupq_n_f32(planes[j].w));
+            visible = vandq_u32(visible, vreinterpretq_u32_f32(dot));
+        }
+        return vshrq_n_u32(visible, 31);
+    };
+    uint8x8_t const mask = vdup_n_u8(uint8_t(1u << bit));
+    int8x8_t const shift = vdup_n_s8(int8_t(bit));
+    for (size_t i = 0; i < count; i += 8) {
+        float const* c = &center[i].x;
+        float const* e = &extent[i].x;
+        uint8x8_t const v = vshl_u8(narrowNEON(test(c, e), test(c + 12, e + 12)), shift);
+        uint8x8_t const r = vld1_u8(results + i);
+        vst1_u8(results + i, vorr_u8(vbic_u8(r, mask), v));
+    }
+}
+
+#endif // FILAMENT_CULLER_HAS_NEON
+
+// ------------------------------------------------------------------------------------------------
+// Dispatch
+// ------------------------------------------------------------------------------------------------
+
+bool Culler::isSupported(Isa isa) noexcept {
+    switch (isa) {
+        case Isa::SCALAR:
+            return true;
+#if defined(FILAMENT_CULLER_HAS_X86)
+        case Isa::SSE2:
+            return true;
+        case Isa::AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+#if defined(FILAMENT_CULLER_HAS_NEON)
+        case Isa::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+Culler::Isa Culler::getIsa() noexcept {
+    static Isa const isa = []() {
+        for (Isa const candidate : { Isa::AVX2, Isa::NEON, Isa::SSE2 }) {
+            if (isSupported(candidate)) {
+                return candidate;
+            }
+        }
+        return Isa::SCALAR;
+    }();
+    return isa;
+}
+
+const char* Culler::getIsaName(Isa isa) noexcept {
+    switch (isa) {
+        case Isa::SCALAR:   return "scalar";
+        case Isa::SSE2:     return "SSE2";
+        case Isa::AVX2:     return "AVX2";
+        case Isa::NEON:     return "NEON";
+    }
+    return "unknown";
+}
+
+static void intersects(Culler::Isa isa,
+        Culler::result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT const planes,
+        float4 const* UTILS_RESTRICT b,
+        size_t count) noexcept {
+    assert_invariant(Culler::isSupported(isa));
+    switch (isa) {
+#if defined(FILAMENT_CULLER_HAS_X86)
+        case Culler::Isa::SSE2:
+            intersectsSSE2(results, planes, b, count);
+            break;
+        case Culler::Isa::AVX2:
+            intersectsAVX2(results, planes, b, count);
+            break;
+#endif
+#if defined(FILAMENT_CULLER_HAS_NEON)
+        case Culler::Isa::NEON:
+            intersectsNEON(results, planes, b, count);
+            break;
+#endif
+        default:
+            intersectsScalar(results, planes, b, count);
+            break;
+    }
+}
+
+static void intersects(Culler::Isa isa,
+        Culler::result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT const planes,
+        float3 const* UTILS_RESTRICT center,
+        float3 const* UTILS_RESTRICT extent,
+        size_t count, size_t bit) noexcept {
+    assert_invariant(Culler::isSupported(isa));
+    assert_invariant(bit < sizeof(Culler::result_type) * 8);
+    switch (isa) {
+#if defined(FILAMENT_CULLER_HAS_X86)
+        case Culler::Isa::SSE2:
+            intersectsSSE2(results, planes, center, extent, count, bit);
+            break;
+        case Culler::Isa::AVX2:
+            intersectsAVX2(results, planes, center, extent, count, bit);
+            break;
+#endif
+#if defined(FILAMENT_CULLER_HAS_NEON)
+        case Culler::Isa::NEON:
+            intersectsNEON(results, planes, center, extent, count, bit);
+            break;
+#endif
+        default:
+            intersectsScalar(results, planes, center, extent, count, bit);
+            break;
+    }
+}
+
+void Culler::intersects(
+        result_type* UTILS_RESTRICT results,
+        Frustum const& UTILS_RESTRICT frustum,
+        float4 const* UTILS_RESTRICT b,
+        size_t count) noexcept {
+    filament::intersects(getIsa(), results, frustum.mPlanes, b, round(count));
+}
+
+void Culler::intersects(
+        result_type* UTILS_RESTRICT results,
+        Frustum const& UTILS_RESTRICT frustum,
+        float3 const* UTILS_RESTRICT center,
+        float3 const* UTILS_RESTRICT extent,
+        size_t count, size_t bit) noexcept {
+    filament::intersects(getIsa(), results, frustum.mPlanes, center, extent, round(count), bit);
+}
+
 /*
  * returns whether a box intersects with the frustum
  */
@@ -128,14 +570,30 @@ void Culler::Test::intersects(
         float3 const* UTILS_RESTRICT c,
         float3 const* UTILS_RESTRICT e,
         size_t count) noexcept {
-    Culler::intersects(results, frustum, c, e, count, 0);
+    intersectsScalar(results, frustum.mPlanes, c, e, round(count), 0);
 }
 
 void Culler::Test::intersects(
         result_type* UTILS_RESTRICT results,
         Frustum const& UTILS_RESTRICT frustum,
         float4 const* UTILS_RESTRICT b, size_t count) noexcept {
-    Culler::intersects(results, frustum, b, count);
+    intersectsScalar(results, frustum.mPlanes, b, round(count));
+}
+
+void Culler::Test::intersects(Isa isa,
+        result_type* UTILS_RESTRICT results,
+        Frustum const& UTILS_RESTRICT frustum,
+        float3 const* UTILS_RESTRICT c,
+        float3 const* UTILS_RESTRICT e,
+        size_t count) noexcept {
+    filament::intersects(isa, results, frustum.mPlanes, c, e, round(count), 0);
+}
+
+void Culler::Test::intersects(Isa isa,
+        result_type* UTILS_RESTRICT results,
+        Frustum const& UTILS_RESTRICT frustum,
+        float4 const* UTILS_RESTRICT b, size_t count) noexcept {
+    filament::intersects(isa, results, frustum.mPlanes, b, round(count));
 }
 
 } // namespace filament
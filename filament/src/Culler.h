@@ -25,6 +25,9 @@
 #include <math/vec4.h>
 #include <math/vec2.h>
 
+#include <stddef.h>
+#include <stdint.h>
+
 namespace filament {
 
 /*
@@ -32,6 +35,9 @@ namespace filament {
  *
  * The implementation assumes 'count' below is multiple of MODULO
  *
+ * The array versions of intersects() use explicit SIMD kernels when available, the best one
+ * for the CPU is selected at runtime. All kernels produce the same results as the scalar
+ * implementation (see Culler::Test), except for items within rounding error of a plane.
  */
 
 class Culler {
@@ -44,6 +50,22 @@ public:
 
     using result_type = uint8_t;
 
+    // Instruction sets the culling kernels are implemented with
+    enum class Isa : uint8_t {
+        SCALAR,     // portable C++, relies on auto-vectorization
+        SSE2,       // x86-64, 4 items per vector
+        AVX2,       // x86-64, 8 items per vector
+        NEON,       // ARMv8, 4 items per vector
+    };
+
+    // returns the instruction set used by intersects(), detected once
+    static Isa getIsa() noexcept;
+
+    // returns whether the given instruction set can be used on this CPU
+    static bool isSupported(Isa isa) noexcept;
+
+    static const char* getIsaName(Isa isa) noexcept;
+
     /*
      * returns whether each AABB in an array intersects with the frustum
      */
@@ -78,6 +100,7 @@ public:
 
 
     struct UTILS_PUBLIC Test {
+        // these always use the scalar implementation
         static void intersects(result_type* results,
                 Frustum const& frustum,
                 math::float3 const* c,
@@ -88,6 +111,18 @@ public:
                 Frustum const& frustum,
                 math::float4 const* b,
                 size_t count) noexcept;
+
+        // these use the given instruction set, which must be supported
+        static void intersects(Isa isa, result_type* results,
+                Frustum const& frustum,
+                math::float3 const* c,
+                math::float3 const* e,
+                size_t count) noexcept;
+
+        static void intersects(Isa isa, result_type* results,
+                Frustum const& frustum,
+                math::float4 const* b,
+                size_t count) noexcept;
     };
 };
 
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DestroyedEntityJournal.h"
+
+#include <utils/Entity.h>
+#include <utils/EntityManager.h>
+#include <utils/Mutex.h>
+
+#include <algorithm>
+#include <mutex>
+
+#include <stddef.h>
+
+using namespace utils;
+
+namespace filament {
+
+DestroyedEntityJournal::DestroyedEntityJournal(EntityManager& em) noexcept
+        : mEntityManager(em) {
+    em.registerListener(this);
+}
+
+DestroyedEntityJournal::~DestroyedEntityJournal() noexcept {
+    mEntityManager.unregisterListener(this);
+}
+
+void DestroyedEntityJournal::onEntitiesDestroyed(size_t n, Entity const* entities) noexcept {
+    std::lock_guard<Mutex> const lock(mLock);
+    mEntities.insert(mEntities.end(), entities, entities + n);
+}
+
+size_t DestroyedEntityJournal::pop(Entity* entities, size_t count) noexcept {
+    std::lock_guard<Mutex> const lock(mLock);
+    count = std::min(count, mEntities.size() - mHead);
+    std::copy_n(mEntities.begin() + ptrdiff_t(mHead), count, entities);
+    mHead += count;
+    if (mHead == mEntities.size()) {
+        // the common case, everything was collected, this keeps the capacity
+        mEntities.clear();
+        mHead = 0;
+    } else if (mHead >= mEntities.size() / 2) {
+        // compact the journal once at least half of it has been popped, so that insertions
+        // and removals stay amortized O(1)
+        mEntities.erase(mEntities.begin(), mEntities.begin() + ptrdiff_t(mHead));
+        mHead = 0;
+    }
+    return count;
+}
+
+size_t DestroyedEntityJournal::size() const noexcept {
+    std::lock_guard<Mutex> const lock(mLock);
+    return mEntities.size() - mHead;
+}
+
+} // namespace filament
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_DESTROYEDENTITYJOURNAL_H
+#define TNT_FILAMENT_DESTROYEDENTITYJOURNAL_H
+
+#include <utils/Entity.h>
+#include <utils/EntityManager.h>
+#include <utils/Mutex.h>
+
+#include <vector>
+
+#include <stddef.h>
+
+namespace filament {
+
+/*
+ * Records the Entities destroyed by an EntityManager, in the order they were destroyed, so that
+ * the components they leave behind can be collected in a single pass instead of being searched
+ * for by each component manager.
+ *
+ * Entities can be destroyed from any thread, the journal is thread-safe.
+ */
+class DestroyedEntityJournal : private utils::EntityManager::Listener {
+public:
+    explicit DestroyedEntityJournal(utils::EntityManager& em) noexcept;
+    ~DestroyedEntityJournal() noexcept override;
+
+    DestroyedEntityJournal(DestroyedEntityJournal const& rhs) = delete;
+    DestroyedEntityJournal& operator=(DestroyedEntityJournal const& rhs) = delete;
+
+    // Removes up to `count` of the oldest entries and copies them into `entities`.
+    // Returns the number of entries copied.
+    size_t pop(utils::Entity* entities, size_t count) noexcept;
+
+    // Number of entries not yet removed by pop().
+    size_t size() const noexcept;
+
+private:
+    void onEntitiesDestroyed(size_t n, utils::Entity const* entities) noexcept override;
+
+    utils::EntityManager& mEntityManager;
+    mutable utils::Mutex mLock;
+    std::vector<utils::Entity> mEntities;
+    size_t mHead = 0;   // index of the oldest entry in mEntities
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_DESTROYEDENTITYJOURNAL_H
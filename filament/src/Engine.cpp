@@ -362,6 +362,14 @@ void Engine::enableAccurateTranslations() noexcept  {
     getTransformManager().setAccurateTranslationsEnabled(true);
 }
 
+size_t Engine::saveProgramManifest(void* buffer, size_t size) const noexcept {
+    return downcast(this)->saveProgramManifest(buffer, size);
+}
+
+bool Engine::loadProgramManifest(void const* data, size_t size) noexcept {
+    return downcast(this)->loadProgramManifest(data, size);
+}
+
 void* Engine::streamAlloc(size_t size, size_t alignment) noexcept {
     return downcast(this)->streamAlloc(size, alignment);
 }
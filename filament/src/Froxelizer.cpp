@@ -59,13 +59,6 @@ constexpr size_t PER_FROXELDATA_ARENA_SIZE = sizeof(float4) *
                                                   FROXEL_BUFFER_MAX_ENTRY_COUNT + 3 +
                                                   FROXEL_SLICE_COUNT / 4 + 1);
 
-// number of lights processed by one group (e.g. 32)
-static constexpr size_t LIGHT_PER_GROUP = sizeof(Froxelizer::LightGroupType) * 8;
-
-// number of groups (i.e. jobs) to use for froxelization (e.g. 8)
-static constexpr size_t GROUP_COUNT =
-        (CONFIG_MAX_LIGHT_COUNT + LIGHT_PER_GROUP - 1) / LIGHT_PER_GROUP;
-
 // This depends on the maximum number of lights (currently 256)
 static_assert(CONFIG_MAX_LIGHT_INDEX <= std::numeric_limits<Froxelizer::RecordBufferType>::max(),
         "can't have more than 256 lights");
@@ -78,10 +71,6 @@ static_assert(RECORD_BUFFER_ENTRY_COUNT <= 65536,
 static_assert(RECORD_BUFFER_ENTRY_COUNT <= CONFIG_MINSPEC_UBO_SIZE,
         "RecordBuffer cannot be larger than the UBO minspec (16KiB)");
 
-struct Froxelizer::FroxelThreadData :
-        public std::array<LightGroupType, FROXEL_BUFFER_MAX_ENTRY_COUNT> {
-};
-
 
 // Returns false if the two matrices are different. May return false if they're the
 // same, with some elements only differing by +0 or -0. Behaviour is undefined with NaNs.
@@ -204,19 +193,15 @@ bool Froxelizer::prepare(
             rootArenaScope.allocate<LightRecord>(getFroxelBufferEntryCount(), CACHELINE_SIZE),
             getFroxelBufferEntryCount() };
 
-    // froxel thread data (~256 KiB)
-    mFroxelShardedData = {
-            rootArenaScope.allocate<FroxelThreadData>(GROUP_COUNT, CACHELINE_SIZE),
-            uint32_t(GROUP_COUNT)
-    };
+    // froxel-space bounds of each light (~16 KiB)
+    mLightBounds = {
+            rootArenaScope.allocate<LightBounds>(CONFIG_MAX_LIGHT_COUNT, CACHELINE_SIZE),
+            CONFIG_MAX_LIGHT_COUNT };
 
     assert_invariant(mFroxelBufferUser.begin());
     assert_invariant(mRecordBufferUser.begin());
     assert_invariant(mLightRecords.begin());
-    assert_invariant(mFroxelShardedData.begin());
-
-    // initialize buffers that need to be
-    memset(mLightRecords.data(), 0, mLightRecords.sizeInBytes());
+    assert_invariant(mLightBounds.begin());
 
     return uniformsNeedUpdating;
 }
@@ -513,7 +498,7 @@ void Froxelizer::commit(backend::DriverApi& driverApi) {
 #ifndef NDEBUG
     mFroxelBufferUser.clear();
     mRecordBufferUser.clear();
-    mFroxelShardedData.clear();
+    mLightBounds.clear();
 #endif
 }
 
@@ -553,67 +538,69 @@ void Froxelizer::froxelizeLoop(FEngine& engine,
         const FScene::LightSoa& UTILS_RESTRICT lightData) noexcept {
     SYSTRACE_CALL();
 
-    Slice<FroxelThreadData> froxelThreadData = mFroxelShardedData;
-    memset(froxelThreadData.data(), 0, froxelThreadData.sizeInBytes());
-
     auto& lcm = engine.getLightManager();
     auto const* UTILS_RESTRICT spheres      = lightData.data<FScene::POSITION_RADIUS>();
     auto const* UTILS_RESTRICT directions   = lightData.data<FScene::DIRECTION>();
     auto const* UTILS_RESTRICT instances    = lightData.data<FScene::LIGHT_INSTANCE>();
 
-    auto process = [ this, &froxelThreadData,
-                     spheres, directions, instances, &viewMatrix, &lcm ]
-            (size_t count, size_t offset, size_t stride) {
+    const size_t lightCount = lightData.size() - FScene::DIRECTIONAL_LIGHTS_COUNT;
+    assert_invariant(lightCount <= mLightBounds.size());
+
+    const mat4f& projection = mProjection;
+    const mat3f& vn = viewMatrix.upperLeft();
+
+    // We use minimum cone angle of 0.5 degrees because too small angles cause issues in the
+    // sphere/cone intersection test, due to floating-point precision.
+    constexpr float maxInvSin = 114.59301f;         // 1 / sin(0.5 degrees)
+    constexpr float maxCosSquared = 0.99992385f;    // cos(0.5 degrees)^2
+
+    // First, bin the lights: find the range of froxels each light can touch. This is cheap
+    // compared to the froxelization itself.
+    LightBounds* const UTILS_RESTRICT lightBounds = mLightBounds.data();
+    for (size_t i = 0; i < lightCount; i++) {
+        const size_t j = i + FScene::DIRECTIONAL_LIGHTS_COUNT;
+        FLightManager::Instance const li = instances[j];
+        LightParams light = {
+                .position = (viewMatrix * float4{ spheres[j].xyz, 1 }).xyz,     // to view-space
+                .cosSqr = std::min(maxCosSquared, lcm.getCosOuterSquared(li)),  // spot only
+                .axis = vn * directions[j],                                     // spot only
+                .invSin = lcm.getSinInverse(li),                                // spot only
+                .radius = spheres[j].w,
+        };
+        // infinity means "point-light"
+        if (light.invSin != std::numeric_limits<float>::infinity()) {
+            light.invSin = std::min(maxInvSin, light.invSin);
+        }
+        computeLightBounds(lightBounds[i], projection, light);
+    }
 
+    // Then froxelize each z-slice in parallel, using only the lights whose z-range overlaps it.
+    // Each froxel belongs to a single slice, so jobs write their light records directly.
+    LightRecord* const UTILS_RESTRICT records = mLightRecords.data();
+    const size_t froxelCountXY = size_t(mFroxelCountX) * mFroxelCountY;
+    auto process = [this, records, lightBounds, lightCount, froxelCountXY, &projection]
+            (uint32_t zBegin, uint32_t zCount) {
         SYSTRACE_NAME("FroxelizeLoop Job");
-
-        const mat4f& projection = mProjection;
-        const mat3f& vn = viewMatrix.upperLeft();
-
-        // We use minimum cone angle of 0.5 degrees because too small angles cause issues in the
-        // sphere/cone intersection test, due to floating-point precision.
-        constexpr float maxInvSin = 114.59301f;         // 1 / sin(0.5 degrees)
-        constexpr float maxCosSquared = 0.99992385f;    // cos(0.5 degrees)^2
-
-        for (size_t i = offset; i < count; i += stride) {
-            const size_t j = i + FScene::DIRECTIONAL_LIGHTS_COUNT;
-            FLightManager::Instance const li = instances[j];
-            LightParams light = {
-                    .position = (viewMatrix * float4{ spheres[j].xyz, 1 }).xyz,     // to view-space
-                    .cosSqr = std::min(maxCosSquared, lcm.getCosOuterSquared(li)),  // spot only
-                    .axis = vn * directions[j],                                     // spot only
-                    .invSin = lcm.getSinInverse(li),                                // spot only
-                    .radius = spheres[j].w,
-            };
-            // infinity means "point-light"
-            if (light.invSin != std::numeric_limits<float>::infinity()) {
-                light.invSin = std::min(maxInvSin, light.invSin);
+        for (size_t iz = zBegin, ze = zBegin + zCount; iz < ze; ++iz) {
+            memset(records + iz * froxelCountXY, 0, froxelCountXY * sizeof(LightRecord));
+            for (size_t i = 0; i < lightCount; i++) {
+                LightBounds const& bounds = lightBounds[i];
+                if (bounds.z0 <= iz && iz <= bounds.z1) {
+                    froxelizePointAndSpotLight(records, i, iz, projection, bounds);
+                }
             }
-
-            const size_t group = i % GROUP_COUNT;
-            const size_t bit   = i / GROUP_COUNT;
-            assert_invariant(bit < LIGHT_PER_GROUP);
-
-            FroxelThreadData& threadData = froxelThreadData[group];
-            froxelizePointAndSpotLight(threadData, bit, projection, light);
         }
     };
 
-    // we do 64 lights per job
     JobSystem& js = engine.getJobSystem();
 
     constexpr bool SINGLE_THREADED = false;
     if (!SINGLE_THREADED) {
-        auto *parent = js.createJob();
-        for (size_t i = 0; i < GROUP_COUNT; i++) {
-            js.run(jobs::createJob(js, parent, std::cref(process),
-                    lightData.size() - FScene::DIRECTIONAL_LIGHTS_COUNT, i, GROUP_COUNT));
-        }
-        js.runAndWait(parent);
+        auto* job = jobs::parallel_for(js, nullptr, 0, uint32_t(mFroxelCountZ),
+                std::cref(process), jobs::CountSplitter<1>());
+        js.runAndWait(job);
     } else {
-        js.runAndWait(jobs::createJob(js, nullptr, std::cref(process),
-                lightData.size() - FScene::DIRECTIONAL_LIGHTS_COUNT, 0, 1)
-        );
+        process(0, mFroxelCountZ);
     }
 }
 
@@ -621,29 +608,10 @@ void Froxelizer::froxelizeAssignRecordsCompress() noexcept {
 
     SYSTRACE_CALL();
 
-    Slice<FroxelThreadData> const froxelThreadData = mFroxelShardedData;
-
-    // convert froxel data from N groups of M bits to LightRecord::bitset, so we can
-    // easily compare adjacent froxels, for compaction. The conversion loops below get
-    // inlined and vectorized in release builds.
-
-    // this gets very well vectorized...
-
-    utils::Slice<LightRecord> records(mLightRecords);
-    for (size_t j = 0, jc = getFroxelBufferEntryCount(); j < jc; j++) {
-        for (size_t i = 0; i < LightRecord::bitset::WORLD_COUNT; i++) {
-            using container_type = LightRecord::bitset::container_type;
-            constexpr size_t r = sizeof(container_type) / sizeof(LightGroupType);
-            container_type b = froxelThreadData[i * r][j];
-            for (size_t k = 0; k < r; k++) {
-                b |= (container_type(froxelThreadData[i * r + k][j]) << (LIGHT_PER_GROUP * k));
-            }
-            records[j].lights.getBitsAt(i) = b;
-        }
-    }
+    utils::Slice<LightRecord> const records(mLightRecords);
 
     LightRecord::bitset allLights{};
-    for (size_t j = 0, jc = getFroxelBufferEntryCount(); j < jc; j++) {
+    for (size_t j = 0, jc = mFroxelCount; j < jc; j++) {
         allLights |= records[j].lights;
     }
 
@@ -659,9 +627,6 @@ void Froxelizer::froxelizeAssignRecordsCompress() noexcept {
     offset += allLightsCount;
     allLights.forEachSetBit([point = froxelRecords, froxelRecords](size_t l) mutable {
         // make sure to keep this code branch-less
-        const size_t word = l / LIGHT_PER_GROUP;
-        const size_t bit  = l % LIGHT_PER_GROUP;
-        l = (bit * GROUP_COUNT) | (word % GROUP_COUNT);
         *point = (RecordBufferType)l;
         // we need to "cancel" the write operation if we have more than 255 spot or point lights
         // (this is a limitation of the data type used to store the light counts per froxel)
@@ -702,9 +667,6 @@ void Froxelizer::froxelizeAssignRecordsCompress() noexcept {
         auto * const beginPoint = froxelRecords + offset;
         b.lights.forEachSetBit([point = beginPoint, beginPoint](size_t l) mutable {
             // make sure to keep this code branch-less
-            const size_t word = l / LIGHT_PER_GROUP;
-            const size_t bit  = l % LIGHT_PER_GROUP;
-            l = (bit * GROUP_COUNT) | (word % GROUP_COUNT);
             *point = (RecordBufferType)l;
             // we need to "cancel" the write operation if we have more than 255 spot or point lights
             // (this is a limitation of the data type used to store the light counts per froxel)
@@ -747,21 +709,21 @@ static inline float2 project(mat4f const& p, float3 const& v) noexcept {
     return float2{ x, y } * (1.0f / w);
 }
 
-void Froxelizer::froxelizePointAndSpotLight(
-        FroxelThreadData& froxelThread, size_t bit,
+void Froxelizer::computeLightBounds(LightBounds& bounds,
         mat4f const& UTILS_RESTRICT p,
         const Froxelizer::LightParams& UTILS_RESTRICT light) const noexcept {
 
+    bounds.light = light;
+
     if (UTILS_UNLIKELY(light.position.z + light.radius < -mZLightFar)) { // z values are negative
         // This light is fully behind LightFar, it doesn't light anything
         // (we could avoid this check if we culled lights using LightFar instead of the
         // culling camera's far plane)
+        bounds.z0 = 1;
+        bounds.z1 = 0;
         return;
     }
 
-    // the code below works with radius^2
-    const float4 s = { light.position, light.radius * light.radius };
-
 #ifdef DEBUG_FROXEL
     const size_t x0 = 0;
     const size_t x1 = mFroxelCountX - 1;
@@ -808,84 +770,110 @@ void Froxelizer::froxelizePointAndSpotLight(
     assert_invariant(z0 <= z1);
 #endif
 
-    const size_t zcenter = findSliceZ(s.z);
+    bounds.x0 = uint16_t(x0);
+    bounds.x1 = uint16_t(x1);
+    bounds.y0 = uint16_t(y0);
+    bounds.y1 = uint16_t(y1);
+    bounds.z0 = uint16_t(z0);
+    bounds.z1 = uint16_t(z1);
+    bounds.zcenter = uint16_t(findSliceZ(light.position.z));
+}
+
+void Froxelizer::froxelizePointAndSpotLight(
+        LightRecord* UTILS_RESTRICT records, size_t lightIndex, size_t iz,
+        mat4f const& UTILS_RESTRICT p,
+        const Froxelizer::LightBounds& UTILS_RESTRICT bounds) const noexcept {
+
+    const LightParams& light = bounds.light;
+    const size_t x0 = bounds.x0;
+    const size_t x1 = bounds.x1;
+    const size_t y0 = bounds.y0;
+    const size_t y1 = bounds.y1;
+    const size_t zcenter = bounds.zcenter;
+
+    // the code below works with radius^2
+    const float4 s = { light.position, light.radius * light.radius };
+
+    // the word and bit of this light in the LightRecord bitset
+    using container_type = LightRecord::bitset::container_type;
+    constexpr size_t BITS_PER_WORD = sizeof(container_type) * 8;
+    const size_t word = lightIndex / BITS_PER_WORD;
+    const size_t bit = lightIndex % BITS_PER_WORD;
+
     float4 const * const UTILS_RESTRICT planesX = mPlanesX;
     float4 const * const UTILS_RESTRICT planesY = mPlanesY;
     float const * const UTILS_RESTRICT planesZ = mDistancesZ;
     float4 const * const UTILS_RESTRICT boundingSpheres = mBoundingSpheres;
-    for (size_t iz = z0 ; iz <= z1; ++iz) {
-        float4 cz(s);
-        // froxel that contain the center of the sphere is special, we don't even need to do the
-        // intersection check, it's always true.
-        if (UTILS_LIKELY(iz != zcenter)) {
-            cz = spherePlaneIntersection(s, (iz < zcenter) ? planesZ[iz + 1] : planesZ[iz]);
-        }
 
-        if (cz.w > 0) { // intersection of light with this plane (slice)
-            // the sphere (light) intersects this slice's plane, and we now have a new smaller
-            // sphere centered there. Now, find x & y slices that contain the sphere's center
-            // (note: this changes with the Z slices)
-            const float2 clip = project(p, cz.xyz);
-            auto const [xcenter, ycenter] = clipToIndices(clip);
-
-            for (size_t iy = y0; iy <= y1; ++iy) {
-                float4 cy(cz);
-                // froxel that contain the center of the sphere is special, we don't even need to
-                // do the intersection check, it's always true.
-                if (UTILS_LIKELY(iy != ycenter)) {
-                    float4 const& plane = iy < ycenter ? planesY[iy + 1] : planesY[iy];
-                    cy = spherePlaneIntersection(cz, plane);
-                }
+    float4 cz(s);
+    // froxel that contain the center of the sphere is special, we don't even need to do the
+    // intersection check, it's always true.
+    if (UTILS_LIKELY(iz != zcenter)) {
+        cz = spherePlaneIntersection(s, (iz < zcenter) ? planesZ[iz + 1] : planesZ[iz]);
+    }
+
+    if (cz.w > 0) { // intersection of light with this plane (slice)
+        // the sphere (light) intersects this slice's plane, and we now have a new smaller
+        // sphere centered there. Now, find x & y slices that contain the sphere's center
+        // (note: this changes with the Z slices)
+        const float2 clip = project(p, cz.xyz);
+        auto const [xcenter, ycenter] = clipToIndices(clip);
+
+        for (size_t iy = y0; iy <= y1; ++iy) {
+            float4 cy(cz);
+            // froxel that contain the center of the sphere is special, we don't even need to
+            // do the intersection check, it's always true.
+            if (UTILS_LIKELY(iy != ycenter)) {
+                float4 const& plane = iy < ycenter ? planesY[iy + 1] : planesY[iy];
+                cy = spherePlaneIntersection(cz, plane);
+            }
 
-                if (cy.w > 0) {
-                    // The reduced sphere from the previous stage intersects this horizontal plane,
-                    // and we now have new smaller sphere centered on these two previous planes
-                    size_t bx = std::numeric_limits<size_t>::max(); // horizontal begin index
-                    size_t ex = 0; // horizontal end index
-
-                    // find the "begin" index (left side)
-                    for (size_t ix = x0; ix < x1 + 1; ++ix) {
-                        // The froxel that contains the center of the sphere is special,
-                        // we don't even need to do the intersection check, it's always true.
-                        if (UTILS_LIKELY(ix != xcenter)) {
-                            float4 const& plane = ix < xcenter ? planesX[ix + 1] : planesX[ix];
-                            if (spherePlaneIntersection(cy, plane).w > 0) {
-                                // The reduced sphere from the previous stage intersects this
-                                // vertical plane, we record the min/max froxel indices
-                                bx = std::min(bx, ix);
-                                ex = std::max(ex, ix);
-                            }
-                        } else {
-                            // this is the froxel containing the center of the sphere, it is
-                            // definitely participating
+            if (cy.w > 0) {
+                // The reduced sphere from the previous stage intersects this horizontal plane,
+                // and we now have new smaller sphere centered on these two previous planes
+                size_t bx = std::numeric_limits<size_t>::max(); // horizontal begin index
+                size_t ex = 0; // horizontal end index
+
+                // find the "begin" index (left side)
+                for (size_t ix = x0; ix < x1 + 1; ++ix) {
+                    // The froxel that contains the center of the sphere is special,
+                    // we don't even need to do the intersection check, it's always true.
+                    if (UTILS_LIKELY(ix != xcenter)) {
+                        float4 const& plane = ix < xcenter ? planesX[ix + 1] : planesX[ix];
+                        if (spherePlaneIntersection(cy, plane).w > 0) {
+                            // The reduced sphere from the previous stage intersects this
+                            // vertical plane, we record the min/max froxel indices
                             bx = std::min(bx, ix);
                             ex = std::max(ex, ix);
                         }
+                    } else {
+                        // this is the froxel containing the center of the sphere, it is
+                        // definitely participating
+                        bx = std::min(bx, ix);
+                        ex = std::max(ex, ix);
                     }
+                }
 
-                    if (UTILS_UNLIKELY(bx > ex)) {
-                        continue;
-                    }
+                if (UTILS_UNLIKELY(bx > ex)) {
+                    continue;
+                }
 
-                    // the loops below assume 1-past the end for the right side of the range
-                    ex++;
-                    assert_invariant(bx <= mFroxelCountX && ex <= mFroxelCountX);
-
-                    size_t fi = getFroxelIndex(bx, iy, iz);
-                    if (light.invSin != std::numeric_limits<float>::infinity()) {
-                        // This is a spotlight (common case)
-                        // this loops gets vectorized (on arm64) w/ clang
-                        while (bx++ != ex) {
-                            // see if this froxel intersects the cone
-                            bool const intersect = sphereConeIntersectionFast(boundingSpheres[fi],
-                                    light.position, light.axis, light.invSin, light.cosSqr);
-                            froxelThread[fi++] |= LightGroupType(intersect) << bit;
-                        }
-                    } else {
-                        // this loops gets vectorized (on arm64) w/ clang
-                        while (bx++ != ex) {
-                            froxelThread[fi++] |= LightGroupType(1) << bit;
-                        }
+                // the loops below assume 1-past the end for the right side of the range
+                ex++;
+                assert_invariant(bx <= mFroxelCountX && ex <= mFroxelCountX);
+
+                size_t fi = getFroxelIndex(bx, iy, iz);
+                if (light.invSin != std::numeric_limits<float>::infinity()) {
+                    // This is a spotlight (common case)
+                    while (bx++ != ex) {
+                        // see if this froxel intersects the cone
+                        bool const intersect = sphereConeIntersectionFast(boundingSpheres[fi],
+                                light.position, light.axis, light.invSin, light.cosSqr);
+                        records[fi++].lights.getBitsAt(word) |= container_type(intersect) << bit;
+                    }
+                } else {
+                    while (bx++ != ex) {
+                        records[fi++].lights.getBitsAt(word) |= container_type(1) << bit;
                     }
                 }
             }
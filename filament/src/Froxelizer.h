@@ -153,10 +153,6 @@ public:
     const utils::Slice<FroxelEntry>& getFroxelBufferUser() const { return mFroxelBufferUser; }
     const utils::Slice<RecordBufferType>& getRecordBufferUser() const { return mRecordBufferUser; }
 
-    // this is chosen so froxelizePointAndSpotLight() vectorizes 4 froxel tests / spotlight
-    // with 256 lights this implies 8 jobs (256 / 32) for froxelization.
-    using LightGroupType = uint32_t;
-
 private:
     size_t getFroxelBufferEntryCount() const noexcept {
         return mFroxelBufferEntryCount;
@@ -177,6 +173,15 @@ private:
         float radius;
     };
 
+    // a light and the range of froxels it can touch, i.e. its z-bin
+    struct LightBounds {
+        LightParams light;
+        uint16_t x0, x1;    // inclusive
+        uint16_t y0, y1;    // inclusive
+        uint16_t z0, z1;    // inclusive, z0 > z1 when the light is culled
+        uint16_t zcenter;
+    };
+
     struct LightTreeNode {
         float min;          // lights z-range min
         float max;          // lights z-range max
@@ -189,8 +194,6 @@ private:
         uint16_t reserved;
     };
 
-    struct FroxelThreadData;
-
     inline void setViewport(Viewport const& viewport) noexcept;
     inline void setProjection(const math::mat4f& projection, float near, float far) noexcept;
     bool update() noexcept;
@@ -200,9 +203,12 @@ private:
 
     void froxelizeAssignRecordsCompress() noexcept;
 
-    void froxelizePointAndSpotLight(FroxelThreadData& froxelThread, size_t bit,
+    void computeLightBounds(LightBounds& bounds,
             math::mat4f const& projection, const LightParams& light) const noexcept;
 
+    void froxelizePointAndSpotLight(LightRecord* records, size_t lightIndex, size_t iz,
+            math::mat4f const& projection, const LightBounds& bounds) const noexcept;
+
     static void computeLightTree(LightTreeNode* lightTree,
             utils::Slice<RecordBufferType> const& lightList,
             const FScene::LightSoa& lightData, size_t lightRecordsOffset) noexcept;
@@ -244,7 +250,7 @@ private:
     math::float4* mBoundingSpheres = nullptr;           // 128 KiB w/ 8192 froxels
 
     // allocations in the per frame arena
-    utils::Slice<FroxelThreadData> mFroxelShardedData;  // 256 KiB w/  256 lights and 8192 froxels
+    utils::Slice<LightBounds> mLightBounds;             //  16 KiB w/  256 lights
     utils::Slice<FroxelEntry> mFroxelBufferUser;        //  32 KiB w/ 8192 froxels
     utils::Slice<LightRecord> mLightRecords;            // 256 KiB w/  256 lights
 
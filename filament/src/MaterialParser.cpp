@@ -80,6 +80,15 @@ MaterialParser::MaterialParserDetails::MaterialParserDetails(
       mMaterialChunk(mChunkContainer) {
 }
 
+MaterialParser::MaterialParserDetails::MaterialParserDetails(
+        utils::FixedCapacityVector<ShaderLanguage> preferredLanguages, const void* data,
+        size_t size, ReleaseCallback callback, void* user)
+    : mManagedBuffer(data, size, callback, user),
+      mChunkContainer(mManagedBuffer.data(), mManagedBuffer.size()),
+      mPreferredLanguages(std::move(preferredLanguages)),
+      mMaterialChunk(mChunkContainer) {
+}
+
 template<typename T>
 UTILS_NOINLINE
 bool MaterialParser::MaterialParserDetails::getFromSimpleChunk(
@@ -94,12 +103,21 @@ bool MaterialParser::MaterialParserDetails::getFromSimpleChunk(
 }
 
 MaterialParser::MaterialParserDetails::ManagedBuffer::ManagedBuffer(const void* start, size_t size)
-        : mStart(malloc(size)), mSize(size) {
+        : mStart(malloc(size)), mSize(size), mOwned(true) {
     memcpy(mStart, start, size);
 }
 
+MaterialParser::MaterialParserDetails::ManagedBuffer::ManagedBuffer(const void* start, size_t size,
+        ReleaseCallback callback, void* user)
+        : mStart(const_cast<void*>(start)), mSize(size), mCallback(callback), mUser(user) {
+}
+
 MaterialParser::MaterialParserDetails::ManagedBuffer::~ManagedBuffer() noexcept {
-    free(mStart);
+    if (mOwned) {
+        free(mStart);
+    } else if (mCallback) {
+        mCallback(mStart, mSize, mUser);
+    }
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -117,6 +135,11 @@ MaterialParser::MaterialParser(utils::FixedCapacityVector<ShaderLanguage> prefer
     : mImpl(std::move(preferredLanguages), data, size) {
 }
 
+MaterialParser::MaterialParser(utils::FixedCapacityVector<ShaderLanguage> preferredLanguages,
+        const void* data, size_t size, ReleaseCallback callback, void* user)
+    : mImpl(std::move(preferredLanguages), data, size, callback, user) {
+}
+
 ChunkContainer& MaterialParser::getChunkContainer() noexcept {
     return mImpl.mChunkContainer;
 }
@@ -18,6 +18,7 @@
 #define TNT_FILAMENT_MATERIALPARSER_H
 
 #include <filaflat/ChunkContainer.h>
+#include <filaflat/DictionaryReader.h>
 #include <filaflat/MaterialChunk.h>
 
 #include <filament/MaterialEnums.h>
@@ -53,9 +54,16 @@ struct MaterialPushConstant;
 
 class MaterialParser {
 public:
+    using ReleaseCallback = void(*)(void const* data, size_t size, void* user);
+
+    // Parses a copy of the package.
     MaterialParser(utils::FixedCapacityVector<backend::ShaderLanguage> preferredLanguages,
             const void* data, size_t size);
 
+    // Parses the package in place, callback (if not null) is called when the parser is destroyed.
+    MaterialParser(utils::FixedCapacityVector<backend::ShaderLanguage> preferredLanguages,
+            const void* data, size_t size, ReleaseCallback callback, void* user);
+
     MaterialParser(MaterialParser const& rhs) noexcept = delete;
     MaterialParser& operator=(MaterialParser const& rhs) noexcept = delete;
 
@@ -149,6 +157,10 @@ private:
                 utils::FixedCapacityVector<backend::ShaderLanguage> preferredLanguages,
                 const void* data, size_t size);
 
+        MaterialParserDetails(
+                utils::FixedCapacityVector<backend::ShaderLanguage> preferredLanguages,
+                const void* data, size_t size, ReleaseCallback callback, void* user);
+
         template<typename T>
         bool getFromSimpleChunk(filamat::ChunkType type, T* value) const noexcept;
 
@@ -158,8 +170,14 @@ private:
         class ManagedBuffer {
             void* mStart = nullptr;
             size_t mSize = 0;
+            ReleaseCallback mCallback = nullptr;
+            void* mUser = nullptr;
+            bool mOwned = false;
         public:
+            // makes a copy of the data
             explicit ManagedBuffer(const void* start, size_t size);
+            // references the data, callback is called on destruction
+            ManagedBuffer(const void* start, size_t size, ReleaseCallback callback, void* user);
             ~ManagedBuffer() noexcept;
             ManagedBuffer(ManagedBuffer const& rhs) = delete;
             ManagedBuffer& operator=(ManagedBuffer const& rhs) = delete;
@@ -176,7 +194,8 @@ private:
 
         // Keep MaterialChunk alive between calls to getShader to avoid reload the shader index.
         filaflat::MaterialChunk mMaterialChunk;
-        filaflat::BlobDictionary mBlobDictionary;
+        // Blobs are only decoded when a shader using them is requested.
+        filaflat::LazyBlobDictionary mBlobDictionary;
     };
 
     filaflat::ChunkContainer& getChunkContainer() noexcept;
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ProgramManifest.h"
+
+#include <private/filament/Variant.h>
+
+#include <utils/debug.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace filament {
+
+namespace {
+
+constexpr uint32_t MANIFEST_MAGIC = 0x464D5046; // 'FPMF'
+constexpr uint32_t MANIFEST_VERSION = 1;
+constexpr size_t VARIANT_WORDS = VARIANT_COUNT / 64;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t materialCount;
+    uint32_t reserved;
+};
+
+struct Entry {
+    uint64_t cacheId;
+    uint64_t variants[VARIANT_WORDS];
+};
+
+} // anonymous namespace
+
+void ProgramManifest::add(uint64_t cacheId, Variant variant) noexcept {
+    assert_invariant(cacheId);
+    mVariants[cacheId].set(variant.key);
+}
+
+VariantList ProgramManifest::getVariants(uint64_t cacheId) const noexcept {
+    auto const pos = mVariants.find(cacheId);
+    return pos == mVariants.end() ? VariantList{} : pos->second;
+}
+
+size_t ProgramManifest::serialize(void* buffer, size_t size) const noexcept {
+    size_t const needed = sizeof(Header) + mVariants.size() * sizeof(Entry);
+    if (!buffer || size < needed) {
+        return needed;
+    }
+
+    Header const header{ MANIFEST_MAGIC, MANIFEST_VERSION, uint32_t(mVariants.size()), 0 };
+    uint8_t* p = static_cast<uint8_t*>(buffer);
+    memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+
+    for (auto const& [cacheId, variants] : mVariants) {
+        Entry entry{ cacheId, {} };
+        for (size_t i = 0; i < VARIANT_WORDS; i++) {
+            entry.variants[i] = variants.getBitsAt(i);
+        }
+        memcpy(p, &entry, sizeof(entry));
+        p += sizeof(entry);
+    }
+    return needed;
+}
+
+bool ProgramManifest::deserialize(void const* data, size_t size) noexcept {
+    if (!data || size < sizeof(Header)) {
+        return false;
+    }
+
+    Header header{};
+    uint8_t const* p = static_cast<uint8_t const*>(data);
+    memcpy(&header, p, sizeof(header));
+    p += sizeof(header);
+
+    if (header.magic != MANIFEST_MAGIC || header.version != MANIFEST_VERSION ||
+            (size - sizeof(Header)) / sizeof(Entry) < header.materialCount) {
+        return false;
+    }
+
+    std::vector<Entry> entries(header.materialCount);
+    memcpy(entries.data(), p, entries.size() * sizeof(Entry));
+    for (Entry const& entry : entries) {
+        if (!entry.cacheId) {
+            return false;
+        }
+    }
+
+    for (Entry const& entry : entries) {
+        VariantList& variants = mVariants[entry.cacheId];
+        for (size_t i = 0; i < VARIANT_WORDS; i++) {
+            variants.getBitsAt(i) |= entry.variants[i];
+        }
+    }
+    return true;
+}
+
+} // namespace filament
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_PROGRAMMANIFEST_H
+#define TNT_FILAMENT_PROGRAMMANIFEST_H
+
+#include <private/filament/Variant.h>
+
+#include <utils/compiler.h>
+
+#include <unordered_map>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+/*
+ * The set of (material cache id, variant) pairs for which a program was created, so that they
+ * can be compiled ahead of time in a later run.
+ *
+ * The serialized form is a small header followed by one 256-bits variant mask per material, in
+ * native byte order. A manifest is meant to be stored on the device that produced it.
+ */
+class UTILS_PUBLIC ProgramManifest {
+public:
+    // Adds a variant for the material identified by cacheId, 0 is not a valid cache id.
+    void add(uint64_t cacheId, Variant variant) noexcept;
+
+    // Returns the variants recorded for the material identified by cacheId.
+    VariantList getVariants(uint64_t cacheId) const noexcept;
+
+    // Number of materials in the manifest.
+    size_t getMaterialCount() const noexcept { return mVariants.size(); }
+
+    void clear() noexcept { mVariants.clear(); }
+
+    /*
+     * Writes the manifest into buffer if it's large enough, and returns the size needed in
+     * bytes. buffer can be null to only query the size.
+     */
+    size_t serialize(void* buffer, size_t size) const noexcept;
+
+    /*
+     * Adds the content of a serialized manifest to this one. Returns false, and leaves this
+     * manifest untouched, if the data is not a valid manifest.
+     */
+    bool deserialize(void const* data, size_t size) noexcept;
+
+private:
+    std::unordered_map<uint64_t, VariantList> mVariants;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_PROGRAMMANIFEST_H
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RadixSort.h"
+
+#include <utils/compiler.h>
+#include <utils/JobSystem.h>
+#include <utils/Systrace.h>
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+using namespace utils;
+
+namespace filament {
+
+static constexpr size_t RADIX_BITS = 8;
+static constexpr size_t BUCKET_COUNT = 1u << RADIX_BITS;
+static constexpr uint64_t RADIX_MASK = BUCKET_COUNT - 1u;
+static constexpr size_t PASS_COUNT = (sizeof(uint64_t) * 8) / RADIX_BITS;
+
+void RadixSort::sort(JobSystem& js,
+        uint64_t* UTILS_RESTRICT keys, uint32_t* UTILS_RESTRICT values,
+        uint64_t* UTILS_RESTRICT scratchKeys, uint32_t* UTILS_RESTRICT scratchValues,
+        size_t count) noexcept {
+    SYSTRACE_CALL();
+
+    if (count <= 1) {
+        return;
+    }
+
+    // find out which bits vary across all keys, digits where no bit varies don't need a pass
+    uint64_t orKeys = 0;
+    uint64_t andKeys = ~uint64_t(0);
+    for (size_t i = 0; i < count; i++) {
+        orKeys |= keys[i];
+        andKeys &= keys[i];
+    }
+    uint64_t const varyingBits = orKeys ^ andKeys;
+    if (!varyingBits) {
+        // all keys are the same, we're already sorted
+        return;
+    }
+
+    size_t const blockCount = std::clamp(count / MIN_BLOCK_SIZE,
+            size_t(1), std::min(MAX_BLOCK_COUNT, js.getThreadCount() + 1));
+    size_t const blockSize = (count + blockCount - 1) / blockCount;
+
+    // per-block histograms, which become per-block output offsets after the prefix sum
+    uint32_t histograms[MAX_BLOCK_COUNT][BUCKET_COUNT];
+
+    uint64_t* srcKeys = keys;
+    uint32_t* srcValues = values;
+    uint64_t* dstKeys = scratchKeys;
+    uint32_t* dstValues = scratchValues;
+
+    auto runBlocks = [&js, blockCount](auto const& work) {
+        if (blockCount == 1) {
+            work(0u, 1u);
+        } else {
+            auto* job = jobs::parallel_for(js, nullptr, 0u, uint32_t(blockCount),
+                    std::cref(work), jobs::CountSplitter<1>());
+            js.runAndWait(job);
+        }
+    };
+
+    for (size_t pass = 0; pass < PASS_COUNT; pass++) {
+        size_t const shift = pass * RADIX_BITS;
+        if (!((varyingBits >> shift) & RADIX_MASK)) {
+            continue;
+        }
+
+        auto histogram = [&histograms, srcKeys, shift, blockSize, count]
+                (uint32_t first, uint32_t n) {
+            for (size_t b = first; b < first + n; b++) {
+                uint32_t* const UTILS_RESTRICT h = histograms[b];
+                std::fill_n(h, BUCKET_COUNT, 0u);
+                for (size_t i = b * blockSize, e = std::min(count, i + blockSize); i < e; i++) {
+                    h[(srcKeys[i] >> shift) & RADIX_MASK]++;
+                }
+            }
+        };
+        runBlocks(histogram);
+
+        // exclusive prefix sum, bucket-major so that the sort is stable
+        uint32_t sum = 0;
+        for (size_t bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+            for (size_t b = 0; b < blockCount; b++) {
+                uint32_t const c = histograms[b][bucket];
+                histograms[b][bucket] = sum;
+                sum += c;
+            }
+        }
+
+        auto scatter = [&histograms, srcKeys, srcValues, dstKeys, dstValues,
+                shift, blockSize, count](uint32_t first, uint32_t n) {
+            for (size_t b = first; b < first + n; b++) {
+                uint32_t* const UTILS_RESTRICT offsets = histograms[b];
+                for (size_t i = b * blockSize, e = std::min(count, i + blockSize); i < e; i++) {
+                    uint64_t const key = srcKeys[i];
+                    uint32_t const d = offsets[(key >> shift) & RADIX_MASK]++;
+                    dstKeys[d] = key;
+                    dstValues[d] = srcValues[i];
+                }
+            }
+        };
+        runBlocks(scatter);
+
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcValues, dstValues);
+    }
+
+    if (srcKeys != keys) {
+        // odd number of passes, the result is in the scratch buffers
+        memcpy(keys, srcKeys, count * sizeof(uint64_t));
+        memcpy(values, srcValues, count * sizeof(uint32_t));
+    }
+}
+
+} // namespace filament
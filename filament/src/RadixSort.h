@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_RADIXSORT_H
+#define TNT_FILAMENT_RADIXSORT_H
+
+#include <utils/compiler.h>
+#include <utils/JobSystem.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+/*
+ * A parallel LSD radix sort of (64-bits key, 32-bits value) pairs.
+ *
+ * Keys are sorted 8 bits at a time, and digits that are the same for all keys are skipped, which
+ * in practice is the case for most of RenderPass::CommandKey's bits. Each pass is split in blocks
+ * processed concurrently on the JobSystem: a histogram pass followed by a scatter pass.
+ *
+ * The sort is stable.
+ */
+class UTILS_PUBLIC RadixSort {
+public:
+    // Number of keys below which we don't use the JobSystem
+    static constexpr size_t MIN_BLOCK_SIZE = 4096;
+
+    // Maximum number of concurrent blocks
+    static constexpr size_t MAX_BLOCK_COUNT = 16;
+
+    /*
+     * Sorts keys[] and values[] by keys. scratchKeys and scratchValues must be able to hold
+     * count elements. On return, keys[] and values[] hold the sorted result.
+     */
+    static void sort(utils::JobSystem& js,
+            uint64_t* UTILS_RESTRICT keys, uint32_t* UTILS_RESTRICT values,
+            uint64_t* UTILS_RESTRICT scratchKeys, uint32_t* UTILS_RESTRICT scratchValues,
+            size_t count) noexcept;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_RADIXSORT_H
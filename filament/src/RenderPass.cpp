@@ -16,6 +16,8 @@
 
 #include "RenderPass.h"
 
+#include "RadixSort.h"
+
 #include "RenderPrimitive.h"
 #include "ShadowMap.h"
 #include "SharedHandle.h"
@@ -44,6 +46,7 @@
 
 #include <utils/compiler.h>
 #include <utils/debug.h>
+#include <utils/Hash.h>
 #include <utils/JobSystem.h>
 #include <utils/Panic.h>
 #include <utils/Slice.h>
@@ -52,6 +55,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <iterator>
 #include <limits>
 #include <utility>
 
@@ -159,10 +163,20 @@ RenderPass::RenderPass(FEngine const& engine, backend::DriverApi& driver,
     }
 
     // sort commands once we're done adding commands
-    commandEnd = resize(builder.mArena,
-            RenderPass::sortCommands(commandBegin, commandEnd));
+    if (engine.getConfig().radixSortRenderPassCommands) {
+        commandEnd = resize(builder.mArena,
+                RenderPass::radixSortCommands(engine.getJobSystem(), builder.mArena,
+                        commandBegin, commandEnd));
+    } else {
+        commandEnd = resize(builder.mArena,
+                RenderPass::sortCommands(commandBegin, commandEnd));
+    }
 
     if (engine.isAutomaticInstancingEnabled()) {
+        if (engine.features.engine.automatic_instancing.group_draws) {
+            groupInstanceableCommands(builder.mArena, commandBegin, commandEnd);
+            resize(builder.mArena, commandEnd);
+        }
         int32_t stereoscopicEyeCount = 1;
         if (builder.mFlags & IS_INSTANCED_STEREOSCOPIC) {
             stereoscopicEyeCount *= engine.getConfig().stereoscopicEyeCount;
@@ -170,7 +184,7 @@ RenderPass::RenderPass(FEngine const& engine, backend::DriverApi& driver,
         commandEnd = resize(builder.mArena,
                 instanceify(driver,
                         engine.getPerRenderableDescriptorSetLayout().getHandle(),
-                        commandBegin, commandEnd, stereoscopicEyeCount));
+                        commandBegin, commandEnd, stereoscopicEyeCount, &mDrawCallsSaved));
     }
 
     // these are `const` from this point on...
@@ -287,21 +301,150 @@ RenderPass::Command* RenderPass::sortCommands(
     return last;
 }
 
+RenderPass::Command* RenderPass::radixSortCommands(JobSystem& js, Arena& arena,
+        Command* const begin, Command* const end) noexcept {
+    size_t const count = end - begin;
+    if (count < RADIX_SORT_MIN_COMMAND_COUNT) {
+        return sortCommands(begin, end);
+    }
+
+    SYSTRACE_NAME("radix sort commands");
+
+    // We sort (key, index) pairs instead of moving the 64 bytes commands around.
+    uint64_t* const keys = arena.alloc<uint64_t>(count * 2, CACHELINE_SIZE);
+    uint32_t* const indices = arena.alloc<uint32_t>(count * 2, CACHELINE_SIZE);
+    Command* const sorted = arena.alloc<Command>(count, CACHELINE_SIZE);
+    assert_invariant(keys && indices && sorted);
+
+    // Sentinels are trimmed anyways, so we skip them right away. Their all-ones key would
+    // otherwise defeat the skipping of constant digits by the radix sort.
+    uint32_t liveCount = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t const key = begin[i].key;
+        if (key != uint64_t(Pass::SENTINEL)) {
+            keys[liveCount] = key;
+            indices[liveCount] = i;
+            liveCount++;
+        }
+    }
+
+    RadixSort::sort(js, keys, indices, keys + count, indices + count, liveCount);
+
+    // gather the commands in sorted order, then copy them back in place
+    auto gather = [begin, sorted, indices](uint32_t first, uint32_t n) {
+        for (uint32_t i = first, e = first + n; i < e; i++) {
+            sorted[i] = begin[indices[i]];
+        }
+    };
+    auto copy = [begin, sorted](uint32_t first, uint32_t n) {
+        std::copy_n(sorted + first, n, begin + first);
+    };
+    js.runAndWait(jobs::parallel_for(js, nullptr, 0u, liveCount,
+            std::cref(gather), jobs::CountSplitter<JOBS_PARALLEL_FOR_COMMANDS_COUNT>()));
+    js.runAndWait(jobs::parallel_for(js, nullptr, 0u, liveCount,
+            std::cref(copy), jobs::CountSplitter<JOBS_PARALLEL_FOR_COMMANDS_COUNT>()));
+
+    return begin + liveCount;
+}
+
+void RenderPass::groupInstanceableCommands(Arena& arena,
+        Command* const begin, Command* const end) noexcept {
+    SYSTRACE_NAME("group instanceable commands");
+
+    // The bits of the key that can be reordered without affecting correctness. Depth-only
+    // passes (e.g. shadow maps) rely on their front-to-back order the most, so they're only
+    // reordered within a Z-bucket.
+    auto reorderMask = [](Command const& c) -> uint64_t {
+        return (c.key & PASS_MASK) == uint64_t(Pass::DEPTH) ?
+                MATERIAL_MASK : Z_BUCKET_MASK | MATERIAL_MASK;
+    };
+
+    auto canReorder = [](Command const& c) {
+        return (c.key & CUSTOM_MASK) == uint64_t(CustomCommand::PASS) &&
+               (c.key & PASS_MASK) != uint64_t(Pass::BLENDED);
+    };
+
+    // same criteria as instanceify()
+    auto canInstance = [](Command const& c) {
+        return !c.info.hasSkinning && !c.info.hasMorphing && c.info.instanceCount <= 1;
+    };
+
+    auto hash = [](PrimitiveInfo const& info) {
+        uint32_t const words[] = {
+                uint32_t(info.padding), uint32_t(info.padding >> 32u),
+                info.rph.getId(), info.vbih.getId(),
+                info.indexOffset, info.indexCount,
+                info.rasterState.u, info.materialVariant.key };
+        return utils::hash::murmur3(words, std::size(words), 0);
+    };
+
+    size_t const count = end - begin;
+    uint64_t* const entries = arena.alloc<uint64_t>(count, CACHELINE_SIZE);
+    uint32_t* const leaders = arena.alloc<uint32_t>(count, CACHELINE_SIZE);
+    Command* const grouped = arena.alloc<Command>(count, CACHELINE_SIZE);
+    assert_invariant(entries && leaders && grouped);
+
+    for (Command* first = begin; first != end;) {
+        if (!canReorder(*first)) {
+            ++first;
+            continue;
+        }
+        uint64_t const mask = ~reorderMask(*first);
+        Command* const last = std::find_if(first + 1, end,
+                [key = first->key & mask, mask](Command const& c) {
+                    return (c.key & mask) != key;
+                });
+        uint32_t const n = last - first;
+
+        // find the first command of each group by sorting the (hash, index) pairs
+        uint32_t m = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            leaders[i] = i;
+            if (canInstance(first[i])) {
+                entries[m++] = (uint64_t(hash(first[i].info)) << 32u) | i;
+            }
+        }
+        std::sort(entries, entries + m);
+        for (uint32_t i = 0; i < m;) {
+            uint32_t const leader = uint32_t(entries[i]);
+            uint32_t j = i + 1;
+            while (j < m && (entries[j] >> 32u) == (entries[i] >> 32u)) {
+                leaders[uint32_t(entries[j++])] = leader;
+            }
+            i = j;
+        }
+
+        // then order the commands by (leader, index), groups of one don't move
+        bool moved = false;
+        for (uint32_t i = 0; i < n; i++) {
+            entries[i] = (uint64_t(leaders[i]) << 32u) | i;
+            moved = moved || leaders[i] != i;
+        }
+        if (moved) {
+            std::sort(entries, entries + n);
+            for (uint32_t i = 0; i < n; i++) {
+                grouped[i] = first[uint32_t(entries[i])];
+            }
+            std::copy_n(grouped, n, first);
+        }
+
+        first = last;
+    }
+}
+
 RenderPass::Command* RenderPass::instanceify(backend::DriverApi& driver,
         DescriptorSetLayoutHandle perRenderableDescriptorSetLayoutHandle,
         Command* curr, Command* const last,
-        int32_t eyeCount) const noexcept {
+        int32_t eyeCount, uint32_t* outDrawCallsSaved) const noexcept {
     SYSTRACE_NAME("instanceify");
 
     // instanceify works by scanning the **sorted** command stream, looking for repeat draw
     // commands. When one is found, it is replaced by an instanced command.
     // A "repeat" draw is one that ends-up using the same draw parameters and state.
-    // Currently, this relies somewhat on luck that "repeat draws" are found consecutively,
-    // we could improve this by including some or all of these "repeat" parameters in the
-    // sorting key (e.g. raster state, primitive handle, etc...), the key could even use a small
-    // hash of those parameters.
+    // Repeat draws are only found if they're consecutive, which groupInstanceableCommands()
+    // makes much more likely.
 
-    UTILS_UNUSED uint32_t drawCallsSavedCount = 0;
+    uint32_t drawCallsSavedCount = 0;
 
     Command* firstSentinel = nullptr;
     PerRenderableData const* uboData = nullptr;
@@ -332,6 +475,7 @@ RenderPass::Command* RenderPass::instanceify(backend::DriverApi& driver,
                         // primitives must be identical to be instanced
                         // Currently, instancing doesn't support skinning/morphing.
                         return lhs.info.mi == rhs.info.mi &&
+                               lhs.info.materialVariant == rhs.info.materialVariant &&
                                lhs.info.rph == rhs.info.rph &&
                                lhs.info.vbih == rhs.info.vbih &&
                                lhs.info.indexOffset == rhs.info.indexOffset &&
@@ -407,9 +551,9 @@ RenderPass::Command* RenderPass::instanceify(backend::DriverApi& driver,
         curr = const_cast<Command*>(e);
     }
 
+    *outDrawCallsSaved = drawCallsSavedCount;
+
     if (UTILS_UNLIKELY(firstSentinel)) {
-        //slog.d << "auto-instancing, saving " << drawCallsSavedCount << " draw calls, out of "
-        //       << count << io::endl;
         // we have instanced primitives
         // copy our instanced ubo data
         driver.updateBufferObjectUnsynchronized(mInstancedUboHandle, {
@@ -911,9 +1055,14 @@ void RenderPass::Executor::execute(FEngine const& engine, backend::DriverApi& dr
     SYSTRACE_CALL();
     SYSTRACE_CONTEXT();
 
-    size_t const capacity = engine.getMinCommandBufferSize();
     CircularBuffer const& circularBuffer = driver.getCircularBuffer();
 
+    // When recording into a secondary CommandStream (see FrameGraph::execute()) we can't flush,
+    // so we must fit in its CircularBuffer.
+    bool const isSecondary = &driver != &const_cast<FEngine&>(engine).getDriverApi();
+    size_t const capacity = isSecondary ?
+            circularBuffer.size() : engine.getMinCommandBufferSize();
+
     if (first != last) {
         SYSTRACE_VALUE32("commandCount", last - first);
 
@@ -975,8 +1124,8 @@ void RenderPass::Executor::execute(FEngine const& engine, backend::DriverApi& dr
             // check we have enough capacity to write these commandCount commands, if not,
             // request a new CircularBuffer allocation of `capacity` bytes.
             if (UTILS_UNLIKELY(circularBuffer.getUsed() > capacity - commandSizeInBytes)) {
-                // FIXME: eventually we can't flush here because this will be a secondary
-                //        command buffer. We will need another solution for overflows.
+                FILAMENT_CHECK_POSTCONDITION(!isSecondary)
+                        << "Secondary command stream overflow, increase commandBufferSizeMB.";
                 const_cast<FEngine&>(engine).flush();
             }
 
@@ -1104,9 +1253,7 @@ void RenderPass::Executor::execute(FEngine const& engine, backend::DriverApi& dr
 
         // If the remaining space is less than half the capacity, we flush right away to
         // allow some headroom for commands that might come later.
-        if (UTILS_UNLIKELY(circularBuffer.getUsed() > capacity / 2)) {
-            // FIXME: eventually we can't flush here because this will be a secondary
-            //        command buffer.
+        if (UTILS_UNLIKELY(!isSecondary && circularBuffer.getUsed() > capacity / 2)) {
             const_cast<FEngine&>(engine).flush();
         }
     }
@@ -396,6 +396,18 @@ public:
         return { *this, b, e };
     }
 
+    // number of draw calls removed by automatic instancing
+    uint32_t getDrawCallsSaved() const noexcept { return mDrawCallsSaved; }
+
+    // Reorders the **sorted** commands [begin, end) so that draws which can be instanced
+    // together are consecutive. Only commands whose keys differ just by their Z-bucket and
+    // material-id are reordered, i.e. the ordering required for correctness is preserved, and
+    // depth-only commands are never moved across Z-buckets. Within such a run, draws are grouped
+    // by a hash of their primitive, material instance and raster state, and groups are ordered
+    // by their first command.
+    // Scratch memory is allocated from the arena and released by the following resize().
+    static void groupInstanceableCommands(Arena& arena, Command* begin, Command* end) noexcept;
+
 private:
     friend class FRenderer;
     friend class RenderPassBuilder;
@@ -425,11 +437,19 @@ private:
     static Command* sortCommands(
             Command* begin, Command* end) noexcept;
 
+    // Same as sortCommands() but uses a parallel radix sort of the keys followed by a gather.
+    // Scratch memory is allocated from the arena and released by the following resize().
+    static Command* radixSortCommands(utils::JobSystem& js, Arena& arena,
+            Command* begin, Command* end) noexcept;
+
+    // below this number of commands, radixSortCommands() falls back to sortCommands()
+    static constexpr size_t RADIX_SORT_MIN_COMMAND_COUNT = 512;
+
     // instanceify commands then trims sentinels
     RenderPass::Command* instanceify(backend::DriverApi& driver,
             backend::DescriptorSetLayoutHandle perRenderableDescriptorSetLayoutHandle,
             Command* begin, Command* end,
-            int32_t eyeCount) const noexcept;
+            int32_t eyeCount, uint32_t* outDrawCallsSaved) const noexcept;
 
     // We choose the command count per job to minimize JobSystem overhead.
     static constexpr size_t JOBS_PARALLEL_FOR_COMMANDS_COUNT = 128;
@@ -466,6 +486,7 @@ private:
     Command const* /* const */ mCommandEnd = nullptr;     // Pointer to one past the last command
     mutable BufferObjectSharedHandle mInstancedUboHandle; // ubo for instanced primitives
     mutable DescriptorSetSharedHandle mInstancedDescriptorSetHandle; // a descriptor-set to hold the ubo
+    uint32_t mDrawCallsSaved = 0;
     // a vector for our custom commands
     using CustomCommandVector = utils::FixedCapacityVector<Executor::CustomCommandFn>;
     mutable CustomCommandVector mCustomCommands;
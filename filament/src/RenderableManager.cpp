@@ -118,6 +118,25 @@ MaterialInstance* RenderableManager::getMaterialInstanceAt(
     return downcast(this)->getMaterialInstanceAt(instance, 0, primitiveIndex);
 }
 
+size_t RenderableManager::getPrimitiveCount(Instance instance, uint8_t level) const noexcept {
+    return downcast(this)->getPrimitiveCount(instance, level);
+}
+
+size_t RenderableManager::getLevelCount(Instance instance) const noexcept {
+    return downcast(this)->getLevelCount(instance);
+}
+
+void RenderableManager::setMaterialInstanceAt(Instance instance, uint8_t level,
+        size_t primitiveIndex, MaterialInstance const* materialInstance) {
+    downcast(this)->setMaterialInstanceAt(instance, level, primitiveIndex,
+            downcast(materialInstance));
+}
+
+MaterialInstance* RenderableManager::getMaterialInstanceAt(
+        Instance instance, uint8_t level, size_t primitiveIndex) const noexcept {
+    return downcast(this)->getMaterialInstanceAt(instance, level, primitiveIndex);
+}
+
 void RenderableManager::setBlendOrderAt(Instance instance, size_t primitiveIndex, uint16_t order) noexcept {
     downcast(this)->setBlendOrderAt(instance, 0, primitiveIndex, order);
 }
@@ -42,6 +42,10 @@ void Renderer::render(View const* view) {
     downcast(this)->render(downcast(view));
 }
 
+void Renderer::renderViews(View const* const* views, size_t count) {
+    downcast(this)->renderViews(views, count);
+}
+
 void Renderer::setPresentationTime(int64_t monotonic_clock_ns) {
     downcast(this)->setPresentationTime(monotonic_clock_ns);
 }
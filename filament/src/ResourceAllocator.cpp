@@ -102,7 +102,13 @@ ResourceAllocatorDisposerInterface::~ResourceAllocatorDisposerInterface() = defa
 // ------------------------------------------------------------------------------------------------
 
 size_t ResourceAllocator::TextureKey::getSize() const noexcept {
-    size_t const pixelCount = width * height * depth;
+    return getTextureSize(format, width, height, depth, levels, samples);
+}
+
+size_t ResourceAllocator::getTextureSize(backend::TextureFormat format,
+        uint32_t width, uint32_t height, uint32_t depth,
+        uint8_t levels, uint8_t samples) noexcept {
+    size_t const pixelCount = size_t(width) * height * depth;
     size_t size = pixelCount * FTexture::getFormatSize(format);
     size_t const s = std::max(uint8_t(1), samples);
     if (s > 1) {
@@ -225,6 +231,11 @@ ResourceAllocatorDisposerInterface& ResourceAllocator::getDisposer() noexcept {
     return *mDisposer;
 }
 
+void ResourceAllocator::planTransientResources(
+        TransientHeap::Allocation* allocations, size_t count) noexcept {
+    mTransientMemoryStats = mTransientHeap.pack(allocations, count, TRANSIENT_HEAP_ALIGNMENT);
+}
+
 void ResourceAllocator::gc(bool skippedFrame) noexcept {
     // this is called regularly -- usually once per frame
 
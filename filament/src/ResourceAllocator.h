@@ -23,6 +23,8 @@
 #include <backend/Handle.h>
 #include <backend/TargetBufferInfo.h>
 
+#include "TransientHeap.h"
+
 #include "backend/DriverApiForward.h"
 
 #include <utils/Hash.h>
@@ -75,6 +77,12 @@ public:
 
     virtual ResourceAllocatorDisposerInterface& getDisposer() noexcept = 0;
 
+    /*
+     * Called by FrameGraph::compile() with the size and lifetime of each transient resource of
+     * the frame, before any of them is created. Lifetimes are in pass order.
+     */
+    virtual void planTransientResources(TransientHeap::Allocation*, size_t) noexcept {}
+
 protected:
     virtual ~ResourceAllocatorInterface();
 };
@@ -113,9 +121,31 @@ public:
 
     ResourceAllocatorDisposerInterface& getDisposer() noexcept override;
 
+    /*
+     * Packs the frame's transient resources into a heap where resources whose lifetimes
+     * don't overlap share memory. None of our backends can alias texture memory yet, so this
+     * is only a simulation, which tells how much memory aliasing would use.
+     */
+    void planTransientResources(
+            TransientHeap::Allocation* allocations, size_t count) noexcept override;
+
+    // Transient memory statistics of the last planned FrameGraph
+    TransientHeap::Stats const& getTransientMemoryStats() const noexcept {
+        return mTransientMemoryStats;
+    }
+
     void gc(bool skippedFrame = false) noexcept;
 
+    // Estimated size in bytes of a texture
+    static size_t getTextureSize(backend::TextureFormat format,
+            uint32_t width, uint32_t height, uint32_t depth,
+            uint8_t levels, uint8_t samples) noexcept;
+
 private:
+    // Heap alignment for the transient resources, this is the typical alignment of
+    // placed resources in GPU heaps.
+    static constexpr size_t TRANSIENT_HEAP_ALIGNMENT = 64 * 1024;
+
     size_t const mCacheMaxAge;
 
     struct TextureKey {
@@ -225,6 +255,8 @@ private:
     uint32_t mCacheSize = 0;
     uint32_t mCacheSizeHiWaterMark = 0;
     static constexpr bool mEnabled = true;
+    TransientHeap mTransientHeap;
+    TransientHeap::Stats mTransientMemoryStats;
 
     friend class ResourceAllocatorDisposer;
 };
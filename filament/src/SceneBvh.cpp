@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SceneBvh.h"
+
+#include <utils/compiler.h>
+#include <utils/debug.h>
+#include <utils/Systrace.h>
+
+#include <math/fast.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace filament::math;
+
+namespace filament {
+
+// The tree is rebuilt when refitting makes its cost (sum of the internal nodes surface area)
+// grow by more than this factor.
+static constexpr float REBUILD_COST_RATIO = 2.0f;
+
+// Maximum depth of the tree. The tree is balanced, so this allows 2^64 leaves.
+static constexpr size_t MAX_DEPTH = 64;
+
+static inline float surfaceArea(float3 const& min, float3 const& max) noexcept {
+    float3 const d = max - min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+SceneBvh::SceneBvh() noexcept = default;
+
+SceneBvh::~SceneBvh() noexcept = default;
+
+void SceneBvh::clear() noexcept {
+    std::vector<Node>().swap(mNodes);
+    std::vector<uint32_t>().swap(mIndices);
+    mBuildCost = 0.0f;
+    mNeedsRebuild = true;
+}
+
+void SceneBvh::update(float3 const* center, float3 const* extent, size_t count) noexcept {
+    SYSTRACE_CALL();
+    if (mNeedsRebuild || count != mIndices.size()) {
+        build(center, extent, count);
+        return;
+    }
+    float const cost = refit(center, extent);
+    if (cost > mBuildCost * REBUILD_COST_RATIO) {
+        build(center, extent, count);
+    }
+}
+
+void SceneBvh::build(float3 const* center, float3 const* extent, size_t count) noexcept {
+    SYSTRACE_CALL();
+    mNodes.clear();
+    mIndices.resize(count);
+    std::iota(mIndices.begin(), mIndices.end(), 0u);
+    if (count) {
+        // a balanced tree has at most 2 * count / LEAF_SIZE nodes (rounded up)
+        mNodes.reserve(2u * (count + LEAF_SIZE - 1u) / LEAF_SIZE);
+        buildNode(center, 0, uint32_t(count));
+    }
+    mBuildCost = refit(center, extent);
+    mNeedsRebuild = false;
+}
+
+uint32_t SceneBvh::buildNode(float3 const* center, uint32_t first, uint32_t count) noexcept {
+    uint32_t const index = uint32_t(mNodes.size());
+    mNodes.push_back({ {}, first, {}, count, 0 });
+    if (count > LEAF_SIZE) {
+        // split at the median along the longest axis of the centers' bounds
+        constexpr float inf = std::numeric_limits<float>::infinity();
+        float3 cmin{ inf };
+        float3 cmax{ -inf };
+        for (uint32_t i = first, e = first + count; i < e; i++) {
+            cmin = min(cmin, center[mIndices[i]]);
+            cmax = max(cmax, center[mIndices[i]]);
+        }
+        float3 const d = cmax - cmin;
+        size_t const axis = d.x > d.y ? (d.x > d.z ? 0 : 2) : (d.y > d.z ? 1 : 2);
+
+        uint32_t const half = count / 2;
+        auto const begin = mIndices.begin() + first;
+        std::nth_element(begin, begin + half, begin + count,
+                [center, axis](uint32_t lhs, uint32_t rhs) {
+                    return center[lhs][axis] < center[rhs][axis];
+                });
+
+        // the left child immediately follows its parent
+        buildNode(center, first, half);
+        uint32_t const right = buildNode(center, first + half, count - half);
+        // note: mNodes might have been reallocated
+        mNodes[index].right = right;
+    }
+    return index;
+}
+
+float SceneBvh::refit(float3 const* center, float3 const* extent) noexcept {
+    SYSTRACE_CALL();
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    float cost = 0.0f;
+    // children are always stored after their parent, so we can refit bottom-up by simply
+    // walking the nodes backward.
+    Node* const nodes = mNodes.data();
+    uint32_t const* const indices = mIndices.data();
+    for (size_t i = mNodes.size(); i-- > 0;) {
+        Node& node = nodes[i];
+        if (node.right) {
+            Node const& l = nodes[i + 1];
+            Node const& r = nodes[node.right];
+            node.min = min(l.min, r.min);
+            node.max = max(l.max, r.max);
+            cost += surfaceArea(node.min, node.max);
+        } else {
+            float3 lo{ inf };
+            float3 hi{ -inf };
+            for (uint32_t k = node.first, e = node.first + node.count; k < e; k++) {
+                uint32_t const j = indices[k];
+                lo = min(lo, center[j] - extent[j]);
+                hi = max(hi, center[j] + extent[j]);
+            }
+            node.min = lo;
+            node.max = hi;
+        }
+    }
+    return cost;
+}
+
+void SceneBvh::intersects(result_type* UTILS_RESTRICT results, Frustum const& frustum,
+        float3 const* UTILS_RESTRICT center, float3 const* UTILS_RESTRICT extent,
+        size_t bit) const noexcept {
+    SYSTRACE_CALL();
+
+    result_type const visibleBit = result_type(1u << bit);
+    size_t const count = mIndices.size();
+    for (size_t i = 0; i < count; i++) {
+        results[i] &= ~visibleBit;
+    }
+    if (UTILS_UNLIKELY(!count)) {
+        return;
+    }
+
+    float4 const* const UTILS_RESTRICT planes = frustum.getNormalizedPlanes();
+    Node const* const UTILS_RESTRICT nodes = mNodes.data();
+    uint32_t const* const UTILS_RESTRICT indices = mIndices.data();
+
+    // each entry holds a node and the set of planes its parent straddles; planes the parent is
+    // fully inside of don't need to be tested again.
+    struct Entry {
+        uint32_t node;
+        uint32_t planes;
+    };
+    Entry stack[MAX_DEPTH + 1];
+    size_t sp = 0;
+    stack[sp++] = { 0, 0x3F };
+
+    while (sp) {
+        Entry const entry = stack[--sp];
+        Node const& node = nodes[entry.node];
+
+        float3 const c = (node.min + node.max) * 0.5f;
+        float3 const e = (node.max - node.min) * 0.5f;
+
+        uint32_t straddled = 0;
+        bool outside = false;
+        for (size_t j = 0; j < 6; j++) {
+            if (entry.planes & (1u << j)) {
+                float const d = dot(planes[j].xyz, c) + planes[j].w;
+                float const r = dot(abs(planes[j].xyz), e);
+                if (d - r > 0.0f) {
+                    outside = true;
+                    break;
+                }
+                if (d + r >= 0.0f) {
+                    straddled |= 1u << j;
+                }
+            }
+        }
+
+        if (outside) {
+            continue;
+        }
+
+        if (!straddled) {
+            // the whole subtree is visible
+            for (uint32_t k = node.first, end = node.first + node.count; k < end; k++) {
+                results[indices[k]] |= visibleBit;
+            }
+            continue;
+        }
+
+        if (node.right) {
+            assert_invariant(sp + 2 <= MAX_DEPTH + 1);
+            stack[sp++] = { node.right, straddled };
+            stack[sp++] = { entry.node + 1, straddled };
+            continue;
+        }
+
+        // leaf: test each primitive against the planes we're straddling, with the same plane
+        // equation as the scalar Culler::intersects().
+        for (uint32_t k = node.first, end = node.first + node.count; k < end; k++) {
+            uint32_t const i = indices[k];
+            bool visible = true;
+            for (size_t j = 0; j < 6; j++) {
+                if (straddled & (1u << j)) {
+                    const float dot =
+                            planes[j].x * center[i].x - std::abs(planes[j].x) * extent[i].x +
+                            planes[j].y * center[i].y - std::abs(planes[j].y) * extent[i].y +
+                            planes[j].z * center[i].z - std::abs(planes[j].z) * extent[i].z +
+                            planes[j].w;
+                    visible &= fast::signbit(dot) != 0;
+                }
+            }
+            if (visible) {
+                results[i] |= visibleBit;
+            }
+        }
+    }
+}
+
+} // namespace filament
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_SCENEBVH_H
+#define TNT_FILAMENT_SCENEBVH_H
+
+#include "Culler.h"
+
+#include <filament/Frustum.h>
+
+#include <utils/compiler.h>
+
+#include <math/vec3.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+/*
+ * A bounding volume hierarchy over a set of world-space AABBs, used to accelerate frustum
+ * culling of large scenes.
+ *
+ * Primitives are identified by their index in the center/extent arrays (i.e. their index in
+ * FScene::RenderableSoa). The tree is built once with a median split and then refit every
+ * frame, which is cheap and always correct as long as the number of primitives doesn't change;
+ * it is rebuilt when invalidated, when the primitive count changes or when refitting has degraded
+ * the tree too much.
+ *
+ * intersects() is equivalent to Culler::intersects() up to floating-point rounding, but rejects
+ * (or accepts) whole subtrees at once. Primitives within rounding error of a frustum plane can be
+ * classified differently.
+ */
+class UTILS_PUBLIC SceneBvh {
+public:
+    using result_type = Culler::result_type;
+
+    // maximum number of primitives per leaf
+    static constexpr size_t LEAF_SIZE = 8;
+
+    SceneBvh() noexcept;
+    ~SceneBvh() noexcept;
+
+    SceneBvh(SceneBvh const& rhs) = delete;
+    SceneBvh& operator=(SceneBvh const& rhs) = delete;
+
+    // Forces a full rebuild on the next update()
+    void invalidate() noexcept { mNeedsRebuild = true; }
+
+    // Refits the tree to the given AABBs, or rebuilds it if needed.
+    void update(math::float3 const* center, math::float3 const* extent, size_t count) noexcept;
+
+    // Releases all memory used by the tree
+    void clear() noexcept;
+
+    /*
+     * For each primitive, sets 'bit' of results if its AABB intersects with the frustum, and
+     * clears it otherwise. 'center' and 'extent' must be the arrays used in the last update().
+     */
+    void intersects(result_type* results, Frustum const& frustum,
+            math::float3 const* center, math::float3 const* extent,
+            size_t bit) const noexcept;
+
+    size_t getPrimitiveCount() const noexcept { return mIndices.size(); }
+    size_t getNodeCount() const noexcept { return mNodes.size(); }
+
+private:
+    struct Node {
+        math::float3 min;       // bounds of all primitives of this subtree
+        uint32_t first;         // first primitive of this subtree in mIndices
+        math::float3 max;
+        uint32_t count;         // number of primitives in this subtree
+        uint32_t right;         // index of right child (left child follows), 0 for leaves
+    };
+
+    void build(math::float3 const* center, math::float3 const* extent, size_t count) noexcept;
+    uint32_t buildNode(math::float3 const* center, uint32_t first, uint32_t count) noexcept;
+    float refit(math::float3 const* center, math::float3 const* extent) noexcept;
+
+    std::vector<Node> mNodes;
+    std::vector<uint32_t> mIndices;
+    float mBuildCost = 0.0f;
+    bool mNeedsRebuild = true;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_SCENEBVH_H
@@ -32,6 +32,7 @@
 #include <utils/compiler.h>
 #include <utils/debug.h>
 #include <utils/Entity.h>
+#include <utils/Mutex.h>
 #include <utils/Slice.h>
 #include <utils/Systrace.h>
 
@@ -45,6 +46,7 @@
 #include <array>
 #include <cmath>
 #include <limits>
+#include <mutex>
 #include <type_traits>
 
 #include <stddef.h>
@@ -57,8 +59,8 @@ namespace filament {
 using namespace math;
 using namespace backend;
 
-ShadowMap::ShadowMap(FEngine& engine) noexcept
-        : mPerShadowMapUniforms(engine),
+ShadowMap::ShadowMap(FEngine& engine, DriverApi& driver) noexcept
+        : mPerShadowMapUniforms(engine, driver),
           mShadowType(ShadowType::DIRECTIONAL),
           mHasVisibleShadows(false),
           mFace(0) {
@@ -423,6 +425,9 @@ ShadowMap::DirectionalShadowBounds ShadowMap::computeDirectionalShadowBounds(
 
 #ifndef NDEBUG
     // LISPSM debugging for directional light (works because we only have one)
+    // the lock is needed because Views can be prepared concurrently, see FRenderer::renderViews()
+    static Mutex sDebugLock;
+    std::lock_guard<Mutex> const lock(sDebugLock);
     const float dz = camera.zf - camera.zn;
     float& dzn = engine.debug.shadowmap.dzn;
     float& dzf = engine.debug.shadowmap.dzf;
@@ -77,7 +77,7 @@ public:
         POINT
     };
 
-    explicit ShadowMap(FEngine& engine) noexcept;
+    ShadowMap(FEngine& engine, backend::DriverApi& driver) noexcept;
 
     // ShadowMap is not copyable for now
     ShadowMap(ShadowMap const& rhs) = delete;
@@ -39,12 +39,15 @@
 #include <backend/DriverApiForward.h>
 #include <backend/DriverEnums.h>
 
+#include <utils/algorithm.h>
 #include <utils/compiler.h>
 #include <utils/debug.h>
 #include <utils/FixedCapacityVector.h>
 #include <utils/BitmaskEnum.h>
+#include <utils/JobSystem.h>
 #include <utils/Range.h>
 #include <utils/Slice.h>
+#include <utils/Systrace.h>
 
 #include <math/half.h>
 #include <math/mat4.h>
@@ -54,6 +57,7 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <functional>
 #include <limits>
 #include <new>
 #include <memory>
@@ -87,10 +91,19 @@ ShadowMapManager::~ShadowMapManager() {
     }
 }
 
-void ShadowMapManager::createIfNeeded(FEngine& engine,
+void ShadowMapManager::createIfNeeded(FEngine& engine, DriverApi& driver,
         std::unique_ptr<ShadowMapManager>& inOutShadowMapManager) {
     if (UTILS_UNLIKELY(!inOutShadowMapManager)) {
         inOutShadowMapManager.reset(new ShadowMapManager(engine));
+        ShadowMapManager& manager = *inOutShadowMapManager;
+        manager.mInitialized = true;
+        // initialize our ShadowMap array in-place
+        manager.mShadowUbh = driver.createBufferObject(manager.mShadowUb.getSize(),
+                BufferObjectBinding::UNIFORM, BufferUsage::DYNAMIC);
+        UTILS_NOUNROLL
+        for (auto& entry: manager.mShadowMapCache) {
+            new(&entry) ShadowMap(engine, driver);
+        }
     }
 }
 
@@ -114,7 +127,7 @@ void ShadowMapManager::terminate(FEngine& engine) {
 
 ShadowMapManager::ShadowTechnique ShadowMapManager::update(
         Builder const& builder,
-        FEngine& engine, FView& view,
+        FEngine& engine, DriverApi& driver, FView& view,
         CameraInfo const& cameraInfo,
         FScene::RenderableSoa& renderableData, FScene::LightSoa const& lightData) noexcept {
 
@@ -123,17 +136,8 @@ ShadowMapManager::ShadowTechnique ShadowMapManager::update(
         return ShadowTechnique::NONE;
     }
 
-    // initialize the shadowmap array the first time
-    if (UTILS_UNLIKELY(!mInitialized)) {
-        mInitialized = true;
-        // initialize our ShadowMap array in-place
-        mShadowUbh = engine.getDriverApi().createBufferObject(mShadowUb.getSize(),
-                BufferObjectBinding::UNIFORM, BufferUsage::DYNAMIC);
-        UTILS_NOUNROLL
-        for (auto& entry: mShadowMapCache) {
-            new(&entry) ShadowMap(engine);
-        }
-    }
+    // the shadowmap array is initialized by createIfNeeded()
+    assert_invariant(mInitialized);
 
     mDirectionalShadowMapCount = builder.mDirectionalShadowMapCount;
     mSpotShadowMapCount = builder.mSpotShadowMapCount;
@@ -321,11 +325,41 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
 
                 // Note: we could almost parallel_for the loop below, the problem currently is
                 // that updatePrimitivesLod() updates temporary global state.
-                // prepareSpotShadowMap() also update the visibility of renderable. These two
+                // The visibility of renderables is also updated for each shadow map. These two
                 // pieces of state are needed only until shadowMap.render() returns.
                 // Conceptually, we could store this out-of-band.
 
+                // Cull the shadow casters of all the spot and point shadow maps at once, each
+                // pass below then only extracts its own visibility bit. Shadow maps without
+                // visible shadows are still rendered, because the shader could sample them,
+                // but they get no casters.
+                std::array<Frustum, CONFIG_MAX_SHADOWMAPS> frustums;
+                uint64_t culledShadowMaps = 0;
+                size_t spotShadowMapCount = 0;
+                utils::Range<uint32_t> spotShadowCastersRange{};
+                for (auto const& entry : data.passList) {
+                    ShadowMap const& shadowMap = *entry.shadowMap;
+                    if (!shadowMap.isDirectionalShadow()) {
+                        if (shadowMap.hasVisibleShadows()) {
+                            frustums[spotShadowMapCount] = getSpotShadowMapFrustum(shadowMap,
+                                    engine, scene->getLightData());
+                            culledShadowMaps |= uint64_t(1) << spotShadowMapCount;
+                        }
+                        spotShadowMapCount++;
+                        spotShadowCastersRange = entry.range;
+                    }
+                }
+                if (spotShadowMapCount) {
+                    // rounded up like updateSpotVisibilityMasks() does
+                    mSpotShadowCasters.resize((spotShadowCastersRange.size() + 0xFu) & ~0xFu);
+                    ShadowMapManager::cullSpotShadowMaps(engine.getJobSystem(),
+                            view.getVisibleLayers(), scene->getRenderableData(),
+                            spotShadowCastersRange, frustums.data(), culledShadowMaps,
+                            mSpotShadowCasters.data());
+                }
+
                 // Generate a RenderPass for each shadow map
+                size_t spotShadowMapIndex = 0;
                 for (auto const& entry : data.passList) {
                     ShadowMap const& shadowMap = *entry.shadowMap;
 
@@ -338,26 +372,15 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                     //       To do this efficiently, we'd need a way to cull draw calls already
                     //       recorded in the command buffer, per shadow map.
 
-                    // Note: the output of culling below is stored in scene->getRenderableData()
+                    // Note: the visible casters of this shadow map are stored in
+                    //       scene->getRenderableData()
 
-                    switch (shadowMap.getShadowType()) {
-                        case ShadowType::DIRECTIONAL:
-                            // we should never be here
-                            break;
-                        case ShadowType::SPOT:
-                            if (shadowMap.hasVisibleShadows()) {
-                                ShadowMapManager::cullSpotShadowMap(shadowMap, engine, view,
-                                        scene->getRenderableData(), entry.range,
-                                        scene->getLightData());
-                            }
-                            break;
-                        case ShadowType::POINT:
-                            if (shadowMap.hasVisibleShadows()) {
-                                ShadowMapManager::cullPointShadowMap(shadowMap, view,
-                                        scene->getRenderableData(), entry.range,
-                                        scene->getLightData());
-                            }
-                            break;
+                    if (!shadowMap.isDirectionalShadow()) {
+                        auto* const visibleArray = scene->getRenderableData()
+                                .data<FScene::VISIBLE_MASK>() + entry.range.first;
+                        ShadowMapManager::updateSpotVisibilityMasks(
+                                mSpotShadowCasters.data(), spotShadowMapIndex++,
+                                visibleArray, entry.range.size());
                     }
 
                     // cameraInfo only valid after calling update
@@ -506,6 +529,10 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                     // render either directly into the shadowmap, or to the temporary texture for
                     // blurring.
                     data.rt = blur ? data.rt : rt;
+
+                    // Shadow passes only depend on state set up by the "Prepare Shadow Pass",
+                    // so they can be recorded concurrently.
+                    builder.allowConcurrentExecution();
                 },
                 [=, &engine, &entry](FrameGraphResources const& resources,
                         auto const& data, DriverApi& driver) {
@@ -614,7 +641,7 @@ ShadowMapManager::ShadowTechnique ShadowMapManager::updateCascadeShadowMaps(FEng
 
         if (hasVisibleShadows) {
             Frustum const& frustum = shadowMap.getCamera().getCullingFrustum();
-            FView::cullRenderables(engine.getJobSystem(), renderableData, frustum,
+            FView::cullRenderables(engine.getJobSystem(), *scene, renderableData, frustum,
                     VISIBLE_DIR_SHADOW_RENDERABLE_BIT);
         }
     }
@@ -723,30 +750,6 @@ ShadowMapManager::ShadowTechnique ShadowMapManager::updateCascadeShadowMaps(FEng
     return shadowTechnique;
 }
 
-void ShadowMapManager::updateSpotVisibilityMasks(
-        uint8_t visibleLayers,
-        uint8_t const* UTILS_RESTRICT layers,
-        FRenderableManager::Visibility const* UTILS_RESTRICT visibility,
-        Culler::result_type* UTILS_RESTRICT visibleMask, size_t count) {
-    // __restrict__ seems to only be taken into account as function parameters. This is very
-    // important here, otherwise, this loop doesn't get vectorized.
-    // This is vectorized 16x.
-    count = (count + 0xFu) & ~0xFu; // capacity guaranteed to be multiple of 16
-    for (size_t i = 0; i < count; ++i) {
-        const Culler::result_type mask = visibleMask[i];
-        const FRenderableManager::Visibility v = visibility[i];
-        const bool inVisibleLayer = layers[i] & visibleLayers;
-
-        const bool visSpotShadowRenderable = v.castShadows && inVisibleLayer &&
-                (!v.culling || (mask & VISIBLE_DYN_SHADOW_RENDERABLE));
-
-        using Type = Culler::result_type;
-
-        visibleMask[i] &= ~Type(VISIBLE_DYN_SHADOW_RENDERABLE);
-        visibleMask[i] |= Type(visSpotShadowRenderable << VISIBLE_DYN_SHADOW_RENDERABLE_BIT);
-    }
-}
-
 void ShadowMapManager::prepareSpotShadowMap(ShadowMap& shadowMap, FEngine& engine, FView& view,
         CameraInfo const& mainCameraInfo,
         FScene::LightSoa& lightData, ShadowMap::SceneInfo const& sceneInfo) noexcept {
@@ -792,52 +795,6 @@ void ShadowMapManager::prepareSpotShadowMap(ShadowMap& shadowMap, FEngine& engin
     }
 }
 
-void ShadowMapManager::cullSpotShadowMap(ShadowMap const& shadowMap,
-        FEngine const& engine, FView const& view,
-        FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range,
-        FScene::LightSoa const& lightData) noexcept {
-    auto& lcm = engine.getLightManager();
-
-    const size_t lightIndex = shadowMap.getLightIndex();
-    const FLightManager::Instance li = lightData.elementAt<FScene::LIGHT_INSTANCE>(lightIndex);
-
-    // compute the frustum for this light
-    // for spotlights, we cull shadow casters first because we already know the frustum,
-    // this will help us find better near/far plane later
-    const auto position = lightData.elementAt<FScene::POSITION_RADIUS>(lightIndex).xyz;
-    const auto direction = lightData.elementAt<FScene::DIRECTION>(lightIndex);
-    const auto radius = lightData.elementAt<FScene::POSITION_RADIUS>(lightIndex).w;
-    const auto outerConeAngle = lcm.getSpotLightOuterCone(li);
-
-    // compute shadow map frustum for culling
-    const mat4f Mv = ShadowMap::getDirectionalLightViewMatrix(direction, { 0, 1, 0 }, position);
-    const mat4f Mp = mat4f::perspective(outerConeAngle * f::RAD_TO_DEG * 2.0f, 1.0f, 0.01f, radius);
-    const mat4f MpMv = math::highPrecisionMultiply(Mp, Mv);
-    const Frustum frustum(MpMv);
-
-    // Cull shadow casters
-    float3 const* worldAABBCenter = renderableData.data<FScene::WORLD_AABB_CENTER>();
-    float3 const* worldAABBExtent = renderableData.data<FScene::WORLD_AABB_EXTENT>();
-    FScene::VisibleMaskType* visibleArray = renderableData.data<FScene::VISIBLE_MASK>();
-    Culler::intersects(
-            visibleArray + range.first,
-            frustum,
-            worldAABBCenter + range.first,
-            worldAABBExtent + range.first,
-            range.size(),
-            VISIBLE_DYN_SHADOW_RENDERABLE_BIT);
-
-    // update their visibility mask
-    uint8_t const* layers = renderableData.data<FScene::LAYERS>();
-    auto const* visibility = renderableData.data<FScene::VISIBILITY_STATE>();
-    updateSpotVisibilityMasks(
-            view.getVisibleLayers(),
-            layers + range.first,
-            visibility + range.first,
-            visibleArray + range.first,
-            range.size());
-}
-
 void ShadowMapManager::preparePointShadowMap(ShadowMap& shadowMap,
         FEngine& engine, FView& view, CameraInfo const& mainCameraInfo,
         FScene::LightSoa& lightData) noexcept {
@@ -883,45 +840,96 @@ void ShadowMapManager::preparePointShadowMap(ShadowMap& shadowMap,
     }
 }
 
-void ShadowMapManager::cullPointShadowMap(ShadowMap const& shadowMap, FView const& view,
-        FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range,
-        FScene::LightSoa const& lightData) noexcept {
-
-    uint8_t const face = shadowMap.getFace();
+Frustum ShadowMapManager::getSpotShadowMapFrustum(ShadowMap const& shadowMap,
+        FEngine const& engine, FScene::LightSoa const& lightData) noexcept {
     size_t const lightIndex = shadowMap.getLightIndex();
-
-    // compute the frustum for this light
-    // for spotlights, we cull shadow casters first because we already know the frustum,
-    // this will help us find better near/far plane later
     auto const position = lightData.elementAt<FScene::POSITION_RADIUS>(lightIndex).xyz;
     auto const radius = lightData.elementAt<FScene::POSITION_RADIUS>(lightIndex).w;
 
-    // compute shadow map frustum for culling
-    mat4f const Mv = ShadowMap::getPointLightViewMatrix(TextureCubemapFace(face), position);
-    mat4f const Mp = mat4f::perspective(90.0f, 1.0f, 0.01f, radius);
-    Frustum const frustum{ math::highPrecisionMultiply(Mp, Mv) };
+    // for spot and point lights, we cull shadow casters first because we already know the
+    // frustum, this will help us find better near/far plane later
+    if (shadowMap.getShadowType() == ShadowType::POINT) {
+        uint8_t const face = shadowMap.getFace();
+        mat4f const Mv = ShadowMap::getPointLightViewMatrix(TextureCubemapFace(face), position);
+        mat4f const Mp = mat4f::perspective(90.0f, 1.0f, 0.01f, radius);
+        return Frustum{ math::highPrecisionMultiply(Mp, Mv) };
+    }
+
+    auto& lcm = engine.getLightManager();
+    FLightManager::Instance const li = lightData.elementAt<FScene::LIGHT_INSTANCE>(lightIndex);
+    auto const direction = lightData.elementAt<FScene::DIRECTION>(lightIndex);
+    auto const outerConeAngle = lcm.getSpotLightOuterCone(li);
+    mat4f const Mv = ShadowMap::getDirectionalLightViewMatrix(direction, { 0, 1, 0 }, position);
+    mat4f const Mp = mat4f::perspective(outerConeAngle * f::RAD_TO_DEG * 2.0f, 1.0f, 0.01f, radius);
+    return Frustum{ math::highPrecisionMultiply(Mp, Mv) };
+}
+
+void ShadowMapManager::cullSpotShadowMaps(utils::JobSystem& js, uint8_t visibleLayers,
+        FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range,
+        Frustum const* frustums, uint64_t culledShadowMaps,
+        uint64_t* UTILS_RESTRICT casters) noexcept {
+    SYSTRACE_CALL();
+
+    static_assert(CONFIG_MAX_SHADOWMAPS <= 64, "one bit per shadow map must fit in 64 bits");
 
-    // Cull shadow casters
     float3 const* worldAABBCenter = renderableData.data<FScene::WORLD_AABB_CENTER>();
     float3 const* worldAABBExtent = renderableData.data<FScene::WORLD_AABB_EXTENT>();
-    FScene::VisibleMaskType* visibleArray = renderableData.data<FScene::VISIBLE_MASK>();
-    Culler::intersects(
-            visibleArray + range.first,
-            frustum,
-            worldAABBCenter + range.first,
-            worldAABBExtent + range.first,
-            range.size(),
-            VISIBLE_DYN_SHADOW_RENDERABLE_BIT);
-
-    // update their visibility mask
     uint8_t const* layers = renderableData.data<FScene::LAYERS>();
     auto const* visibility = renderableData.data<FScene::VISIBILITY_STATE>();
-    updateSpotVisibilityMasks(
-            view.getVisibleLayers(),
-            layers + range.first,
-            visibility + range.first,
-            visibleArray + range.first,
-            range.size());
+
+    // Renderables are processed in chunks small enough to stay in the cache while they're
+    // tested against every frustum. CHUNK_SIZE is a multiple of Culler::MODULO.
+    constexpr size_t CHUNK_SIZE = 1024;
+    size_t const chunkCount = (range.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    auto work = [&](uint32_t const startChunk, uint32_t const count) {
+        // Culler::intersects() only updates bit 0, the other ones must be initialized
+        Culler::result_type results[CHUNK_SIZE] = {};
+        for (size_t chunk = startChunk; chunk < startChunk + count; chunk++) {
+            size_t const first = range.first + chunk * CHUNK_SIZE;
+            size_t const n = std::min(CHUNK_SIZE, size_t(range.last) - first);
+            uint64_t* const UTILS_RESTRICT out = casters + chunk * CHUNK_SIZE;
+
+            std::fill_n(out, n, 0);
+            for (uint64_t maps = culledShadowMaps; maps; maps &= maps - 1) {
+                size_t const i = utils::ctz(maps);
+                Culler::intersects(results, frustums[i],
+                        worldAABBCenter + first, worldAABBExtent + first, n, 0);
+                for (size_t k = 0; k < n; k++) {
+                    out[k] |= uint64_t(results[k] & 1u) << i;
+                }
+            }
+
+            for (size_t k = 0; k < n; k++) {
+                FRenderableManager::Visibility const v = visibility[first + k];
+                bool const castsShadows = v.castShadows && (layers[first + k] & visibleLayers);
+                uint64_t const visible = v.culling ? out[k] : culledShadowMaps;
+                out[k] = castsShadows ? visible : 0;
+            }
+        }
+    };
+
+    if (chunkCount <= 1) {
+        work(0, chunkCount);
+    } else {
+        auto* job = utils::jobs::parallel_for(js, nullptr, 0, uint32_t(chunkCount),
+                std::cref(work), utils::jobs::CountSplitter<1>());
+        js.runAndWait(job);
+    }
+}
+
+void ShadowMapManager::updateSpotVisibilityMasks(
+        uint64_t const* UTILS_RESTRICT casters, size_t index,
+        Culler::result_type* UTILS_RESTRICT visibleMask, size_t count) {
+    // __restrict__ seems to only be taken into account as function parameters. This is very
+    // important here, otherwise, this loop doesn't get vectorized.
+    count = (count + 0xFu) & ~0xFu; // capacity guaranteed to be multiple of 16
+    for (size_t i = 0; i < count; ++i) {
+        using Type = Culler::result_type;
+        Type const visible = Type((casters[i] >> index) & 1u);
+        visibleMask[i] &= ~Type(VISIBLE_DYN_SHADOW_RENDERABLE);
+        visibleMask[i] |= Type(visible << VISIBLE_DYN_SHADOW_RENDERABLE_BIT);
+    }
 }
 
 ShadowMapManager::ShadowTechnique ShadowMapManager::updateSpotShadowMaps(FEngine& engine,
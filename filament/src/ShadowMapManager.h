@@ -21,6 +21,7 @@
 #include "ShadowMap.h"
 #include "ds/TypedBuffer.h"
 
+#include <filament/Frustum.h>
 #include <filament/LightManager.h>
 #include <filament/Options.h>
 
@@ -41,6 +42,7 @@
 #include <utils/BitmaskEnum.h>
 #include <utils/compiler.h>
 #include <utils/FixedCapacityVector.h>
+#include <utils/JobSystem.h>
 #include <utils/debug.h>
 #include <utils/Range.h>
 #include <utils/Slice.h>
@@ -112,7 +114,10 @@ public:
 
     ~ShadowMapManager();
 
-    static void createIfNeeded(FEngine& engine,
+    // Creates the ShadowMapManager and its shadow maps. This creates Camera components, so it
+    // must be called on the main thread, never while Views are prepared concurrently.
+    // update() is safe to call concurrently for different Views.
+    static void createIfNeeded(FEngine& engine, backend::DriverApi& driver,
             std::unique_ptr<ShadowMapManager>& inOutShadowMapManager);
 
     static void terminate(FEngine& engine,
@@ -121,7 +126,7 @@ public:
     // Updates all the shadow maps and performs culling.
     // Returns true if any of the shadow maps have visible shadows.
     ShadowMapManager::ShadowTechnique update(Builder const& builder,
-            FEngine& engine, FView& view,
+            FEngine& engine, backend::DriverApi& driver, FView& view,
             CameraInfo const& cameraInfo,
             FScene::RenderableSoa& renderableData, FScene::LightSoa const& lightData) noexcept;
 
@@ -142,6 +147,20 @@ public:
     // for debugging only
     utils::FixedCapacityVector<Camera const*> getDirectionalShadowCameras() const noexcept;
 
+    // Culls the shadow casters of the spot and point shadow maps with a single pass over the
+    // renderables. On return, bit i of casters[k] is set if the renderable at range.first + k
+    // must be rendered into the shadow map i. Only the shadow maps set in culledShadowMaps are
+    // culled against their frustum, the others get no casters.
+    static void cullSpotShadowMaps(utils::JobSystem& js, uint8_t visibleLayers,
+            FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range,
+            Frustum const* frustums, uint64_t culledShadowMaps,
+            uint64_t* UTILS_RESTRICT casters) noexcept;
+
+    // Sets VISIBLE_DYN_SHADOW_RENDERABLE from bit `index` of each caster mask
+    static void updateSpotVisibilityMasks(
+            uint64_t const* UTILS_RESTRICT casters, size_t index,
+            Culler::result_type* UTILS_RESTRICT visibleMask, size_t count);
+
 private:
     explicit ShadowMapManager(FEngine& engine);
 
@@ -164,24 +183,13 @@ private:
             FEngine& engine, FView& view, CameraInfo const& mainCameraInfo,
             FScene::LightSoa& lightData, ShadowMap::SceneInfo const& sceneInfo) noexcept;
 
-    static void cullSpotShadowMap(ShadowMap const& map,
-            FEngine const& engine, FView const& view,
-            FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range,
-            FScene::LightSoa const& lightData) noexcept;
-
     void preparePointShadowMap(ShadowMap& map,
             FEngine& engine, FView& view, CameraInfo const& mainCameraInfo,
             FScene::LightSoa& lightData) noexcept;
 
-    static void cullPointShadowMap(ShadowMap const& shadowMap, FView const& view,
-            FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range,
-            FScene::LightSoa const& lightData) noexcept;
-
-    static void updateSpotVisibilityMasks(
-            uint8_t visibleLayers,
-            uint8_t const* UTILS_RESTRICT layers,
-            FRenderableManager::Visibility const* UTILS_RESTRICT visibility,
-            Culler::result_type* UTILS_RESTRICT visibleMask, size_t count);
+    // Frustum used to cull the shadow casters of a spot or point shadow map
+    static Frustum getSpotShadowMapFrustum(ShadowMap const& shadowMap,
+            FEngine const& engine, FScene::LightSoa const& lightData) noexcept;
 
     class CascadeSplits {
     public:
@@ -224,6 +232,10 @@ private:
 
     ShadowMap::SceneInfo mSceneInfo;
 
+    // Per-renderable masks of the spot and point shadow maps it's visible in, see
+    // cullSpotShadowMaps(). Kept across frames to avoid reallocating.
+    std::vector<uint64_t> mSpotShadowCasters;
+
     // Inline storage for all our ShadowMap objects, we can't easily use a std::array<> directly.
     // Because ShadowMap doesn't have a default ctor, and we avoid out-of-line allocations.
     // Each ShadowMap is currently 40 bytes (total of 2.5KB for 64 shadow maps)
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TransientHeap.h"
+
+#include <utils/debug.h>
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+TransientHeap::Stats TransientHeap::pack(
+        Allocation* allocations, size_t count, size_t alignment) noexcept {
+    assert_invariant(alignment && !(alignment & (alignment - 1)));
+
+    Stats stats;
+    if (!count) {
+        return stats;
+    }
+
+    auto alignedSize = [alignment](Allocation const& a) {
+        return (a.size + alignment - 1) & ~(alignment - 1);
+    };
+
+    // place the largest allocations first, this usually gives a tighter packing
+    std::vector<uint32_t>& order = mOrder;
+    order.resize(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [allocations](uint32_t lhs, uint32_t rhs) {
+        return allocations[lhs].size > allocations[rhs].size;
+    });
+
+    // [begin, end) ranges of the heap used by placed allocations alive at the same time
+    std::vector<std::pair<size_t, size_t>>& busy = mBusy;
+    busy.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+        Allocation& a = allocations[order[i]];
+        size_t const size = alignedSize(a);
+
+        busy.clear();
+        for (size_t j = 0; j < i; j++) {
+            Allocation const& b = allocations[order[j]];
+            if (b.first <= a.last && a.first <= b.last) {
+                busy.emplace_back(b.offset, b.offset + alignedSize(b));
+            }
+        }
+        std::sort(busy.begin(), busy.end());
+
+        // find the lowest gap large enough
+        size_t offset = 0;
+        for (auto const& range : busy) {
+            if (range.first >= offset + size) {
+                break;
+            }
+            offset = std::max(offset, range.second);
+        }
+
+        a.offset = offset;
+        stats.totalSize += size;
+        stats.heapSize = std::max(stats.heapSize, offset + size);
+    }
+
+    // Find the peak of memory alive at the same time. Each allocation contributes +size at its
+    // first use and -size right after its last use; at equal times releases come first.
+    std::vector<std::pair<uint64_t, int64_t>>& events = mEvents;
+    events.clear();
+    events.reserve(count * 2);
+    for (size_t i = 0; i < count; i++) {
+        Allocation const& a = allocations[i];
+        int64_t const size = int64_t(alignedSize(a));
+        events.emplace_back(uint64_t(a.first), size);
+        events.emplace_back(uint64_t(a.last) + 1u, -size);
+    }
+    std::sort(events.begin(), events.end());
+
+    int64_t alive = 0;
+    for (auto const& event : events) {
+        alive += event.second;
+        stats.peakSize = std::max(stats.peakSize, size_t(alive));
+    }
+
+    assert_invariant(stats.peakSize <= stats.heapSize);
+    assert_invariant(stats.heapSize <= stats.totalSize);
+    return stats;
+}
+
+} // namespace filament
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_TRANSIENTHEAP_H
+#define TNT_FILAMENT_TRANSIENTHEAP_H
+
+#include <utils/compiler.h>
+
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+/*
+ * Packs allocations with known lifetimes into a single heap, such that allocations whose
+ * lifetimes don't overlap can share the same memory.
+ *
+ * Lifetimes are expressed in an arbitrary monotonic unit, typically the FrameGraph pass order.
+ * Allocations are placed by decreasing size, each at the lowest offset that doesn't collide with
+ * an already placed allocation alive at the same time (i.e. a greedy interval packing).
+ */
+class UTILS_PUBLIC TransientHeap {
+public:
+    struct Allocation {
+        size_t size;        // size in bytes
+        uint32_t first;     // start of the lifetime
+        uint32_t last;      // end of the lifetime (inclusive)
+        size_t offset;      // offset in the heap, computed by pack()
+    };
+
+    struct Stats {
+        size_t totalSize = 0;   // memory needed without aliasing
+        size_t peakSize = 0;    // memory alive at the busiest time, a lower bound of heapSize
+        size_t heapSize = 0;    // size of the heap after packing
+    };
+
+    /*
+     * Computes the offset of each allocation in the heap. Offsets are multiple of alignment,
+     * which must be a power of two. The scratch memory is kept from one call to the next, so
+     * packing every frame only allocates when a frame has more allocations than any before.
+     */
+    Stats pack(Allocation* allocations, size_t count, size_t alignment) noexcept;
+
+private:
+    std::vector<uint32_t> mOrder;
+    std::vector<std::pair<size_t, size_t>> mBusy;
+    std::vector<std::pair<uint64_t, int64_t>> mEvents;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_TRANSIENTHEAP_H
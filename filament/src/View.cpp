@@ -309,6 +309,18 @@ const View::StereoscopicOptions& View::getStereoscopicOptions() const noexcept {
     return downcast(this)->getStereoscopicOptions();
 }
 
+void View::setLodOptions(LodOptions const& options) noexcept {
+    downcast(this)->setLodOptions(options);
+}
+
+View::LodOptions const& View::getLodOptions() const noexcept {
+    return downcast(this)->getLodOptions();
+}
+
+size_t View::getLodTriangleCount(uint8_t level) const noexcept {
+    return downcast(this)->getLodTriangleCount(level);
+}
+
 View::PickingQuery& View::pick(uint32_t x, uint32_t y, backend::CallbackHandler* handler,
         View::PickingQueryResultCallback callback) noexcept {
     return downcast(this)->pick(x, y, handler, callback);
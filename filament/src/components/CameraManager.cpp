@@ -47,13 +47,6 @@ void FCameraManager::terminate(FEngine& engine) noexcept {
     }
 }
 
-void FCameraManager::gc(FEngine& engine, utils::EntityManager& em) noexcept {
-    auto& manager = mManager;
-    manager.gc(em, [this, &engine](Entity e) {
-        destroy(engine, e);
-    });
-}
-
 FCamera* FCameraManager::create(FEngine& engine, Entity entity) {
     auto& manager = mManager;
 
@@ -46,8 +46,6 @@ public:
     // free-up all resources
     void terminate(FEngine& engine) noexcept;
 
-    void gc(FEngine& engine, utils::EntityManager& em) noexcept;
-
     /*
     * Component Manager APIs
     */
@@ -227,11 +227,6 @@ void FLightManager::terminate() noexcept {
         }
     }
 }
-void FLightManager::gc(utils::EntityManager& em) noexcept {
-    mManager.gc(em, [this](Entity e) {
-        destroy(e);
-    });
-}
 
 void FLightManager::setShadowOptions(Instance i, ShadowOptions const& options) noexcept {
     ShadowParams& params = mManager[i].shadowParams;
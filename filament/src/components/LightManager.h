@@ -44,8 +44,6 @@ public:
 
     void terminate() noexcept;
 
-    void gc(utils::EntityManager& em) noexcept;
-
     /*
      * Component Manager APIs
      */
@@ -73,6 +73,12 @@ using namespace backend;
 struct RenderableManager::BuilderDetails {
     using Entry = FRenderableManager::Entry;
     std::vector<Entry> mEntries;
+    // levels of detail 1 and up, level 0's primitives are mEntries
+    struct Level {
+        std::vector<Entry> entries;
+        float error = 0.0f;
+    };
+    std::vector<Level> mLevels;
     Box mAABB;
     uint8_t mLayerMask = 0x1;
     uint8_t mPriority = 0x4;
@@ -113,6 +119,12 @@ struct RenderableManager::BuilderDetails {
 
     void processBoneIndicesAndWights(Engine& engine, utils::Entity entity);
 
+    std::vector<Entry>* getEntries(uint8_t level) noexcept {
+        if (!level) {
+            return &mEntries;
+        }
+        return level <= mLevels.size() ? &mLevels[level - 1].entries : nullptr;
+    }
 };
 
 using BuilderType = RenderableManager;
@@ -152,6 +164,33 @@ RenderableManager::Builder& RenderableManager::Builder::geometry(size_t index,
     return *this;
 }
 
+RenderableManager::Builder& RenderableManager::Builder::levelOfDetail(uint8_t level,
+        size_t count, float error) noexcept {
+    if (level > 0 && level < MAX_LEVEL_COUNT) {
+        std::vector<BuilderDetails::Level>& levels = mImpl->mLevels;
+        if (levels.size() < level) {
+            levels.resize(level);
+        }
+        levels[level - 1] = { std::vector<BuilderDetails::Entry>(count), error };
+    }
+    return *this;
+}
+
+RenderableManager::Builder& RenderableManager::Builder::geometry(uint8_t level, size_t index,
+        PrimitiveType type, VertexBuffer* vertices, IndexBuffer* indices,
+        size_t offset, size_t count) noexcept {
+    std::vector<BuilderDetails::Entry>* const entries = mImpl->getEntries(level);
+    if (entries && index < entries->size()) {
+        BuilderDetails::Entry& entry = (*entries)[index];
+        entry.vertices = vertices;
+        entry.indices = indices;
+        entry.offset = offset;
+        entry.count = count;
+        entry.type = type;
+    }
+    return *this;
+}
+
 RenderableManager::Builder& RenderableManager::Builder::geometryType(GeometryType type) noexcept {
     mImpl->mGeometryType = type;
     return *this;
@@ -165,6 +204,15 @@ RenderableManager::Builder& RenderableManager::Builder::material(size_t index,
     return *this;
 }
 
+RenderableManager::Builder& RenderableManager::Builder::material(uint8_t level, size_t index,
+        MaterialInstance const* materialInstance) noexcept {
+    std::vector<BuilderDetails::Entry>* const entries = mImpl->getEntries(level);
+    if (entries && index < entries->size()) {
+        (*entries)[index].materialInstance = materialInstance;
+    }
+    return *this;
+}
+
 RenderableManager::Builder& RenderableManager::Builder::boundingBox(const Box& axisAlignedBoundingBox) noexcept {
     mImpl->mAABB = axisAlignedBoundingBox;
     return *this;
@@ -286,9 +334,9 @@ RenderableManager::Builder& RenderableManager::Builder::morphing(
 RenderableManager::Builder& RenderableManager::Builder::morphing(uint8_t level,
         size_t primitiveIndex, size_t offset) noexcept {
     // the last parameter "count" is unused, because it must be equal to the primitive's vertex count
-    std::vector<BuilderDetails::Entry>& entries = mImpl->mEntries;
-    if (primitiveIndex < entries.size()) {
-        auto& morphing = entries[primitiveIndex].morphing;
+    std::vector<BuilderDetails::Entry>* const entries = mImpl->getEntries(level);
+    if (entries && primitiveIndex < entries->size()) {
+        auto& morphing = (*entries)[primitiveIndex].morphing;
         morphing.offset = uint32_t(offset);
     }
     return *this;
@@ -464,47 +512,59 @@ RenderableManager::Builder::Result RenderableManager::Builder::build(Engine& eng
         mImpl->processBoneIndicesAndWights(engine, entity);
     }
 
-    for (size_t i = 0, c = mImpl->mEntries.size(); i < c; i++) {
-        auto& entry = mImpl->mEntries[i];
+    for (size_t l = 0, n = mImpl->mLevels.size(); l < n; l++) {
+        float const previousError = l ? mImpl->mLevels[l - 1].error : 0.0f;
+        FILAMENT_CHECK_PRECONDITION(mImpl->mLevels[l].error > previousError)
+                << "[entity=" << entity.getId() << ", level " << l + 1 << "] error ("
+                << mImpl->mLevels[l].error << ") must be larger than the previous level's ("
+                << previousError << "), or the level wasn't declared";
+    }
 
-        // entry.materialInstance must be set to something even if indices/vertices are null
-        FMaterial const* material;
-        if (!entry.materialInstance) {
-            material = downcast(engine.getDefaultMaterial());
-            entry.materialInstance = material->getDefaultInstance();
-        } else {
-            material = downcast(entry.materialInstance->getMaterial());
-        }
+    for (uint8_t level = 0, n = uint8_t(mImpl->mLevels.size() + 1); level < n; level++) {
+        std::vector<BuilderDetails::Entry>& entries = *mImpl->getEntries(level);
+        for (size_t i = 0, c = entries.size(); i < c; i++) {
+            auto& entry = entries[i];
+
+            // entry.materialInstance must be set to something even if indices/vertices are null
+            FMaterial const* material;
+            if (!entry.materialInstance) {
+                material = downcast(engine.getDefaultMaterial());
+                entry.materialInstance = material->getDefaultInstance();
+            } else {
+                material = downcast(entry.materialInstance->getMaterial());
+            }
 
-        // primitives without indices or vertices will be ignored
-        if (!entry.indices || !entry.vertices) {
-            continue;
-        }
+            // primitives without indices or vertices will be ignored
+            if (!entry.indices || !entry.vertices) {
+                continue;
+            }
 
-        // we want a feature level violation to be a hard error (exception if enabled, or crash)
-        FILAMENT_CHECK_PRECONDITION(downcast(engine).hasFeatureLevel(material->getFeatureLevel()))
-                << "Material \"" << material->getName().c_str_safe() << "\" has feature level "
-                << (uint8_t)material->getFeatureLevel() << " which is not supported by this Engine";
-
-        // reject invalid geometry parameters
-        FILAMENT_CHECK_PRECONDITION(entry.offset + entry.count <= entry.indices->getIndexCount())
-                << "[entity=" << entity.getId() << ", primitive @ " << i << "] offset ("
-                << entry.offset << ") + count (" << entry.count << ") > indexCount ("
-                << entry.indices->getIndexCount() << ")";
-
-        // this can't be an error because (1) those values are not immutable, so the caller
-        // could fix later, and (2) the material's shader will work (i.e. compile), and
-        // use the default values for this attribute, which maybe be acceptable.
-        AttributeBitset const declared = downcast(entry.vertices)->getDeclaredAttributes();
-        AttributeBitset const required = material->getRequiredAttributes();
-        if ((declared & required) != required) {
-            slog.w << "[entity=" << entity.getId() << ", primitive @ " << i
-                   << "] missing required attributes ("
-                   << required << "), declared=" << declared << io::endl;
-        }
+            // we want a feature level violation to be a hard error (exception if enabled, or crash)
+            FILAMENT_CHECK_PRECONDITION(downcast(engine).hasFeatureLevel(material->getFeatureLevel()))
+                    << "Material \"" << material->getName().c_str_safe() << "\" has feature level "
+                    << (uint8_t)material->getFeatureLevel() << " which is not supported by this Engine";
+
+            // reject invalid geometry parameters
+            FILAMENT_CHECK_PRECONDITION(entry.offset + entry.count <= entry.indices->getIndexCount())
+                    << "[entity=" << entity.getId() << ", level " << +level << ", primitive @ "
+                    << i << "] offset (" << entry.offset << ") + count (" << entry.count
+                    << ") > indexCount ("
+                    << entry.indices->getIndexCount() << ")";
+
+            // this can't be an error because (1) those values are not immutable, so the caller
+            // could fix later, and (2) the material's shader will work (i.e. compile), and
+            // use the default values for this attribute, which maybe be acceptable.
+            AttributeBitset const declared = downcast(entry.vertices)->getDeclaredAttributes();
+            AttributeBitset const required = material->getRequiredAttributes();
+            if ((declared & required) != required) {
+                slog.w << "[entity=" << entity.getId() << ", level " << +level
+                       << ", primitive @ " << i << "] missing required attributes ("
+                       << required << "), declared=" << declared << io::endl;
+            }
 
-        // we have at least one valid primitive
-        isEmpty = false;
+            // we have at least one valid primitive
+            isEmpty = false;
+        }
     }
 
     FILAMENT_CHECK_PRECONDITION(!mImpl->mAABB.isEmpty() ||
@@ -555,15 +615,28 @@ void FRenderableManager::create(
 
     if (ci) {
         // create and initialize all needed RenderPrimitives
-        using size_type = Slice<FRenderPrimitive>::size_type;
-        auto const * const entries = builder->mEntries.data();
-        const size_t entryCount = builder->mEntries.size();
-        FRenderPrimitive* rp = new FRenderPrimitive[entryCount];
-        auto& factory = mHwRenderPrimitiveFactory;
-        for (size_t i = 0; i < entryCount; ++i) {
-            rp[i].init(factory, driver, entries[i]);
+        auto createPrimitives = [this, &driver](std::vector<Entry> const& entries) {
+            using size_type = Slice<FRenderPrimitive>::size_type;
+            const size_t entryCount = entries.size();
+            FRenderPrimitive* rp = new FRenderPrimitive[entryCount];
+            auto& factory = mHwRenderPrimitiveFactory;
+            for (size_t i = 0; i < entryCount; ++i) {
+                rp[i].init(factory, driver, entries[i]);
+            }
+            return Slice<FRenderPrimitive>{ rp, size_type(entryCount) };
+        };
+        setPrimitives(ci, createPrimitives(builder->mEntries));
+
+        if (UTILS_UNLIKELY(!builder->mLevels.empty())) {
+            LevelsOfDetail* const lods = new LevelsOfDetail{};
+            lods->count = uint8_t(builder->mLevels.size() + 1);
+            for (size_t l = 1; l < lods->count; l++) {
+                auto const& level = builder->mLevels[l - 1];
+                lods->primitives[l] = createPrimitives(level.entries);
+                lods->errors[l] = level.error;
+            }
+            manager[ci].lods = lods;
         }
-        setPrimitives(ci, { rp, size_type(entryCount) });
 
         setAxisAlignedBoundingBox(ci, builder->mAABB);
         setLayerMask(ci, builder->mLayerMask);
@@ -692,12 +765,14 @@ void FRenderableManager::create(
                         backend::BufferUsage::DYNAMIC),
                 .count = targetCount };
 
-            Slice<FRenderPrimitive>& primitives = mManager[ci].primitives;
             mManager[ci].morphTargetBuffer = morphTargetBuffer;
             if (builder->mMorphTargetBuffer) {
-                for (size_t i = 0; i < entryCount; ++i) {
-                    const auto& morphing = builder->mEntries[i].morphing;
-                    primitives[i].setMorphingBufferOffset(morphing.offset);
+                for (uint8_t l = 0, n = uint8_t(builder->mLevels.size() + 1); l < n; l++) {
+                    auto const& entries = l ? builder->mLevels[l - 1].entries : builder->mEntries;
+                    Slice<FRenderPrimitive>& primitives = getRenderPrimitives(ci, l);
+                    for (size_t i = 0, c = entries.size(); i < c; ++i) {
+                        primitives[i].setMorphingBufferOffset(entries[i].morphing.offset);
+                    }
                 }
             }
             
@@ -739,12 +814,6 @@ void FRenderableManager::terminate() noexcept {
     mHwRenderPrimitiveFactory.terminate(mEngine.getDriverApi());
 }
 
-void FRenderableManager::gc(utils::EntityManager& em) noexcept {
-    mManager.gc(em, [this](Entity e) {
-        destroy(e);
-    });
-}
-
 // This is basically a Renderable's destructor.
 void FRenderableManager::destroyComponent(Instance ci) noexcept {
     auto& manager = mManager;
@@ -754,6 +823,7 @@ void FRenderableManager::destroyComponent(Instance ci) noexcept {
 
     // See create(RenderableManager::Builder&, Entity)
     destroyComponentPrimitives(mHwRenderPrimitiveFactory, driver, manager[ci].primitives);
+    destroyLevelsOfDetail(ci);
 
     // destroy the per-renderable descriptor set if we have one
     DescriptorSet& descriptorSet = manager[ci].descriptorSet;
@@ -790,6 +860,18 @@ void FRenderableManager::destroyComponentPrimitives(
     delete[] primitives.data();
 }
 
+void FRenderableManager::destroyLevelsOfDetail(Instance ci) noexcept {
+    LevelsOfDetail*& lods = mManager[ci].lods;
+    if (lods) {
+        FEngine::DriverApi& driver = mEngine.getDriverApi();
+        for (size_t l = 1; l < lods->count; l++) {
+            destroyComponentPrimitives(mHwRenderPrimitiveFactory, driver, lods->primitives[l]);
+        }
+        delete lods;
+        lods = nullptr;
+    }
+}
+
 void FRenderableManager::setMaterialInstanceAt(Instance instance, uint8_t level,
         size_t primitiveIndex, FMaterialInstance const* mi) {
     if (instance) {
@@ -966,7 +1048,7 @@ void FRenderableManager::setMorphTargetBufferOffsetAt(Instance instance, uint8_t
         size_t offset) {
     if (instance) {
         assert_invariant(mManager[instance].morphTargetBuffer);
-        Slice<FRenderPrimitive>& primitives = mManager[instance].primitives;
+        Slice<FRenderPrimitive>& primitives = getRenderPrimitives(instance, level);
         if (primitiveIndex < primitives.size()) {
             primitives[primitiveIndex].setMorphingBufferOffset(offset);
         }
@@ -42,6 +42,8 @@
 #include <math/mat4.h>
 
 #include <algorithm>
+#include <atomic>
+#include <utility>
 
 #include <stddef.h>
 #include <stdint.h>
@@ -88,8 +90,6 @@ public:
     // free-up all resources
     void terminate() noexcept;
 
-    void gc(utils::EntityManager& em) noexcept;
-
     /*
      * Component Manager APIs
      */
@@ -200,7 +200,21 @@ public:
     static_assert(sizeof(InstancesInfo) == 16);
     inline InstancesInfo getInstancesInfo(Instance instance) const noexcept;
 
-    inline size_t getLevelCount(Instance) const noexcept { return 1u; }
+    // Levels of detail of a renderable that has more than one, see Builder::levelOfDetail().
+    struct LevelsOfDetail {
+        static constexpr size_t MAX_LEVEL_COUNT = RenderableManager::Builder::MAX_LEVEL_COUNT;
+        // primitives of levels 1 and up, level 0's are in PRIMITIVES and primitives[0] is unused
+        utils::Slice<FRenderPrimitive> primitives[MAX_LEVEL_COUNT];
+        // geometric error of each level in object space, errors[0] is always 0
+        float errors[MAX_LEVEL_COUNT] = {};
+        uint8_t count = 1;
+        // level selected in the last frame, for the hysteresis. Views of different Scenes that
+        // share this renderable can be prepared concurrently, and all update it.
+        std::atomic<uint8_t> current = 0;
+    };
+
+    inline size_t getLevelCount(Instance instance) const noexcept;
+    inline LevelsOfDetail* getLevelsOfDetail(Instance instance) const noexcept;
     size_t getPrimitiveCount(Instance instance, uint8_t level) const noexcept;
     void setMaterialInstanceAt(Instance instance, uint8_t level,
             size_t primitiveIndex, FMaterialInstance const* materialInstance);
@@ -233,6 +247,7 @@ private:
     static void destroyComponentPrimitives(
             HwRenderPrimitiveFactory& factory, backend::DriverApi& driver,
             utils::Slice<FRenderPrimitive>& primitives) noexcept;
+    void destroyLevelsOfDetail(Instance ci) noexcept;
 
     struct Bones {
         backend::Handle<backend::HwBufferObject> handle;
@@ -259,7 +274,8 @@ private:
         PRIMITIVES,             // user data
         BONES,                  // filament data, UBO storing a pointer to the bones information
         MORPHTARGET_BUFFER,     // morphtarget buffer for the component
-        DESCRIPTOR_SET          // per-renderable descriptor set
+        DESCRIPTOR_SET,         // per-renderable descriptor set
+        LODS                    // levels of detail above 0, null if there are none
     };
 
     using Base = utils::SingleInstanceComponentManager<
@@ -272,7 +288,8 @@ private:
             utils::Slice<FRenderPrimitive>,  // PRIMITIVES
             Bones,                           // BONES
             FMorphTargetBuffer*,            // MORPHTARGET_BUFFER
-            filament::DescriptorSet          // DESCRIPTOR_SET
+            filament::DescriptorSet,         // DESCRIPTOR_SET
+            LevelsOfDetail*                  // LODS
     >;
 
     struct Sim : public Base {
@@ -297,6 +314,7 @@ private:
                 Field<BONES>                bones;
                 Field<MORPHTARGET_BUFFER>   morphTargetBuffer;
                 Field<DESCRIPTOR_SET>       descriptorSet;
+                Field<LODS>                 lods;
             };
         };
 
@@ -477,14 +495,34 @@ FRenderableManager::getInstancesInfo(Instance instance) const noexcept {
     return mManager[instance].instances;
 }
 
+size_t FRenderableManager::getLevelCount(Instance instance) const noexcept {
+    LevelsOfDetail const* const lods = mManager[instance].lods;
+    return lods ? lods->count : 1u;
+}
+
+FRenderableManager::LevelsOfDetail* FRenderableManager::getLevelsOfDetail(
+        Instance instance) const noexcept {
+    return mManager[instance].lods;
+}
+
 utils::Slice<FRenderPrimitive> const& FRenderableManager::getRenderPrimitives(
-        Instance instance, UTILS_UNUSED uint8_t level) const noexcept {
-    return mManager[instance].primitives;
+        Instance instance, uint8_t level) const noexcept {
+    if (UTILS_LIKELY(!level)) {
+        return mManager[instance].primitives;
+    }
+    LevelsOfDetail const* const lods = mManager[instance].lods;
+    if (lods && level < lods->count) {
+        return lods->primitives[level];
+    }
+    static utils::Slice<FRenderPrimitive> const sNoPrimitives;
+    return sNoPrimitives;
 }
 
 utils::Slice<FRenderPrimitive>& FRenderableManager::getRenderPrimitives(
-        Instance instance, UTILS_UNUSED uint8_t level) noexcept {
-    return mManager[instance].primitives;
+        Instance instance, uint8_t level) noexcept {
+    // the empty slice returned for an invalid level is never written to, since it has no element
+    return const_cast<utils::Slice<FRenderPrimitive>&>(
+            std::as_const(*this).getRenderPrimitives(instance, level));
 }
 
 DescriptorSet& FRenderableManager::getDescriptorSet(Instance instance) noexcept {
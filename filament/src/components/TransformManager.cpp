@@ -19,8 +19,14 @@
 #include <math/mat4.h>
 
 #include <utils/debug.h>
+#include <utils/JobSystem.h>
 #include <filament/TransformManager.h>
 
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include <stddef.h>
 
 using namespace utils;
 using namespace filament::math;
@@ -29,6 +35,10 @@ namespace filament {
 
 FTransformManager::FTransformManager() noexcept = default;
 
+FTransformManager::FTransformManager(JobSystem* js) noexcept
+        : mJobSystem(js) {
+}
+
 FTransformManager::~FTransformManager() noexcept = default;
 
 void FTransformManager::terminate() noexcept {
@@ -38,8 +48,12 @@ void FTransformManager::setAccurateTranslationsEnabled(bool enable) noexcept {
     if (enable != mAccurateTranslations) {
         mAccurateTranslations = enable;
         // when enabling accurate translations, we have to recompute all world transforms
-        if (enable && !mLocalTransformTransactionOpen) {
-            computeAllWorldTransforms();
+        if (enable) {
+            if (!mLocalTransformTransactionOpen) {
+                computeAllWorldTransforms();
+            } else {
+                mAllDirty = true;
+            }
         }
     }
 }
@@ -65,6 +79,7 @@ void FTransformManager::create(Entity entity, Instance parent, const mat4f& loca
         manager[i].next = 0;
         manager[i].prev = 0;
         manager[i].firstChild = 0;
+        manager[i].dirty = false;
         insertNode(i, parent);
         setTransform(i, localTransform);
     }
@@ -87,6 +102,7 @@ void FTransformManager::create(Entity entity, Instance parent, const mat4& local
         manager[i].next = 0;
         manager[i].prev = 0;
         manager[i].firstChild = 0;
+        manager[i].dirty = false;
         insertNode(i, parent);
         setTransform(i, localTransform);
     }
@@ -104,7 +120,7 @@ void FTransformManager::setParent(Instance i, Instance parent) noexcept {
             updateNodeTransform(i);
             // Note: setParent() doesn't reorder the child after the parent in the array,
             // but that's not a problem because TransformManager doesn't rely on that.
-            // Also note that commitLocalTransformTransaction() does reorder all children after
+            // Also note that commitLocalTransformTransaction() may reorder all children after
             // their parent, as an optimization to calculate the world transform.
         }
     }
@@ -154,6 +170,9 @@ void FTransformManager::destroy(Entity e) noexcept {
         Instance child = manager[i].firstChild;
         while (child) {
             manager[child].parent = 0;
+            if (UTILS_UNLIKELY(mLocalTransformTransactionOpen)) {
+                markDirty(child);
+            }
             child = manager[child].next;
         }
 
@@ -191,12 +210,14 @@ void FTransformManager::setTransform(Instance ci, const mat4& model) noexcept {
 
 void FTransformManager::updateNodeTransform(Instance i) noexcept {
     if (UTILS_UNLIKELY(mLocalTransformTransactionOpen)) {
+        markDirty(i);
         return;
     }
 
     validateNode(i);
     auto& manager = mManager;
     assert_invariant(i);
+    mWorldTransformUpdateCount.fetch_add(1, std::memory_order_relaxed);
 
     // find our parent's world transform, if any
     // note: by using the raw_array() we don't need to check that parent is valid.
@@ -221,7 +242,21 @@ void FTransformManager::openLocalTransformTransaction() noexcept {
 void FTransformManager::commitLocalTransformTransaction() noexcept {
     if (mLocalTransformTransactionOpen) {
         mLocalTransformTransactionOpen = false;
-        computeAllWorldTransforms();
+        // When a good part of the hierarchy changed, a linear pass over all the transforms is
+        // faster than walking the dirty subtrees (note: mDirtyEntities can have duplicates).
+        if (mAllDirty || mDirtyEntities.size() * 4 >= mManager.getComponentCount()) {
+            computeAllWorldTransforms();
+        } else {
+            computeDirtyWorldTransforms();
+        }
+    }
+}
+
+void FTransformManager::markDirty(Instance i) noexcept {
+    auto& manager = mManager;
+    if (!manager[i].dirty) {
+        manager[i].dirty = true;
+        mDirtyEntities.push_back(manager.getEntity(i));
     }
 }
 
@@ -246,6 +281,88 @@ void FTransformManager::computeAllWorldTransforms() noexcept {
                 manager[parent].world, manager[i].local,
                 manager[parent].worldTranslationLo, manager[i].localTranslationLo,
                 accurate);
+
+        manager[i].dirty = false;
+    }
+
+    mWorldTransformUpdateCount.fetch_add(manager.getComponentCount(), std::memory_order_relaxed);
+    mDirtyEntities.clear();
+    mAllDirty = false;
+}
+
+void FTransformManager::computeDirtyWorldTransforms() noexcept {
+    auto& manager = mManager;
+    auto& level = mCurrentLevel;
+    auto& nextLevel = mNextLevel;
+
+    // find the instances of the dirty nodes, some of them might have been destroyed since.
+    level.clear();
+    for (Entity const e : mDirtyEntities) {
+        Instance const i = manager.getInstance(e);
+        if (i && manager[i].dirty) {
+            level.push_back(i);
+        }
+    }
+    mDirtyEntities.clear();
+    std::sort(level.begin(), level.end());
+    level.erase(std::unique(level.begin(), level.end()), level.end());
+
+    // we only need the roots of the dirty subtrees, i.e. the dirty nodes without dirty ancestors
+    nextLevel.clear();
+    for (Instance const i : level) {
+        Instance p = manager[i].parent;
+        while (p && !manager[p].dirty) {
+            p = manager[p].parent;
+        }
+        if (!p) {
+            nextLevel.push_back(i);
+        }
+    }
+    for (Instance const i : level) {
+        manager[i].dirty = false;
+    }
+    std::swap(level, nextLevel);
+
+    // Update the dirty subtrees breadth-first, so that each level only depends on the previous
+    // one and can be processed in parallel.
+    while (!level.empty()) {
+        computeWorldTransforms(level.data(), level.size());
+        mWorldTransformUpdateCount.fetch_add(level.size(), std::memory_order_relaxed);
+
+        nextLevel.clear();
+        for (Instance const i : level) {
+            for (Instance child = manager[i].firstChild; child; child = manager[child].next) {
+                nextLevel.push_back(child);
+            }
+        }
+        std::swap(level, nextLevel);
+    }
+}
+
+void FTransformManager::computeWorldTransforms(Instance* instances, size_t count) noexcept {
+    auto work = [this](Instance const* instances, size_t count) {
+        auto& manager = mManager;
+        const bool accurate = mAccurateTranslations;
+        for (size_t k = 0; k < count; k++) {
+            Instance const i = instances[k];
+            Instance const parent = manager[i].parent;
+            FTransformManager::computeWorldTransform(
+                    manager[i].world, manager[i].worldTranslationLo,
+                    manager[parent].world, manager[i].local,
+                    manager[parent].worldTranslationLo, manager[i].localTranslationLo,
+                    accurate);
+        }
+    };
+
+    // below this, the overhead of the JobSystem isn't worth it
+    constexpr size_t PARALLEL_THRESHOLD = 1024;
+    if (mJobSystem && count >= PARALLEL_THRESHOLD) {
+        JobSystem& js = *mJobSystem;
+        auto* job = jobs::parallel_for(js, nullptr, instances, uint32_t(count),
+                std::cref(work), jobs::CountSplitter<256>());
+        js.runAndWait(job);
+    } else {
+        work(instances, count);
     }
 }
 
@@ -285,6 +402,7 @@ void FTransformManager::swapNode(Instance i, Instance j) noexcept {
     std::swap(manager.elementAt<LOCAL_LO>(i), manager.elementAt<LOCAL_LO>(j));
     std::swap(manager.elementAt<WORLD>(i),    manager.elementAt<WORLD>(j));
     std::swap(manager.elementAt<WORLD_LO>(i), manager.elementAt<WORLD_LO>(j));
+    std::swap(manager.elementAt<DIRTY>(i),    manager.elementAt<DIRTY>(j));
     manager.swap(i, j); // this swaps the data relative to SingleInstanceComponentManager
 
     // now swap the linked-list references, to do that correctly we must use a temporary
@@ -381,6 +499,7 @@ void FTransformManager::transformChildren(Sim& manager, Instance i) noexcept {
                 manager[parent].world, manager[i].local,
                 manager[parent].worldTranslationLo, manager[i].localTranslationLo,
                 accurate);
+        mWorldTransformUpdateCount.fetch_add(1, std::memory_order_relaxed);
 
         // assume we don't have a deep hierarchy
         Instance const child = manager[i].firstChild;
@@ -470,12 +589,6 @@ void FTransformManager::validateNode(UTILS_UNUSED_IN_RELEASE Instance i) noexcep
 #endif
 }
 
-void FTransformManager::gc(utils::EntityManager& em) noexcept {
-    mManager.gc(em, [this](Entity e) {
-                destroy(e);
-            });
-}
-
 TransformManager::children_iterator& TransformManager::children_iterator::operator++() {
     FTransformManager const& that = downcast(mManager);
     mInstance = that.mManager[mInstance].next;
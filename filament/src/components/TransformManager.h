@@ -28,6 +28,15 @@
 
 #include <math/mat4.h>
 
+#include <atomic>
+#include <vector>
+
+#include <stddef.h>
+
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace filament {
 
 class UTILS_PRIVATE FTransformManager : public TransformManager {
@@ -35,6 +44,10 @@ public:
     using Instance = TransformManager::Instance;
 
     FTransformManager() noexcept;
+
+    // When a JobSystem is provided, large transactions update world transforms in parallel.
+    // In that case commitLocalTransformTransaction() must be called from an adopted thread.
+    explicit FTransformManager(utils::JobSystem* js) noexcept;
     ~FTransformManager() noexcept;
 
     // free-up all resources
@@ -99,7 +112,18 @@ public:
 
     void commitLocalTransformTransaction() noexcept;
 
-    void gc(utils::EntityManager& em) noexcept;
+    bool isLocalTransformTransactionOpen() const noexcept {
+        return mLocalTransformTransactionOpen;
+    }
+
+    // number of world transforms computed since the last reset, for stats and debugging
+    size_t getWorldTransformUpdateCount() const noexcept {
+        return mWorldTransformUpdateCount.load(std::memory_order_relaxed);
+    }
+
+    void resetWorldTransformUpdateCount() noexcept {
+        mWorldTransformUpdateCount.store(0, std::memory_order_relaxed);
+    }
 
     utils::Slice<const math::mat4f> getWorldTransforms() const noexcept {
         return mManager.slice<WORLD>();
@@ -143,8 +167,11 @@ private:
     void insertNode(Instance i, Instance p) noexcept;
     void swapNode(Instance i, Instance j) noexcept;
     void transformChildren(Sim& manager, Instance firstChild) noexcept;
+    void markDirty(Instance i) noexcept;
 
     void computeAllWorldTransforms() noexcept;
+    void computeDirtyWorldTransforms() noexcept;
+    void computeWorldTransforms(Instance* instances, size_t count) noexcept;
 
     static void computeWorldTransform(math::mat4f& outWorld, math::float3& inoutWorldTranslationLo,
             math::mat4f const& pt, math::mat4f const& local,
@@ -162,6 +189,7 @@ private:
         FIRST_CHILD,    // instance to our first child
         NEXT,           // instance to our next sibling
         PREV,           // instance to our previous sibling
+        DIRTY,          // local transform or parent changed during a transaction
     };
 
     using Base = utils::SingleInstanceComponentManager<
@@ -172,7 +200,8 @@ private:
             Instance,       // parent
             Instance,       // firstChild
             Instance,       // next
-            Instance        // prev
+            Instance,       // prev
+            bool            // dirty
     >;
 
     struct Sim : public Base {
@@ -197,6 +226,7 @@ private:
                 Field<FIRST_CHILD>  firstChild;
                 Field<NEXT>         next;
                 Field<PREV>         prev;
+                Field<DIRTY>        dirty;
             };
         };
 
@@ -209,8 +239,18 @@ private:
     };
 
     Sim mManager;
+    utils::JobSystem* const mJobSystem = nullptr;
+    // Entities marked dirty during the current transaction. Entities are used rather than
+    // instances because the latter can change when components are destroyed.
+    std::vector<utils::Entity> mDirtyEntities;
+    // breadth-first traversal storage, kept around to avoid allocations
+    std::vector<Instance> mCurrentLevel;
+    std::vector<Instance> mNextLevel;
+    // atomic because the shadow maps of Views prepared concurrently set their camera's transform
+    std::atomic<size_t> mWorldTransformUpdateCount = 0;
     bool mLocalTransformTransactionOpen = false;
     bool mAccurateTranslations = false;
+    bool mAllDirty = false;
 };
 
 FILAMENT_DOWNCAST(TransformManager)
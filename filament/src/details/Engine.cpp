@@ -16,6 +16,7 @@
 
 #include "details/Engine.h"
 
+#include "CommandStreamPool.h"
 #include "MaterialParser.h"
 #include "ResourceAllocator.h"
 #include "RenderPrimitive.h"
@@ -214,9 +215,10 @@ FEngine::FEngine(Engine::Builder const& builder) :
         mPostProcessManager(*this),
         mEntityManager(EntityManager::get()),
         mRenderableManager(*this),
-        mTransformManager(),
+        mTransformManager(&mJobSystem),
         mLightManager(*this),
         mCameraManager(*this),
+        mDestroyedEntities(mEntityManager),
         mCommandBufferQueue(
                 builder->mConfig.minCommandBufferSizeMB * MiB,
                 builder->mConfig.commandBufferSizeMB * MiB,
@@ -482,6 +484,13 @@ void FEngine::init() {
                 });
             });
 
+    mDebugRegistry.registerProperty("d.transform.world_transform_updates",
+            &debug.transform.world_transform_updates);
+    mDebugRegistry.registerProperty("d.gc.pending_entities",
+            &debug.gc.pending_entities);
+    mDebugRegistry.registerProperty("d.gc.collected_components",
+            &debug.gc.collected_components);
+
     mInitialized = true;
 }
 
@@ -617,6 +626,9 @@ void FEngine::shutdown() {
     // These callbacks CANNOT call driver APIs.
     getDriver().purge();
 
+    // all secondary command streams have been executed and recycled at this point
+    mCommandStreamPool.reset();
+
     // and destroy the CommandStream
     std::destroy_at(std::launder(reinterpret_cast<DriverApi*>(&mDriverApiStorage)));
 
@@ -628,6 +640,16 @@ void FEngine::shutdown() {
     mJobSystem.emancipate();
 }
 
+CommandStreamPool& FEngine::getCommandStreamPool() noexcept {
+    if (UTILS_UNLIKELY(!mCommandStreamPool)) {
+        // secondary streams are sized like the main CommandStream so that anything that fits
+        // in a frame fits in a secondary stream.
+        mCommandStreamPool = std::make_unique<CommandStreamPool>(
+                getDriver(), getCommandBufferSize());
+    }
+    return *mCommandStreamPool;
+}
+
 void FEngine::prepare() {
     SYSTRACE_CALL();
     // prepare() is called once per Renderer frame. Ideally we would upload the content of
@@ -650,11 +672,50 @@ void FEngine::prepare() {
 
 void FEngine::gc() {
     // Note: this runs in a Job
+    SYSTRACE_CALL();
+
     auto& em = mEntityManager;
-    mRenderableManager.gc(em);
-    mLightManager.gc(em);
-    mTransformManager.gc(em);
-    mCameraManager.gc(*this, em);
+    auto& rcm = mRenderableManager;
+    auto& lcm = mLightManager;
+    auto& tcm = mTransformManager;
+    auto& ccm = mCameraManager;
+
+    auto const deadline = std::chrono::steady_clock::now() + GC_TIME_BUDGET;
+    size_t collected = 0;
+    size_t count;
+    do {
+        Entity entities[GC_BATCH_SIZE];
+        count = mDestroyedEntities.pop(entities, GC_BATCH_SIZE);
+        for (size_t i = 0; i < count; i++) {
+            Entity const e = entities[i];
+            // The generation of an index wraps around, if the Entity has been recycled that many
+            // times since it was destroyed, its components belong to the new one.
+            if (UTILS_UNLIKELY(em.isAlive(e))) {
+                continue;
+            }
+            if (rcm.hasComponent(e)) {
+                rcm.destroy(e);
+                collected++;
+            }
+            if (lcm.hasComponent(e)) {
+                lcm.destroy(e);
+                collected++;
+            }
+            if (tcm.hasComponent(e)) {
+                tcm.destroy(e);
+                collected++;
+            }
+            if (ccm.hasComponent(e)) {
+                ccm.destroy(*this, e);
+                collected++;
+            }
+        }
+    } while (count == GC_BATCH_SIZE && std::chrono::steady_clock::now() < deadline);
+
+    size_t const pending = mDestroyedEntities.size();
+    debug.gc.pending_entities = int(pending);
+    debug.gc.collected_components = int(collected);
+    SYSTRACE_VALUE32("gc.pendingEntities", pending);
 }
 
 void FEngine::flush() {
@@ -1300,6 +1361,22 @@ size_t FEngine::getSkyboxeCount() const noexcept { return mSkyboxes.size(); }
 size_t FEngine::getColorGradingCount() const noexcept { return mColorGradings.size(); }
 size_t FEngine::getRenderTargetCount() const noexcept { return mRenderTargets.size(); }
 
+size_t FEngine::saveProgramManifest(void* buffer, size_t size) const noexcept {
+    return mProgramManifest.serialize(buffer, size);
+}
+
+bool FEngine::loadProgramManifest(void const* data, size_t size) noexcept {
+    if (!mProgramManifest.deserialize(data, size)) {
+        return false;
+    }
+    // existing materials compile the manifest's variants now, the ones created later do it when
+    // they're built
+    mMaterials.forEach([](FMaterial* material) {
+        material->prepareManifestPrograms();
+    });
+    return true;
+}
+
 void* FEngine::streamAlloc(size_t size, size_t alignment) noexcept {
     // we allow this only for small allocations
     if (size > 65536) {
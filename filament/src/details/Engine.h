@@ -21,7 +21,9 @@
 
 #include "Allocators.h"
 #include "DFG.h"
+#include "DestroyedEntityJournal.h"
 #include "PostProcessManager.h"
+#include "ProgramManifest.h"
 #include "ResourceList.h"
 #include "HwDescriptorSetLayoutFactory.h"
 #include "HwVertexBufferInfoFactory.h"
@@ -91,6 +93,7 @@ using MaterialKey = uint32_t;
 namespace filament {
 
 class Renderer;
+class CommandStreamPool;
 class MaterialParser;
 class ResourceAllocatorDisposer;
 
@@ -157,6 +160,11 @@ public:
     uint32_t getMaterialId() const noexcept { return mMaterialId++; }
 
     const FMaterial* getDefaultMaterial() const noexcept { return mDefaultMaterial; }
+
+    // programs created by materials, see saveProgramManifest()
+    ProgramManifest& getProgramManifest() noexcept { return mProgramManifest; }
+    size_t saveProgramManifest(void* buffer, size_t size) const noexcept;
+    bool loadProgramManifest(void const* data, size_t size) noexcept;
     const FMaterial* getSkyboxMaterial() const noexcept;
     const FIndirectLight* getDefaultIndirectLight() const noexcept { return mDefaultIbl; }
     const FTexture* getDummyCubemap() const noexcept { return mDefaultIblTexture; }
@@ -278,6 +286,9 @@ public:
         return mResourceAllocatorDisposer;
     }
 
+    // secondary command streams, created on first use
+    CommandStreamPool& getCommandStreamPool() noexcept;
+
     void* streamAlloc(size_t size, size_t alignment) noexcept;
 
     Epoch getEngineEpoch() const { return mEngineEpoch; }
@@ -416,7 +427,17 @@ public:
     }
 
     void prepare();
+
+    // Collects the components of the Entities destroyed since the last call, oldest first, for
+    // at most GC_TIME_BUDGET. Whatever is left is collected by the next call.
     void gc();
+    static constexpr std::chrono::microseconds GC_TIME_BUDGET{ 500 };
+    static constexpr size_t GC_BATCH_SIZE = 64;
+
+    // number of destroyed Entities whose components haven't been collected yet
+    size_t getPendingDestroyedEntityCount() const noexcept {
+        return mDestroyedEntities.size();
+    }
 
     using ShaderContent = utils::FixedCapacityVector<uint8_t>;
 
@@ -549,7 +570,9 @@ private:
     FTransformManager mTransformManager;
     FLightManager mLightManager;
     FCameraManager mCameraManager;
+    DestroyedEntityJournal mDestroyedEntities;
     std::shared_ptr<ResourceAllocatorDisposer> mResourceAllocatorDisposer;
+    std::unique_ptr<CommandStreamPool> mCommandStreamPool;
     HwVertexBufferInfoFactory mHwVertexBufferInfoFactory;
     HwDescriptorSetLayoutFactory mHwDescriptorSetLayoutFactory;
     DescriptorSetLayout mPerViewDescriptorSetLayoutDepthVariant;
@@ -569,6 +592,7 @@ private:
     ResourceList<FVertexBuffer> mVertexBuffers{ "VertexBuffer" };
     ResourceList<FIndirectLight> mIndirectLights{ "IndirectLight" };
     ResourceList<FMaterial> mMaterials{ "Material" };
+    ProgramManifest mProgramManifest;
     ResourceList<FTexture> mTextures{ "Texture" };
     ResourceList<FSkybox> mSkyboxes{ "Skybox" };
     ResourceList<FColorGrading> mColorGradings{ "ColorGrading" };
@@ -654,6 +678,9 @@ public:
         } shadowmap;
         struct {
             bool camera_at_origin = true;
+            // Renderables moved between visibility groups during the last frame, for all Views.
+            // This is an output.
+            int partition_moves = 0;
             struct {
                 float kp = 0.0f;
                 float ki = 0.0f;
@@ -666,10 +693,28 @@ public:
             bool doFrameCapture = false;
             bool disable_buffer_padding = false;
             bool disable_subpasses = false;
+            // Transient FrameGraph memory of the last frame in MiB, for the busiest View.
+            // These are outputs.
+            float transient_memory_total = 0.0f;    // without aliasing
+            float transient_memory_peak = 0.0f;     // alive at the same time
+            float transient_memory_aliased = 0.0f;  // with aliasing
+            // Draw calls removed by automatic instancing from the color passes of the last
+            // frame. This is an output.
+            int instanced_draw_calls_saved = 0;
         } renderer;
         struct {
             bool debug_froxel_visualization = false;
         } lighting;
+        struct {
+            // World transforms computed during the last frame. This is an output.
+            int world_transform_updates = 0;
+        } transform;
+        struct {
+            // Destroyed Entities whose components are still waiting to be collected, and
+            // components collected, at the end of the last frame. These are outputs.
+            int pending_entities = 0;
+            int collected_components = 0;
+        } gc;
         struct {
             bool combine_multiview_images = false;
         } stereo;
@@ -684,6 +729,23 @@ public:
             bool disable_parallel_shader_compile = false;
             bool disable_handle_use_after_free_check = false;
         } backend;
+        struct {
+            struct {
+                bool concurrent_pass_recording = false;
+            } frame_graph;
+            struct {
+                bool group_draws = false;
+            } automatic_instancing;
+            struct {
+                bool persistent_partitions = true;
+            } visibility;
+            struct {
+                bool upload_changes_only = true;
+            } renderable_ubo;
+            struct {
+                bool concurrent_view_prepare = false;
+            } renderer;
+        } engine;
     } features;
 
     std::array<Engine::FeatureFlag, sizeof(features)> const mFeatures{{
@@ -695,7 +757,24 @@ public:
               &features.backend.disable_handle_use_after_free_check, true },
             { "backend.opengl.assert_native_window_is_valid",
               "Asserts that the ANativeWindow is valid when rendering starts.",
-              &features.backend.opengl.assert_native_window_is_valid, true }
+              &features.backend.opengl.assert_native_window_is_valid, true },
+            { "engine.frame_graph.concurrent_pass_recording",
+              "Record independent FrameGraph passes concurrently.",
+              &features.engine.frame_graph.concurrent_pass_recording, false },
+            { "engine.automatic_instancing.group_draws",
+              "Make identical draws consecutive before automatic instancing, at the expense "
+              "of depth ordering in color passes.",
+              &features.engine.automatic_instancing.group_draws, false },
+            { "engine.visibility.persistent_partitions",
+              "Keep renderables in last frame's visibility order and only move those whose "
+              "visibility changed.",
+              &features.engine.visibility.persistent_partitions, false },
+            { "engine.renderable_ubo.upload_changes_only",
+              "Only upload the per-renderable uniforms that changed since the last frame.",
+              &features.engine.renderable_ubo.upload_changes_only, false },
+            { "engine.renderer.concurrent_view_prepare",
+              "Prepare the Views passed to Renderer::renderViews() concurrently.",
+              &features.engine.renderer.concurrent_view_prepare, false }
     }};
 
     utils::Slice<const Engine::FeatureFlag> getFeatureFlags() const noexcept {
@@ -83,10 +83,8 @@ void FInstanceBuffer::setLocalTransforms(
     memcpy(mLocalTransforms.data() + offset, localTransforms, sizeof(math::mat4f) * count);
 }
 
-void FInstanceBuffer::prepare(FEngine& engine, math::mat4f rootTransform,
+void FInstanceBuffer::prepare(DriverApi& driver, math::mat4f rootTransform,
         const PerRenderableData& ubo, Handle<HwBufferObject> handle) {
-    DriverApi& driver = engine.getDriverApi();
-
     // TODO: allocate this staging buffer from a pool.
     uint32_t stagingBufferSize = sizeof(PerRenderableUib);
     PerRenderableData* stagingBuffer = (PerRenderableData*)::malloc(stagingBufferSize);
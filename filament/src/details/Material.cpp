@@ -78,11 +78,9 @@ using namespace backend;
 using namespace filaflat;
 using namespace utils;
 
-static std::unique_ptr<MaterialParser> createParser(Backend backend,
-        utils::FixedCapacityVector<ShaderLanguage> languages, const void* data, size_t size) {
-    // unique_ptr so we don't leak MaterialParser on failures below
-    auto materialParser = std::make_unique<MaterialParser>(languages, data, size);
-
+static std::unique_ptr<MaterialParser> parseMaterial(Backend backend,
+        utils::FixedCapacityVector<ShaderLanguage> const& languages,
+        std::unique_ptr<MaterialParser> materialParser) {
     MaterialParser::ParseResult const materialResult = materialParser->parse();
 
     if (UTILS_UNLIKELY(materialResult == MaterialParser::ParseResult::ERROR_MISSING_BACKEND)) {
@@ -118,9 +116,27 @@ static std::unique_ptr<MaterialParser> createParser(Backend backend,
     return materialParser;
 }
 
+static std::unique_ptr<MaterialParser> createParser(Backend backend,
+        utils::FixedCapacityVector<ShaderLanguage> languages, const void* data, size_t size) {
+    // unique_ptr so we don't leak MaterialParser on failures below
+    auto materialParser = std::make_unique<MaterialParser>(languages, data, size);
+    return parseMaterial(backend, languages, std::move(materialParser));
+}
+
+static std::unique_ptr<MaterialParser> createParser(Backend backend,
+        utils::FixedCapacityVector<ShaderLanguage> languages, const void* data, size_t size,
+        MaterialParser::ReleaseCallback callback, void* user) {
+    // the package is released with the parser, including on failures below
+    auto materialParser = std::make_unique<MaterialParser>(languages, data, size, callback, user);
+    return parseMaterial(backend, languages, std::move(materialParser));
+}
+
 struct Material::BuilderDetails {
     const void* mPayload = nullptr;
     size_t mSize = 0;
+    bool mZeroCopy = false;
+    Material::Builder::PackageReleaseCallback mReleaseCallback = nullptr;
+    void* mReleaseUser = nullptr;
     bool mDefaultMaterial = false;
     int32_t mShBandsCount = 3;
     std::unordered_map<
@@ -144,6 +160,21 @@ BuilderType::Builder& BuilderType::Builder::operator=(BuilderType::Builder&& rhs
 Material::Builder& Material::Builder::package(const void* payload, size_t size) {
     mImpl->mPayload = payload;
     mImpl->mSize = size;
+    mImpl->mZeroCopy = false;
+    mImpl->mReleaseCallback = nullptr;
+    mImpl->mReleaseUser = nullptr;
+    return *this;
+}
+
+Material::Builder& Material::Builder::package(const void* payload, size_t size,
+        PackageReleaseCallback callback, void* user) {
+    FILAMENT_CHECK_PRECONDITION((uintptr_t(payload) % 8) == 0)
+            << "the material package must be 8-bytes aligned";
+    mImpl->mPayload = payload;
+    mImpl->mSize = size;
+    mImpl->mZeroCopy = true;
+    mImpl->mReleaseCallback = callback;
+    mImpl->mReleaseUser = user;
     return *this;
 }
 
@@ -164,9 +195,11 @@ template Material::Builder& Material::Builder::constant<float>(const char*, size
 template Material::Builder& Material::Builder::constant<bool>(const char*, size_t, bool);
 
 Material* Material::Builder::build(Engine& engine) {
-    std::unique_ptr<MaterialParser> materialParser = createParser(
-        downcast(engine).getBackend(), downcast(engine).getShaderLanguage(),
-        mImpl->mPayload, mImpl->mSize);
+    std::unique_ptr<MaterialParser> materialParser = mImpl->mZeroCopy ?
+        createParser(downcast(engine).getBackend(), downcast(engine).getShaderLanguage(),
+                mImpl->mPayload, mImpl->mSize, mImpl->mReleaseCallback, mImpl->mReleaseUser) :
+        createParser(downcast(engine).getBackend(), downcast(engine).getShaderLanguage(),
+                mImpl->mPayload, mImpl->mSize);
 
     if (!materialParser) {
         return nullptr;
@@ -334,6 +367,7 @@ FMaterial::FMaterial(FEngine& engine, const Material::Builder& builder,
     processPushConstants(engine, parser);
     processDescriptorSets(engine, parser);
     precacheDepthVariants(engine);
+    prepareManifestPrograms();
 
 #if FILAMENT_ENABLE_MATDBG
     // Register the material with matdbg.
@@ -488,9 +522,34 @@ bool FMaterial::hasVariant(Variant variant) const noexcept {
     return true;
 }
 
+void FMaterial::prepareManifestPrograms() const noexcept {
+    if (!mCacheId || !mEngine.getDriverApi().isParallelShaderCompileSupported()) {
+        return;
+    }
+    bool const isStereoSupported = mEngine.getDriverApi().isStereoSupported();
+    VariantList const variants = mEngine.getProgramManifest().getVariants(mCacheId);
+    variants.forEachSetBit([this, isStereoSupported](size_t key) {
+        Variant const variant{ Variant::type_t(key) };
+        // the manifest could come from an engine with a different configuration
+        if (Variant::isStereoVariant(variant) && !isStereoSupported) {
+            return;
+        }
+        if (mMaterialDomain == MaterialDomain::SURFACE && (Variant::isReserved(variant) ||
+                variant != Variant::filterVariant(variant, isVariantLit()))) {
+            return;
+        }
+        if (hasVariant(variant)) {
+            prepareProgram(variant, CompilerPriorityQueue::LOW);
+        }
+    });
+}
+
 void FMaterial::prepareProgramSlow(Variant variant,
         backend::CompilerPriorityQueue priorityQueue) const noexcept {
     assert_invariant(mEngine.hasFeatureLevel(mFeatureLevel));
+    if (mCacheId) {
+        mEngine.getProgramManifest().add(mCacheId, variant);
+    }
     switch (getMaterialDomain()) {
         case MaterialDomain::SURFACE:
             getSurfaceProgramSlow(variant, priorityQueue);
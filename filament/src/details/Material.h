@@ -148,6 +148,10 @@ public:
         }
     }
 
+    // Starts compiling the variants listed for this material in the engine's ProgramManifest,
+    // only if the backend can compile them in parallel.
+    void prepareManifestPrograms() const noexcept;
+
     // getProgram returns the backend program for the material's given variant.
     // Must be called after prepareProgram().
     [[nodiscard]] backend::Handle<backend::HwProgram> getProgram(Variant variant) const noexcept {
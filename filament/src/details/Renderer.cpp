@@ -17,6 +17,7 @@
 #include "details/Renderer.h"
 
 #include "Allocators.h"
+#include "CommandStreamPool.h"
 #include "DebugRegistry.h"
 #include "FrameHistory.h"
 #include "PostProcessManager.h"
@@ -24,6 +25,8 @@
 #include "RenderPass.h"
 #include "ResourceAllocator.h"
 
+#include "components/TransformManager.h"
+
 #include "details/Engine.h"
 #include "details/Fence.h"
 #include "details/Scene.h"
@@ -58,9 +61,12 @@
 #include <utils/Systrace.h>
 #include <utils/debug.h>
 
+#include <algorithm>
 #include <chrono>
 #include <limits>
 #include <memory>
+#include <optional>
+#include <random>
 #include <utility>
 
 #include <stddef.h>
@@ -102,6 +108,14 @@ FRenderer::FRenderer(FEngine& engine) :
             &engine.debug.renderer.disable_buffer_padding);
     debugRegistry.registerProperty("d.renderer.disable_subpasses",
             &engine.debug.renderer.disable_subpasses);
+    debugRegistry.registerProperty("d.renderer.transient_memory_total",
+            &engine.debug.renderer.transient_memory_total);
+    debugRegistry.registerProperty("d.renderer.transient_memory_peak",
+            &engine.debug.renderer.transient_memory_peak);
+    debugRegistry.registerProperty("d.renderer.transient_memory_aliased",
+            &engine.debug.renderer.transient_memory_aliased);
+    debugRegistry.registerProperty("d.renderer.instanced_draw_calls_saved",
+            &engine.debug.renderer.instanced_draw_calls_saved);
     debugRegistry.registerProperty("d.shadowmap.display_shadow_texture",
             &engine.debug.shadowmap.display_shadow_texture);
     debugRegistry.registerProperty("d.shadowmap.display_shadow_texture_scale",
@@ -308,6 +322,9 @@ bool FRenderer::beginFrame(FSwapChain* swapChain, uint64_t vsyncSteadyClockTimeN
 
     mFrameId++;
     mViewRenderedCount = 0;
+    mTransientMemoryStats = {};
+    mInstancedDrawCallsSaved = 0;
+    mPartitionMoves = 0;
 
     SYSTRACE_FRAME_ID(mFrameId);
 
@@ -418,6 +435,17 @@ void FRenderer::endFrame() {
     mFrameInfoManager.endFrame(driver);
     mFrameSkipper.endFrame(driver);
 
+    constexpr float MiB = 1.0f / float(1u << 20u);
+    engine.debug.renderer.transient_memory_total = float(mTransientMemoryStats.totalSize) * MiB;
+    engine.debug.renderer.transient_memory_peak = float(mTransientMemoryStats.peakSize) * MiB;
+    engine.debug.renderer.transient_memory_aliased = float(mTransientMemoryStats.heapSize) * MiB;
+    engine.debug.renderer.instanced_draw_calls_saved = int(mInstancedDrawCallsSaved);
+    engine.debug.view.partition_moves = int(mPartitionMoves);
+
+    FTransformManager& tcm = engine.getTransformManager();
+    engine.debug.transform.world_transform_updates = int(tcm.getWorldTransformUpdateCount());
+    tcm.resetWorldTransformUpdateCount();
+
     driver.endFrame(mFrameId);
 
     // gives the backend a chance to execute periodic tasks
@@ -581,6 +609,159 @@ void FRenderer::render(FView const* view) {
     }
 }
 
+struct FRenderer::ViewSetup {
+    bool hasPostProcess = false;
+    bool hasColorGrading = false;
+    bool hasFXAA = false;
+    bool isRenderingMultiview = false;
+    bool blendModeTranslucent = false;
+    bool needsAlphaChannel = false;
+    bool isProtectedContent = false;
+    bool scaled = false;
+    uint8_t msaaSampleCount = 1;
+    float temporalNoise = 0.0f;
+    float2 scale{ 1.0f };
+    MultiSampleAntiAliasingOptions msaaOptions;
+    DynamicResolutionOptions dsrOptions;
+    BloomOptions bloomOptions;
+    DepthOfFieldOptions dofOptions;
+    AmbientOcclusionOptions aoOptions;
+    TemporalAntiAliasingOptions taaOptions;
+    VignetteOptions vignetteOptions;
+    ScreenSpaceReflectionsOptions ssReflectionsOptions;
+    FColorGrading const* colorGrading = nullptr;
+    PostProcessManager::ColorGradingConfig colorGradingConfig;
+    filament::Viewport svp;
+    filament::Viewport xvp;
+    CameraInfo cameraInfo;
+};
+
+void FRenderer::renderViews(View const* const* views, size_t count) {
+    SYSTRACE_CALL();
+
+    if (UTILS_UNLIKELY(mBeginFrameInternal)) {
+        // see render()
+        mBeginFrameInternal();
+        mBeginFrameInternal = {};
+    }
+
+    // after beginFrame() is called, mSwapChain should be true
+    assert_invariant(mSwapChain);
+
+    FEngine& engine = mEngine;
+    JobSystem& js = engine.getJobSystem();
+    FEngine::DriverApi& driver = engine.getDriverApi();
+
+    // A View prepared concurrently records its driver commands in a secondary stream, which is
+    // spliced in the engine's CommandStream at a placeholder recorded in View order.
+    struct PreparedView {
+        FView* view;
+        ViewSetup setup;
+        bool visible;
+        std::optional<RootArenaScope> rootArenaScope;  // only set if prepared concurrently
+        backend::NoopCommand* jump = nullptr;
+        CommandStreamPool::Stream* stream = nullptr;
+    };
+
+    auto preparedViews = FixedCapacityVector<PreparedView>::with_capacity(count);
+    auto concurrentViews = FixedCapacityVector<PreparedView*>::with_capacity(count);
+
+    // Preparing a View sets the transform of its shadow cameras, which during a transform
+    // transaction only marks them dirty, in a list that isn't thread-safe.
+    bool const concurrent = engine.features.engine.renderer.concurrent_view_prepare &&
+            !engine.getTransformManager().isLocalTransformTransactionOpen();
+
+    for (size_t i = 0; i < count; i++) {
+        FView const* const view = downcast(views[i]);
+        if (UTILS_UNLIKELY(!view || !view->getScene() || !view->hasCamera())) {
+            continue;
+        }
+
+        FILAMENT_CHECK_PRECONDITION(!view->hasPostProcessPass() ||
+                                    engine.hasFeatureLevel(FeatureLevel::FEATURE_LEVEL_1))
+                        << "post-processing is not supported at FEATURE_LEVEL_0";
+
+        PreparedView& preparedView = preparedViews.emplace_back();
+        preparedView.view = const_cast<FView*>(view);
+        preparedView.visible = setupView(*preparedView.view, preparedView.setup);
+        if (!preparedView.visible) {
+            continue;
+        }
+
+        // Preparing a View writes the per-frame state of its Scene, so only the first View of
+        // each Scene is prepared concurrently, the others are prepared when they're rendered.
+        bool const isFirstOfScene = std::none_of(concurrentViews.begin(), concurrentViews.end(),
+                [scene = view->getScene()](PreparedView const* other) {
+                    return other->view->getScene() == scene;
+                });
+        if (concurrent && isFirstOfScene) {
+            size_t const arenaIndex = concurrentViews.size();
+            if (mViewArenas.size() <= arenaIndex) {
+                mViewArenas.push_back(std::make_unique<LinearAllocatorArena>(
+                        "FRenderer::mViewArenas", engine.getPerRenderPassArenaSize()));
+            }
+            preparedView.rootArenaScope.emplace(*mViewArenas[arenaIndex]);
+            // creating the shadow maps can't happen while other Views are prepared
+            preparedView.view->prepareShadowMaps(engine, driver);
+            preparedView.jump = driver.jump();
+            concurrentViews.push_back(&preparedView);
+        }
+    }
+
+    // create a root job so no other job can escape
+    auto* rootJob = js.setRootJob(js.createJob());
+
+    if (!concurrentViews.empty()) {
+        SYSTRACE_NAME("prepareViews");
+        CommandStreamPool& pool = engine.getCommandStreamPool();
+        float4 const userTime = getShaderUserTime();
+        auto work = [&](uint32_t const first, uint32_t const c) {
+            for (uint32_t i = first; i < first + c; i++) {
+                PreparedView& preparedView = *concurrentViews[i];
+                ViewSetup const& setup = preparedView.setup;
+                preparedView.stream = pool.acquire();
+                preparedView.view->prepare(engine, preparedView.stream->getDriverApi(),
+                        *preparedView.rootArenaScope, setup.svp, setup.cameraInfo,
+                        userTime, setup.temporalNoise, setup.needsAlphaChannel);
+                CommandStreamPool::splice(preparedView.jump, preparedView.stream);
+            }
+        };
+        auto* job = jobs::parallel_for(js, nullptr, 0u, uint32_t(concurrentViews.size()),
+                std::cref(work), jobs::CountSplitter<1>());
+        js.runAndWait(job);
+
+        for (PreparedView const* preparedView : concurrentViews) {
+            pool.recycle(driver, preparedView->stream);
+        }
+    }
+
+    for (PreparedView& preparedView : preparedViews) {
+        if (mViewRenderedCount) {
+            // see render()
+            driver.flush();
+        }
+
+        FView& view = *preparedView.view;
+        ViewSetup const& setup = preparedView.setup;
+        if (preparedView.rootArenaScope) {
+            renderPreparedView(*preparedView.rootArenaScope, view, setup);
+            preparedView.rootArenaScope.reset();
+        } else if (preparedView.visible) {
+            RootArenaScope rootArenaScope(engine.getPerRenderPassArena());
+            view.prepare(engine, driver, rootArenaScope, setup.svp, setup.cameraInfo,
+                    getShaderUserTime(), setup.temporalNoise, setup.needsAlphaChannel);
+            renderPreparedView(rootArenaScope, view, setup);
+        }
+
+        // make sure to flush the command buffer
+        engine.flush();
+        mViewRenderedCount++;
+    }
+
+    // and wait for all jobs to finish as a safety (this should be a no-op)
+    js.runAndWait(rootJob);
+}
+
 void FRenderer::renderInternal(FView const* view) {
     FEngine& engine = mEngine;
 
@@ -606,14 +787,18 @@ void FRenderer::renderInternal(FView const* view) {
 }
 
 void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
+    ViewSetup setup;
+    if (!setupView(view, setup)) {
+        return;
+    }
+    view.prepare(mEngine, mEngine.getDriverApi(), rootArenaScope, setup.svp, setup.cameraInfo,
+            getShaderUserTime(), setup.temporalNoise, setup.needsAlphaChannel);
+    renderPreparedView(rootArenaScope, view, setup);
+}
+
+bool FRenderer::setupView(FView& view, ViewSetup& setup) {
     FEngine& engine = mEngine;
-    JobSystem& js = engine.getJobSystem();
     FEngine::DriverApi& driver = engine.getDriverApi();
-    PostProcessManager& ppm = engine.getPostProcessManager();
-    ppm.setFrameUniforms(driver, view.getFrameUniforms());
-
-    // DEBUG: driver commands must all happen from the same thread. Enforce that on debug builds.
-    driver.debugThreading();
 
     bool hasPostProcess = view.hasPostProcessPass();
     bool hasScreenSpaceRefraction = false;
@@ -652,9 +837,7 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
         hasFXAA = false;
         scale = 1.0f;
     } else {
-        // This configures post-process materials by setting constant parameters
         if (taaOptions.enabled) {
-            ppm.configureTemporalAntiAliasingMaterial(taaOptions);
             if (taaOptions.upscaling) {
                 // for now TAA upscaling is incompatible with regular dsr
                 dsrOptions.enabled = false;
@@ -718,7 +901,7 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
             uint32_t(float(vp.height) * scale.y)
     };
     if (svp.empty()) {
-        return;
+        return false;
     }
 
     // xvp is the viewport relative to svp containing the "interesting" rendering
@@ -791,7 +974,80 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
         xvp.bottom = int32_t(guardBand);
     }
 
-    view.prepare(engine, driver, rootArenaScope, svp, cameraInfo, getShaderUserTime(), needsAlphaChannel);
+    // drawn here rather than in FView::prepare() which can run concurrently for several Views
+    std::uniform_real_distribution<float> uniformDistribution{ 0.0f, 1.0f };
+    float const temporalNoise = uniformDistribution(engine.getRandomEngine());
+
+    setup.hasPostProcess = hasPostProcess;
+    setup.hasColorGrading = hasColorGrading;
+    setup.hasFXAA = hasFXAA;
+    setup.isRenderingMultiview = isRenderingMultiview;
+    setup.blendModeTranslucent = blendModeTranslucent;
+    setup.needsAlphaChannel = needsAlphaChannel;
+    setup.isProtectedContent = isProtectedContent;
+    setup.scaled = scaled;
+    setup.msaaSampleCount = msaaSampleCount;
+    setup.temporalNoise = temporalNoise;
+    setup.scale = scale;
+    setup.msaaOptions = msaaOptions;
+    setup.dsrOptions = dsrOptions;
+    setup.bloomOptions = bloomOptions;
+    setup.dofOptions = dofOptions;
+    setup.aoOptions = aoOptions;
+    setup.taaOptions = taaOptions;
+    setup.vignetteOptions = vignetteOptions;
+    setup.ssReflectionsOptions = ssReflectionsOptions;
+    setup.colorGrading = colorGrading;
+    setup.colorGradingConfig = colorGradingConfig;
+    setup.svp = svp;
+    setup.xvp = xvp;
+    setup.cameraInfo = cameraInfo;
+    return true;
+}
+
+void FRenderer::renderPreparedView(RootArenaScope& rootArenaScope, FView& view,
+        ViewSetup const& setup) {
+    FEngine& engine = mEngine;
+    JobSystem& js = engine.getJobSystem();
+    FEngine::DriverApi& driver = engine.getDriverApi();
+    PostProcessManager& ppm = engine.getPostProcessManager();
+    ppm.setFrameUniforms(driver, view.getFrameUniforms());
+
+    // DEBUG: driver commands must all happen from the same thread. Enforce that on debug builds.
+    driver.debugThreading();
+
+    bool const hasPostProcess = setup.hasPostProcess;
+    bool hasScreenSpaceRefraction = false;
+    bool const hasColorGrading = setup.hasColorGrading;
+    bool const hasFXAA = setup.hasFXAA;
+    bool const isRenderingMultiview = setup.isRenderingMultiview;
+    bool const blendModeTranslucent = setup.blendModeTranslucent;
+    bool const needsAlphaChannel = setup.needsAlphaChannel;
+    bool const isProtectedContent = setup.isProtectedContent;
+    bool scaled = setup.scaled;
+    uint8_t const msaaSampleCount = setup.msaaSampleCount;
+    float2 scale = setup.scale;
+    auto msaaOptions = setup.msaaOptions;
+    auto dsrOptions = setup.dsrOptions;
+    auto bloomOptions = setup.bloomOptions;
+    auto dofOptions = setup.dofOptions;
+    auto aoOptions = setup.aoOptions;
+    auto taaOptions = setup.taaOptions;
+    auto vignetteOptions = setup.vignetteOptions;
+    auto ssReflectionsOptions = setup.ssReflectionsOptions;
+    auto const* const colorGrading = setup.colorGrading;
+    auto const& colorGradingConfig = setup.colorGradingConfig;
+    filament::Viewport const& vp = view.getViewport();
+    filament::Viewport svp = setup.svp;
+    filament::Viewport xvp = setup.xvp;
+    CameraInfo const& cameraInfo = setup.cameraInfo;
+
+    if (hasPostProcess && taaOptions.enabled) {
+        // This configures post-process materials by setting constant parameters
+        ppm.configureTemporalAntiAliasingMaterial(taaOptions);
+    }
+
+    mPartitionMoves += view.getPartitionMoveCount();
 
     view.prepareUpscaler(scale, taaOptions, dsrOptions);
 
@@ -1168,6 +1424,7 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
     }
 
     RenderPass const pass{ passBuilder.build(engine, driver) };
+    mInstancedDrawCallsSaved += pass.getDrawCallsSaved();
 
     FrameGraphTexture::Descriptor colorBufferDesc = {
             .width = config.physicalViewport.width,
@@ -1437,9 +1694,22 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
 
     fg.compile();
 
+    // Views are rendered one after the other, so the frame's transient memory is the max
+    TransientHeap::Stats const& transientMemoryStats = mResourceAllocator->getTransientMemoryStats();
+    mTransientMemoryStats.totalSize =
+            std::max(mTransientMemoryStats.totalSize, transientMemoryStats.totalSize);
+    mTransientMemoryStats.peakSize =
+            std::max(mTransientMemoryStats.peakSize, transientMemoryStats.peakSize);
+    mTransientMemoryStats.heapSize =
+            std::max(mTransientMemoryStats.heapSize, transientMemoryStats.heapSize);
+
     //fg.export_graphviz(slog.d, view.getName());
 
-    fg.execute(driver);
+    if (engine.features.engine.frame_graph.concurrent_pass_recording) {
+        fg.execute(driver, engine.getJobSystem(), engine.getCommandStreamPool());
+    } else {
+        fg.execute(driver);
+    }
 
     // save the current history entry and destroy the oldest entry
     view.commitFrameHistory(engine);
@@ -24,6 +24,7 @@
 #include "FrameSkipper.h"
 #include "PostProcessManager.h"
 #include "RenderPass.h"
+#include "TransientHeap.h"
 
 #include "details/SwapChain.h"
 
@@ -48,6 +49,7 @@
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include <stddef.h>
 #include <stdint.h>
@@ -103,6 +105,10 @@ public:
     // render a view. must be called between beginFrame/enfFrame.
     void render(FView const* view);
 
+    // render several views, preparing them concurrently. must be called between
+    // beginFrame/endFrame.
+    void renderViews(View const* const* views, size_t count);
+
     // read pixel from the current swapchain. must be called between beginFrame/enfFrame.
     void readPixels(uint32_t xoffset, uint32_t yoffset, uint32_t width, uint32_t height,
             backend::PixelBufferDescriptor&& buffer);
@@ -186,15 +192,28 @@ private:
         return mCommandsHighWatermark;
     }
 
+    // everything needed to render a View that is known before preparing it, see setupView()
+    struct ViewSetup;
+
     void renderInternal(FView const* view);
     void renderJob(RootArenaScope& rootArenaScope, FView& view);
 
+    // Computes the ViewSetup of a View, returns false if there is nothing to render.
+    bool setupView(FView& view, ViewSetup& setup);
+
+    // Renders a View once FView::prepare() has been called with `setup`.
+    void renderPreparedView(RootArenaScope& rootArenaScope, FView& view,
+            ViewSetup const& setup);
+
     // keep a reference to our engine
     FEngine& mEngine;
     FrameSkipper mFrameSkipper;
     backend::Handle<backend::HwRenderTarget> mRenderTargetHandle;
     FSwapChain* mSwapChain = nullptr;
     size_t mCommandsHighWatermark = 0;
+    TransientHeap::Stats mTransientMemoryStats;
+    uint32_t mInstancedDrawCallsSaved = 0;
+    uint32_t mPartitionMoves = 0;
     uint32_t mFrameId = 0;
     uint32_t mViewRenderedCount = 0;
     FrameInfoManager mFrameInfoManager;
@@ -213,6 +232,8 @@ private:
     std::function<void()> mBeginFrameInternal;
     uint64_t mVsyncSteadyClockTimeNano = 0;
     std::unique_ptr<ResourceAllocator> mResourceAllocator{};
+    // per-View arenas used by renderViews(), created on first use
+    std::vector<std::unique_ptr<LinearAllocatorArena>> mViewArenas;
 };
 
 FILAMENT_DOWNCAST(Renderer)
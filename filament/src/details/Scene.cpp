@@ -28,14 +28,26 @@
 
 #include "BufferPoolAllocator.h"
 
+#include <backend/BufferDescriptor.h>
+
 #include <utils/compiler.h>
 #include <utils/EntityManager.h>
+#include <utils/JobSystem.h>
 #include <utils/Range.h>
 #include <utils/Systrace.h>
 
 #include <math/quat.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include <stddef.h>
+#include <string.h>
 
 using namespace filament::backend;
 using namespace filament::math;
@@ -148,7 +160,25 @@ void FScene::prepare(utils::JobSystem& js,
 
     // TODO: the resize below could happen in a job
 
-    if (!sceneData.capacity() || sceneData.size() != renderableInstances.size()) {
+    bool const renderableDataIsValid =
+            sceneData.capacity() && sceneData.size() == renderableInstances.size();
+
+    /*
+     * With persistent partitions, each renderable is stored where FView left it at the end of
+     * the previous frame, and renderables added since then fill the free slots. Visibility
+     * rarely changes from one frame to the next, so the SoA is then mostly partitioned already.
+     * This is not done with hierarchical culling, because the BVH relies on renderables keeping
+     * their index.
+     */
+
+    uint32_t* renderableIndices = nullptr;
+    if (engine.features.engine.visibility.persistent_partitions && !mHierarchicalCulling &&
+            sceneData.size() && !renderableInstances.empty()) {
+        renderableIndices = computeRenderableIndices(localArenaScope,
+                { renderableInstances.data(), renderableInstances.size() });
+    }
+
+    if (!renderableDataIsValid) {
         sceneData.clear();
         if (sceneData.capacity() < renderableDataCapacity) {
             sceneData.setCapacity(renderableDataCapacity);
@@ -170,8 +200,9 @@ void FScene::prepare(utils::JobSystem& js,
      * Fill the SoA with the JobSystem
      */
 
-    auto renderableWork = [first = renderableInstances.data(), &rcm, &tcm, &worldTransform,
-                 &sceneData, shadowReceiversAreCasters](auto* p, auto c) {
+    auto renderableWork = [first = renderableInstances.data(), renderableIndices,
+                 &rcm, &tcm, &worldTransform, &sceneData, shadowReceiversAreCasters]
+                 (auto* p, auto c) {
         SYSTRACE_NAME("renderableWork");
 
         for (size_t i = 0; i < c; i++) {
@@ -197,7 +228,10 @@ void FScene::prepare(utils::JobSystem& js,
             float const scale = (length(transform[0].xyz) + length(transform[1].xyz) +
                                  length(transform[2].xyz)) / 3.0f;
 
-            size_t const index = std::distance(first, p) + i;
+            size_t index = std::distance(first, p) + i;
+            if (renderableIndices) {
+                index = renderableIndices[index];
+            }
             assert_invariant(index < sceneData.size());
 
             sceneData.elementAt<RENDERABLE_INSTANCE>(index) = ri;
@@ -213,6 +247,8 @@ void FScene::prepare(utils::JobSystem& js,
             sceneData.elementAt<WORLD_AABB_EXTENT>(index)   = worldAABB.halfExtent;
             //sceneData.elementAt<PRIMITIVES>(index)          = {}; // already initialized, Slice<>
             sceneData.elementAt<SUMMED_PRIMITIVE_COUNT>(index) = 0;
+            sceneData.elementAt<LODS>(index)                = rcm.getLevelsOfDetail(ri);
+            sceneData.elementAt<LOD_LEVEL>(index)           = 0;
             //sceneData.elementAt<UBO>(index)                 = {}; // not needed here
             sceneData.elementAt<USER_DATA>(index)           = scale;
         }
@@ -324,129 +360,324 @@ void FScene::prepare(utils::JobSystem& js,
     js.runAndWait(rootJob);
 
     SYSTRACE_NAME_END();
+
+    if (mHierarchicalCulling) {
+        // the world AABBs are recomputed every frame, refit the BVH to them
+        mCullingBvh.update(sceneData.data<WORLD_AABB_CENTER>(),
+                sceneData.data<WORLD_AABB_EXTENT>(), sceneData.size());
+    }
 }
 
-void FScene::prepareVisibleRenderables(Range<uint32_t> visibleRenderables) noexcept {
+uint32_t* FScene::computeRenderableIndices(ArenaScope<RootArenaScope::Arena>& arenaScope,
+        Slice<const std::pair<RenderableManager::Instance, TransformManager::Instance>>
+                renderableInstances) noexcept {
     SYSTRACE_CALL();
-    RenderableSoa& sceneData = mRenderableData;
-    FRenderableManager const& rcm = mEngine.getRenderableManager();
 
-    mHasContactShadows = false;
-    for (uint32_t const i : visibleRenderables) {
-        PerRenderableData& uboData = sceneData.elementAt<UBO>(i);
-
-        auto const visibility = sceneData.elementAt<VISIBILITY_STATE>(i);
-        auto const& model = sceneData.elementAt<WORLD_TRANSFORM>(i);
-        auto const ri = sceneData.elementAt<RENDERABLE_INSTANCE>(i);
-
-        // Using mat3f::getTransformForNormals handles non-uniform scaling, but DOESN'T guarantee that
-        // the transformed normals will have unit-length, therefore they need to be normalized
-        // in the shader (that's already the case anyway, since normalization is needed after
-        // interpolation).
-        //
-        // We pre-scale normals by the inverse of the largest scale factor to avoid
-        // large post-transform magnitudes in the shader, especially in the fragment shader, where
-        // we use medium precision.
-        //
-        // Note: if the model matrix is known to be a rigid-transform, we could just use it directly.
-
-        mat3f m = mat3f::getTransformForNormals(model.upperLeft());
-        m = prescaleForNormals(m);
-
-        // The shading normal must be flipped for mirror transformations.
-        // Basically we're shading the other side of the polygon and therefore need to negate the
-        // normal, similar to what we already do to support double-sided lighting.
-        if (visibility.reversedWindingOrder) {
-            m = -m;
-        }
+    constexpr uint32_t UNASSIGNED = std::numeric_limits<uint32_t>::max();
+    size_t const count = renderableInstances.size();
+    size_t const previousCount = mRenderableData.size();
+    RenderableManager::Instance const* const previous =
+            mRenderableData.data<RENDERABLE_INSTANCE>();
 
-        uboData.worldFromModelMatrix = model;
+    uint32_t maxInstance = 0;
+    for (size_t i = 0; i < previousCount; i++) {
+        maxInstance = std::max(maxInstance, uint32_t(previous[i]));
+    }
+    for (size_t i = 0; i < count; i++) {
+        maxInstance = std::max(maxInstance, uint32_t(renderableInstances[i].first));
+    }
 
-        uboData.worldFromModelNormalMatrix = m;
+    // If renderables were removed, the slots past the new count are gone and the renderables
+    // they held are handled like new ones.
+    auto& previousIndex = mPreviousRenderableIndex;
+    previousIndex.assign(maxInstance + 1, UNASSIGNED);
+    for (size_t i = 0, c = std::min(count, previousCount); i < c; i++) {
+        previousIndex[previous[i]] = uint32_t(i);
+    }
 
-        uboData.flagsChannels = PerRenderableData::packFlagsChannels(
-                visibility.skinning,
-                visibility.morphing,
-                visibility.screenSpaceContactShadows,
-                sceneData.elementAt<INSTANCES>(i).buffer != nullptr,
-                sceneData.elementAt<CHANNELS>(i));
+    bool* const assigned = arenaScope.allocate<bool>(count);
+    std::fill_n(assigned, count, false);
 
-        uboData.morphTargetCount = sceneData.elementAt<MORPHING_BUFFER>(i).count;
+    uint32_t* const indices = arenaScope.allocate<uint32_t>(count);
+    for (size_t i = 0; i < count; i++) {
+        RenderableManager::Instance const ri = renderableInstances[i].first;
+        uint32_t const index = previousIndex[ri];
+        if (index != UNASSIGNED) {
+            previousIndex[ri] = UNASSIGNED;
+            assigned[index] = true;
+        }
+        indices[i] = index;
+    }
 
-        uboData.objectId = rcm.getEntity(ri).getId();
+    // renderables which weren't there in the previous frame use the remaining indices
+    for (size_t i = 0, next = 0; i < count; i++) {
+        if (indices[i] == UNASSIGNED) {
+            while (assigned[next]) {
+                next++;
+            }
+            indices[i] = uint32_t(next++);
+        }
+    }
+    return indices;
+}
 
-        // TODO: We need to find a better way to provide the scale information per object
-        uboData.userData = sceneData.elementAt<USER_DATA>(i);
+PerRenderableData FScene::computePerRenderableData(uint32_t i) const noexcept {
+    RenderableSoa const& sceneData = mRenderableData;
+    FRenderableManager const& rcm = mEngine.getRenderableManager();
 
-        mHasContactShadows = mHasContactShadows || visibility.screenSpaceContactShadows;
+    auto const visibility = sceneData.elementAt<VISIBILITY_STATE>(i);
+    auto const& model = sceneData.elementAt<WORLD_TRANSFORM>(i);
+    auto const ri = sceneData.elementAt<RENDERABLE_INSTANCE>(i);
+
+    // Using mat3f::getTransformForNormals handles non-uniform scaling, but DOESN'T guarantee that
+    // the transformed normals will have unit-length, therefore they need to be normalized
+    // in the shader (that's already the case anyway, since normalization is needed after
+    // interpolation).
+    //
+    // We pre-scale normals by the inverse of the largest scale factor to avoid
+    // large post-transform magnitudes in the shader, especially in the fragment shader, where
+    // we use medium precision.
+    //
+    // Note: if the model matrix is known to be a rigid-transform, we could just use it directly.
+
+    mat3f m = mat3f::getTransformForNormals(model.upperLeft());
+    m = prescaleForNormals(m);
+
+    // The shading normal must be flipped for mirror transformations.
+    // Basically we're shading the other side of the polygon and therefore need to negate the
+    // normal, similar to what we already do to support double-sided lighting.
+    if (visibility.reversedWindingOrder) {
+        m = -m;
     }
+
+    // zero-initialized, so that the padding can be compared
+    PerRenderableData uboData{};
+
+    uboData.worldFromModelMatrix = model;
+
+    uboData.worldFromModelNormalMatrix = m;
+
+    uboData.flagsChannels = PerRenderableData::packFlagsChannels(
+            visibility.skinning,
+            visibility.morphing,
+            visibility.screenSpaceContactShadows,
+            sceneData.elementAt<INSTANCES>(i).buffer != nullptr,
+            sceneData.elementAt<CHANNELS>(i));
+
+    uboData.morphTargetCount = sceneData.elementAt<MORPHING_BUFFER>(i).count;
+
+    uboData.objectId = rcm.getEntity(ri).getId();
+
+    // TODO: We need to find a better way to provide the scale information per object
+    uboData.userData = sceneData.elementAt<USER_DATA>(i);
+
+    return uboData;
 }
 
-void FScene::updateUBOs(
+void FScene::updateUBOs(JobSystem& js, FEngine::DriverApi& driver,
         Range<uint32_t> visibleRenderables,
-        Handle<HwBufferObject> renderableUbh) noexcept {
+        Handle<HwBufferObject> renderableUbh, bool isNewBuffer) noexcept {
     SYSTRACE_CALL();
-    FEngine::DriverApi& driver = mEngine.getDriverApi();
-
-    // don't allocate more than 16 KiB directly into the render stream
-    static constexpr size_t MAX_STREAM_ALLOCATION_COUNT = 64;   // 16 KiB
-    const size_t count = visibleRenderables.size();
-    PerRenderableData* buffer = [&]{
-        if (count >= MAX_STREAM_ALLOCATION_COUNT) {
-            // use the heap allocator
-            auto& bufferPoolAllocator = mSharedState->mBufferPoolAllocator;
-            return (PerRenderableData*)bufferPoolAllocator.get(count * sizeof(PerRenderableData));
-        } else {
-            // allocate space into the command stream directly
-            return driver.allocatePod<PerRenderableData>(count);
+
+    mHasContactShadows = false;
+    mRenderablesWithBuffersCount = 0;
+    mUploadedRangeCount = 0;
+
+    // visible renderables always start at index 0, they're also their index in the UBO
+    assert_invariant(visibleRenderables.first == 0);
+    size_t const count = visibleRenderables.size();
+    if (!count) {
+        return;
+    }
+
+    // When renderableUbh holds what we uploaded last time, we only upload the slots whose data
+    // changed. Slots are compared with what was uploaded to them, not with the UBO column, whose
+    // rows are reordered by the View and shifted by scene changes.
+    bool const uploadChangesOnly = mEngine.features.engine.renderable_ubo.upload_changes_only &&
+            !isNewBuffer && renderableUbh == mUploadedRenderableUbh;
+    size_t const uploadedCount = uploadChangesOnly ? mUploadedRenderableCount : 0;
+
+    // When everything is uploaded, we write directly into the upload buffer.
+    PerRenderableData* const buffer = uploadChangesOnly ? nullptr : allocateUboBuffer(driver, count);
+
+    if (mRenderableUboChanged.size() < count) {
+        mRenderableUboChanged.resize(count);
+    }
+    if (mUploadedRenderableData.size() < count) {
+        mUploadedRenderableData.resize(count);
+    }
+    if (mRenderablesWithBuffers.size() < count) {
+        mRenderablesWithBuffers.resize(count);
+    }
+
+    RenderableSoa& sceneData = mRenderableData;
+    PerRenderableData* const uboData = sceneData.data<UBO>();
+    auto const* const visibilityData = sceneData.data<VISIBILITY_STATE>();
+    auto const* const skinningData = sceneData.data<SKINNING_BUFFER>();
+    auto const* const morphingData = sceneData.data<MORPHING_BUFFER>();
+    FRenderableManager::InstancesInfo const* instancesData = sceneData.data<INSTANCES>();
+    PerRenderableData* const uploaded = mUploadedRenderableData.data();
+    uint8_t* const changed = mRenderableUboChanged.data();
+    uint32_t* const withBuffers = mRenderablesWithBuffers.data();
+
+    std::atomic<bool> hasContactShadows{ false };
+    std::atomic<uint32_t> withBuffersCount{ 0 };
+
+    // Only the data we set is compared, the reserved fields are never written.
+    constexpr size_t COMPARED_SIZE = offsetof(PerRenderableData, reserved);
+
+    auto work = [&](uint32_t const first, uint32_t const c) {
+        bool contactShadows = false;
+        for (uint32_t i = first; i < first + c; i++) {
+            PerRenderableData const data = computePerRenderableData(i);
+            uboData[i] = data;
+            if (buffer) {
+                buffer[i] = data;
+                uploaded[i] = data;
+            } else {
+                bool const isChanged = i >= uploadedCount ||
+                        memcmp(&uploaded[i], &data, COMPARED_SIZE) != 0;
+                if (isChanged) {
+                    uploaded[i] = data;
+                }
+                changed[i] = isChanged;
+            }
+
+            contactShadows = contactShadows || visibilityData[i].screenSpaceContactShadows;
+
+            if (UTILS_UNLIKELY(skinningData[i].handle || morphingData[i].handle ||
+                    instancesData[i].handle)) {
+                withBuffers[withBuffersCount.fetch_add(1, std::memory_order_relaxed)] = i;
+            }
+        }
+        if (contactShadows) {
+            hasContactShadows.store(true, std::memory_order_relaxed);
         }
-    }();
+    };
+
+    auto* job = jobs::parallel_for(js, nullptr, 0, uint32_t(count),
+            std::cref(work), jobs::CountSplitter<64>());
+    js.runAndWait(job);
 
-    PerRenderableData const* const uboData = mRenderableData.data<UBO>();
-    mat4f const* const worldTransformData = mRenderableData.data<WORLD_TRANSFORM>();
+    mHasContactShadows = hasContactShadows.load(std::memory_order_relaxed);
+    mRenderablesWithBuffersCount = withBuffersCount.load(std::memory_order_relaxed);
 
     // prepare each InstanceBuffer.
-    FRenderableManager::InstancesInfo const* instancesData = mRenderableData.data<INSTANCES>();
-    for (uint32_t const i : visibleRenderables) {
+    mat4f const* const worldTransformData = sceneData.data<WORLD_TRANSFORM>();
+    for (uint32_t const i : getRenderablesWithBuffers()) {
         auto& instancesInfo = instancesData[i];
         if (UTILS_UNLIKELY(instancesInfo.buffer)) {
             instancesInfo.buffer->prepare(
-                    mEngine, worldTransformData[i], uboData[i], instancesInfo.handle);
+                    driver, worldTransformData[i], uboData[i], instancesInfo.handle);
         }
     }
 
-    // copy our data into the UBO for each visible renderable
-    for (uint32_t const i : visibleRenderables) {
-        buffer[i] = uboData[i];
+    mUploadedRenderableUbh = renderableUbh;
+    mUploadedRenderableCount = uint32_t(count);
+
+    if (buffer) {
+        uploadUboBuffer(driver, renderableUbh, buffer, count);
+        mUploadedRanges[0] = { 0, uint32_t(count) };
+        mUploadedRangeCount = 1;
+        return;
     }
 
-    // We capture state shared between Scene and the update buffer callback, because the Scene could
-    // be destroyed before the callback executes.
-    std::weak_ptr<SharedState>* const weakShared = new std::weak_ptr<SharedState>(mSharedState);
+    // Find the ranges of changed renderables. When there are too many, uploading everything
+    // with a single command is cheaper.
+    auto& ranges = mUploadedRanges;
+    size_t rangeCount = 0;
+    size_t changedCount = 0;
+    bool tooManyRanges = false;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!changed[i]) {
+            continue;
+        }
+        changedCount++;
+        if (rangeCount && ranges[rangeCount - 1].last == i) {
+            ranges[rangeCount - 1].last++;
+            continue;
+        }
+        if (rangeCount == MAX_UPLOAD_RANGE_COUNT) {
+            tooManyRanges = true;
+            break;
+        }
+        ranges[rangeCount++] = { i, i + 1 };
+    }
 
-    // update the UBO
-    driver.resetBufferObject(renderableUbh);
-    driver.updateBufferObjectUnsynchronized(renderableUbh, {
-            buffer, count * sizeof(PerRenderableData),
-            +[](void* p, size_t s, void* user) {
-                std::weak_ptr<SharedState>* const weakShared =
-                        static_cast<std::weak_ptr<SharedState>*>(user);
-                if (s >= MAX_STREAM_ALLOCATION_COUNT * sizeof(PerRenderableData)) {
-                    if (auto state = weakShared->lock()) {
-                        state->mBufferPoolAllocator.put(p);
+    if (tooManyRanges || changedCount > count / 2) {
+        PerRenderableData* const all = allocateUboBuffer(driver, count);
+        std::copy_n(uploaded, count, all);
+        uploadUboBuffer(driver, renderableUbh, all, count);
+        ranges[0] = { 0, uint32_t(count) };
+        mUploadedRangeCount = 1;
+        return;
+    }
+
+    // Pack the changed renderables in a single buffer and upload each range from it. Commands
+    // are executed in order, so the buffer is released after the last range is uploaded.
+    PerRenderableData* const changes = changedCount ? allocateUboBuffer(driver, changedCount) : nullptr;
+    size_t offset = 0;
+    for (size_t r = 0; r < rangeCount; r++) {
+        Range<uint32_t> const range = ranges[r];
+        std::copy_n(uploaded + range.first, range.size(), changes + offset);
+        BufferDescriptor bd = (r == rangeCount - 1) ?
+                makeUboBufferDescriptor(changes + offset, range.size(), changes, changedCount) :
+                BufferDescriptor{ changes + offset, range.size() * sizeof(PerRenderableData) };
+        // the buffer may still be in use by the GPU, so this must be synchronized
+        driver.updateBufferObject(renderableUbh, std::move(bd),
+                range.first * sizeof(PerRenderableData));
+        offset += range.size();
+    }
+    mUploadedRangeCount = rangeCount;
+}
+
+PerRenderableData* FScene::allocateUboBuffer(FEngine::DriverApi& driver,
+        size_t count) noexcept {
+    if (count >= MAX_STREAM_ALLOCATION_COUNT) {
+        // use the heap allocator
+        auto& bufferPoolAllocator = mSharedState->mBufferPoolAllocator;
+        return (PerRenderableData*)bufferPoolAllocator.get(count * sizeof(PerRenderableData));
+    }
+    // allocate space into the command stream directly
+    return driver.allocatePod<PerRenderableData>(count);
+}
+
+BufferDescriptor FScene::makeUboBufferDescriptor(PerRenderableData* data, size_t count,
+        PerRenderableData* allocation, size_t allocationCount) const noexcept {
+    struct Release {
+        // We capture state shared between Scene and the update buffer callback, because the
+        // Scene could be destroyed before the callback executes.
+        std::weak_ptr<SharedState> weakShared;
+        void* allocation;
+        bool pooled;
+    };
+    return {
+            data, count * sizeof(PerRenderableData),
+            +[](void*, size_t, void* user) {
+                Release* const release = static_cast<Release*>(user);
+                if (release->pooled) {
+                    if (auto state = release->weakShared.lock()) {
+                        state->mBufferPoolAllocator.put(release->allocation);
                     }
                 }
-                delete weakShared;
-            }, weakShared
-    }, 0);
+                delete release;
+            }, new Release{ mSharedState, allocation,
+                    allocationCount >= MAX_STREAM_ALLOCATION_COUNT }
+    };
+}
+
+void FScene::uploadUboBuffer(FEngine::DriverApi& driver, Handle<HwBufferObject> renderableUbh,
+        PerRenderableData* buffer, size_t count) noexcept {
+    driver.resetBufferObject(renderableUbh);
+    driver.updateBufferObjectUnsynchronized(renderableUbh,
+            makeUboBufferDescriptor(buffer, count, buffer, count), 0);
 }
 
 void FScene::terminate(FEngine&) {
 }
 
-void FScene::prepareDynamicLights(const CameraInfo& camera,
+void FScene::prepareDynamicLights(FEngine::DriverApi& driver, const CameraInfo& camera,
         Handle<HwBufferObject> lightUbh) noexcept {
-    FEngine::DriverApi& driver = mEngine.getDriverApi();
     FLightManager const& lcm = mEngine.getLightManager();
     FScene::LightSoa& lightData = getLightData();
 
@@ -527,16 +758,19 @@ inline void FScene::computeLightRanges(
 UTILS_NOINLINE
 void FScene::addEntity(Entity entity) {
     mEntities.insert(entity);
+    mCullingBvh.invalidate();
 }
 
 UTILS_NOINLINE
 void FScene::addEntities(const Entity* entities, size_t count) {
     mEntities.insert(entities, entities + count);
+    mCullingBvh.invalidate();
 }
 
 UTILS_NOINLINE
 void FScene::remove(Entity entity) {
     mEntities.erase(entity);
+    mCullingBvh.invalidate();
 }
 
 UTILS_NOINLINE
@@ -572,6 +806,13 @@ size_t FScene::getLightCount() const noexcept {
     return count;
 }
 
+void FScene::setHierarchicalCullingEnabled(bool enabled) noexcept {
+    mHierarchicalCulling = enabled;
+    if (!enabled) {
+        mCullingBvh.clear();
+    }
+}
+
 UTILS_NOINLINE
 bool FScene::hasEntity(Entity entity) const noexcept {
     return mEntities.find(entity) != mEntities.end();
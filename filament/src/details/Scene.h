@@ -21,6 +21,7 @@
 
 #include "Allocators.h"
 #include "Culler.h"
+#include "SceneBvh.h"
 
 #include "ds/DescriptorSet.h"
 
@@ -33,10 +34,15 @@
 #include <filament/Box.h>
 #include <filament/Scene.h>
 
+#include <backend/BufferDescriptor.h>
+#include <backend/DriverApiForward.h>
+#include <backend/Handle.h>
+
 #include <math/mathfwd.h>
 
 #include <utils/compiler.h>
 #include <utils/Entity.h>
+#include <utils/JobSystem.h>
 #include <utils/Slice.h>
 #include <utils/StructureOfArrays.h>
 #include <utils/Range.h>
@@ -46,7 +52,10 @@
 
 #include <tsl/robin_set.h>
 
+#include <array>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace filament {
 
@@ -77,9 +86,7 @@ public:
     void prepare(utils::JobSystem& js, RootArenaScope& rootArenaScope,
             math::mat4 const& worldTransform, bool shadowReceiversAreCasters) noexcept;
 
-    void prepareVisibleRenderables(utils::Range<uint32_t> visibleRenderables) noexcept;
-
-    void prepareDynamicLights(const CameraInfo& camera,
+    void prepareDynamicLights(backend::DriverApi& driver, const CameraInfo& camera,
             backend::Handle<backend::HwBufferObject> lightUbh) noexcept;
 
     /*
@@ -106,6 +113,8 @@ public:
         // These are temporaries and should be stored out of line
         PRIMITIVES,             //   8 | level-of-detail'ed primitives
         SUMMED_PRIMITIVE_COUNT, //   4 | summed visible primitive counts
+        LODS,                   //   8 | levels of detail, null if the renderable has only one
+        LOD_LEVEL,              //   1 | level of detail selected by the view
         UBO,                    // 128 |
         DESCRIPTOR_SET_HANDLE,
 
@@ -127,6 +136,8 @@ public:
             math::float3,                               // WORLD_AABB_EXTENT
             utils::Slice<FRenderPrimitive>,             // PRIMITIVES
             uint32_t,                                   // SUMMED_PRIMITIVE_COUNT
+            FRenderableManager::LevelsOfDetail*,        // LODS
+            uint8_t,                                    // LOD_LEVEL
             PerRenderableData,                          // UBO
             backend::DescriptorSetHandle,               // DESCRIPTOR_SET_HANDLE
             // FIXME: We need a better way to handle this
@@ -186,11 +197,33 @@ public:
     LightSoa const& getLightData() const noexcept { return mLightData; }
     LightSoa& getLightData() noexcept { return mLightData; }
 
-    void updateUBOs(utils::Range<uint32_t> visibleRenderables,
-            backend::Handle<backend::HwBufferObject> renderableUbh) noexcept;
+    // Computes the PerRenderableData of the visible renderables with the JobSystem and uploads
+    // it to renderableUbh. If renderableUbh is the buffer used by the previous call, only the
+    // renderables whose data changed are uploaded; isNewBuffer must be set when it was just
+    // (re)created. Also prepares the InstanceBuffers.
+    void updateUBOs(utils::JobSystem& js, backend::DriverApi& driver,
+            utils::Range<uint32_t> visibleRenderables,
+            backend::Handle<backend::HwBufferObject> renderableUbh, bool isNewBuffer) noexcept;
+
+    // UBO slot ranges uploaded by the last updateUBOs(), for stats and testing.
+    utils::Slice<const utils::Range<uint32_t>> getUploadedRanges() const noexcept {
+        return { mUploadedRanges.data(), mUploadedRangeCount };
+    }
+
+    // Visible renderables with skinning, morphing or an InstanceBuffer, as of the last
+    // updateUBOs(), in no particular order.
+    utils::Slice<const uint32_t> getRenderablesWithBuffers() const noexcept {
+        return { mRenderablesWithBuffers.data(), mRenderablesWithBuffersCount };
+    }
 
     bool hasContactShadows() const noexcept;
 
+    // Returns the BVH over the renderables' world AABBs, or nullptr if hierarchical culling is
+    // disabled. Only valid between prepare() and the partitioning of the RenderableSoa.
+    SceneBvh const* getCullingBvh() const noexcept {
+        return mHierarchicalCulling ? &mCullingBvh : nullptr;
+    }
+
 private:
     friend class Scene;
     void setSkybox(FSkybox* skybox) noexcept;
@@ -204,6 +237,29 @@ private:
     size_t getLightCount() const noexcept;
     bool hasEntity(utils::Entity entity) const noexcept;
     void forEach(utils::Invocable<void(utils::Entity)>&& functor) const noexcept;
+    void setHierarchicalCullingEnabled(bool enabled) noexcept;
+    bool isHierarchicalCullingEnabled() const noexcept { return mHierarchicalCulling; }
+
+    // Returns where each renderable is stored in mRenderableData, i.e. where it was at the end
+    // of the previous frame, or in a free slot for new renderables.
+    uint32_t* computeRenderableIndices(utils::ArenaScope<RootArenaScope::Arena>& arenaScope,
+            utils::Slice<const std::pair<RenderableManager::Instance,
+                    TransformManager::Instance>> renderableInstances) noexcept;
+
+    PerRenderableData computePerRenderableData(uint32_t i) const noexcept;
+
+    // UBO updates of fewer renderables are allocated directly in the command stream
+    static constexpr size_t MAX_STREAM_ALLOCATION_COUNT = 64;   // 16 KiB
+
+    PerRenderableData* allocateUboBuffer(backend::DriverApi& driver, size_t count) noexcept;
+
+    // Uploads `count` renderables from data, allocation is released once the upload is done
+    backend::BufferDescriptor makeUboBufferDescriptor(PerRenderableData* data, size_t count,
+            PerRenderableData* allocation, size_t allocationCount) const noexcept;
+
+    void uploadUboBuffer(backend::DriverApi& driver,
+            backend::Handle<backend::HwBufferObject> renderableUbh,
+            PerRenderableData* buffer, size_t count) noexcept;
 
     static inline void computeLightRanges(math::float2* zrange,
             CameraInfo const& camera, const math::float4* spheres, size_t count) noexcept;
@@ -230,6 +286,28 @@ private:
     LightSoa mLightData;
     bool mHasContactShadows = false;
 
+    // Buffer written by the last updateUBOs(), and what its slots [0, mUploadedRenderableCount)
+    // hold. Rows of mRenderableData move between frames, so the UBO column can't be used.
+    backend::Handle<backend::HwBufferObject> mUploadedRenderableUbh;
+    uint32_t mUploadedRenderableCount = 0;
+    std::vector<PerRenderableData> mUploadedRenderableData;
+    // Slot ranges uploaded by the last updateUBOs()
+    static constexpr size_t MAX_UPLOAD_RANGE_COUNT = 64;
+    std::array<utils::Range<uint32_t>, MAX_UPLOAD_RANGE_COUNT> mUploadedRanges;
+    size_t mUploadedRangeCount = 0;
+    // Scratch for updateUBOs(), whether each renderable's UBO data changed
+    std::vector<uint8_t> mRenderableUboChanged;
+    std::vector<uint32_t> mRenderablesWithBuffers;
+    uint32_t mRenderablesWithBuffersCount = 0;
+
+    // Scratch for prepare(), maps a renderable instance to its index in mRenderableData at the
+    // end of the previous frame.
+    std::vector<uint32_t> mPreviousRenderableIndex;
+
+    // BVH over WORLD_AABB_CENTER/WORLD_AABB_EXTENT, refit in prepare()
+    SceneBvh mCullingBvh;
+    bool mHierarchicalCulling = false;
+
     // State shared between Scene and driver callbacks.
     struct SharedState {
         BufferPoolAllocator<3> mBufferPoolAllocator = {};
@@ -48,7 +48,9 @@
 #include <math/scalar.h>
 #include <math/fast.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <memory>
 #include <tuple>
 
@@ -76,6 +78,8 @@ FView::FView(FEngine& engine)
 
     debugRegistry.registerProperty("d.view.camera_at_origin",
             &engine.debug.view.camera_at_origin);
+    debugRegistry.registerProperty("d.view.partition_moves",
+            &engine.debug.view.partition_moves);
 
     // The integral term is used to fight back the dead-band below, we limit how much it can act.
     mPidController.setIntegralLimits(-100.0f, 100.0f);
@@ -320,8 +324,15 @@ bool FView::isSkyboxVisible() const noexcept {
     return skybox != nullptr && (skybox->getLayerMask() & mVisibleLayers);
 }
 
-void FView::prepareShadowing(FEngine& engine, FScene::RenderableSoa& renderableData,
-        FScene::LightSoa const& lightData, CameraInfo const& cameraInfo) noexcept {
+void FView::prepareShadowMaps(FEngine& engine, DriverApi& driver) {
+    if (mShadowingEnabled) {
+        ShadowMapManager::createIfNeeded(engine, driver, mShadowMapManager);
+    }
+}
+
+void FView::prepareShadowing(FEngine& engine, DriverApi& driver,
+        FScene::RenderableSoa& renderableData, FScene::LightSoa const& lightData,
+        CameraInfo const& cameraInfo) noexcept {
     SYSTRACE_CALL();
 
     mHasShadowing = false;
@@ -384,8 +395,8 @@ void FView::prepareShadowing(FEngine& engine, FScene::RenderableSoa& renderableD
     }
 
     if (builder.hasShadowMaps()) {
-        ShadowMapManager::createIfNeeded(engine, mShadowMapManager);
-        auto shadowTechnique = mShadowMapManager->update(builder, engine, *this,
+        ShadowMapManager::createIfNeeded(engine, driver, mShadowMapManager);
+        auto shadowTechnique = mShadowMapManager->update(builder, engine, driver, *this,
                 cameraInfo, renderableData, lightData);
 
         mHasShadowing = any(shadowTechnique);
@@ -393,7 +404,8 @@ void FView::prepareShadowing(FEngine& engine, FScene::RenderableSoa& renderableD
     }
 }
 
-void FView::prepareLighting(FEngine& engine, CameraInfo const& cameraInfo) noexcept {
+void FView::prepareLighting(FEngine& engine, DriverApi& driver,
+        CameraInfo const& cameraInfo) noexcept {
     SYSTRACE_CALL();
     SYSTRACE_CONTEXT();
 
@@ -405,7 +417,7 @@ void FView::prepareLighting(FEngine& engine, CameraInfo const& cameraInfo) noexc
      */
 
     if (hasDynamicLighting()) {
-        scene->prepareDynamicLights(cameraInfo, mLightUbh);
+        scene->prepareDynamicLights(driver, cameraInfo, mLightUbh);
     }
 
     // here the array of visible lights has been shrunk to CONFIG_MAX_LIGHT_COUNT
@@ -480,7 +492,7 @@ CameraInfo FView::computeCameraInfo(FEngine& engine) const noexcept {
 
 void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootArenaScope,
         filament::Viewport viewport, CameraInfo cameraInfo,
-        float4 const& userTime, bool needsAlphaChannel) noexcept {
+        float4 const& userTime, float temporalNoise, bool needsAlphaChannel) noexcept {
 
         SYSTRACE_CALL();
         SYSTRACE_CONTEXT();
@@ -562,7 +574,7 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
          * (this will set the VISIBLE_RENDERABLE bit)
          */
 
-        prepareVisibleRenderables(js, cullingFrustum, renderableData);
+        prepareVisibleRenderables(js, *scene, cullingFrustum, renderableData);
 
 
         /*
@@ -607,7 +619,7 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
 
         setFroxelizerSync(froxelizeLightsJob);
 
-        prepareShadowing(engine, renderableData, lightData, cameraInfo);
+        prepareShadowing(engine, driver, renderableData, lightData, cameraInfo);
 
         /*
          * Partition the SoA so that renderables are partitioned w.r.t their visibility into the
@@ -626,6 +638,8 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
          *
          * This operation is somewhat heavy as it sorts the whole SoA. We use std::partition instead
          * of sort(), which gives us O(4.N) instead of O(N.log(N)) application of swap().
+         * With persistent partitions, the SoA is still partitioned from the previous frame and
+         * partitionIncremental() only swaps the renderables that changed group.
          */
 
         // TODO: we need to compare performance of doing this partitioning vs not doing it.
@@ -639,49 +653,73 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
         computeVisibilityMasks(getVisibleLayers(), layers, visibility, cullingMask.begin(),
                 renderableData.size());
 
-        auto const beginRenderables = renderableData.begin();
+        // end of each group, see above
+        std::array<uint32_t, 4> groupEnds;
+
+        if (engine.features.engine.visibility.persistent_partitions) {
+            // FScene::prepare() stored the renderables in the order we left them last frame,
+            // so only those which changed group are moved.
+            mPartitionMoveCount = partitionIncremental(renderableData, groupEnds);
+        } else {
+            mPartitionMoveCount = 0;
 
-        auto beginDirCasters = partition(beginRenderables, renderableData.end(),
-                VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE,
-                VISIBLE_RENDERABLE);
+            auto const beginRenderables = renderableData.begin();
 
-        auto beginDirCastersOnly = partition(beginDirCasters, renderableData.end(),
-                VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE,
-                VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE);
+            auto beginDirCasters = partition(beginRenderables, renderableData.end(),
+                    VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE,
+                    VISIBLE_RENDERABLE);
 
-        auto endDirCastersOnly = partition(beginDirCastersOnly, renderableData.end(),
-                VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE,
-                VISIBLE_DIR_SHADOW_RENDERABLE);
+            auto beginDirCastersOnly = partition(beginDirCasters, renderableData.end(),
+                    VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE,
+                    VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE);
+
+            auto endDirCastersOnly = partition(beginDirCastersOnly, renderableData.end(),
+                    VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE,
+                    VISIBLE_DIR_SHADOW_RENDERABLE);
+
+            auto endPotentialSpotCastersOnly = partition(endDirCastersOnly, renderableData.end(),
+                    VISIBLE_DYN_SHADOW_RENDERABLE,
+                    VISIBLE_DYN_SHADOW_RENDERABLE);
+
+            // convert to indices
+            groupEnds = {
+                    uint32_t(beginDirCasters - beginRenderables),
+                    uint32_t(beginDirCastersOnly - beginRenderables),
+                    uint32_t(endDirCastersOnly - beginRenderables),
+                    uint32_t(endPotentialSpotCastersOnly - beginRenderables) };
+        }
 
-        auto endPotentialSpotCastersOnly = partition(endDirCastersOnly, renderableData.end(),
-                VISIBLE_DYN_SHADOW_RENDERABLE,
-                VISIBLE_DYN_SHADOW_RENDERABLE);
+        uint32_t const beginDirCasters = groupEnds[0];
+        uint32_t const beginDirCastersOnly = groupEnds[1];
+        uint32_t const endDirCastersOnly = groupEnds[2];
+        uint32_t const endPotentialSpotCastersOnly = groupEnds[3];
 
-        // convert to indices
-        mVisibleRenderables = { 0, uint32_t(beginDirCastersOnly - beginRenderables) };
+        mVisibleRenderables = { 0, beginDirCastersOnly };
 
-        mVisibleDirectionalShadowCasters = {
-                uint32_t(beginDirCasters - beginRenderables),
-                uint32_t(endDirCastersOnly - beginRenderables)};
+        mVisibleDirectionalShadowCasters = { beginDirCasters, endDirCastersOnly };
 
-        merged = { 0, uint32_t(endPotentialSpotCastersOnly - beginRenderables) };
+        merged = { 0, endPotentialSpotCastersOnly };
         if (!needsShadowMap() || !mShadowMapManager->hasSpotShadows()) {
             // we know we don't have spot shadows, we can reduce the range to not even include
             // the potential spot casters
-            merged = { 0, uint32_t(endDirCastersOnly - beginRenderables) };
+            merged = { 0, endDirCastersOnly };
         }
 
         mSpotLightShadowCasters = merged;
 
         SYSTRACE_NAME_END();
 
+        // this must happen before the passes call updatePrimitivesLod()
+        selectLevelsOfDetail(renderableData, mLodOptions, cameraInfo, viewport, merged);
+        updateLodTriangleCounts(engine.getRenderableManager(), renderableData);
+
         // TODO: when any spotlight is used, `merged` ends-up being the whole list. However,
         //       some of the items will end-up not being visible by any light. Can we do better?
-        //       e.g. could we deffer some of the prepareVisibleRenderables() to later?
-        scene->prepareVisibleRenderables(merged);
+        //       e.g. could we deffer some of the UBO updates to later?
 
         // update those UBOs
         const size_t size = merged.size() * sizeof(PerRenderableData);
+        bool isNewBuffer = false;
         if (size) {
             if (mRenderableUBOSize < size) {
                 // allocate 1/3 extra, with a minimum of 16 objects
@@ -691,12 +729,16 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
                 mRenderableUbh = driver.createBufferObject(
                         mRenderableUBOSize + sizeof(PerRenderableUib),
                         BufferObjectBinding::UNIFORM, BufferUsage::DYNAMIC);
+                isNewBuffer = true;
             } else {
                 // TODO: should we shrink the underlying UBO at some point?
             }
             assert_invariant(mRenderableUbh);
-            scene->updateUBOs(merged, mRenderableUbh);
+        }
 
+        scene->updateUBOs(js, driver, merged, mRenderableUbh, isNewBuffer);
+
+        if (size) {
             mCommonRenderableDescriptorSet.setBuffer(
                     +PerRenderableBindingPoints::OBJECT_UNIFORMS, mRenderableUbh,
                     0, sizeof(PerRenderableUib));
@@ -709,54 +751,53 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
     { // this must happen after mRenderableUbh is created/updated
         // prepare skinning, morphing and hybrid instancing
         auto& sceneData = scene->getRenderableData();
-        for (uint32_t const i : merged) {
+
+        // most renderables use the shared descriptor-set
+        std::fill_n(sceneData.data<FScene::DESCRIPTOR_SET_HANDLE>() + merged.first,
+                merged.size(), mCommonRenderableDescriptorSet.getHandle());
+
+        for (uint32_t const i : scene->getRenderablesWithBuffers()) {
             auto const& skinning = sceneData.elementAt<FScene::SKINNING_BUFFER>(i);
             auto const& morphing = sceneData.elementAt<FScene::MORPHING_BUFFER>(i);
             auto const& instance = sceneData.elementAt<FScene::INSTANCES>(i);
 
             // FIXME: when only one is active the UBO handle of the other is null
             //        (probably a problem on vulkan)
-            if (UTILS_UNLIKELY(skinning.handle || morphing.handle || instance.handle)) {
-                auto const ci = sceneData.elementAt<FScene::RENDERABLE_INSTANCE>(i);
-                FRenderableManager& rcm = engine.getRenderableManager();
-                auto& descriptorSet = rcm.getDescriptorSet(ci);
-
-                // initialize the descriptor set the first time it's needed
-                if (UTILS_UNLIKELY(!descriptorSet.getHandle())) {
-                    descriptorSet = DescriptorSet{ engine.getPerRenderableDescriptorSetLayout() };
-                }
-
-                descriptorSet.setBuffer(+PerRenderableBindingPoints::OBJECT_UNIFORMS,
-                        instance.handle ? instance.handle : mRenderableUbh,
-                        0, sizeof(PerRenderableUib));
+            auto const ci = sceneData.elementAt<FScene::RENDERABLE_INSTANCE>(i);
+            FRenderableManager& rcm = engine.getRenderableManager();
+            auto& descriptorSet = rcm.getDescriptorSet(ci);
 
-                if (UTILS_UNLIKELY(skinning.handle || morphing.handle)) {
+            // initialize the descriptor set the first time it's needed
+            if (UTILS_UNLIKELY(!descriptorSet.getHandle())) {
+                descriptorSet = DescriptorSet{ engine.getPerRenderableDescriptorSetLayout() };
+            }
 
-                    descriptorSet.setBuffer(+PerRenderableBindingPoints::BONES_UNIFORMS,
-                            skinning.handle, 0, sizeof(PerRenderableBoneUib));
+            descriptorSet.setBuffer(+PerRenderableBindingPoints::OBJECT_UNIFORMS,
+                    instance.handle ? instance.handle : mRenderableUbh,
+                    0, sizeof(PerRenderableUib));
 
-                    descriptorSet.setSampler(+PerRenderableBindingPoints::BONES_INDICES_AND_WEIGHTS,
-                            skinning.boneIndicesAndWeightHandle, {});
+            if (UTILS_UNLIKELY(skinning.handle || morphing.handle)) {
 
-                    descriptorSet.setBuffer(+PerRenderableBindingPoints::MORPHING_UNIFORMS,
-                            morphing.handle, 0, sizeof(PerRenderableMorphingUib));
+                descriptorSet.setBuffer(+PerRenderableBindingPoints::BONES_UNIFORMS,
+                        skinning.handle, 0, sizeof(PerRenderableBoneUib));
 
-                    descriptorSet.setSampler(+PerRenderableBindingPoints::MORPH_TARGET_POSITIONS,
-                            morphing.morphTargetBuffer->getPositionsHandle(), {});
+                descriptorSet.setSampler(+PerRenderableBindingPoints::BONES_INDICES_AND_WEIGHTS,
+                        skinning.boneIndicesAndWeightHandle, {});
 
-                    descriptorSet.setSampler(+PerRenderableBindingPoints::MORPH_TARGET_TANGENTS,
-                            morphing.morphTargetBuffer->getTangentsHandle(), {});
-                }
+                descriptorSet.setBuffer(+PerRenderableBindingPoints::MORPHING_UNIFORMS,
+                        morphing.handle, 0, sizeof(PerRenderableMorphingUib));
 
-                descriptorSet.commit(engine.getPerRenderableDescriptorSetLayout(), driver);
+                descriptorSet.setSampler(+PerRenderableBindingPoints::MORPH_TARGET_POSITIONS,
+                        morphing.morphTargetBuffer->getPositionsHandle(), {});
 
-                // write the descriptor-set handle to the sceneData array for access later
-                sceneData.elementAt<FScene::DESCRIPTOR_SET_HANDLE>(i) = descriptorSet.getHandle();
-            } else {
-                // use the shared descriptor-set
-                sceneData.elementAt<FScene::DESCRIPTOR_SET_HANDLE>(i) =
-                        mCommonRenderableDescriptorSet.getHandle();
+                descriptorSet.setSampler(+PerRenderableBindingPoints::MORPH_TARGET_TANGENTS,
+                        morphing.morphTargetBuffer->getTangentsHandle(), {});
             }
+
+            descriptorSet.commit(engine.getPerRenderableDescriptorSetLayout(), driver);
+
+            // write the descriptor-set handle to the sceneData array for access later
+            sceneData.elementAt<FScene::DESCRIPTOR_SET_HANDLE>(i) = descriptorSet.getHandle();
         }
     }
 
@@ -766,7 +807,7 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
      * Relies on FScene::prepare() and prepareVisibleLights()
      */
 
-    prepareLighting(engine, cameraInfo);
+    prepareLighting(engine, driver, cameraInfo);
 
     /*
      * Update driver state
@@ -778,7 +819,7 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
     mColorPassDescriptorSet.prepareTime(engine, userTime);
     mColorPassDescriptorSet.prepareFog(engine, cameraInfo, fogTransform, mFogOptions,
             scene->getIndirectLight());
-    mColorPassDescriptorSet.prepareTemporalNoise(engine, mTemporalAntiAliasingOptions);
+    mColorPassDescriptorSet.prepareTemporalNoise(temporalNoise, mTemporalAntiAliasingOptions);
     mColorPassDescriptorSet.prepareBlending(needsAlphaChannel);
     mColorPassDescriptorSet.prepareMaterialGlobals(mMaterialGlobals);
 }
@@ -814,6 +855,67 @@ void FView::computeVisibilityMasks(
     }
 }
 
+/* static */ uint32_t FView::partitionIncremental(FScene::RenderableSoa& renderableData,
+        std::array<uint32_t, 4>& groupEnds) noexcept {
+    SYSTRACE_CALL();
+
+    constexpr size_t GROUP_COUNT = 5;
+    Culler::result_type const* const visibleMask = renderableData.data<FScene::VISIBLE_MASK>();
+
+    // the groups are in the order documented in prepare()
+    auto group = [visibleMask](size_t i) -> size_t {
+        Culler::result_type const mask = visibleMask[i];
+        switch (mask & (VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE)) {
+            case VISIBLE_RENDERABLE:
+                return 0;
+            case VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE:
+                return 1;
+            case VISIBLE_DIR_SHADOW_RENDERABLE:
+                return 2;
+            default:
+                return (mask & VISIBLE_DYN_SHADOW_RENDERABLE) ? 3 : 4;
+        }
+    };
+
+    size_t const count = renderableData.size();
+    std::array<uint32_t, GROUP_COUNT> sizes{};
+    for (size_t i = 0; i < count; i++) {
+        sizes[group(i)]++;
+    }
+
+    // next[g] is the first slot of group g that might not hold one of its renderables yet
+    std::array<uint32_t, GROUP_COUNT> next{};
+    std::array<uint32_t, GROUP_COUNT> end{};
+    for (size_t g = 0, offset = 0; g < GROUP_COUNT; g++) {
+        next[g] = uint32_t(offset);
+        offset += sizes[g];
+        end[g] = uint32_t(offset);
+    }
+
+    // Each swap puts at least one renderable in its final group, renderables already in their
+    // group are never moved. The two renderables of a swap count as moved.
+    uint32_t moved = 0;
+    auto const begin = renderableData.begin();
+    for (size_t g = 0; g < GROUP_COUNT - 1; g++) {
+        while (next[g] < end[g]) {
+            size_t const h = group(next[g]);
+            if (h == g) {
+                next[g]++;
+                continue;
+            }
+            while (group(next[h]) == h) {
+                next[h]++;
+            }
+            std::iter_swap(begin + next[g], begin + next[h]);
+            next[h]++;
+            moved += 2;
+        }
+    }
+
+    std::copy_n(end.begin(), groupEnds.size(), groupEnds.begin());
+    return moved;
+}
+
 UTILS_NOINLINE
 /* static */ FScene::RenderableSoa::iterator FView::partition(
         FScene::RenderableSoa::iterator begin,
@@ -923,18 +1025,18 @@ void FView::commitFroxels(DriverApi& driverApi) const noexcept {
 }
 
 UTILS_NOINLINE
-void FView::prepareVisibleRenderables(JobSystem& js,
+void FView::prepareVisibleRenderables(JobSystem& js, FScene const& scene,
         Frustum const& frustum, FScene::RenderableSoa& renderableData) const noexcept {
     SYSTRACE_CALL();
     if (UTILS_LIKELY(isFrustumCullingEnabled())) {
-        FView::cullRenderables(js, renderableData, frustum, VISIBLE_RENDERABLE_BIT);
+        FView::cullRenderables(js, scene, renderableData, frustum, VISIBLE_RENDERABLE_BIT);
     } else {
         std::uninitialized_fill(renderableData.begin<FScene::VISIBLE_MASK>(),
                   renderableData.end<FScene::VISIBLE_MASK>(), VISIBLE_RENDERABLE);
     }
 }
 
-void FView::cullRenderables(JobSystem&,
+void FView::cullRenderables(JobSystem&, FScene const& scene,
         FScene::RenderableSoa& renderableData, Frustum const& frustum, size_t bit) noexcept {
     SYSTRACE_CALL();
 
@@ -942,6 +1044,13 @@ void FView::cullRenderables(JobSystem&,
     float3 const* worldAABBExtent = renderableData.data<FScene::WORLD_AABB_EXTENT>();
     FScene::VisibleMaskType* visibleArray = renderableData.data<FScene::VISIBLE_MASK>();
 
+    if (SceneBvh const* const bvh = scene.getCullingBvh()) {
+        // the BVH indexes the renderables in the order FScene::prepare() stored them
+        assert_invariant(bvh->getPrimitiveCount() == renderableData.size());
+        bvh->intersects(visibleArray, frustum, worldAABBCenter, worldAABBExtent, bit);
+        return;
+    }
+
     // culling job (this runs on multiple threads)
     auto functor = [&frustum, worldAABBCenter, worldAABBExtent, visibleArray, bit]
             (uint32_t index, uint32_t c) {
@@ -1041,8 +1150,17 @@ void FView::prepareVisibleLights(FLightManager const& lcm,
 
         // skip directional light
         Zip2Iterator<FScene::LightSoa::iterator, float*> b = { lightData.begin(), distances };
-        std::sort(b + FScene::DIRECTIONAL_LIGHTS_COUNT, b + visibleLightCount,
-                [](auto const& lhs, auto const& rhs) { return lhs.second < rhs.second; });
+        auto const first = b + FScene::DIRECTIONAL_LIGHTS_COUNT;
+        auto last = b + visibleLightCount;
+        auto const closer = [](auto const& lhs, auto const& rhs) {
+            return lhs.second < rhs.second;
+        };
+        // With thousands of lights, select the ones we keep in linear time and only sort those.
+        if (positionalLightCount > CONFIG_MAX_LIGHT_COUNT) {
+            std::nth_element(first, first + CONFIG_MAX_LIGHT_COUNT, last, closer);
+            last = first + CONFIG_MAX_LIGHT_COUNT;
+        }
+        std::sort(first, last, closer);
     }
 
     // drop excess lights
@@ -1073,12 +1191,90 @@ void FView::updatePrimitivesLod(FScene::RenderableSoa& renderableData,
         FEngine const& engine, CameraInfo const&, Range visible) noexcept {
     FRenderableManager const& rcm = engine.getRenderableManager();
     for (uint32_t const index : visible) {
-        uint8_t const level = 0; // TODO: pick the proper level of detail
+        // the level was picked by selectLevelsOfDetail(), so that all passes agree
+        uint8_t const level = renderableData.elementAt<FScene::LOD_LEVEL>(index);
         auto ri = renderableData.elementAt<FScene::RENDERABLE_INSTANCE>(index);
         renderableData.elementAt<FScene::PRIMITIVES>(index) = rcm.getRenderPrimitives(ri, level);
     }
 }
 
+void FView::selectLevelsOfDetail(FScene::RenderableSoa& renderableData,
+        LodOptions const& options, CameraInfo const& camera, filament::Viewport const& viewport,
+        Range range) noexcept {
+    if (!options.enabled) {
+        // FScene::prepare() already reset all renderables to level 0
+        return;
+    }
+
+    SYSTRACE_CALL();
+
+    // size in pixels of a unit length at a distance of 1 (or at any distance when orthographic)
+    bool const perspective = camera.projection[2][3] != 0.0f;
+    float const pixelsPerUnit = 0.5f * float(viewport.height) * std::abs(camera.projection[1][1]);
+    float const threshold = options.maxScreenSpaceError;
+    float const coarserThreshold = threshold * (1.0f - saturate(options.hysteresis));
+
+    auto const* const lodsArray = renderableData.data<FScene::LODS>();
+    for (uint32_t const index : range) {
+        FRenderableManager::LevelsOfDetail* const lods = lodsArray[index];
+        if (UTILS_LIKELY(!lods)) {
+            continue;
+        }
+
+        // the errors are in object space, use the largest scale of the world transform
+        mat4f const& model = renderableData.elementAt<FScene::WORLD_TRANSFORM>(index);
+        float const scale = std::sqrt(std::max({
+                length2(model[0].xyz), length2(model[1].xyz), length2(model[2].xyz) }));
+
+        float pixelsPerError = pixelsPerUnit * scale;
+        if (perspective) {
+            // use the closest point of the bounding sphere
+            float3 const center = renderableData.elementAt<FScene::WORLD_AABB_CENTER>(index);
+            float3 const extent = renderableData.elementAt<FScene::WORLD_AABB_EXTENT>(index);
+            float const distance = length(center - camera.getPosition()) - length(extent);
+            pixelsPerError /= std::max(distance, camera.zn);
+        }
+
+        // errors grow with the level, find the coarsest level that is below the threshold
+        uint8_t level = lods->count - 1;
+        while (level && lods->errors[level] * pixelsPerError > threshold) {
+            level--;
+        }
+        // but only switch to a coarser level if it's below the threshold by some margin
+        uint8_t const current = lods->current.load(std::memory_order_relaxed);
+        while (level > current && lods->errors[level] * pixelsPerError > coarserThreshold) {
+            level--;
+        }
+        lods->current.store(level, std::memory_order_relaxed);
+        renderableData.elementAt<FScene::LOD_LEVEL>(index) = level;
+    }
+}
+
+void FView::updateLodTriangleCounts(FRenderableManager const& rcm,
+        FScene::RenderableSoa const& renderableData) noexcept {
+    mLodTriangleCounts.fill(0);
+    for (uint32_t const index : mVisibleRenderables) {
+        uint8_t const level = renderableData.elementAt<FScene::LOD_LEVEL>(index);
+        auto const ri = renderableData.elementAt<FScene::RENDERABLE_INSTANCE>(index);
+        size_t triangleCount = 0;
+        for (FRenderPrimitive const& primitive : rcm.getRenderPrimitives(ri, level)) {
+            uint32_t const indexCount = primitive.getIndexCount();
+            switch (primitive.getPrimitiveType()) {
+                case PrimitiveType::TRIANGLES:
+                    triangleCount += indexCount / 3;
+                    break;
+                case PrimitiveType::TRIANGLE_STRIP:
+                    triangleCount += indexCount > 2 ? indexCount - 2 : 0;
+                    break;
+                default:
+                    break;
+            }
+        }
+        mLodTriangleCounts[level] +=
+                triangleCount * renderableData.elementAt<FScene::INSTANCES>(index).count;
+    }
+}
+
 FrameGraphId<FrameGraphTexture> FView::renderShadowMaps(FEngine& engine, FrameGraph& fg,
         CameraInfo const& cameraInfo, float4 const& userTime,
         RenderPassBuilder const& passBuilder) noexcept {
@@ -1260,6 +1456,12 @@ void FView::setStereoscopicOptions(const StereoscopicOptions& options) noexcept
     mStereoscopicOptions = options;
 }
 
+void FView::setLodOptions(LodOptions const& options) noexcept {
+    mLodOptions = options;
+    mLodOptions.maxScreenSpaceError = std::max(0.0f, options.maxScreenSpaceError);
+    mLodOptions.hysteresis = saturate(options.hysteresis);
+}
+
 void FView::setMaterialGlobal(uint32_t index, float4 const& value) {
     FILAMENT_CHECK_PRECONDITION(index < 4)
             << "material global variable index (" << +index << ") out of range";
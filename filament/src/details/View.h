@@ -74,6 +74,8 @@ namespace utils {
 class JobSystem;
 } // namespace utils;
 
+class FroxelizerFixture;
+
 // Avoid warnings for using the deprecated APIs.
 #if defined(__clang__)
 #pragma clang diagnostic push
@@ -107,7 +109,7 @@ public:
     // keep references on them that would outlive the scope of prepare() (e.g. with JobSystem).
     void prepare(FEngine& engine, backend::DriverApi& driver, RootArenaScope& rootArenaScope,
             filament::Viewport viewport, CameraInfo cameraInfo,
-            math::float4 const& userTime, bool needsAlphaChannel) noexcept;
+            math::float4 const& userTime, float temporalNoise, bool needsAlphaChannel) noexcept;
 
     void setScene(FScene* scene) { mScene = scene; }
     FScene const* getScene() const noexcept { return mScene; }
@@ -160,9 +162,16 @@ public:
             const Viewport& physicalViewport,
             const filament::Viewport& logicalViewport) const noexcept;
 
-    void prepareShadowing(FEngine& engine, FScene::RenderableSoa& renderableData,
-            FScene::LightSoa const& lightData, CameraInfo const& cameraInfo) noexcept;
-    void prepareLighting(FEngine& engine, CameraInfo const& cameraInfo) noexcept;
+    // Creates the shadow maps if shadowing is enabled. prepare() does it when they're first
+    // needed, but this must be called on the main thread before the View is prepared
+    // concurrently with others, because it creates Camera components.
+    void prepareShadowMaps(FEngine& engine, backend::DriverApi& driver);
+
+    void prepareShadowing(FEngine& engine, backend::DriverApi& driver,
+            FScene::RenderableSoa& renderableData, FScene::LightSoa const& lightData,
+            CameraInfo const& cameraInfo) noexcept;
+    void prepareLighting(FEngine& engine, backend::DriverApi& driver,
+            CameraInfo const& cameraInfo) noexcept;
 
     void prepareSSAO(backend::Handle<backend::HwTexture> ssao) const noexcept;
     void prepareSSR(backend::Handle<backend::HwTexture> ssr, bool disableSSR,
@@ -208,6 +217,15 @@ public:
             FEngine const& engine, CameraInfo const& camera,
             Range visible) noexcept;
 
+    // Selects the level of detail of the renderables in range, from their screen-space error.
+    static void selectLevelsOfDetail(FScene::RenderableSoa& renderableData,
+            LodOptions const& options, CameraInfo const& camera, Viewport const& viewport,
+            Range range) noexcept;
+
+    // Counts the triangles drawn at each level of detail by the visible renderables.
+    void updateLodTriangleCounts(FRenderableManager const& rcm,
+            FScene::RenderableSoa const& renderableData) noexcept;
+
     void setShadowingEnabled(bool enabled) noexcept { mShadowingEnabled = enabled; }
 
     bool isShadowingEnabled() const noexcept { return mShadowingEnabled; }
@@ -224,6 +242,14 @@ public:
 
     void setStereoscopicOptions(StereoscopicOptions const& options) noexcept;
 
+    void setLodOptions(LodOptions const& options) noexcept;
+
+    LodOptions const& getLodOptions() const noexcept { return mLodOptions; }
+
+    size_t getLodTriangleCount(uint8_t level) const noexcept {
+        return level < mLodTriangleCounts.size() ? mLodTriangleCounts[level] : 0;
+    }
+
     utils::FixedCapacityVector<Camera const*> getDirectionalShadowCameras() const noexcept {
         if (!mShadowMapManager) return {};
         return mShadowMapManager->getDirectionalShadowCameras();
@@ -408,6 +434,9 @@ public:
         return mSpotLightShadowCasters;
     }
 
+    // Number of renderables moved between visibility groups by the last prepare()
+    uint32_t getPartitionMoveCount() const noexcept { return mPartitionMoveCount; }
+
     FCamera const& getCameraUser() const noexcept { return *mCullingCamera; }
     FCamera& getCameraUser() noexcept { return *mCullingCamera; }
     void setCameraUser(FCamera* camera) noexcept { setCullingCamera(camera); }
@@ -429,8 +458,9 @@ public:
         }
     }
 
-    static void cullRenderables(utils::JobSystem& js, FScene::RenderableSoa& renderableData,
-            Frustum const& frustum, size_t bit) noexcept;
+    // When the scene has a culling BVH, renderableData must not have been partitioned yet.
+    static void cullRenderables(utils::JobSystem& js, FScene const& scene,
+            FScene::RenderableSoa& renderableData, Frustum const& frustum, size_t bit) noexcept;
 
     ColorPassDescriptorSet& getColorPassDescriptorSet() noexcept { return mColorPassDescriptorSet; }
 
@@ -467,7 +497,17 @@ public:
         return mUniforms;
     }
 
+    // Partitions renderableData in the visibility groups described in prepare(), only moving
+    // the renderables that are not in their group already. This is fast when renderableData is
+    // still partitioned from the previous frame. groupEnds receives the end of the first four
+    // groups, the last one ends with renderableData. Returns the number of renderables moved.
+    static uint32_t partitionIncremental(FScene::RenderableSoa& renderableData,
+            std::array<uint32_t, 4>& groupEnds) noexcept;
+
 private:
+    // benchmark_froxelizer measures prepareVisibleLights()
+    friend class ::FroxelizerFixture;
+
     struct FPickingQuery : public PickingQuery {
     private:
         FPickingQuery(uint32_t x, uint32_t y,
@@ -494,9 +534,11 @@ private:
         PickingQueryResult result;
     };
 
-    void prepareVisibleRenderables(utils::JobSystem& js,
+    void prepareVisibleRenderables(utils::JobSystem& js, FScene const& scene,
             Frustum const& frustum, FScene::RenderableSoa& renderableData) const noexcept;
 
+    // Culls the lights, then keeps the CONFIG_MAX_LIGHT_COUNT closest ones sorted by distance.
+    // scratch must hold at least one float per light.
     static void prepareVisibleLights(FLightManager const& lcm,
             utils::Slice<float> scratch,
             math::mat4f const& viewMatrix, Frustum const& frustum,
@@ -559,6 +601,7 @@ private:
     ScreenSpaceReflectionsOptions mScreenSpaceReflectionsOptions;
     GuardBandOptions mGuardBandOptions;
     StereoscopicOptions mStereoscopicOptions;
+    LodOptions mLodOptions;
     BlendMode mBlendMode = BlendMode::OPAQUE;
     const FColorGrading* mColorGrading = nullptr;
     const FColorGrading* mDefaultColorGrading = nullptr;
@@ -585,6 +628,8 @@ private:
     Range mVisibleRenderables;
     Range mVisibleDirectionalShadowCasters;
     Range mSpotLightShadowCasters;
+    uint32_t mPartitionMoveCount = 0;
+    std::array<size_t, RenderableManager::Builder::MAX_LEVEL_COUNT> mLodTriangleCounts{};
     uint32_t mRenderableUBOSize = 0;
     mutable bool mHasDirectionalLighting = false;
     mutable bool mHasDynamicLighting = false;
@@ -54,7 +54,6 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
-#include <random>
 
 #include <stddef.h>
 #include <stdint.h>
@@ -217,12 +216,10 @@ void ColorPassDescriptorSet::prepareTime(FEngine& engine, math::float4 const& us
     s.userTime = userTime;
 }
 
-void ColorPassDescriptorSet::prepareTemporalNoise(FEngine& engine,
+void ColorPassDescriptorSet::prepareTemporalNoise(float noise,
         TemporalAntiAliasingOptions const& options) noexcept {
-    std::uniform_real_distribution<float> uniformDistribution{ 0.0f, 1.0f };
     auto& s = mUniforms.edit();
-    const float temporalNoise = uniformDistribution(engine.getRandomEngine());
-    s.temporalNoise = options.enabled ? temporalNoise : 0.0f;
+    s.temporalNoise = options.enabled ? noise : 0.0f;
 }
 
 void ColorPassDescriptorSet::prepareFog(FEngine& engine, const CameraInfo& cameraInfo,
@@ -106,7 +106,7 @@ public:
             const filament::Viewport& logicalViewport) noexcept;
 
     void prepareTime(FEngine& engine, math::float4 const& userTime) noexcept;
-    void prepareTemporalNoise(FEngine& engine, TemporalAntiAliasingOptions const& options) noexcept;
+    void prepareTemporalNoise(float noise, TemporalAntiAliasingOptions const& options) noexcept;
     void prepareExposure(float ev100) noexcept;
     void prepareFog(FEngine& engine, const CameraInfo& cameraInfo,
             math::mat4 const& fogTransform, FogOptions const& options,
@@ -36,9 +36,7 @@ namespace filament {
 using namespace backend;
 using namespace math;
 
-ShadowMapDescriptorSet::ShadowMapDescriptorSet(FEngine& engine) noexcept {
-    DriverApi& driver = engine.getDriverApi();
-
+ShadowMapDescriptorSet::ShadowMapDescriptorSet(FEngine& engine, DriverApi& driver) noexcept {
     mUniformBufferHandle = driver.createBufferObject(sizeof(PerViewUib),
             BufferObjectBinding::UNIFORM, BufferUsage::DYNAMIC);
 
@@ -51,7 +51,7 @@ public:
         Transaction() = default; // disallow creation by the caller
     };
 
-    explicit ShadowMapDescriptorSet(FEngine& engine) noexcept;
+    ShadowMapDescriptorSet(FEngine& engine, backend::DriverApi& driver) noexcept;
 
     void terminate(backend::DriverApi& driver);
 
@@ -24,7 +24,9 @@
 #include "FrameGraphPass.h"
 #include "FrameGraphRenderPass.h"
 #include "FrameGraphTexture.h"
+#include "CommandStreamPool.h"
 #include "ResourceAllocator.h"
+#include "TransientHeap.h"
 
 #include "details/Engine.h"
 
@@ -33,6 +35,7 @@
 
 #include <utils/compiler.h>
 #include <utils/debug.h>
+#include <utils/JobSystem.h>
 #include <utils/ostream.h>
 #include <utils/Panic.h>
 #include <utils/Systrace.h>
@@ -52,6 +55,10 @@ void FrameGraph::Builder::sideEffect() noexcept {
     mPassNode->makeTarget();
 }
 
+void FrameGraph::Builder::allowConcurrentExecution() noexcept {
+    mPassNode->setConcurrent();
+}
+
 const char* FrameGraph::Builder::getName(FrameGraphHandle handle) const noexcept {
     return mFrameGraph.getResource(handle)->name;
 }
@@ -190,10 +197,40 @@ FrameGraph& FrameGraph::compile() noexcept {
         pNode->resolveResourceUsage(dependencyGraph);
     }
 
+    /*
+     * Plan the memory of transient resources, i.e. resources created and destroyed by this
+     * FrameGraph. Node ids are allocated in declaration order, so they give the pass order.
+     * Note: resources are only detached during execute(), after this plan is made, so they're
+     * counted as transient here even though they outlive the FrameGraph.
+     * The list lives in the per-frame arena, the packing reuses the ResourceAllocator's memory.
+     */
+    Vector<TransientHeap::Allocation> transients(mArena);
+    for (VirtualResource const* resource : mResources) {
+        if (resource->refcount && resource->first &&
+                !resource->isImported() && !resource->isSubResource()) {
+            size_t const size = resource->getMemorySize();
+            if (size) {
+                transients.push_back({ size,
+                        resource->first->getId(), resource->last->getId(), 0 });
+            }
+        }
+    }
+    mResourceAllocator.planTransientResources(transients.data(), transients.size());
+
     return *this;
 }
 
 void FrameGraph::execute(backend::DriverApi& driver) noexcept {
+    executeInternal(driver, nullptr, nullptr);
+}
+
+void FrameGraph::execute(backend::DriverApi& driver,
+        utils::JobSystem& js, CommandStreamPool& pool) noexcept {
+    executeInternal(driver, &js, &pool);
+}
+
+void FrameGraph::executeInternal(backend::DriverApi& driver,
+        utils::JobSystem* js, CommandStreamPool* pool) noexcept {
 
     bool const useProtectedMemory = mMode == Mode::PROTECTED;
     auto const& passNodes = mPassNodes;
@@ -202,6 +239,51 @@ void FrameGraph::execute(backend::DriverApi& driver) noexcept {
     SYSTRACE_NAME("FrameGraph");
     driver.pushGroupMarker("FrameGraph");
 
+    auto destroyResources = [&resourceAllocator](PassNode* node) {
+        node->destroyPassResources();
+        for (VirtualResource* resource : node->destroy) {
+            assert_invariant(resource->last == node);
+            resource->destroy(resourceAllocator);
+        }
+    };
+
+    // Consecutive concurrent passes form a batch. A pass of the batch is given a placeholder
+    // in `driver` where its commands are spliced once it's been recorded on the JobSystem.
+    struct ConcurrentPass {
+        PassNode* node;
+        backend::NoopCommand* jump;
+        CommandStreamPool::Stream* stream;
+    };
+    Vector<ConcurrentPass> batch(mArena);
+
+    auto executeBatch = [&]() {
+        if (batch.empty()) {
+            return;
+        }
+
+        auto work = [this, &batch, pool](uint32_t start, uint32_t count) {
+            for (uint32_t i = start, e = start + count; i < e; i++) {
+                ConcurrentPass& pass = batch[i];
+                SYSTRACE_NAME(pass.node->getName());
+                pass.stream = pool->acquire();
+                FrameGraphResources const resources(*this, *pass.node);
+                pass.node->execute(resources, pass.stream->getDriverApi());
+                CommandStreamPool::splice(pass.jump, pass.stream);
+            }
+        };
+        auto* job = utils::jobs::parallel_for(*js, nullptr, 0u, uint32_t(batch.size()),
+                std::cref(work), utils::jobs::CountSplitter<1>());
+        js->runAndWait(job);
+
+        // Resources used by the batch's passes can only be destroyed now that they're recorded,
+        // because destroying them clears their handle.
+        for (auto const& pass : batch) {
+            pool->recycle(driver, pass.stream);
+            destroyResources(pass.node);
+        }
+        batch.clear();
+    };
+
     auto first = passNodes.begin();
     const auto activePassNodesEnd = mActivePassNodesEnd;
     while (first != activePassNodesEnd) {
@@ -209,6 +291,14 @@ void FrameGraph::execute(backend::DriverApi& driver) noexcept {
         first++;
         assert_invariant(!node->isCulled());
 
+        bool const concurrent = js && node->isConcurrent();
+        if (!concurrent) {
+            // The batch must be spliced before executing a regular pass, which could flush
+            // `driver`. Regular passes could also depend on the CPU side effects of previous
+            // passes.
+            executeBatch();
+        }
+
         SYSTRACE_NAME(node->getName());
         driver.pushGroupMarker(node->getName());
 
@@ -217,18 +307,21 @@ void FrameGraph::execute(backend::DriverApi& driver) noexcept {
             assert_invariant(resource->first == node);
             resource->devirtualize(resourceAllocator, useProtectedMemory);
         }
+        node->createPassResources();
 
-        // call execute
-        FrameGraphResources const resources(*this, *node);
-        node->execute(resources, driver);
+        if (concurrent) {
+            batch.push_back({ node, driver.jump(), nullptr });
+        } else {
+            // call execute
+            FrameGraphResources const resources(*this, *node);
+            node->execute(resources, driver);
 
-        // destroy concrete resources
-        for (VirtualResource* resource : node->destroy) {
-            assert_invariant(resource->last == node);
-            resource->destroy(resourceAllocator);
+            // destroy concrete resources
+            destroyResources(node);
         }
         driver.popGroupMarker();
     }
+    executeBatch();
     driver.popGroupMarker();
 }
 
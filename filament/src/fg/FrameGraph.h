@@ -36,8 +36,13 @@
 
 #include <functional>
 
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace filament {
 
+class CommandStreamPool;
 class ResourceAllocatorInterface;
 
 class FrameGraphPassExecutor;
@@ -154,6 +159,14 @@ public:
          */
         void sideEffect() noexcept;
 
+        /**
+         * Allows this pass' execute lambda to be called concurrently with other passes, from a
+         * JobSystem thread, when the FrameGraph is executed with a JobSystem. In that case the
+         * lambda must only issue commands through the DriverApi it's given and must not modify
+         * any state shared with other passes.
+         */
+        void allowConcurrentExecution() noexcept;
+
         /**
          * Retrieves the descriptor associated to a resource
          * @tparam RESOURCE Type of the resource
@@ -298,6 +311,18 @@ public:
      */
     void execute(backend::DriverApi& driver) noexcept;
 
+    /**
+     * Execute all referenced passes, consecutive passes that allow concurrent execution are
+     * recorded concurrently on the JobSystem into secondary command streams, which are then
+     * spliced into `driver` in graph order.
+     *
+     * @param driver    a reference to the backend to execute the commands
+     * @param js        the JobSystem to use for recording concurrent passes
+     * @param pool      where secondary command streams come from
+     */
+    void execute(backend::DriverApi& driver,
+            utils::JobSystem& js, CommandStreamPool& pool) noexcept;
+
     /**
      * Forwards a resource to another one which gets replaced.
      * The replaced resource's handle becomes forever invalid.
@@ -519,6 +544,9 @@ private:
 
     void destroyInternal() noexcept;
 
+    void executeInternal(backend::DriverApi& driver,
+            utils::JobSystem* js, CommandStreamPool* pool) noexcept;
+
     Blackboard mBlackboard;
     ResourceAllocatorInterface& mResourceAllocator;
     LinearAllocatorArena mArena;
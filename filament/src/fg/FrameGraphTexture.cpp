@@ -47,6 +47,11 @@ void FrameGraphTexture::destroy(ResourceAllocatorInterface& resourceAllocator) n
     }
 }
 
+size_t FrameGraphTexture::getMemorySize(Descriptor const& descriptor) noexcept {
+    return ResourceAllocator::getTextureSize(descriptor.format, descriptor.width,
+            descriptor.height, descriptor.depth, descriptor.levels, descriptor.samples);
+}
+
 FrameGraphTexture::Descriptor FrameGraphTexture::generateSubResourceDescriptor(
         Descriptor descriptor,
         SubResourceDescriptor const& srd) noexcept {
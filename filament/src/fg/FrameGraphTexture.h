@@ -22,6 +22,8 @@
 #include <backend/DriverEnums.h>
 #include <backend/Handle.h>
 
+#include <stddef.h>
+
 namespace filament {
 class ResourceAllocatorInterface;
 } // namespace::filament
@@ -37,6 +39,7 @@ namespace filament {
  *      void create(ResourceAllocatorInterface&, const char* name, Descriptor const&, Usage,
  *              bool useProtectedMemory) noexcept;
  *      void destroy(ResourceAllocatorInterface&) noexcept;
+ *      static size_t getMemorySize(Descriptor const&) noexcept;
  */
 struct FrameGraphTexture {
     backend::Handle<backend::HwTexture> handle;
@@ -87,6 +90,13 @@ struct FrameGraphTexture {
      */
     void destroy(ResourceAllocatorInterface& resourceAllocator) noexcept;
 
+    /**
+     * Estimates the memory used by a concrete resource
+     * @param descriptor Descriptor to the resource
+     * @return           size in bytes
+     */
+    static size_t getMemorySize(Descriptor const& descriptor) noexcept;
+
     /**
      * Generates the Descriptor for a subresource from its parent Descriptor and its
      * SubResourceDescriptor
@@ -58,8 +58,7 @@ RenderPassNode::RenderPassNode(FrameGraph& fg, const char* name, FrameGraphPassB
 RenderPassNode::RenderPassNode(RenderPassNode&& rhs) noexcept = default;
 RenderPassNode::~RenderPassNode() noexcept = default;
 
-void RenderPassNode::execute(FrameGraphResources const& resources, DriverApi& driver) noexcept {
-
+void RenderPassNode::createPassResources() noexcept {
     FrameGraph& fg = mFrameGraph;
     ResourceAllocatorInterface& resourceAllocator = fg.getResourceAllocator();
 
@@ -67,15 +66,21 @@ void RenderPassNode::execute(FrameGraphResources const& resources, DriverApi& dr
     for (auto& rt : mRenderTargetData) {
         rt.devirtualize(fg, resourceAllocator);
     }
+}
+
+void RenderPassNode::destroyPassResources() noexcept {
+    ResourceAllocatorInterface& resourceAllocator = mFrameGraph.getResourceAllocator();
 
-    mPassBase->execute(resources, driver);
-    
     // destroy the render targets
     for (auto& rt : mRenderTargetData) {
         rt.destroy(resourceAllocator);
     }
 }
 
+void RenderPassNode::execute(FrameGraphResources const& resources, DriverApi& driver) noexcept {
+    mPassBase->execute(resources, driver);
+}
+
 uint32_t RenderPassNode::declareRenderTarget(FrameGraph& fg, FrameGraph::Builder&,
         const char* name, FrameGraphRenderPass::Descriptor const& descriptor) {
 
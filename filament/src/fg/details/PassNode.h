@@ -54,12 +54,24 @@ public:
 
     void registerResource(FrameGraphHandle resourceHandle) noexcept;
 
+    // Creates and destroys the concrete resources owned by the pass itself (e.g. render
+    // targets). Always called from the thread calling FrameGraph::execute().
+    virtual void createPassResources() noexcept {}
+    virtual void destroyPassResources() noexcept {}
+
+    // execute() can be called from any thread if isConcurrent() is true
     virtual void execute(FrameGraphResources const& resources, backend::DriverApi& driver) noexcept = 0;
     virtual void resolve() noexcept = 0;
     utils::CString graphvizifyEdgeColor() const noexcept override;
 
+    void setConcurrent() noexcept { mConcurrent = true; }
+    bool isConcurrent() const noexcept { return mConcurrent; }
+
     Vector<VirtualResource*> devirtualize;         // resources we need to create before executing
     Vector<VirtualResource*> destroy;              // resources we need to destroy after executing
+
+private:
+    bool mConcurrent = false;
 };
 
 class RenderPassNode : public PassNode {
@@ -96,6 +108,8 @@ private:
     // virtuals from DependencyGraph::Node
     char const* getName() const noexcept override { return mName; }
     utils::CString graphvizify() const noexcept override;
+    void createPassResources() noexcept override;
+    void destroyPassResources() noexcept override;
     void execute(FrameGraphResources const& resources, backend::DriverApi& driver) noexcept override;
     void resolve() noexcept override;
 
@@ -97,6 +97,9 @@ public:
 
     virtual bool isImported() const noexcept { return false; }
 
+    /* Size in bytes of the concrete resource, or 0 if unknown */
+    virtual size_t getMemorySize() const noexcept { return 0; }
+
     // this is to workaround our lack of RTTI -- otherwise we could use dynamic_cast
     virtual ImportedRenderTarget* asImportedRenderTarget() noexcept { return nullptr; }
 
@@ -247,6 +250,10 @@ protected:
         resource.destroy(resourceAllocator);
     }
 
+    size_t getMemorySize() const noexcept override {
+        return RESOURCE::getMemorySize(descriptor);
+    }
+
     utils::CString usageString() const noexcept override {
         return utils::to_string(usage);
     }
@@ -16,6 +16,7 @@
 
 #include <gtest/gtest.h>
 
+#include "CommandStreamPool.h"
 #include "ResourceAllocator.h"
 
 #include <backend/Platform.h>
@@ -29,6 +30,10 @@
 
 #include "details/Texture.h"
 
+#include <utils/JobSystem.h>
+
+#include <vector>
+
 using namespace filament;
 using namespace backend;
 
@@ -77,12 +82,16 @@ protected:
 
     void TearDown() override {
         //fg.export_graphviz(utils::slog.d);
+        driver->terminate();
+        delete driver;
+        PlatformFactory::destroy(&platform);
     }
 
     Backend backend = Backend::NOOP;
     CircularBuffer buffer = CircularBuffer{ 8192 };
     Platform* platform = PlatformFactory::create(&backend);
-    CommandStream driverApi = CommandStream{ *platform->createDriver(nullptr, {}), buffer };
+    Driver* driver = platform->createDriver(nullptr, {});
+    CommandStream driverApi = CommandStream{ *driver, buffer };
     MockResourceAllocator resourceAllocator;
     FrameGraph fg{resourceAllocator};
 };
@@ -951,3 +960,70 @@ TEST_F(FrameGraphTest, WriteResourceReadAsAttachment) {
 
     fg.execute(driverApi);
 }
+
+TEST_F(FrameGraphTest, ConcurrentExecution) {
+    utils::JobSystem js;
+    js.adopt();
+    CommandStreamPool pool{ *driver, 65536 };
+
+    struct PassData {
+        FrameGraphId<FrameGraphTexture> input;
+        FrameGraphId<FrameGraphTexture> output;
+    };
+
+    std::vector<char const*> order;
+    auto record = [&order](DriverApi& driver, char const* name) {
+        driver.queueCommand([&order, name]() { order.push_back(name); });
+    };
+
+    auto& first = fg.addPass<PassData>("First", [&](FrameGraph::Builder& builder, auto& data) {
+                data.output = builder.create<FrameGraphTexture>("First output", {.width=16, .height=32});
+                data.output = builder.write(data.output, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+            },
+            [=, &driverApi = driverApi](FrameGraphResources const&, auto const&, DriverApi& driver) {
+                EXPECT_EQ(&driver, &driverApi);
+                record(driver, "First");
+            });
+
+    for (char const* name : { "Concurrent 0", "Concurrent 1", "Concurrent 2" }) {
+        fg.addPass<PassData>(name, [&](FrameGraph::Builder& builder, auto& data) {
+                    data.input = builder.sample(first->output);
+                    data.output = builder.create<FrameGraphTexture>("Output", {.width=16, .height=32});
+                    data.output = builder.declareRenderPass(data.output);
+                    builder.sideEffect();
+                    builder.allowConcurrentExecution();
+                },
+                [=, &driverApi = driverApi](FrameGraphResources const& resources, auto const& data,
+                        DriverApi& driver) {
+                    EXPECT_NE(&driver, &driverApi);
+                    EXPECT_TRUE(resources.getTexture(data.input));
+                    EXPECT_TRUE(resources.getTexture(data.output));
+                    EXPECT_TRUE(resources.getRenderPassInfo().target);
+                    record(driver, name);
+                });
+    }
+
+    fg.addPass<PassData>("Last", [&](FrameGraph::Builder& builder, auto& data) {
+                data.input = builder.sample(first->output);
+                builder.sideEffect();
+            },
+            [=](FrameGraphResources const&, auto const&, DriverApi& driver) {
+                record(driver, "Last");
+            });
+
+    fg.compile();
+    fg.execute(driverApi, js, pool);
+
+    // terminate and execute the command stream, this also recycles the secondary streams
+    new(buffer.allocate(sizeof(NoopCommand))) NoopCommand(nullptr);
+    driverApi.execute(buffer.getBuffer().tail);
+
+    ASSERT_EQ(order.size(), 5);
+    EXPECT_STREQ(order[0], "First");
+    EXPECT_STREQ(order[1], "Concurrent 0");
+    EXPECT_STREQ(order[2], "Concurrent 1");
+    EXPECT_STREQ(order[3], "Concurrent 2");
+    EXPECT_STREQ(order[4], "Last");
+
+    js.emancipate();
+}
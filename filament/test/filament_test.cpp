@@ -14,8 +14,12 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <random>
+#include <thread>
 
 #include <gtest/gtest.h>
 
@@ -31,16 +35,36 @@
 #include <filament/Frustum.h>
 #include <filament/Material.h>
 #include <filament/Engine.h>
+#include <filament/IndexBuffer.h>
+#include <filament/RenderableManager.h>
+#include <filament/Renderer.h>
+#include <filament/Scene.h>
+#include <filament/VertexBuffer.h>
+#include <filament/View.h>
 
 #include <private/filament/BufferInterfaceBlock.h>
 #include <private/filament/UibStructs.h>
 #include <private/backend/BackendUtils.h>
+#include <private/backend/CircularBuffer.h>
+#include <private/backend/CommandBufferQueue.h>
+
+#include <utils/JobSystem.h>
 
 #include "Allocators.h"
+#include "Culler.h"
+#include "DestroyedEntityJournal.h"
 #include "details/Material.h"
 #include "details/Camera.h"
 #include "Froxelizer.h"
+#include "ProgramManifest.h"
+#include "RadixSort.h"
+#include "RenderPass.h"
+#include "SceneBvh.h"
+#include "ShadowMapManager.h"
+#include "TransientHeap.h"
 #include "details/Engine.h"
+#include "details/View.h"
+#include "components/LightManager.h"
 #include "components/RenderableManager.h"
 #include "components/TransformManager.h"
 #include "UniformBuffer.h"
@@ -300,6 +324,62 @@ TEST(FilamentTest, TransformManager) {
     EXPECT_EQ(c, tcm.getChildCount(newParent));
 }
 
+TEST(FilamentTest, TransformManagerIncremental) {
+    JobSystem js;
+    js.adopt();
+    {
+        filament::FTransformManager tcm(&js);
+        EntityManager& em = EntityManager::get();
+
+        // 50 roots with 40 children each, which have 2 children each
+        constexpr size_t ROOTS = 50, CHILDREN = 40, GRAND_CHILDREN = 2;
+        std::vector<Entity> roots(ROOTS);
+        std::vector<Entity> children(ROOTS * CHILDREN);
+        std::vector<Entity> grandChildren(ROOTS * CHILDREN * GRAND_CHILDREN);
+        em.create(roots.size(), roots.data());
+        em.create(children.size(), children.data());
+        em.create(grandChildren.size(), grandChildren.data());
+        auto const translation = [](size_t i) {
+            return mat4f::translation(float3{ float(i % 7), float(i % 5), 1 });
+        };
+        for (size_t i = 0; i < roots.size(); i++) {
+            tcm.create(roots[i], {}, translation(i));
+        }
+        for (size_t i = 0; i < children.size(); i++) {
+            tcm.create(children[i], tcm.getInstance(roots[i / CHILDREN]), translation(i));
+        }
+        for (size_t i = 0; i < grandChildren.size(); i++) {
+            tcm.create(grandChildren[i], tcm.getInstance(children[i / GRAND_CHILDREN]),
+                    translation(i));
+        }
+
+        // modify a few subtrees, including nested ones
+        tcm.resetWorldTransformUpdateCount();
+        tcm.openLocalTransformTransaction();
+        for (size_t i = 0; i < 30; i++) {
+            tcm.setTransform(tcm.getInstance(roots[i]), mat4f::scaling(float3{ 2 }));
+        }
+        tcm.setTransform(tcm.getInstance(children[0]), mat4f::scaling(float3{ 4 }));
+        tcm.setTransform(tcm.getInstance(grandChildren[40 * CHILDREN * GRAND_CHILDREN]),
+                mat4f::scaling(float3{ 8 }));
+        EXPECT_EQ(tcm.getWorldTransformUpdateCount(), 0);
+        tcm.commitLocalTransformTransaction();
+
+        // only the dirty subtrees have been updated
+        EXPECT_EQ(tcm.getWorldTransformUpdateCount(),
+                30 * (1 + CHILDREN + CHILDREN * GRAND_CHILDREN) + 1);
+
+        for (Entity const e : grandChildren) {
+            auto const gi = tcm.getInstance(e);
+            auto const ci = tcm.getInstance(tcm.getParent(gi));
+            auto const ri = tcm.getInstance(tcm.getParent(ci));
+            EXPECT_EQ(tcm.getWorldTransform(gi),
+                    tcm.getTransform(ri) * tcm.getTransform(ci) * tcm.getTransform(gi));
+        }
+    }
+    js.emancipate();
+}
+
 TEST(FilamentTest, UniformInterfaceBlock) {
 
     BufferInterfaceBlock::Builder b;
@@ -612,6 +692,880 @@ TEST(FilamentTest, SphereCulling) {
     EXPECT_TRUE(frustum.intersects({ 0, 200 }));
 }
 
+TEST(FilamentTest, CullingIsa) {
+    Frustum const frustum(mat4f::perspective(45.0f, 1.0f, 0.1f, 100.0f));
+
+    std::default_random_engine gen; // NOLINT
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> size(0.1f, 25.0f);
+
+    constexpr size_t count = 1000;
+    size_t const capacity = Culler::round(count);
+    std::vector<float3> centers(capacity);
+    std::vector<float3> extents(capacity);
+    std::vector<float4> spheres(capacity);
+    for (size_t i = 0; i < capacity; i++) {
+        centers[i] = { position(gen), position(gen), position(gen) };
+        extents[i] = { size(gen), size(gen), size(gen) };
+        spheres[i] = { centers[i], size(gen) };
+    }
+
+    std::vector<Culler::result_type> expectedBoxes(capacity);
+    std::vector<Culler::result_type> expectedSpheres(capacity);
+    Culler::Test::intersects(expectedBoxes.data(), frustum,
+            centers.data(), extents.data(), count);
+    Culler::Test::intersects(expectedSpheres.data(), frustum, spheres.data(), count);
+
+    // The compiler may contract the scalar implementation into FMAs, so the kernels can only
+    // be expected to agree with it for items that aren't within rounding error of a plane.
+    float4 const* const planes = frustum.getNormalizedPlanes();
+    auto isOnPlane = [planes](float3 center, float3 extent, float radius) {
+        double maxDistance = -std::numeric_limits<double>::infinity();
+        double magnitude = 0.0;
+        for (size_t j = 0; j < 6; j++) {
+            double3 const n = planes[j].xyz;
+            double3 const c = center;
+            double3 const e = extent;
+            double const distance = dot(n, c) - dot(abs(n), e) + planes[j].w - radius;
+            maxDistance = std::max(maxDistance, distance);
+            magnitude = std::max(magnitude,
+                    dot(abs(n), abs(c) + e) + std::abs(planes[j].w) + radius);
+        }
+        return std::abs(maxDistance) <= 1e-5 * magnitude;
+    };
+
+    EXPECT_TRUE(Culler::isSupported(Culler::getIsa()));
+
+    for (auto isa : { Culler::Isa::SCALAR, Culler::Isa::SSE2, Culler::Isa::AVX2,
+            Culler::Isa::NEON }) {
+        if (!Culler::isSupported(isa)) {
+            continue;
+        }
+        // the bit of the box test must be updated without affecting the other ones
+        std::vector<Culler::result_type> boxes(capacity, 0xAA);
+        std::vector<Culler::result_type> spheresResult(capacity);
+        Culler::Test::intersects(isa, boxes.data(), frustum,
+                centers.data(), extents.data(), count);
+        Culler::Test::intersects(isa, spheresResult.data(), frustum, spheres.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            EXPECT_EQ(boxes[i] & ~1u, 0xAAu & ~1u) << Culler::getIsaName(isa);
+            if ((boxes[i] & 1u) != expectedBoxes[i]) {
+                EXPECT_TRUE(isOnPlane(centers[i], extents[i], 0.0f))
+                        << Culler::getIsaName(isa) << " box " << i;
+            }
+            if (spheresResult[i] != expectedSpheres[i]) {
+                EXPECT_TRUE(isOnPlane(spheres[i].xyz, float3{}, spheres[i].w))
+                        << Culler::getIsaName(isa) << " sphere " << i;
+            }
+        }
+    }
+}
+
+TEST(FilamentTest, BvhCulling) {
+    std::default_random_engine gen; // NOLINT
+    std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> size(0.1f, 10.0f);
+
+    constexpr size_t count = 10000;
+    std::vector<float3> centers(Culler::round(count));
+    std::vector<float3> extents(Culler::round(count));
+    for (size_t i = 0; i < count; i++) {
+        centers[i] = { position(gen), position(gen), position(gen) };
+        extents[i] = { size(gen), size(gen), size(gen) };
+    }
+
+    SceneBvh bvh;
+    bvh.update(centers.data(), extents.data(), count);
+    EXPECT_EQ(bvh.getPrimitiveCount(), count);
+
+    auto check = [&](Frustum const& frustum) {
+        std::vector<Culler::result_type> expected(Culler::round(count), 0);
+        std::vector<Culler::result_type> results(Culler::round(count), 0xFF);
+        Culler::Test::intersects(expected.data(), frustum, centers.data(), extents.data(), count);
+        bvh.intersects(results.data(), frustum, centers.data(), extents.data(), 0);
+        for (size_t i = 0; i < count; i++) {
+            // only the requested bit must be modified
+            EXPECT_EQ(results[i] & ~1u, 0xFEu);
+            EXPECT_EQ(results[i] & 1u, expected[i] & 1u) << "renderable " << i;
+        }
+    };
+
+    check(Frustum{ mat4f::perspective(45.0f, 1.0f, 0.1f, 100.0f) });
+    check(Frustum{ mat4f::perspective(90.0f, 1.0f, 0.1f, 1000.0f) });
+    check(Frustum{ mat4f::ortho(-20, 20, -20, 20, -100, 100) });
+
+    // move everything around, refitting must keep the results correct
+    for (size_t i = 0; i < count; i++) {
+        centers[i] = { position(gen), position(gen), position(gen) };
+    }
+    bvh.update(centers.data(), extents.data(), count);
+    check(Frustum{ mat4f::perspective(45.0f, 1.0f, 0.1f, 100.0f) });
+}
+
+TEST(FilamentTest, SpotShadowCasters) {
+    JobSystem js;
+    js.adopt();
+
+    // more than one chunk of renderables, so that they're culled in parallel
+    constexpr size_t COUNT = 3000;
+    constexpr size_t SHADOW_MAP_COUNT = 3;
+    constexpr uint8_t VISIBLE_LAYERS = 0x1;
+    FScene::RenderableSoa renderableData;
+    renderableData.setCapacity(Culler::round(COUNT) + 16);
+    renderableData.resize(COUNT);
+
+    std::default_random_engine gen; // NOLINT
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> size(0.1f, 10.0f);
+    std::uniform_int_distribution<int> flags(0, 3);
+    for (size_t i = 0; i < COUNT; i++) {
+        FRenderableManager::Visibility visibility{};
+        visibility.castShadows = flags(gen) != 0;
+        visibility.culling = flags(gen) != 0;
+        renderableData.elementAt<FScene::VISIBILITY_STATE>(i) = visibility;
+        renderableData.elementAt<FScene::LAYERS>(i) = flags(gen) ? VISIBLE_LAYERS : 0x2;
+        renderableData.elementAt<FScene::WORLD_AABB_CENTER>(i) =
+                { position(gen), position(gen), position(gen) };
+        renderableData.elementAt<FScene::WORLD_AABB_EXTENT>(i) =
+                { size(gen), size(gen), size(gen) };
+        renderableData.elementAt<FScene::VISIBLE_MASK>(i) = VISIBLE_RENDERABLE;
+    }
+
+    // the second shadow map has no visible shadows, it isn't culled
+    Frustum const frustums[SHADOW_MAP_COUNT] = {
+            Frustum{ mat4f::perspective(45.0f, 1.0f, 0.1f, 100.0f) },
+            Frustum{ mat4f::perspective(90.0f, 1.0f, 0.1f, 100.0f) },
+            Frustum{ mat4f::ortho(-20, 20, -20, 20, -100, 100) },
+    };
+    uint64_t const culledShadowMaps = 0x5;
+
+    float3 const* centers = renderableData.data<FScene::WORLD_AABB_CENTER>();
+    float3 const* extents = renderableData.data<FScene::WORLD_AABB_EXTENT>();
+    std::vector<Culler::result_type> expected[SHADOW_MAP_COUNT];
+    for (size_t i = 0; i < SHADOW_MAP_COUNT; i++) {
+        expected[i].resize(Culler::round(COUNT));
+        Culler::intersects(expected[i].data(), frustums[i], centers, extents, COUNT, 0);
+        for (size_t k = 0; k < COUNT; k++) {
+            auto const visibility = renderableData.elementAt<FScene::VISIBILITY_STATE>(k);
+            bool const castsShadows = visibility.castShadows &&
+                    (renderableData.elementAt<FScene::LAYERS>(k) & VISIBLE_LAYERS);
+            bool const visible = !visibility.culling || (expected[i][k] & 1u);
+            expected[i][k] = ((culledShadowMaps >> i) & 1u) && castsShadows && visible;
+        }
+    }
+
+    std::vector<uint64_t> casters((COUNT + 0xFu) & ~0xFu);
+    ShadowMapManager::cullSpotShadowMaps(js, VISIBLE_LAYERS, renderableData, { 0, COUNT },
+            frustums, culledShadowMaps, casters.data());
+    for (size_t k = 0; k < COUNT; k++) {
+        for (size_t i = 0; i < SHADOW_MAP_COUNT; i++) {
+            EXPECT_EQ((casters[k] >> i) & 1u, expected[i][k]) << "renderable " << k;
+        }
+        EXPECT_EQ(casters[k] >> SHADOW_MAP_COUNT, 0u) << "renderable " << k;
+    }
+
+    // each pass only gets its own casters, and the other visibility bits are left untouched
+    Culler::result_type* visibleMask = renderableData.data<FScene::VISIBLE_MASK>();
+    for (size_t i = 0; i < SHADOW_MAP_COUNT; i++) {
+        ShadowMapManager::updateSpotVisibilityMasks(casters.data(), i, visibleMask, COUNT);
+        for (size_t k = 0; k < COUNT; k++) {
+            Culler::result_type const dynShadow = expected[i][k] ?
+                    VISIBLE_DYN_SHADOW_RENDERABLE : 0;
+            EXPECT_EQ(visibleMask[k], Culler::result_type(VISIBLE_RENDERABLE | dynShadow))
+                    << "renderable " << k;
+        }
+    }
+
+    js.emancipate();
+}
+
+TEST(FilamentTest, RadixSort) {
+    JobSystem js;
+    js.adopt();
+
+    std::default_random_engine gen; // NOLINT
+    // few distinct values in the low bits so that we exercise stability and skipped digits
+    std::uniform_int_distribution<uint64_t> rand(0, 255);
+
+    for (size_t count : { 0, 1, 100, 5000, 100000 }) {
+        std::vector<std::pair<uint64_t, uint32_t>> expected(count);
+        std::vector<uint64_t> keys(count * 2);
+        std::vector<uint32_t> values(count * 2);
+        for (size_t i = 0; i < count; i++) {
+            uint64_t const key = (rand(gen) << 56) | (rand(gen) << 20) | (rand(gen) & 0x3);
+            expected[i] = { key, uint32_t(i) };
+            keys[i] = key;
+            values[i] = uint32_t(i);
+        }
+        std::stable_sort(expected.begin(), expected.end(),
+                [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; });
+
+        RadixSort::sort(js, keys.data(), values.data(),
+                keys.data() + count, values.data() + count, count);
+
+        for (size_t i = 0; i < count; i++) {
+            EXPECT_EQ(keys[i], expected[i].first);
+            EXPECT_EQ(values[i], expected[i].second);
+        }
+    }
+
+    js.emancipate();
+}
+
+TEST(FilamentTest, TransientHeap) {
+    constexpr size_t alignment = 256;
+
+    // disjoint lifetimes share the same memory
+    TransientHeap::Allocation disjoint[] = {
+            { 1000, 0, 1, 0 },
+            { 1000, 2, 3, 0 },
+            { 512,  4, 4, 0 },
+    };
+    TransientHeap heap;
+    TransientHeap::Stats stats = heap.pack(disjoint, 3, alignment);
+    EXPECT_EQ(stats.totalSize, 1024 + 1024 + 512);
+    EXPECT_EQ(stats.peakSize, 1024);
+    EXPECT_EQ(stats.heapSize, 1024);
+    for (auto const& a : disjoint) {
+        EXPECT_EQ(a.offset, 0);
+    }
+
+    // random lifetimes never collide
+    std::default_random_engine gen; // NOLINT
+    std::uniform_int_distribution<uint32_t> time(0, 20);
+    std::uniform_int_distribution<size_t> size(1, 1u << 20u);
+    std::vector<TransientHeap::Allocation> allocations(200);
+    for (auto& a : allocations) {
+        uint32_t const t0 = time(gen);
+        uint32_t const t1 = time(gen);
+        a = { size(gen), std::min(t0, t1), std::max(t0, t1), 0 };
+    }
+    stats = heap.pack(allocations.data(), allocations.size(), alignment);
+    EXPECT_LE(stats.peakSize, stats.heapSize);
+    EXPECT_LE(stats.heapSize, stats.totalSize);
+    for (size_t i = 0; i < allocations.size(); i++) {
+        auto const& a = allocations[i];
+        EXPECT_EQ(a.offset % alignment, 0);
+        EXPECT_LE(a.offset + a.size, stats.heapSize);
+        for (size_t j = i + 1; j < allocations.size(); j++) {
+            auto const& b = allocations[j];
+            if (a.first <= b.last && b.first <= a.last) {
+                EXPECT_TRUE(a.offset + a.size <= b.offset || b.offset + b.size <= a.offset);
+            }
+        }
+    }
+
+    // the heap's scratch memory is reused, a smaller set packs as it did the first time
+    for (auto& a : disjoint) {
+        a.offset = 1;
+    }
+    stats = heap.pack(disjoint, 3, alignment);
+    EXPECT_EQ(stats.totalSize, 1024 + 1024 + 512);
+    EXPECT_EQ(stats.peakSize, 1024);
+    EXPECT_EQ(stats.heapSize, 1024);
+    for (auto const& a : disjoint) {
+        EXPECT_EQ(a.offset, 0);
+    }
+}
+
+TEST(FilamentTest, GroupInstanceableCommands) {
+    using Command = RenderPass::Command;
+
+    std::vector<uint8_t> storage(1024 * 1024);
+    RenderPass::Arena arena("test", { storage.data(), storage.data() + storage.size() });
+
+    auto makeCommand = [](RenderPass::Pass pass, uint64_t zBucket, uint32_t primitive) {
+        Command c{};
+        c.key = uint64_t(pass) | uint64_t(RenderPass::CustomCommand::PASS) |
+                (zBucket << RenderPass::Z_BUCKET_SHIFT);
+        c.info.mi = reinterpret_cast<FMaterialInstance const*>(uintptr_t(64));
+        c.info.rph = backend::RenderPrimitiveHandle{ primitive };
+        c.info.index = uint32_t(zBucket);
+        c.info.instanceCount = 1;
+        return c;
+    };
+
+    // two primitives interleaved by depth, followed by blended commands which can't move
+    std::vector<Command> commands;
+    for (uint64_t z = 0; z < 6; z++) {
+        commands.push_back(makeCommand(RenderPass::Pass::COLOR, z, uint32_t(z % 2)));
+    }
+    for (uint64_t z = 0; z < 4; z++) {
+        commands.push_back(makeCommand(RenderPass::Pass::BLENDED, z, uint32_t(z % 2)));
+    }
+
+    RenderPass::groupInstanceableCommands(arena,
+            commands.data(), commands.data() + commands.size());
+
+    uint32_t const expected[] = { 0, 2, 4, 1, 3, 5, 0, 1, 2, 3 };
+    for (size_t i = 0; i < commands.size(); i++) {
+        EXPECT_EQ(commands[i].info.index, expected[i]);
+    }
+
+    // depth-only commands are only grouped within a Z-bucket
+    commands.clear();
+    for (uint64_t z = 0; z < 4; z++) {
+        commands.push_back(makeCommand(RenderPass::Pass::DEPTH, z / 2, uint32_t(z % 2)));
+        commands.back().info.index = uint32_t(z);
+    }
+    commands.push_back(makeCommand(RenderPass::Pass::DEPTH, 1, 0));
+    commands.back().info.index = 4;
+    RenderPass::groupInstanceableCommands(arena,
+            commands.data(), commands.data() + commands.size());
+    uint32_t const expectedDepth[] = { 0, 1, 2, 4, 3 };
+    for (size_t i = 0; i < commands.size(); i++) {
+        EXPECT_EQ(commands[i].info.index, expectedDepth[i]);
+    }
+
+    // skinned commands are never grouped
+    commands.clear();
+    for (uint64_t z = 0; z < 4; z++) {
+        commands.push_back(makeCommand(RenderPass::Pass::DEPTH, z, uint32_t(z % 2)));
+        commands.back().info.hasSkinning = true;
+    }
+    RenderPass::groupInstanceableCommands(arena,
+            commands.data(), commands.data() + commands.size());
+    for (size_t i = 0; i < commands.size(); i++) {
+        EXPECT_EQ(commands[i].info.index, i);
+    }
+
+    // identical draws that only differ by their variant, e.g. receiveShadows, are not grouped
+    commands.clear();
+    for (uint64_t z = 0; z < 4; z++) {
+        commands.push_back(makeCommand(RenderPass::Pass::COLOR, z, 0));
+        Variant variant{};
+        variant.setShadowReceiver(z % 2);
+        commands.back().info.materialVariant = variant;
+    }
+    RenderPass::groupInstanceableCommands(arena,
+            commands.data(), commands.data() + commands.size());
+    uint32_t const expectedByVariant[] = { 0, 2, 1, 3 };
+    for (size_t i = 0; i < commands.size(); i++) {
+        EXPECT_EQ(commands[i].info.index, expectedByVariant[i]);
+    }
+}
+
+TEST(FilamentTest, PartitionIncremental) {
+    constexpr size_t COUNT = 256;
+    FScene::RenderableSoa renderableData;
+    renderableData.setCapacity(COUNT + 1);
+    renderableData.resize(COUNT);
+
+    auto group = [](Culler::result_type mask) -> size_t {
+        switch (mask & (VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE)) {
+            case VISIBLE_RENDERABLE: return 0;
+            case VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE: return 1;
+            case VISIBLE_DIR_SHADOW_RENDERABLE: return 2;
+            default: return (mask & VISIBLE_DYN_SHADOW_RENDERABLE) ? 3 : 4;
+        }
+    };
+
+    auto check = [&](std::array<uint32_t, 4> const& groupEnds) {
+        float sum = 0.0f;
+        for (size_t i = 0; i < COUNT; i++) {
+            size_t const g = group(renderableData.elementAt<FScene::VISIBLE_MASK>(i));
+            uint32_t const first = g ? groupEnds[g - 1] : 0;
+            uint32_t const last = g < 4 ? groupEnds[g] : COUNT;
+            EXPECT_GE(i, first);
+            EXPECT_LT(i, last);
+            sum += renderableData.elementAt<FScene::USER_DATA>(i);
+        }
+        // renderables are only moved around
+        EXPECT_EQ(sum, float(COUNT * (COUNT - 1) / 2));
+    };
+
+    std::default_random_engine gen; // NOLINT
+    std::uniform_int_distribution<uint32_t> masks(0,
+            VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE | VISIBLE_DYN_SHADOW_RENDERABLE);
+    for (size_t i = 0; i < COUNT; i++) {
+        renderableData.elementAt<FScene::VISIBLE_MASK>(i) = Culler::result_type(masks(gen));
+        renderableData.elementAt<FScene::USER_DATA>(i) = float(i);
+    }
+
+    std::array<uint32_t, 4> groupEnds{};
+    EXPECT_GT(FView::partitionIncremental(renderableData, groupEnds), 0);
+    check(groupEnds);
+
+    // nothing changed, nothing moves
+    EXPECT_EQ(FView::partitionIncremental(renderableData, groupEnds), 0);
+    check(groupEnds);
+
+    // a single renderable becoming invisible only moves a few renderables at group boundaries
+    renderableData.elementAt<FScene::VISIBLE_MASK>(0) = 0;
+    EXPECT_LE(FView::partitionIncremental(renderableData, groupEnds), 8);
+    check(groupEnds);
+}
+
+TEST(FilamentTest, PersistentRenderableIndices) {
+    constexpr size_t COUNT = 12;
+    Engine* engine = Engine::create(Engine::Backend::NOOP);
+    FEngine& fengine = downcast(*engine);
+    auto& tcm = engine->getTransformManager();
+
+    Scene* const publicScene = engine->createScene();
+    FScene& scene = downcast(*publicScene);
+    Entity entities[COUNT];
+    EntityManager::get().create(COUNT, entities);
+    for (size_t i = 0; i < COUNT; i++) {
+        RenderableManager::Builder(1)
+                .culling(false)
+                .castShadows(false)
+                .receiveShadows(false)
+                .build(*engine, entities[i]);
+        tcm.create(entities[i]);
+    }
+
+    LinearAllocatorArena arena("PersistentRenderableIndices", 1024 * 1024);
+    auto prepare = [&]() {
+        RootArenaScope rootArenaScope(arena);
+        scene.prepare(fengine.getJobSystem(), rootArenaScope, mat4{}, false);
+    };
+    auto instances = [&]() {
+        auto const& renderableData = scene.getRenderableData();
+        auto const* const first = renderableData.data<FScene::RENDERABLE_INSTANCE>();
+        return std::vector<RenderableManager::Instance>(first, first + renderableData.size());
+    };
+    auto entityAt = [&](std::vector<RenderableManager::Instance> const& slots, size_t i) {
+        auto const& rcm = fengine.getRenderableManager();
+        return *std::find_if(std::begin(entities), std::end(entities),
+                [&](Entity e) { return rcm.getInstance(e) == slots[i]; });
+    };
+
+    for (size_t i = 0; i < 8; i++) {
+        publicScene->addEntity(entities[i]);
+    }
+    prepare();
+
+    // the View reorders rows, then a renderable is removed and two are added: the remaining
+    // ones keep their slot, the new ones fill the free slot and the new ones at the end
+    scene.getRenderableData().swap(0, 7);
+    auto const before = instances();
+    publicScene->remove(entityAt(before, 2));
+    publicScene->addEntity(entities[8]);
+    publicScene->addEntity(entities[9]);
+    prepare();
+    auto after = instances();
+    ASSERT_EQ(after.size(), 9u);
+    for (size_t i = 0; i < before.size(); i++) {
+        if (i != 2) {
+            EXPECT_EQ(after[i], before[i]) << "slot " << i;
+        }
+    }
+
+    // renderables past the new end move to the free slots, the others don't move
+    auto const previous = after;
+    publicScene->remove(entityAt(previous, 1));
+    publicScene->remove(entityAt(previous, 3));
+    publicScene->remove(entityAt(previous, 4));
+    prepare();
+    after = instances();
+    ASSERT_EQ(after.size(), 6u);
+    for (size_t i : { 0, 2, 5 }) {
+        EXPECT_EQ(after[i], previous[i]) << "slot " << i;
+    }
+    std::vector<RenderableManager::Instance> moved(after.begin(), after.end());
+    std::vector<RenderableManager::Instance> expected = {
+            previous[0], previous[2], previous[5], previous[6], previous[7], previous[8] };
+    std::sort(moved.begin(), moved.end());
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(moved, expected);
+
+    engine->destroy(publicScene);
+    for (Entity const e : entities) {
+        engine->destroy(e);
+    }
+    EntityManager::get().destroy(COUNT, entities);
+    Engine::destroy(&engine);
+}
+
+TEST(FilamentTest, RenderableUboUploadAfterReorder) {
+    constexpr size_t COUNT = 8;
+    Engine* engine = Engine::create(Engine::Backend::NOOP);
+    FEngine& fengine = downcast(*engine);
+    FEngine::DriverApi& driver = fengine.getDriverApi();
+    auto& tcm = engine->getTransformManager();
+
+    Scene* const publicScene = engine->createScene();
+    FScene& scene = downcast(*publicScene);
+    Entity entities[COUNT];
+    EntityManager::get().create(COUNT, entities);
+    for (size_t i = 0; i < COUNT; i++) {
+        // primitives without geometry are ignored, so no AABB is needed
+        RenderableManager::Builder(1)
+                .culling(false)
+                .castShadows(false)
+                .receiveShadows(false)
+                .build(*engine, entities[i]);
+        tcm.create(entities[i], {}, mat4f::translation(float3{ float(i), 0, 0 }));
+        publicScene->addEntity(entities[i]);
+    }
+
+    LinearAllocatorArena arena("RenderableUboUploadAfterReorder", 1024 * 1024);
+    RootArenaScope rootArenaScope(arena);
+    scene.prepare(fengine.getJobSystem(), rootArenaScope, mat4{}, false);
+
+    auto const ubh = driver.createBufferObject(COUNT * sizeof(PerRenderableData),
+            backend::BufferObjectBinding::UNIFORM, backend::BufferUsage::DYNAMIC);
+    auto update = [&](bool isNewBuffer) {
+        scene.updateUBOs(fengine.getJobSystem(), driver, { 0, COUNT }, ubh, isNewBuffer);
+    };
+    using Ranges = std::vector<std::pair<uint32_t, uint32_t>>;
+    auto uploaded = [&]() {
+        Ranges result;
+        for (auto const& range : scene.getUploadedRanges()) {
+            result.emplace_back(range.first, range.last);
+        }
+        return result;
+    };
+
+    // a new buffer is uploaded entirely, then nothing changes
+    update(true);
+    EXPECT_EQ(uploaded(), (Ranges{{ 0, COUNT }}));
+    update(false);
+    EXPECT_EQ(uploaded(), Ranges{});
+
+    // the View reorders rows, the renderables moved to other slots must be uploaded even
+    // though their own data didn't change
+    scene.getRenderableData().swap(3, 7);
+    update(false);
+    EXPECT_EQ(uploaded(), (Ranges{{ 3, 4 }, { 7, 8 }}));
+    update(false);
+    EXPECT_EQ(uploaded(), Ranges{});
+
+    driver.destroyBufferObject(ubh);
+    engine->destroy(publicScene);
+    for (Entity const e : entities) {
+        engine->destroy(e);
+    }
+    EntityManager::get().destroy(COUNT, entities);
+    Engine::destroy(&engine);
+}
+
+TEST(FilamentTest, LevelOfDetailSelection) {
+    FScene::RenderableSoa renderableData;
+    renderableData.setCapacity(2);
+    renderableData.resize(1);
+
+    FRenderableManager::LevelsOfDetail lods;
+    lods.count = 3;
+    lods.errors[1] = 0.01f;
+    lods.errors[2] = 0.1f;
+    renderableData.elementAt<FScene::LODS>(0) = &lods;
+    renderableData.elementAt<FScene::WORLD_TRANSFORM>(0) = mat4f{};
+    renderableData.elementAt<FScene::WORLD_AABB_EXTENT>(0) = float3{ 0 };
+
+    // a unit length at a distance of 1 covers 500 pixels
+    CameraInfo camera;
+    camera.projection = mat4f::perspective(90, 1.0f, 0.1f, 100.0f);
+    camera.zn = 0.1f;
+    Viewport const viewport{ 0, 0, 1000, 1000 };
+
+    LodOptions options;
+    options.maxScreenSpaceError = 1.0f;
+    options.hysteresis = 0.1f;
+
+    auto select = [&](float distance) -> uint8_t {
+        renderableData.elementAt<FScene::WORLD_AABB_CENTER>(0) = float3{ 0, 0, -distance };
+        renderableData.elementAt<FScene::LOD_LEVEL>(0) = 0;
+        FView::selectLevelsOfDetail(renderableData, options, camera, viewport, { 0, 1 });
+        return renderableData.elementAt<FScene::LOD_LEVEL>(0);
+    };
+
+    // level 1 is below 1px past a distance of 5, level 2 past 50
+    EXPECT_EQ(select(2.0f), 0);
+    EXPECT_EQ(select(6.0f), 1);
+    EXPECT_EQ(select(5.2f), 1);
+    EXPECT_EQ(select(4.0f), 0);
+    // within the hysteresis margin, the finer level is kept
+    EXPECT_EQ(select(5.2f), 0);
+    EXPECT_EQ(select(100.0f), 2);
+
+    // a larger scale makes the error larger
+    renderableData.elementAt<FScene::WORLD_TRANSFORM>(0) = mat4f::scaling(float3{ 4 });
+    EXPECT_EQ(select(100.0f), 1);
+
+    options.enabled = false;
+    EXPECT_EQ(select(1000.0f), 0);
+}
+
+TEST(FilamentTest, LevelOfDetailBuilder) {
+    Engine* engine = Engine::create(Engine::Backend::NOOP);
+    utils::Entity const entity = utils::EntityManager::get().create();
+
+    // primitives without geometry are ignored, so no AABB is needed
+    RenderableManager::Builder(1)
+            .levelOfDetail(1, 2, 0.01f)
+            .levelOfDetail(2, 0, 0.1f)
+            .culling(false)
+            .castShadows(false)
+            .receiveShadows(false)
+            .build(*engine, entity);
+
+    FRenderableManager const& rcm = downcast(engine->getRenderableManager());
+    auto const ri = rcm.getInstance(entity);
+    EXPECT_EQ(rcm.getLevelCount(ri), 3u);
+    EXPECT_EQ(rcm.getPrimitiveCount(ri, 0), 1u);
+    EXPECT_EQ(rcm.getPrimitiveCount(ri, 1), 2u);
+    EXPECT_EQ(rcm.getPrimitiveCount(ri, 2), 0u);
+    EXPECT_EQ(rcm.getPrimitiveCount(ri, 3), 0u);
+    EXPECT_EQ(rcm.getLevelsOfDetail(ri)->errors[2], 0.1f);
+
+    // the default material is bound to the primitives of all levels
+    EXPECT_NE(rcm.getMaterialInstanceAt(ri, 1, 1), nullptr);
+    EXPECT_EQ(rcm.getMaterialInstanceAt(ri, 2, 0), nullptr);
+
+    engine->getRenderableManager().destroy(entity);
+    utils::EntityManager::get().destroy(entity);
+    Engine::destroy(&engine);
+}
+
+TEST(FilamentTest, RenderViews) {
+    Engine* engine = Engine::create(Engine::Backend::NOOP);
+    SwapChain* swapChain = engine->createSwapChain(64, 64, 0);
+    Renderer* renderer = engine->createRenderer();
+
+    static float3 const vertices[] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 } };
+    static uint16_t const indices[] = { 0, 1, 2 };
+    VertexBuffer* vb = VertexBuffer::Builder()
+            .vertexCount(3)
+            .bufferCount(1)
+            .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::FLOAT3)
+            .build(*engine);
+    vb->setBufferAt(*engine, 0, { vertices, sizeof(vertices) });
+    IndexBuffer* ib = IndexBuffer::Builder()
+            .indexCount(3)
+            .bufferType(IndexBuffer::IndexType::USHORT)
+            .build(*engine);
+    ib->setBuffer(*engine, { indices, sizeof(indices) });
+
+    // the first Scene has one triangle, the second one has two
+    Scene* scenes[2] = { engine->createScene(), engine->createScene() };
+    Entity renderables[3];
+    EntityManager::get().create(3, renderables);
+    for (size_t i = 0; i < 3; i++) {
+        RenderableManager::Builder(1)
+                .boundingBox({{ 0.5f, 0.5f, 0.0f }, { 0.5f, 0.5f, 0.1f }})
+                .geometry(0, RenderableManager::PrimitiveType::TRIANGLES, vb, ib)
+                .build(*engine, renderables[i]);
+        scenes[i ? 1 : 0]->addEntity(renderables[i]);
+    }
+
+    Entity const cameraEntity = EntityManager::get().create();
+    Camera* camera = engine->createCamera(cameraEntity);
+    camera->setProjection(60.0, 1.0, 0.1, 100.0);
+    camera->lookAt({ 0, 0, 10 }, { 0, 0, 0 });
+
+    // the first two Views share a Scene, so the second one isn't prepared concurrently
+    View* views[3];
+    for (size_t i = 0; i < 3; i++) {
+        views[i] = engine->createView();
+        views[i]->setScene(scenes[i < 2 ? 0 : 1]);
+        views[i]->setCamera(camera);
+        views[i]->setViewport({ 0, 0, 64, 64 });
+        views[i]->setPostProcessingEnabled(false);
+    }
+
+    for (bool const concurrent : { false, true }) {
+        SCOPED_TRACE(concurrent ? "concurrent" : "serial");
+        engine->setFeatureFlag("engine.renderer.concurrent_view_prepare", concurrent);
+        for (size_t frame = 0; frame < 2; frame++) {
+            renderer->beginFrame(swapChain);
+            renderer->renderViews(views, 3);
+            renderer->endFrame();
+            engine->flushAndWait();
+
+            EXPECT_EQ(views[0]->getLodTriangleCount(0), 1u);
+            EXPECT_EQ(views[1]->getLodTriangleCount(0), 1u);
+            EXPECT_EQ(views[2]->getLodTriangleCount(0), 2u);
+        }
+    }
+
+    for (View* view : views) {
+        engine->destroy(view);
+    }
+    engine->destroyCameraComponent(cameraEntity);
+    EntityManager::get().destroy(cameraEntity);
+    for (Entity const e : renderables) {
+        engine->destroy(e);
+    }
+    EntityManager::get().destroy(3, renderables);
+    engine->destroy(scenes[0]);
+    engine->destroy(scenes[1]);
+    engine->destroy(vb);
+    engine->destroy(ib);
+    engine->destroy(renderer);
+    engine->destroy(swapChain);
+    Engine::destroy(&engine);
+}
+
+TEST(FilamentTest, ProgramManifest) {
+    ProgramManifest manifest;
+    manifest.add(0x1234, Variant{ 0x01 });
+    manifest.add(0x1234, Variant{ 0x85 });
+    manifest.add(0x5678, Variant{ 0xFF });
+    EXPECT_EQ(manifest.getMaterialCount(), 2);
+
+    size_t const size = manifest.serialize(nullptr, 0);
+    std::vector<uint8_t> data(size);
+    EXPECT_EQ(manifest.serialize(data.data(), data.size() - 1), size);
+    EXPECT_EQ(manifest.serialize(data.data(), data.size()), size);
+
+    // loading merges with what's already there
+    ProgramManifest loaded;
+    loaded.add(0x1234, Variant{ 0x02 });
+    EXPECT_TRUE(loaded.deserialize(data.data(), data.size()));
+    EXPECT_EQ(loaded.getMaterialCount(), 2);
+
+    VariantList const variants = loaded.getVariants(0x1234);
+    EXPECT_EQ(variants.count(), 3);
+    EXPECT_TRUE(variants.test(0x01));
+    EXPECT_TRUE(variants.test(0x02));
+    EXPECT_TRUE(variants.test(0x85));
+    EXPECT_TRUE(loaded.getVariants(0x5678).test(0xFF));
+    EXPECT_EQ(loaded.getVariants(0x9ABC).count(), 0);
+
+    // truncated or corrupted data is rejected and doesn't change the manifest
+    ProgramManifest rejected;
+    EXPECT_FALSE(rejected.deserialize(data.data(), data.size() - 1));
+    data[0] ^= 0xFF;
+    EXPECT_FALSE(rejected.deserialize(data.data(), data.size()));
+    EXPECT_EQ(rejected.getMaterialCount(), 0);
+}
+
+TEST(FilamentTest, DestroyedEntityJournal) {
+    auto& em = EntityManager::get();
+    DestroyedEntityJournal journal(em);
+
+    Entity entities[8];
+    em.create(8, entities);
+    em.destroy(5, entities);
+    em.destroy(3, entities + 5);
+    EXPECT_EQ(journal.size(), 8);
+
+    // entries come out oldest first, and partial pops keep the rest
+    Entity popped[8];
+    EXPECT_EQ(journal.pop(popped, 3), 3);
+    EXPECT_EQ(journal.size(), 5);
+    EXPECT_EQ(journal.pop(popped + 3, 8), 5);
+    EXPECT_EQ(journal.size(), 0);
+    for (size_t i = 0; i < 8; i++) {
+        EXPECT_EQ(popped[i].getId(), entities[i].getId());
+    }
+    EXPECT_EQ(journal.pop(popped, 8), 0);
+}
+
+TEST(FilamentTest, GarbageCollection) {
+    Engine* engine = Engine::create(Engine::Backend::NOOP);
+    FEngine& fengine = downcast(*engine);
+    auto& em = EntityManager::get();
+    auto& tcm = fengine.getTransformManager();
+    auto& lcm = fengine.getLightManager();
+
+    // more than one gc() batch, half of the entities also have a light
+    size_t const count = FEngine::GC_BATCH_SIZE * 4 + 3;
+    std::vector<Entity> entities(count);
+    em.create(count, entities.data());
+    for (size_t i = 0; i < count; i++) {
+        tcm.create(entities[i]);
+        if (i & 1) {
+            LightManager::Builder(LightManager::Type::POINT).build(*engine, entities[i]);
+        }
+    }
+
+    // a component destroyed explicitly before its Entity is simply skipped
+    tcm.destroy(entities[0]);
+    EXPECT_EQ(fengine.getPendingDestroyedEntityCount(), 0);
+    em.destroy(count, entities.data());
+    EXPECT_EQ(fengine.getPendingDestroyedEntityCount(), count);
+
+    // an Entity destroyed from another thread is collected as well
+    Entity other = em.create();
+    tcm.create(other);
+    std::thread([&em, other]() { em.destroy(other); }).join();
+    EXPECT_EQ(fengine.getPendingDestroyedEntityCount(), count + 1);
+
+    // the time budget may spread the collection over several calls
+    while (fengine.getPendingDestroyedEntityCount()) {
+        size_t const pending = fengine.getPendingDestroyedEntityCount();
+        fengine.gc();
+        EXPECT_LT(fengine.getPendingDestroyedEntityCount(), pending);
+        EXPECT_EQ(fengine.debug.gc.pending_entities,
+                int(fengine.getPendingDestroyedEntityCount()));
+    }
+
+    for (Entity const e : entities) {
+        EXPECT_FALSE(tcm.hasComponent(e));
+        EXPECT_FALSE(lcm.hasComponent(e));
+    }
+    EXPECT_FALSE(tcm.hasComponent(other));
+
+    Engine::destroy(&engine);
+}
+
+TEST(FilamentTest, CommandBufferQueue) {
+    using backend::CircularBuffer;
+    using backend::CommandBufferQueue;
+
+    // small slices, so that producers regularly wait for the consumer
+    size_t const blockSize = CircularBuffer::getBlockSize();
+    CommandBufferQueue queue(blockSize, blockSize * 4, false);
+
+    constexpr uint32_t PRODUCER_COUNT = 4;
+    constexpr uint32_t FLUSH_COUNT = 2000;
+
+    std::array<CommandBufferQueue::Slice*, PRODUCER_COUNT> slices{};
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < PRODUCER_COUNT; p++) {
+        slices[p] = p ? queue.createSlice(blockSize * 4) : nullptr;
+        producers.emplace_back([&queue, slice = slices[p], p]() {
+            CircularBuffer& circularBuffer =
+                    slice ? slice->getCircularBuffer() : queue.getCircularBuffer();
+            for (uint32_t i = 0; i < FLUSH_COUNT; i++) {
+                uint32_t* const data = (uint32_t*)circularBuffer.allocate(256);
+                data[0] = p;
+                data[1] = i;
+                if (slice) {
+                    queue.flush(*slice);
+                } else {
+                    queue.flush();
+                }
+            }
+        });
+    }
+
+    // each producer's buffers must be received in order
+    // Note: no ASSERT_* until the producers are joined, returning early would destroy joinable
+    // threads.
+    std::array<uint32_t, PRODUCER_COUNT> received{};
+    uint32_t total = 0;
+    while (total < PRODUCER_COUNT * FLUSH_COUNT) {
+        auto const buffers = queue.waitForCommands();
+        EXPECT_FALSE(buffers.empty());
+        for (auto const& buffer : buffers) {
+            uint32_t const* const data = (uint32_t const*)buffer.begin;
+            uint32_t const p = data[0];
+            EXPECT_LT(p, PRODUCER_COUNT);
+            if (p < PRODUCER_COUNT) {
+                EXPECT_EQ(received[p], data[1]);
+                received[p] = data[1] + 1;
+            }
+            queue.releaseBuffer(buffer);
+            total++;
+        }
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    // nothing is pending anymore
+    queue.requestExit();
+    EXPECT_TRUE(queue.waitForCommands().empty());
+    for (uint32_t p = 0; p < PRODUCER_COUNT; p++) {
+        EXPECT_EQ(FLUSH_COUNT, received[p]);
+    }
+}
+
 TEST(FilamentTest, ColorConversion) {
     // Linear to Gamma
     // 0.0 stays 0.0
@@ -16,9 +16,15 @@
 
 #include <fstream>
 #include <iostream>
+#include <memory>
+
+#include <string.h>
 
 #include <gtest/gtest.h>
 
+#include <filament/Engine.h>
+#include <filament/Material.h>
+
 #include "MaterialParser.h"
 
 #include "filament_test_resources.h"
@@ -41,6 +47,79 @@ TEST(MaterialParser, Parse) {
             "See instructions in filament_test_material_parser.cpp" << std::endl;
 }
 
+namespace {
+
+// The zero-copy Material::Builder::package() requires an 8-bytes aligned payload, the resource
+// isn't guaranteed to be.
+struct AlignedPackage {
+    std::unique_ptr<uint64_t[]> storage;
+    size_t size;
+    AlignedPackage(void const* data, size_t size)
+            : storage(new uint64_t[(size + 7) / 8]()), size(size) {
+        memcpy(storage.get(), data, size);
+    }
+    void const* data() const noexcept { return storage.get(); }
+};
+
+struct ReleaseRecord {
+    void const* payload = nullptr;
+    size_t size = 0;
+    int count = 0;
+};
+
+void onPackageReleased(void const* payload, size_t size, void* user) {
+    ReleaseRecord* const record = static_cast<ReleaseRecord*>(user);
+    record->payload = payload;
+    record->size = size;
+    record->count++;
+}
+
+} // anonymous namespace
+
+// A package passed without a copy must stay alive for the lifetime of the Material, and be
+// released exactly once, when the Material is destroyed.
+TEST(MaterialPackage, ReleasedWhenMaterialIsDestroyed) {
+    AlignedPackage const package(FILAMENT_TEST_RESOURCES_TEST_MATERIAL_DATA,
+            FILAMENT_TEST_RESOURCES_TEST_MATERIAL_SIZE);
+    ReleaseRecord record;
+
+    Engine* engine = Engine::create(Engine::Backend::NOOP);
+    Material* material = Material::Builder()
+            .package(package.data(), package.size, &onPackageReleased, &record)
+            .build(*engine);
+    ASSERT_NE(material, nullptr);
+    EXPECT_EQ(record.count, 0);
+
+    engine->destroy(material);
+    EXPECT_EQ(record.count, 1);
+    EXPECT_EQ(record.payload, package.data());
+    EXPECT_EQ(record.size, package.size);
+
+    Engine::destroy(&engine);
+    EXPECT_EQ(record.count, 1);
+}
+
+// When build() fails, the package is released before build() returns, since no Material
+// references it.
+TEST(MaterialPackage, ReleasedWhenBuildFails) {
+    // not a material package: its first chunk runs past the end of the payload, so the parser
+    // finds no shader model and build() returns nullptr
+    std::unique_ptr<uint64_t[]> const garbage(new uint64_t[64]);
+    memset(garbage.get(), 0xff, 64 * sizeof(uint64_t));
+    ReleaseRecord record;
+
+    Engine* engine = Engine::create(Engine::Backend::NOOP);
+    Material* material = Material::Builder()
+            .package(garbage.get(), 64 * sizeof(uint64_t), &onPackageReleased, &record)
+            .build(*engine);
+    EXPECT_EQ(material, nullptr);
+    EXPECT_EQ(record.count, 1);
+    EXPECT_EQ(record.payload, garbage.get());
+    EXPECT_EQ(record.size, 64 * sizeof(uint64_t));
+
+    Engine::destroy(&engine);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
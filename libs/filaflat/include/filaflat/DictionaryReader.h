@@ -19,12 +19,60 @@
 
 #include <filaflat/ChunkContainer.h>
 
+#include <utils/FixedCapacityVector.h>
+
+#include <memory>
+
+#include <stddef.h>
+#include <stdint.h>
+
 namespace filaflat {
 
+struct SpirvDecoder;
+
+/*
+ * A dictionary that references its blobs in place, in the material package, instead of copying
+ * them. Blobs are only decoded, when needed, by get(). The package must outlive the dictionary.
+ * SPIR-V blobs are decoded at most once, even when get() is called from several threads, and
+ * the decoded content is kept for the lifetime of the dictionary.
+ */
+class LazyBlobDictionary {
+public:
+    struct Blob {
+        uint8_t const* start;
+        size_t length;
+        uint8_t const* data() const noexcept { return start; }
+        size_t size() const noexcept { return length; }
+    };
+
+    size_t size() const noexcept { return mBlobs.size(); }
+
+    // Raw blob, for text dictionaries this is the line including its trailing null.
+    Blob const& operator[](size_t index) const noexcept { return mBlobs[index]; }
+
+    // Decodes a blob into content, reusing content's storage if possible.
+    bool get(size_t index, ShaderContent& content) const noexcept;
+
+    // Number of blobs decoded so far, for stats and testing/debugging.
+    size_t getDecodedCount() const noexcept;
+
+private:
+    friend struct DictionaryReader;
+    struct DecodedCache;
+    utils::FixedCapacityVector<Blob> mBlobs;
+    ChunkContainer::Type mType = filamat::ChunkType::Unknown;
+    std::shared_ptr<SpirvDecoder const> mSpirvDecoder;
+    std::shared_ptr<DecodedCache> mDecodedCache;
+};
+
 struct DictionaryReader {
     static bool unflatten(ChunkContainer const& container,
             ChunkContainer::Type dictionaryTag,
             BlobDictionary& dictionary);
+
+    static bool unflatten(ChunkContainer const& container,
+            ChunkContainer::Type dictionaryTag,
+            LazyBlobDictionary& dictionary);
 };
 
 } // namespace filaflat
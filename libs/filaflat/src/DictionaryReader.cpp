@@ -22,14 +22,98 @@
 #if defined (FILAMENT_DRIVER_SUPPORTS_VULKAN)
 #include <utils/Log.h>
 #include <smolv.h>
+#include <zstd.h>
 #endif
 
+#include <mutex>
+#include <vector>
+
 #include <assert.h>
+#include <string.h>
 
 using namespace filamat;
 
 namespace filaflat {
 
+#if defined (FILAMENT_DRIVER_SUPPORTS_VULKAN)
+
+// Decodes the blobs of a SPIR-V dictionary. With compression scheme 1, blobs are smol-v encoded,
+// with scheme 2 they're additionally zstd compressed, using a dictionary stored in the chunk.
+struct SpirvDecoder {
+    uint32_t compressionScheme = 0;
+    ZSTD_DDict* zstdDictionary = nullptr;
+
+    SpirvDecoder() noexcept = default;
+    SpirvDecoder(SpirvDecoder const&) = delete;
+    SpirvDecoder& operator=(SpirvDecoder const&) = delete;
+
+    ~SpirvDecoder() noexcept {
+        ZSTD_freeDDict(zstdDictionary);
+    }
+
+    // reads the dictionary's header, up to the blob count
+    bool readHeader(Unflattener& unflattener) noexcept {
+        if (!unflattener.read(&compressionScheme)) {
+            return false;
+        }
+        if (compressionScheme == 2) {
+            unflattener.skipAlignmentPadding();
+            const char* data;
+            size_t dataSize;
+            if (!unflattener.read(&data, &dataSize)) {
+                return false;
+            }
+            // an empty dictionary means the blobs were compressed without one
+            if (dataSize) {
+                zstdDictionary = ZSTD_createDDict(data, dataSize);
+                if (!zstdDictionary) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        return compressionScheme == 1;
+    }
+
+    // dctx is only used by scheme 2, it can be null, in which case a context is created.
+    bool decode(ZSTD_DCtx* dctx, const char* blob, size_t blobSize,
+            ShaderContent& spirv) const noexcept {
+        ShaderContent smol;
+        if (compressionScheme == 2) {
+            unsigned long long const size = ZSTD_getFrameContentSize(blob, blobSize);
+            if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN) {
+                return false;
+            }
+            ZSTD_DCtx* const context = dctx ? dctx : ZSTD_createDCtx();
+            smol = ShaderContent(size_t(size));
+            size_t const result = zstdDictionary ?
+                    ZSTD_decompress_usingDDict(context,
+                            smol.data(), smol.size(), blob, blobSize, zstdDictionary) :
+                    ZSTD_decompressDCtx(context, smol.data(), smol.size(), blob, blobSize);
+            if (!dctx) {
+                ZSTD_freeDCtx(context);
+            }
+            if (ZSTD_isError(result) || result != smol.size()) {
+                return false;
+            }
+            blob = (const char*)smol.data();
+            blobSize = smol.size();
+        }
+
+        assert_invariant((intptr_t(blob) % 8) == 0);
+
+        size_t const spirvSize = smolv::GetDecodedBufferSize(blob, blobSize);
+        if (spirvSize == 0) {
+            return false;
+        }
+        spirv.reserve(spirvSize);
+        spirv.resize(spirvSize);
+        return smolv::Decode(blob, blobSize, spirv.data(), spirvSize);
+    }
+};
+
+#endif
+
 bool DictionaryReader::unflatten(ChunkContainer const& container,
         ChunkContainer::Type dictionaryTag,
         BlobDictionary& dictionary) {
@@ -38,46 +122,37 @@ bool DictionaryReader::unflatten(ChunkContainer const& container,
     Unflattener unflattener(start, end);
 
     if (dictionaryTag == ChunkType::DictionarySpirv) {
-        uint32_t compressionScheme;
-        if (!unflattener.read(&compressionScheme)) {
+#if defined (FILAMENT_DRIVER_SUPPORTS_VULKAN)
+        SpirvDecoder decoder;
+        if (!decoder.readHeader(unflattener)) {
             return false;
         }
-        // For now, 1 is the only acceptable compression scheme.
-        assert(compressionScheme == 1);
 
         uint32_t blobCount;
         if (!unflattener.read(&blobCount)) {
             return false;
         }
 
+        ZSTD_DCtx* const dctx = decoder.compressionScheme == 2 ? ZSTD_createDCtx() : nullptr;
+        bool success = true;
         dictionary.reserve(blobCount);
-        for (uint32_t i = 0; i < blobCount; i++) {
+        for (uint32_t i = 0; success && i < blobCount; i++) {
             unflattener.skipAlignmentPadding();
 
             const char* compressed;
             size_t compressedSize;
-            if (!unflattener.read(&compressed, &compressedSize)) {
-                return false;
-            }
-
-            assert_invariant((intptr_t(compressed) % 8) == 0);
-
-#if defined (FILAMENT_DRIVER_SUPPORTS_VULKAN)
-            size_t spirvSize = smolv::GetDecodedBufferSize(compressed, compressedSize);
-            if (spirvSize == 0) {
-                return false;
-            }
-            ShaderContent spirv(spirvSize);
-            if (!smolv::Decode(compressed, compressedSize, spirv.data(), spirvSize)) {
-                return false;
+            ShaderContent spirv;
+            success = unflattener.read(&compressed, &compressedSize) &&
+                    decoder.decode(dctx, compressed, compressedSize, spirv);
+            if (success) {
+                dictionary.emplace_back(std::move(spirv));
             }
-            dictionary.emplace_back(std::move(spirv));
+        }
+        ZSTD_freeDCtx(dctx);
+        return success;
 #else
-            return false;
+        return false;
 #endif
-
-        }
-        return true;
     } else if (dictionaryTag == ChunkType::DictionaryMetalLibrary) {
         uint32_t blobCount;
         if (!unflattener.read(&blobCount)) {
@@ -120,4 +195,122 @@ bool DictionaryReader::unflatten(ChunkContainer const& container,
     return false;
 }
 
+// Decoded SPIR-V blobs. Variants often share blobs, and several threads may request the same
+// blob, so each one is decoded once, under the lock, and copied out afterwards.
+struct LazyBlobDictionary::DecodedCache {
+    std::mutex lock;
+    std::vector<ShaderContent> contents;
+    std::vector<bool> decoded;
+    size_t decodedCount = 0;
+};
+
+bool DictionaryReader::unflatten(ChunkContainer const& container,
+        ChunkContainer::Type dictionaryTag,
+        LazyBlobDictionary& dictionary) {
+
+    auto [start, end] = container.getChunkRange(dictionaryTag);
+    Unflattener unflattener(start, end);
+
+    dictionary.mType = dictionaryTag;
+
+    if (dictionaryTag == ChunkType::DictionarySpirv ||
+            dictionaryTag == ChunkType::DictionaryMetalLibrary) {
+        if (dictionaryTag == ChunkType::DictionarySpirv) {
+#if defined (FILAMENT_DRIVER_SUPPORTS_VULKAN)
+            auto decoder = std::make_shared<SpirvDecoder>();
+            if (!decoder->readHeader(unflattener)) {
+                return false;
+            }
+            dictionary.mSpirvDecoder = std::move(decoder);
+#else
+            return false;
+#endif
+        }
+
+        uint32_t blobCount;
+        if (!unflattener.read(&blobCount)) {
+            return false;
+        }
+
+        dictionary.mBlobs.reserve(blobCount);
+        for (uint32_t i = 0; i < blobCount; i++) {
+            unflattener.skipAlignmentPadding();
+
+            const char* data;
+            size_t dataSize;
+            if (!unflattener.read(&data, &dataSize)) {
+                return false;
+            }
+            dictionary.mBlobs.push_back({ (uint8_t const*)data, dataSize });
+        }
+
+        if (dictionaryTag == ChunkType::DictionarySpirv) {
+            auto cache = std::make_shared<LazyBlobDictionary::DecodedCache>();
+            cache->contents.resize(blobCount);
+            cache->decoded.resize(blobCount, false);
+            dictionary.mDecodedCache = std::move(cache);
+        }
+        return true;
+    } else if (dictionaryTag == ChunkType::DictionaryText) {
+        uint32_t stringCount = 0;
+        if (!unflattener.read(&stringCount)) {
+            return false;
+        }
+
+        dictionary.mBlobs.reserve(stringCount);
+        for (uint32_t i = 0; i < stringCount; i++) {
+            const char* str;
+            if (!unflattener.read(&str)) {
+                return false;
+            }
+            // like BlobDictionary, include the trailing null
+            dictionary.mBlobs.push_back({ (uint8_t const*)str, strlen(str) + 1 });
+        }
+        return true;
+    }
+
+    return false;
+}
+
+bool LazyBlobDictionary::get(size_t index, ShaderContent& content) const noexcept {
+    if (index >= mBlobs.size()) {
+        return false;
+    }
+
+    Blob const& blob = mBlobs[index];
+    if (mType == ChunkType::DictionarySpirv) {
+#if defined (FILAMENT_DRIVER_SUPPORTS_VULKAN)
+        DecodedCache& cache = *mDecodedCache;
+        std::lock_guard const guard(cache.lock);
+        ShaderContent& decoded = cache.contents[index];
+        if (!cache.decoded[index]) {
+            if (!mSpirvDecoder->decode(nullptr, (const char*)blob.start, blob.length, decoded)) {
+                return false;
+            }
+            cache.decoded[index] = true;
+            cache.decodedCount++;
+        }
+        content.reserve(decoded.size());
+        content.resize(decoded.size());
+        memcpy(content.data(), decoded.data(), decoded.size());
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    content.reserve(blob.length);
+    content.resize(blob.length);
+    memcpy(content.data(), blob.start, blob.length);
+    return true;
+}
+
+size_t LazyBlobDictionary::getDecodedCount() const noexcept {
+    if (!mDecodedCache) {
+        return 0;
+    }
+    std::lock_guard const guard(mDecodedCache->lock);
+    return mDecodedCache->decodedCount;
+}
+
 } // namespace filaflat
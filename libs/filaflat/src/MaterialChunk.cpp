@@ -16,6 +16,7 @@
 
 #include <filaflat/MaterialChunk.h>
 #include <filaflat/ChunkContainer.h>
+#include <filaflat/DictionaryReader.h>
 
 #include <backend/DriverEnums.h>
 
@@ -95,8 +96,9 @@ bool MaterialChunk::initialize(filamat::ChunkType materialTag) {
     return true;
 }
 
+template<typename Dictionary>
 bool MaterialChunk::getTextShader(Unflattener unflattener,
-        BlobDictionary const& dictionary, ShaderContent& shaderContent,
+        Dictionary const& dictionary, ShaderContent& shaderContent,
         ShaderModel shaderModel, Variant variant, ShaderStage shaderStage) {
     if (mBase == nullptr) {
         return false;
@@ -153,7 +155,18 @@ bool MaterialChunk::getTextShader(Unflattener unflattener,
     return true;
 }
 
-bool MaterialChunk::getBinaryShader(BlobDictionary const& dictionary,
+static bool getBlob(BlobDictionary const& dictionary, size_t index, ShaderContent& shaderContent) {
+    shaderContent = dictionary[index];
+    return true;
+}
+
+static bool getBlob(LazyBlobDictionary const& dictionary, size_t index,
+        ShaderContent& shaderContent) {
+    return dictionary.get(index, shaderContent);
+}
+
+template<typename Dictionary>
+bool MaterialChunk::getBinaryShader(Dictionary const& dictionary,
         ShaderContent& shaderContent, ShaderModel shaderModel, filament::Variant variant, ShaderStage shaderStage) {
 
     if (mBase == nullptr) {
@@ -166,8 +179,7 @@ bool MaterialChunk::getBinaryShader(BlobDictionary const& dictionary,
         return false;
     }
 
-    shaderContent = dictionary[pos->second];
-    return true;
+    return getBlob(dictionary, pos->second, shaderContent);
 }
 
 bool MaterialChunk::hasShader(ShaderModel model, Variant variant, ShaderStage stage) const noexcept {
@@ -180,6 +192,17 @@ bool MaterialChunk::hasShader(ShaderModel model, Variant variant, ShaderStage st
 
 bool MaterialChunk::getShader(ShaderContent& shaderContent, BlobDictionary const& dictionary,
         ShaderModel shaderModel, filament::Variant variant, ShaderStage stage) {
+    return getShaderImpl(shaderContent, dictionary, shaderModel, variant, stage);
+}
+
+bool MaterialChunk::getShader(ShaderContent& shaderContent, LazyBlobDictionary const& dictionary,
+        ShaderModel shaderModel, filament::Variant variant, ShaderStage stage) {
+    return getShaderImpl(shaderContent, dictionary, shaderModel, variant, stage);
+}
+
+template<typename Dictionary>
+bool MaterialChunk::getShaderImpl(ShaderContent& shaderContent, Dictionary const& dictionary,
+        ShaderModel shaderModel, filament::Variant variant, ShaderStage stage) {
     switch (mMaterialTag) {
         case filamat::ChunkType::MaterialGlsl:
         case filamat::ChunkType::MaterialEssl1:
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filamat/MaterialBuilder.h>
+#include <filamat/Package.h>
+
+#include <filaflat/ChunkContainer.h>
+#include <filaflat/DictionaryReader.h>
+#include <filaflat/MaterialChunk.h>
+
+#include <filament/MaterialChunkType.h>
+
+#include <utils/JobSystem.h>
+
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace filamat;
+using namespace utils;
+
+using ShaderModel = filament::backend::ShaderModel;
+using ShaderStage = filament::backend::ShaderStage;
+
+/*
+ * Cost of loading every SPIR-V shader of a lit material, when the dictionary is only smol-v
+ * encoded (state.range(0) == 0), or also zstd compressed (state.range(0) == 1). The package
+ * size is reported as a counter.
+ */
+class SpirvDictionaryFixture : public benchmark::Fixture {
+protected:
+    // building the material dominates, so each package is only built once
+    static Package const& getPackage(bool compress) {
+        static std::map<bool, Package> packages;
+        auto pos = packages.find(compress);
+        if (pos == packages.end()) {
+            JobSystem js;
+            js.adopt();
+            MaterialBuilder::init();
+            MaterialBuilder builder;
+            builder.name("benchmark")
+                    .targetApi(MaterialBuilder::TargetApi::VULKAN)
+                    .shading(MaterialBuilder::Shading::LIT)
+                    .compressSpirv(compress)
+                    .material(R"(
+                        void material(inout MaterialInputs material) {
+                            prepareMaterial(material);
+                            material.baseColor = vec4(0.8, 0.2, 0.2, 1.0);
+                            material.roughness = 0.5;
+                        }
+                    )");
+            pos = packages.emplace(compress, builder.build(js)).first;
+            MaterialBuilder::shutdown();
+            js.emancipate();
+        }
+        return pos->second;
+    }
+
+    Package const* package = nullptr;
+    std::unique_ptr<filaflat::ChunkContainer> container;
+    std::vector<std::tuple<ShaderModel, filament::Variant, ShaderStage>> shaders;
+
+public:
+    void SetUp(benchmark::State const& state) override {
+        package = &getPackage(state.range(0) != 0);
+        container = std::make_unique<filaflat::ChunkContainer>(
+                package->getData(), package->getSize());
+        container->parse();
+        filaflat::MaterialChunk chunk(*container);
+        chunk.initialize(ChunkType::MaterialSpirv);
+        chunk.visitShaders([this](ShaderModel model, filament::Variant variant, ShaderStage stage) {
+            shaders.emplace_back(model, variant, stage);
+        });
+    }
+
+    void TearDown(benchmark::State const&) override {
+        shaders.clear();
+        container.reset();
+        package = nullptr;
+    }
+};
+
+// Lazy path used by filament: parse the dictionary, then decode each variant when requested.
+BENCHMARK_DEFINE_F(SpirvDictionaryFixture, decodeVariants)(benchmark::State& state) {
+    filaflat::ShaderContent content;
+    for (auto _ : state) {
+        filaflat::LazyBlobDictionary dictionary;
+        filaflat::DictionaryReader::unflatten(*container, ChunkType::DictionarySpirv, dictionary);
+        filaflat::MaterialChunk chunk(*container);
+        chunk.initialize(ChunkType::MaterialSpirv);
+        for (auto const& [model, variant, stage] : shaders) {
+            chunk.getShader(content, dictionary, model, variant, stage);
+            benchmark::DoNotOptimize(content.data());
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * shaders.size()));
+    state.counters["package"] = double(package->getSize());
+}
+
+// Eager path used by the tools: decode the whole dictionary.
+BENCHMARK_DEFINE_F(SpirvDictionaryFixture, unflattenDictionary)(benchmark::State& state) {
+    for (auto _ : state) {
+        filaflat::BlobDictionary dictionary;
+        filaflat::DictionaryReader::unflatten(*container, ChunkType::DictionarySpirv, dictionary);
+        benchmark::DoNotOptimize(dictionary.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * shaders.size()));
+    state.counters["package"] = double(package->getSize());
+}
+
+BENCHMARK_REGISTER_F(SpirvDictionaryFixture, decodeVariants)
+        ->ArgName("zstd")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(SpirvDictionaryFixture, unflattenDictionary)
+        ->ArgName("zstd")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
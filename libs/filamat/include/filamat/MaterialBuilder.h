@@ -23,6 +23,7 @@
 
 #include <filamat/IncludeCallback.h>
 #include <filamat/Package.h>
+#include <filamat/ShaderCache.h>
 
 #include <backend/DriverEnums.h>
 #include <backend/TargetBufferInfo.h>
@@ -136,6 +137,7 @@ protected:
     bool mPrintShaders = false;
     bool mSaveRawVariants = false;
     bool mGenerateDebugInfo = false;
+    bool mCompressSpirv = false;
     bool mIncludeEssl1 = true;
     utils::bitset32 mShaderModels;
     struct CodeGenParams {
@@ -373,6 +375,13 @@ public:
      */
     MaterialBuilder& includeCallback(IncludeCallback callback) noexcept;
 
+    /**
+     * Set the cache used to skip the post-processing of shaders that were already compiled with
+     * the same source and settings, typically by a previous build of this material. The cache
+     * must outlive the call to build(). The default is no cache.
+     */
+    MaterialBuilder& shaderCache(ShaderCache* cache) noexcept;
+
     /**
      * Set the vertex code content of this material.
      *
@@ -601,6 +610,13 @@ public:
     //! If true, will include debugging information in generated SPIRV.
     MaterialBuilder& generateDebugInfo(bool generateDebugInfo) noexcept;
 
+    /**
+     * If true, the SPIRV shaders are compressed with zstd, using a dictionary trained on this
+     * material's shaders and stored in the package. This typically makes the package much
+     * smaller, at the cost of a decompression when a shader is loaded. The default is false.
+     */
+    MaterialBuilder& compressSpirv(bool compressSpirv) noexcept;
+
     //! Specifies a list of variants that should be filtered out during code generation.
     MaterialBuilder& variantFilter(filament::UserVariantFilterMask variantFilter) noexcept;
 
@@ -627,6 +643,9 @@ public:
     /**
      * Build the material. If you are using the Filament engine with this library, you should use
      * the job system provided by Engine.
+     *
+     * Once a first material has been built, several MaterialBuilders can build concurrently,
+     * including from jobs of the same JobSystem.
      */
     Package build(utils::JobSystem& jobSystem) noexcept;
 
@@ -855,6 +874,7 @@ private:
     ShaderCode mMaterialVertexCode;
 
     IncludeCallback mIncludeCallback = nullptr;
+    ShaderCache* mShaderCache = nullptr;
 
     PropertyList mProperties;
     ParameterList mParameters;
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMAT_SHADERCACHE_H
+#define TNT_FILAMAT_SHADERCACHE_H
+
+#include <utils/compiler.h>
+
+#include <string_view>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filamat {
+
+/**
+ * A cache of post-processed shaders, see MaterialBuilder::shaderCache().
+ *
+ * Post-processing a generated shader (optimization, SPIR-V and MSL generation) is by far the
+ * most expensive part of building a material. MaterialBuilder looks up each variant in the cache
+ * before post-processing it, using a key that is a hash of everything the result depends on:
+ * the generated source, the compilation settings and the versions of the shader toolchain
+ * (glslang, SPIRV-Tools, SPIRV-Cross and filamat's own optimizer configuration). Entries are
+ * never invalidated: after a change to any of these, the old entries are simply never asked for
+ * again. Implementations that store entries persistently should evict them eventually, e.g. by
+ * age.
+ *
+ * Both methods are called concurrently from the JobSystem's threads, implementations must be
+ * thread-safe.
+ */
+class UTILS_PUBLIC ShaderCache {
+public:
+    virtual ~ShaderCache() noexcept;
+
+    /**
+     * Retrieves an entry.
+     *
+     * @param key   a 32 characters hexadecimal string.
+     * @param data  receives the entry's content.
+     * @return      true if the entry was found.
+     */
+    virtual bool get(std::string_view key, std::vector<uint8_t>& data) noexcept = 0;
+
+    /**
+     * Stores an entry, replacing any entry with the same key.
+     *
+     * @param key   a 32 characters hexadecimal string.
+     * @param data  the entry's content.
+     * @param size  size of data in bytes.
+     */
+    virtual void put(std::string_view key, uint8_t const* data, size_t size) noexcept = 0;
+};
+
+} // namespace filamat
+
+#endif // TNT_FILAMAT_SHADERCACHE_H
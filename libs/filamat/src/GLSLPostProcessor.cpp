@@ -20,6 +20,7 @@
 #include <SPVRemapper.h>
 #include <spirv-tools/libspirv.hpp>
 
+#include <spirv_cross_c.h>
 #include <spirv_glsl.hpp>
 #include <spirv_msl.hpp>
 
@@ -301,6 +302,17 @@ GLSLPostProcessor::GLSLPostProcessor(MaterialBuilder::Optimization optimization,
 
 GLSLPostProcessor::~GLSLPostProcessor() = default;
 
+std::string const& GLSLPostProcessor::getToolchainVersion() noexcept {
+    static std::string const version =
+            std::to_string(POST_PROCESSOR_REVISION) + ':' +
+            GetGlslVersionString() + ':' +
+            spvSoftwareVersionDetailsString() + ':' +
+            std::to_string(SPVC_C_API_VERSION_MAJOR) + '.' +
+            std::to_string(SPVC_C_API_VERSION_MINOR) + '.' +
+            std::to_string(SPVC_C_API_VERSION_PATCH);
+    return version;
+}
+
 static bool filterSpvOptimizerMessage(spv_message_level_t level) {
 #ifdef NDEBUG
     // In release builds, only log errors.
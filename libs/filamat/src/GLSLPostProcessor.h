@@ -83,6 +83,11 @@ public:
             SpirvBlob* outputSpirv,
             std::string* outputMsl);
 
+    // Identifies the toolchain the output depends on: the versions of glslang, SPIRV-Tools and
+    // SPIRV-Cross, and POST_PROCESSOR_REVISION for the optimizer passes and cross-compiler
+    // options chosen here. Used in ShaderCache keys.
+    static std::string const& getToolchainVersion() noexcept;
+
     // public so backend_test can also use it
     static void spirvToMsl(const SpirvBlob* spirv, std::string* outMsl,
             filament::backend::ShaderStage stage, filament::backend::ShaderModel shaderModel,
@@ -121,6 +126,10 @@ private:
 
     void fixupClipDistance(SpirvBlob& spirv, GLSLPostProcessor::Config const& config) const;
 
+    // Must be incremented when the optimizer passes or the cross-compiler options change, so that
+    // shaders cached with the previous settings aren't used.
+    static constexpr uint32_t POST_PROCESSOR_REVISION = 1;
+
     const MaterialBuilder::Optimization mOptimization;
     const bool mPrintShaders;
     const bool mGenerateDebugInfo;
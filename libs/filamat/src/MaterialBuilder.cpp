@@ -61,6 +61,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <string>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -69,6 +70,8 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdio.h>
+#include <string.h>
 
 namespace filamat {
 
@@ -222,6 +225,13 @@ MaterialBuilder& MaterialBuilder::includeCallback(IncludeCallback callback) noex
     return *this;
 }
 
+ShaderCache::~ShaderCache() noexcept = default;
+
+MaterialBuilder& MaterialBuilder::shaderCache(ShaderCache* cache) noexcept {
+    mShaderCache = cache;
+    return *this;
+}
+
 MaterialBuilder& MaterialBuilder::materialVertex(const char* code, size_t line) noexcept {
     mMaterialVertexCode.setUnresolved(CString(code));
     mMaterialVertexCode.setLineOffset(line);
@@ -582,6 +592,11 @@ MaterialBuilder& MaterialBuilder::generateDebugInfo(bool generateDebugInfo) noex
     return *this;
 }
 
+MaterialBuilder& MaterialBuilder::compressSpirv(bool compressSpirv) noexcept {
+    mCompressSpirv = compressSpirv;
+    return *this;
+}
+
 MaterialBuilder& MaterialBuilder::variantFilter(UserVariantFilterMask variantFilter) noexcept {
     mVariantFilter = variantFilter;
     return *this;
@@ -856,6 +871,59 @@ static void showErrorMessage(const char* materialName, filament::Variant variant
             << shaderCode;
 }
 
+// Returns the ShaderCache key of a post-processed shader, i.e. a hash of everything the
+// post-processing depends on: the toolchain, the generated source, the configuration and the
+// part of MaterialInfo used by GLSLPostProcessor.
+static std::string getShaderCacheKey(std::string const& shader,
+        GLSLPostProcessor::Config const& config, MaterialBuilder::Optimization optimization,
+        uint32_t flags) noexcept {
+    MaterialInfo const& info = *config.materialInfo;
+    std::string desc;
+    desc += GLSLPostProcessor::getToolchainVersion() + ':';
+    desc += std::to_string(MATERIAL_VERSION) + ':';
+    desc += std::to_string(config.variant.key) + ':';
+    desc += std::to_string(config.variantFilter) + ':';
+    desc += std::to_string(uint32_t(config.targetApi)) + ':';
+    desc += std::to_string(uint32_t(config.targetLanguage)) + ':';
+    desc += std::to_string(uint32_t(config.shaderType)) + ':';
+    desc += std::to_string(uint32_t(config.shaderModel)) + ':';
+    desc += std::to_string(uint32_t(config.featureLevel)) + ':';
+    desc += std::to_string(uint32_t(config.domain)) + ':';
+    desc += std::to_string(config.hasFramebufferFetch) + ':';
+    desc += std::to_string(config.usesClipDistance) + ':';
+    for (auto const& [input, location] : config.glsl.subpassInputToColorLocation) {
+        desc += std::to_string(input) + '>' + std::to_string(location) + ':';
+    }
+    desc += std::to_string(uint32_t(optimization)) + ':';
+    desc += std::to_string(flags) + ':';
+    desc += std::to_string(info.isLit) + ':';
+    desc += std::to_string(info.hasShadowMultiplier) + ':';
+    desc += std::to_string(uint32_t(info.reflectionMode)) + ':';
+    desc += std::to_string(uint32_t(info.refractionMode)) + ':';
+    desc += std::to_string(uint32_t(info.stereoscopicType)) + ':';
+    desc += std::to_string(info.stereoscopicEyeCount) + ':';
+    for (auto const& sampler : info.sib.getSamplerInfoList()) {
+        desc += sampler.name.c_str_safe();
+        desc += ':';
+        desc += sampler.uniformName.c_str_safe();
+        desc += ':' + std::to_string(sampler.binding);
+        desc += ':' + std::to_string(uint32_t(sampler.type));
+        desc += ':' + std::to_string(uint32_t(sampler.format));
+        desc += ':' + std::to_string(uint32_t(sampler.precision));
+        desc += ':' + std::to_string(sampler.multisample) + ':';
+    }
+    desc += shader;
+
+    char key[33];
+    auto const* const data = reinterpret_cast<uint8_t const*>(desc.data());
+    snprintf(key, sizeof(key), "%08x%08x%08x%08x",
+            hash::murmurSlow(data, desc.size(), 0x5d1b3f4a),
+            hash::murmurSlow(data, desc.size(), 0x2c9e8d17),
+            hash::murmurSlow(data, desc.size(), 0x7f4a7c15),
+            hash::murmurSlow(data, desc.size(), 0x1b873593));
+    return key;
+}
+
 bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Variant>& variants,
         ChunkContainer& container, const MaterialInfo& info) const noexcept {
     // Create a postprocessor to optimize / compile to Spir-V if necessary.
@@ -882,36 +950,40 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
 
     container.emplace<bool>(ChunkType::MaterialHasCustomDepthShader, needsStandardDepthProgram());
 
+    // Printed shaders come from the post-processor, so the cache is bypassed.
+    ShaderCache* const shaderCache = mPrintShaders ? nullptr : mShaderCache;
+
     std::atomic_bool cancelJobs(false);
     bool firstJob = true;
 
+    // The jobs of all the code generation permutations are pipelined, we only wait for all of
+    // them at the end.
+    JobSystem::Job* parent = jobSystem.createJob();
+
     for (const auto& params : mCodeGenPermutations) {
         if (cancelJobs.load()) {
-            return false;
+            break;
         }
 
-        const ShaderModel shaderModel = ShaderModel(params.shaderModel);
-        const TargetApi targetApi = params.targetApi;
-        const TargetLanguage targetLanguage = params.targetLanguage;
-        const FeatureLevel featureLevel = params.featureLevel;
-
-        assertSingleTargetApi(targetApi);
-
-        // Metal Shading Language is cross-compiled from Vulkan.
-        const bool targetApiNeedsSpirv =
-                (targetApi == TargetApi::VULKAN || targetApi == TargetApi::METAL);
-        const bool targetApiNeedsMsl = targetApi == TargetApi::METAL;
-        const bool targetApiNeedsGlsl = targetApi == TargetApi::OPENGL;
-
-        // Set when a job fails
-        JobSystem::Job* parent = jobSystem.createJob();
+        assertSingleTargetApi(params.targetApi);
 
         for (const auto& v : variants) {
-            JobSystem::Job* job = jobs::createJob(jobSystem, parent, [&]() {
+            JobSystem::Job* job = jobs::createJob(jobSystem, parent, [&, params, v]() {
                 if (cancelJobs.load()) {
                     return;
                 }
 
+                const ShaderModel shaderModel = ShaderModel(params.shaderModel);
+                const TargetApi targetApi = params.targetApi;
+                const TargetLanguage targetLanguage = params.targetLanguage;
+                const FeatureLevel featureLevel = params.featureLevel;
+
+                // Metal Shading Language is cross-compiled from Vulkan.
+                const bool targetApiNeedsSpirv =
+                        (targetApi == TargetApi::VULKAN || targetApi == TargetApi::METAL);
+                const bool targetApiNeedsMsl = targetApi == TargetApi::METAL;
+                const bool targetApiNeedsGlsl = targetApi == TargetApi::OPENGL;
+
                 // TODO: avoid allocations when not required
                 std::vector<uint32_t> spirv;
                 std::string msl;
@@ -998,21 +1070,71 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
                     config.glsl.subpassInputToColorLocation.emplace_back(0, 0);
                 }
 
-                bool const ok = postProcessor.process(shader, config, pGlsl, pSpirv, pMsl);
-                if (!ok) {
-                    showErrorMessage(mMaterialName.c_str_safe(), v.variant, targetApi, v.stage,
-                                     featureLevel, shader);
-                    cancelJobs = true;
-                    if (mPrintShaders) {
-                        slog.e << shader << io::endl;
+                // Look up the post-processed shader in the cache, its content depends on the
+                // target API: GLSL or MSL source, or SPIR-V binary.
+                std::string cacheKey;
+                bool cached = false;
+                if (shaderCache) {
+                    cacheKey = getShaderCacheKey(shader, config, mOptimization, flags);
+                    std::vector<uint8_t> data;
+                    if (shaderCache->get(cacheKey, data)) {
+                        cached = true;
+                        switch (targetApi) {
+                            case TargetApi::ALL:
+                                break;
+                            case TargetApi::OPENGL:
+                                shader.assign(data.begin(), data.end());
+                                break;
+                            case TargetApi::VULKAN:
+                                spirv.resize(data.size() / sizeof(uint32_t));
+                                memcpy(spirv.data(), data.data(), spirv.size() * sizeof(uint32_t));
+                                break;
+                            case TargetApi::METAL:
+                                msl.assign(data.begin(), data.end());
+                                break;
+                        }
                     }
-                    return;
                 }
 
-                if (targetApi == TargetApi::OPENGL) {
-                    if (targetLanguage == TargetLanguage::SPIRV) {
-                        ShaderGenerator::fixupExternalSamplers(shaderModel, shader, featureLevel,
-                                info);
+                if (!cached) {
+                    bool const ok = postProcessor.process(shader, config, pGlsl, pSpirv, pMsl);
+                    if (!ok) {
+                        showErrorMessage(mMaterialName.c_str_safe(), v.variant, targetApi,
+                                v.stage, featureLevel, shader);
+                        cancelJobs = true;
+                        if (mPrintShaders) {
+                            slog.e << shader << io::endl;
+                        }
+                        return;
+                    }
+
+                    if (targetApi == TargetApi::OPENGL) {
+                        if (targetLanguage == TargetLanguage::SPIRV) {
+                            ShaderGenerator::fixupExternalSamplers(shaderModel, shader,
+                                    featureLevel, info);
+                        }
+                    }
+
+                    if (shaderCache) {
+                        switch (targetApi) {
+                            case TargetApi::ALL:
+                                break;
+                            case TargetApi::OPENGL:
+                                shaderCache->put(cacheKey,
+                                        reinterpret_cast<uint8_t const*>(shader.data()),
+                                        shader.size());
+                                break;
+                            case TargetApi::VULKAN:
+                                shaderCache->put(cacheKey,
+                                        reinterpret_cast<uint8_t const*>(spirv.data()),
+                                        spirv.size() * sizeof(uint32_t));
+                                break;
+                            case TargetApi::METAL:
+                                shaderCache->put(cacheKey,
+                                        reinterpret_cast<uint8_t const*>(msl.data()),
+                                        msl.size());
+                                break;
+                        }
                     }
                 }
 
@@ -1047,7 +1169,7 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
                         break;
                     }
                     case TargetApi::METAL:
-                        assert(!spirv.empty());
+                        assert(cached || !spirv.empty());
                         assert(msl.length() > 0);
                         metalEntry.stage = v.stage;
                         metalEntry.shader = msl;
@@ -1066,10 +1188,10 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
                 jobSystem.run(job);
             }
         }
-
-        jobSystem.runAndWait(parent);
     }
 
+    jobSystem.runAndWait(parent);
+
     if (cancelJobs.load()) {
         return false;
     }
@@ -1087,20 +1209,30 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
     std::sort(spirvEntries.begin(), spirvEntries.end(), compare);
     std::sort(metalEntries.begin(), metalEntries.end(), compare);
 
-    // Generate the dictionaries.
+    // Generate the dictionaries, the SPIR-V dictionary is built in a job while the text
+    // dictionary is built on this thread.
+    JobSystem::Job* spirvDictionaryJob = nullptr;
+    if (!spirvEntries.empty()) {
+        spirvDictionaryJob = jobSystem.runAndRetain(jobs::createJob(jobSystem, nullptr,
+                [&spirvEntries, &spirvDictionary]() {
+                    for (auto& s : spirvEntries) {
+                        std::vector<uint8_t> spirv = std::move(s.data);
+                        s.dictionaryIndex = spirvDictionary.addBlob(spirv);
+                    }
+                }));
+    }
     for (const auto& s : glslEntries) {
         textDictionary.addText(s.shader);
     }
     for (const auto& s : essl1Entries) {
         textDictionary.addText(s.shader);
     }
-    for (auto& s : spirvEntries) {
-        std::vector<uint8_t> spirv = std::move(s.data);
-        s.dictionaryIndex = spirvDictionary.addBlob(spirv);
-    }
     for (const auto& s : metalEntries) {
         textDictionary.addText(s.shader);
     }
+    if (spirvDictionaryJob) {
+        jobSystem.waitAndRelease(spirvDictionaryJob);
+    }
 
     // Emit dictionary chunk (TextDictionaryReader and DictionaryTextChunk)
     const auto& dictionaryChunk = container.push<filamat::DictionaryTextChunk>(
@@ -1121,7 +1253,8 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
     // Emit SPIRV chunks (SpirvDictionaryReader and MaterialBinaryChunk).
     if (!spirvEntries.empty()) {
         const bool stripInfo = !mGenerateDebugInfo;
-        container.push<filamat::DictionarySpirvChunk>(std::move(spirvDictionary), stripInfo);
+        container.push<filamat::DictionarySpirvChunk>(std::move(spirvDictionary), stripInfo,
+                mCompressSpirv);
         container.push<MaterialBinaryChunk>(std::move(spirvEntries), ChunkType::MaterialSpirv);
     }
 
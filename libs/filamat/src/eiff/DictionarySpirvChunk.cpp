@@ -16,34 +16,108 @@
 
 #include "DictionarySpirvChunk.h"
 
-#include <smolv.h>
+#include <utils/Log.h>
 
-namespace filamat {
+#include <smolv.h>
+#include <zdict.h>
+#include <zstd.h>
 
-DictionarySpirvChunk::DictionarySpirvChunk(BlobDictionary&& dictionary, bool stripDebugInfo) :
-        Chunk(ChunkType::DictionarySpirv), mDictionary(std::move(dictionary)), mStripDebugInfo(stripDebugInfo) {
-}
+#include <algorithm>
+#include <numeric>
 
-void DictionarySpirvChunk::flatten(Flattener& f) {
+namespace filamat {
 
-    // For now, 1 is the only acceptable compression scheme.
-    f.writeUint32(1);
+DictionarySpirvChunk::DictionarySpirvChunk(BlobDictionary&& dictionary, bool stripDebugInfo,
+        bool compress) : Chunk(ChunkType::DictionarySpirv) {
 
     uint32_t flags = 0;
-    if (mStripDebugInfo) {
+    if (stripDebugInfo) {
         flags |= smolv::kEncodeFlagStripDebugInfo;
     }
 
-    f.writeUint32(mDictionary.getBlobCount());
-    for (size_t i = 0 ; i < mDictionary.getBlobCount() ; i++) {
-        std::string_view spirv = mDictionary.getBlob(i);
-        smolv::ByteArray compressed;
-        if (!smolv::Encode(spirv.data(), spirv.size(), compressed, flags)) {
+    std::vector<std::vector<uint8_t>> blobs(dictionary.getBlobCount());
+    for (size_t i = 0 ; i < dictionary.getBlobCount() ; i++) {
+        std::string_view spirv = dictionary.getBlob(i);
+        if (!smolv::Encode(spirv.data(), spirv.size(), blobs[i], flags)) {
             utils::slog.e << "Error with SPIRV compression" << utils::io::endl;
         }
+    }
+
+    if (compress) {
+        this->compress(blobs);
+    }
+    mBlobs = std::move(blobs);
+}
+
+void DictionarySpirvChunk::compress(std::vector<std::vector<uint8_t>>& blobs) {
+    // The dictionary is trained on the smol-v blobs themselves. It's kept to a tenth of their size,
+    // if training fails (e.g. too few blobs), they're compressed without a dictionary.
+    std::vector<uint8_t> samples;
+    std::vector<size_t> sampleSizes;
+    sampleSizes.reserve(blobs.size());
+    for (auto const& blob : blobs) {
+        samples.insert(samples.end(), blob.begin(), blob.end());
+        sampleSizes.push_back(blob.size());
+    }
+
+    constexpr size_t MAX_DICTIONARY_SIZE = 112640; // zstd's recommended size
+    std::vector<uint8_t> zstdDictionary(std::min(samples.size() / 10, MAX_DICTIONARY_SIZE));
+    if (!zstdDictionary.empty()) {
+        size_t const size = ZDICT_trainFromBuffer(zstdDictionary.data(), zstdDictionary.size(),
+                samples.data(), sampleSizes.data(), unsigned(sampleSizes.size()));
+        zstdDictionary.resize(ZDICT_isError(size) ? 0 : size);
+    }
+
+    // Maximum compression is affordable for shaders, except in debug builds.
+#ifdef NDEBUG
+    int const compressionLevel = ZSTD_maxCLevel();
+#else
+    int const compressionLevel = ZSTD_CLEVEL_DEFAULT;
+#endif
+
+    ZSTD_CCtx* const cctx = ZSTD_createCCtx();
+    ZSTD_CDict* const cdict = zstdDictionary.empty() ? nullptr :
+            ZSTD_createCDict(zstdDictionary.data(), zstdDictionary.size(), compressionLevel);
+
+    std::vector<std::vector<uint8_t>> compressed(blobs.size());
+    for (size_t i = 0; i < blobs.size(); i++) {
+        std::vector<uint8_t> const& blob = blobs[i];
+        compressed[i].resize(ZSTD_compressBound(blob.size()));
+        size_t const size = cdict ?
+                ZSTD_compress_usingCDict(cctx, compressed[i].data(), compressed[i].size(),
+                        blob.data(), blob.size(), cdict) :
+                ZSTD_compressCCtx(cctx, compressed[i].data(), compressed[i].size(),
+                        blob.data(), blob.size(), compressionLevel);
+        if (ZSTD_isError(size)) {
+            utils::slog.e << "Error with SPIRV compression: " << ZSTD_getErrorName(size)
+                    << utils::io::endl;
+            ZSTD_freeCDict(cdict);
+            ZSTD_freeCCtx(cctx);
+            return;
+        }
+        compressed[i].resize(size);
+    }
+
+    ZSTD_freeCDict(cdict);
+    ZSTD_freeCCtx(cctx);
+
+    mCompressionScheme = 2;
+    mZstdDictionary = std::move(zstdDictionary);
+    blobs = std::move(compressed);
+}
+
+void DictionarySpirvChunk::flatten(Flattener& f) {
+    // 1: smol-v, 2: smol-v + zstd, followed by the zstd dictionary
+    f.writeUint32(mCompressionScheme);
+    if (mCompressionScheme == 2) {
+        f.writeAlignmentPadding();
+        f.writeBlob((const char*) mZstdDictionary.data(), mZstdDictionary.size());
+    }
 
+    f.writeUint32(mBlobs.size());
+    for (auto const& blob : mBlobs) {
         f.writeAlignmentPadding();
-        f.writeBlob((const char*) compressed.data(), compressed.size());
+        f.writeBlob((const char*) blob.data(), blob.size());
     }
 }
 
@@ -28,14 +28,22 @@ namespace filamat {
 
 class DictionarySpirvChunk final : public Chunk {
 public:
-    explicit DictionarySpirvChunk(BlobDictionary&& dictionary, bool stripDebugInfo);
+    // Blobs are smol-v encoded. If compress is true, they're also compressed with zstd using a
+    // dictionary trained on them, which is stored in the chunk.
+    DictionarySpirvChunk(BlobDictionary&& dictionary, bool stripDebugInfo,
+            bool compress = false);
     ~DictionarySpirvChunk() = default;
 
 private:
     void flatten(Flattener& f) override;
 
-    BlobDictionary mDictionary;
-    bool mStripDebugInfo;
+    void compress(std::vector<std::vector<uint8_t>>& blobs);
+
+    uint32_t mCompressionScheme = 1;
+    std::vector<uint8_t> mZstdDictionary;
+    // Encoded blobs. Encoding happens in the constructor because flatten() runs twice, once
+    // as a dry run to compute the size.
+    std::vector<std::vector<uint8_t>> mBlobs;
 };
 
 } // namespace filamat
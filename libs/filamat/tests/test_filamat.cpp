@@ -25,9 +25,16 @@
 #include <filamat/Enums.h>
 #include <filamat/MaterialBuilder.h>
 
+#include <filaflat/ChunkContainer.h>
+#include <filaflat/DictionaryReader.h>
+#include <filaflat/MaterialChunk.h>
+
 #include <utils/JobSystem.h>
 
+#include <atomic>
 #include <memory>
+#include <thread>
+#include <vector>
 
 using namespace utils;
 using namespace ASTHelpers;
@@ -891,6 +898,122 @@ TEST_F(MaterialCompiler, FeatureLevel0Ess3CallFails) {
   EXPECT_FALSE(result.isValid());
 }
 
+#if defined(FILAMENT_DRIVER_SUPPORTS_VULKAN)
+
+TEST_F(MaterialCompiler, CompressedSpirvDictionary) {
+    std::string shaderCode(R"(
+        void material(inout MaterialInputs material) {
+            prepareMaterial(material);
+            material.baseColor = vec4(1.0, 0.0, 0.0, 1.0);
+        }
+    )");
+
+    auto build = [&](bool compress) {
+        filamat::MaterialBuilder builder;
+        builder.targetApi(MaterialBuilder::TargetApi::VULKAN);
+        builder.optimization(MaterialBuilder::Optimization::NONE);
+        builder.compressSpirv(compress);
+        builder.material(shaderCode.c_str());
+        return builder.build(*jobSystem);
+    };
+
+    filamat::Package const reference = build(false);
+    filamat::Package const compressed = build(true);
+    ASSERT_TRUE(reference.isValid());
+    ASSERT_TRUE(compressed.isValid());
+    EXPECT_LT(compressed.getSize(), reference.getSize());
+
+    filaflat::ChunkContainer referenceContainer(reference.getData(), reference.getSize());
+    filaflat::ChunkContainer compressedContainer(compressed.getData(), compressed.getSize());
+    ASSERT_TRUE(referenceContainer.parse());
+    ASSERT_TRUE(compressedContainer.parse());
+
+    filaflat::BlobDictionary referenceDictionary;
+    filaflat::BlobDictionary compressedDictionary;
+    filaflat::LazyBlobDictionary lazyDictionary;
+    ASSERT_TRUE(filaflat::DictionaryReader::unflatten(referenceContainer,
+            ChunkType::DictionarySpirv, referenceDictionary));
+    ASSERT_TRUE(filaflat::DictionaryReader::unflatten(compressedContainer,
+            ChunkType::DictionarySpirv, compressedDictionary));
+    ASSERT_TRUE(filaflat::DictionaryReader::unflatten(compressedContainer,
+            ChunkType::DictionarySpirv, lazyDictionary));
+
+    ASSERT_EQ(referenceDictionary.size(), compressedDictionary.size());
+    ASSERT_EQ(referenceDictionary.size(), lazyDictionary.size());
+    for (size_t i = 0; i < referenceDictionary.size(); i++) {
+        filaflat::ShaderContent const& expected = referenceDictionary[i];
+        filaflat::ShaderContent lazy;
+        ASSERT_TRUE(lazyDictionary.get(i, lazy));
+        ASSERT_EQ(expected.size(), compressedDictionary[i].size());
+        ASSERT_EQ(expected.size(), lazy.size());
+        EXPECT_EQ(0, memcmp(expected.data(), compressedDictionary[i].data(), expected.size()));
+        EXPECT_EQ(0, memcmp(expected.data(), lazy.data(), expected.size()));
+    }
+}
+
+TEST_F(MaterialCompiler, LazySpirvDictionaryDecodesOnce) {
+    std::string shaderCode(R"(
+        void material(inout MaterialInputs material) {
+            prepareMaterial(material);
+            material.baseColor = vec4(1.0, 0.0, 0.0, 1.0);
+        }
+    )");
+
+    filamat::MaterialBuilder builder;
+    builder.targetApi(MaterialBuilder::TargetApi::VULKAN);
+    builder.optimization(MaterialBuilder::Optimization::NONE);
+    builder.compressSpirv(true);
+    builder.material(shaderCode.c_str());
+    filamat::Package const package = builder.build(*jobSystem);
+    ASSERT_TRUE(package.isValid());
+
+    filaflat::ChunkContainer container(package.getData(), package.getSize());
+    ASSERT_TRUE(container.parse());
+
+    filaflat::BlobDictionary referenceDictionary;
+    filaflat::LazyBlobDictionary lazyDictionary;
+    ASSERT_TRUE(filaflat::DictionaryReader::unflatten(container,
+            ChunkType::DictionarySpirv, referenceDictionary));
+    ASSERT_TRUE(filaflat::DictionaryReader::unflatten(container,
+            ChunkType::DictionarySpirv, lazyDictionary));
+    ASSERT_GT(lazyDictionary.size(), 1u);
+
+    // nothing is decoded until it's requested
+    EXPECT_EQ(lazyDictionary.getDecodedCount(), 0u);
+    filaflat::ShaderContent content;
+    ASSERT_TRUE(lazyDictionary.get(0, content));
+    EXPECT_EQ(lazyDictionary.getDecodedCount(), 1u);
+    ASSERT_TRUE(lazyDictionary.get(0, content));
+    EXPECT_EQ(lazyDictionary.getDecodedCount(), 1u);
+
+    // all threads request all blobs, each blob is still decoded once
+    constexpr size_t THREAD_COUNT = 8;
+    std::atomic<size_t> mismatches = 0;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREAD_COUNT; t++) {
+        threads.emplace_back([&, t]() {
+            filaflat::ShaderContent content;
+            for (size_t j = 0; j < lazyDictionary.size(); j++) {
+                // start each thread at a different blob
+                size_t const i = (j + t) % lazyDictionary.size();
+                filaflat::ShaderContent const& expected = referenceDictionary[i];
+                if (!lazyDictionary.get(i, content) || content.size() != expected.size() ||
+                        memcmp(expected.data(), content.data(), expected.size()) != 0) {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_EQ(lazyDictionary.getDecodedCount(), lazyDictionary.size());
+}
+
+#endif
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filament/Engine.h>
+#include <filament/Texture.h>
+
+#include <gltfio/TextureProvider.h>
+
+#include <utils/Path.h>
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <fstream>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace filament;
+using namespace gltfio;
+using namespace utils;
+
+static char const* COLOR_GRID_KTX2 = "color_grid_uastc_zstd.ktx2";
+
+/*
+ * Time for the last of state.range(0) KTX2 textures to be popped when it has a higher priority
+ * than the others, compared to the average time for a texture to be popped. Both are reported as
+ * counters, in milliseconds.
+ */
+class Ktx2ProviderFixture : public benchmark::Fixture {
+protected:
+    Engine* engine = nullptr;
+    TextureProvider* provider = nullptr;
+    std::vector<uint8_t> file;
+
+public:
+    void SetUp(benchmark::State& state) override {
+        Path const path = Path::getCurrentExecutable().getParent() + Path(COLOR_GRID_KTX2);
+        std::ifstream in(path.c_str(), std::ifstream::ate | std::ifstream::binary);
+        if (!in) {
+            state.SkipWithError("unable to open color_grid_uastc_zstd.ktx2");
+            return;
+        }
+        file.resize(size_t(in.tellg()));
+        in.seekg(0);
+        in.read((char*) file.data(), std::streamsize(file.size()));
+
+        engine = Engine::create(Engine::Backend::NOOP);
+        provider = createKtx2Provider(engine);
+    }
+
+    void TearDown(benchmark::State&) override {
+        delete provider;
+        provider = nullptr;
+        Engine::destroy(&engine);
+        file.clear();
+    }
+};
+
+BENCHMARK_DEFINE_F(Ktx2ProviderFixture, timeToPop)(benchmark::State& state) {
+    using Clock = std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+    size_t const count = size_t(state.range(0));
+    ms prioritizedTotal{}, completeTotal{};
+
+    for (auto _ : state) {
+        Clock::time_point const start = Clock::now();
+        std::vector<Texture*> textures;
+        for (size_t i = 0; i < count; i++) {
+            textures.push_back(provider->pushTexture(file.data(), file.size(), "image/ktx2", {}));
+        }
+        Texture* const prioritized = textures.back();
+        provider->setPriority(prioritized, 1.0f);
+
+        size_t popped = 0;
+        while (popped < count) {
+            provider->updateQueue();
+            while (Texture* texture = provider->popTexture()) {
+                Clock::duration const elapsed = Clock::now() - start;
+                if (texture == prioritized) {
+                    prioritizedTotal += elapsed;
+                }
+                completeTotal += elapsed;
+                popped++;
+            }
+        }
+
+        for (Texture* texture : textures) {
+            engine->destroy(texture);
+        }
+    }
+
+    if (state.iterations() == 0) {
+        return;
+    }
+    double const textureCount = double(state.iterations() * count);
+    state.counters["prioritized"] = prioritizedTotal.count() / double(state.iterations());
+    state.counters["complete"] = completeTotal.count() / textureCount;
+    state.SetItemsProcessed(int64_t(state.iterations() * count));
+}
+
+BENCHMARK_REGISTER_F(Ktx2ProviderFixture, timeToPop)
+        ->ArgName("textures")->Arg(16)->Unit(benchmark::kMillisecond);
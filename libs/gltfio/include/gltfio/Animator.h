@@ -42,6 +42,10 @@ public:
      * Applies rotation, translation, and scale to entities that have been targeted by the given
      * animation definition. Uses filament::TransformManager.
      *
+     * Keyframes are evaluated once per glTF sampler for all instances. Animations targeting many
+     * nodes update them in parallel on the Engine's JobSystem, in which case this must be called
+     * from the Engine's thread, like other Engine APIs.
+     *
      * @param animationIndex Zero-based index for the \c animation of interest.
      * @param time Elapsed time of interest in seconds.
      */
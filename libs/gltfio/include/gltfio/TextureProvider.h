@@ -155,6 +155,25 @@ public:
      */
     virtual void cancelDecoding() = 0;
 
+    /**
+     * Sets the decoding priority of a texture that is still in the queue, e.g. its size on screen.
+     * Textures with a higher priority are decoded first, the default priority is 0.
+     *
+     * Providers that don't schedule their work can ignore this.
+     */
+    virtual void setPriority(Texture* texture, float priority) {}
+
+    /**
+     * Cancels the decoding of a single texture, e.g. when it's no longer visible.
+     *
+     * The work that has not started yet is discarded, and the texture becomes poppable as an
+     * incomplete texture on a subsequent call to updateQueue(). None of its miplevels are
+     * uploaded.
+     *
+     * Providers that can't cancel their work can ignore this.
+     */
+    virtual void cancelTexture(Texture* texture) {}
+
     /** Total number of successful push calls since the provider was created. */
     virtual size_t getPushedCount() const = 0;
 
@@ -176,6 +195,9 @@ TextureProvider* createStbProvider(filament::Engine* engine);
 /**
  * Creates a decoder that can handle certain types of "image/ktx2" content as specified in
  * the KHR_texture_basisu specification.
+ *
+ * Textures are transcoded one miplevel at a time, in priority order (see setPriority), and
+ * pending work can be cancelled. A texture is uploaded once all of its miplevels are transcoded.
  */
 TextureProvider* createKtx2Provider(filament::Engine* engine);
 
@@ -26,6 +26,7 @@
 #include <filament/RenderableManager.h>
 #include <filament/TransformManager.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Log.h>
 
 #include <math/mat4.h>
@@ -36,6 +37,7 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 using namespace filament;
@@ -61,11 +63,31 @@ struct Channel {
     enum { TRANSLATION, ROTATION, SCALE, WEIGHTS } transformType;
 };
 
+// Keyframe pair and interpolant of a Sampler at a given time.
+struct Keyframes {
+    size_t prevIndex;
+    size_t nextIndex;
+    float t;
+};
+
+// The channels of an Animation grouped by type. Channels of all the instances share the same
+// samplers, so TRS values are evaluated once per sampler and each node then picks its values by
+// index. Rebuilt lazily when channels are added.
+struct ChannelBatch {
+    static constexpr uint32_t NONE = UINT32_MAX;
+    vector<uint32_t> samplers[3];   // TRS samplers, indexed by Channel::transformType
+    vector<Entity> nodes;           // nodes targeted by TRS channels
+    vector<uint32_t> values[3];     // per node, index into samplers[type] or NONE
+    vector<uint32_t> weights;       // indices of WEIGHTS channels
+    bool dirty = true;
+};
+
 struct Animation {
     float duration;
     std::string name;
     vector<Sampler> samplers;
     vector<Channel> channels;
+    ChannelBatch batch;
 };
 
 struct AnimatorImpl {
@@ -78,9 +100,20 @@ struct AnimatorImpl {
     TrsTransformManager* trsTransformManager;
     vector<float> weights;
     FixedCapacityVector<mat4f> crossFade;
+
+    // scratch buffers for applyAnimation()
+    vector<Keyframes> keyframes;
+    vector<float3> translations;
+    vector<quatf> rotations;
+    vector<float3> scales;
+    vector<mat4f> transforms;
+    vector<TransformManager::Instance> nodes;
+
     void addChannels(const FixedCapacityVector<Entity>& nodeMap, const cgltf_animation& srcAnim,
             Animation& dst);
-    void applyAnimation(const Channel& channel, float t, size_t prevIndex, size_t nextIndex);
+    void createBatch(Animation& anim);
+    void applyAnimation(Animation& anim, float time);
+    void applyWeights(const Channel& channel, const Keyframes& keyframes);
     void stashCrossFade();
     void applyCrossFade(float alpha);
     void resetBoneMatrices(FFilamentInstance* instance);
@@ -160,6 +193,66 @@ static void setTransformType(const cgltf_animation_channel& src, Channel& dst) {
     }
 }
 
+static Keyframes findKeyframes(const Sampler& sampler, float time) {
+    const TimeValues& times = sampler.times;
+
+    // Find the first keyframe after the given time, or the keyframe that matches it exactly.
+    TimeValues::const_iterator iter = times.lower_bound(time);
+
+    // Compute the interpolant (between 0 and 1) and determine the keyframe pair.
+    Keyframes result{ 0, 0, 0.0f };
+    if (iter == times.end()) {
+        result.nextIndex = times.size() - 1;
+        result.prevIndex = result.nextIndex;
+    } else if (iter != times.begin()) {
+        TimeValues::const_iterator prev = iter; --prev;
+        result.nextIndex = iter->second;
+        result.prevIndex = prev->second;
+        const float nextTime = iter->first;
+        const float prevTime = prev->first;
+        float deltaTime = nextTime - prevTime;
+        assert(deltaTime >= 0);
+        if (deltaTime > 0) {
+            result.t = (time - prevTime) / deltaTime;
+        }
+    }
+
+    if (sampler.interpolation == Sampler::STEP) {
+        result.t = 0.0f;
+    }
+    return result;
+}
+
+static float3 evaluateFloat3(const Sampler& sampler, const Keyframes& keyframes) {
+    const float3* srcVec3 = (const float3*) sampler.values.data();
+    const size_t prevIndex = keyframes.prevIndex;
+    const size_t nextIndex = keyframes.nextIndex;
+    const float t = keyframes.t;
+    if (sampler.interpolation == Sampler::CUBIC) {
+        float3 vert0 = srcVec3[prevIndex * 3 + 1];
+        float3 tang0 = srcVec3[prevIndex * 3 + 2];
+        float3 tang1 = srcVec3[nextIndex * 3];
+        float3 vert1 = srcVec3[nextIndex * 3 + 1];
+        return cubicSpline(vert0, tang0, vert1, tang1, t);
+    }
+    return ((1 - t) * srcVec3[prevIndex]) + (t * srcVec3[nextIndex]);
+}
+
+static quatf evaluateQuat(const Sampler& sampler, const Keyframes& keyframes) {
+    const quatf* srcQuat = (const quatf*) sampler.values.data();
+    const size_t prevIndex = keyframes.prevIndex;
+    const size_t nextIndex = keyframes.nextIndex;
+    const float t = keyframes.t;
+    if (sampler.interpolation == Sampler::CUBIC) {
+        quatf vert0 = srcQuat[prevIndex * 3 + 1];
+        quatf tang0 = srcQuat[prevIndex * 3 + 2];
+        quatf tang1 = srcQuat[nextIndex * 3];
+        quatf vert1 = srcQuat[nextIndex * 3 + 1];
+        return normalize(cubicSpline(vert0, tang0, vert1, tang1, t));
+    }
+    return slerp(srcQuat[prevIndex], srcQuat[nextIndex], t);
+}
+
 static bool validateAnimation(const cgltf_animation& anim) {
     for (cgltf_size j = 0; j < anim.channels_count; ++j) {
         const cgltf_animation_channel& channel = anim.channels[j];
@@ -263,51 +356,9 @@ size_t Animator::getAnimationCount() const {
 }
 
 void Animator::applyAnimation(size_t animationIndex, float time) const {
-    const Animation& anim = mImpl->animations[animationIndex];
+    Animation& anim = mImpl->animations[animationIndex];
     time = time == anim.duration ? time : fmod(time, anim.duration);
-    TransformManager& transformManager = *mImpl->transformManager;
-    transformManager.openLocalTransformTransaction();
-    for (const auto& channel : anim.channels) {
-        const Sampler* sampler = channel.sourceData;
-        if (sampler->times.size() < 2) {
-            continue;
-        }
-
-        const TimeValues& times = sampler->times;
-
-        // Find the first keyframe after the given time, or the keyframe that matches it exactly.
-        TimeValues::const_iterator iter = times.lower_bound(time);
-
-        // Compute the interpolant (between 0 and 1) and determine the keyframe pair.
-        float t = 0.0f;
-        size_t nextIndex;
-        size_t prevIndex;
-        if (iter == times.end()) {
-            nextIndex = times.size() - 1;
-            prevIndex = nextIndex;
-        } else if (iter == times.begin()) {
-            nextIndex = 0;
-            prevIndex = 0;
-        } else {
-            TimeValues::const_iterator prev = iter; --prev;
-            nextIndex = iter->second;
-            prevIndex = prev->second;
-            const float nextTime = iter->first;
-            const float prevTime = prev->first;
-            float deltaTime = nextTime - prevTime;
-            assert(deltaTime >= 0);
-            if (deltaTime > 0) {
-                t = (time - prevTime) / deltaTime;
-            }
-        }
-
-        if (sampler->interpolation == Sampler::STEP) {
-            t = 0.0f;
-        }
-
-        mImpl->applyAnimation(channel, t, prevIndex, nextIndex);
-    }
-    transformManager.commitLocalTransformTransaction();
+    mImpl->applyAnimation(anim, time);
 }
 
 void Animator::resetBoneMatrices() {
@@ -429,101 +480,180 @@ void AnimatorImpl::addChannels(const FixedCapacityVector<Entity>& nodeMap,
         setTransformType(srcChannel, dstChannel);
         dst.channels.push_back(dstChannel);
     }
+    dst.batch.dirty = true;
 }
 
-void AnimatorImpl::applyAnimation(const Channel& channel, float t, size_t prevIndex,
-        size_t nextIndex) {
-    const Sampler* sampler = channel.sourceData;
-    const TimeValues& times = sampler->times;
-    TrsTransformManager::Instance trsNode = trsTransformManager->getInstance(channel.targetEntity);
-    TransformManager::Instance node = transformManager->getInstance(channel.targetEntity);
-
-    switch (channel.transformType) {
-
-        case Channel::SCALE: {
-            float3 scale;
-            const float3* srcVec3 = (const float3*) sampler->values.data();
-            if (sampler->interpolation == Sampler::CUBIC) {
-                float3 vert0 = srcVec3[prevIndex * 3 + 1];
-                float3 tang0 = srcVec3[prevIndex * 3 + 2];
-                float3 tang1 = srcVec3[nextIndex * 3];
-                float3 vert1 = srcVec3[nextIndex * 3 + 1];
-                scale = cubicSpline(vert0, tang0, vert1, tang1, t);
-            } else {
-                scale = ((1 - t) * srcVec3[prevIndex]) + (t * srcVec3[nextIndex]);
-            }
-            trsTransformManager->setScale(trsNode, scale);
-            break;
+void AnimatorImpl::createBatch(Animation& anim) {
+    ChannelBatch& batch = anim.batch;
+    batch = {};
+
+    const Sampler* const samplers = anim.samplers.data();
+    vector<uint32_t> samplerSlots[3];
+    for (auto& slots : samplerSlots) {
+        slots.resize(anim.samplers.size(), ChannelBatch::NONE);
+    }
+    unordered_map<Entity, uint32_t, Entity::Hasher> nodeSlots;
+
+    for (size_t i = 0, n = anim.channels.size(); i < n; ++i) {
+        const Channel& channel = anim.channels[i];
+        if (channel.sourceData->times.size() < 2) {
+            continue;
+        }
+        if (channel.transformType == Channel::WEIGHTS) {
+            batch.weights.push_back(uint32_t(i));
+            continue;
         }
 
-        case Channel::TRANSLATION: {
-            float3 translation;
-            const float3* srcVec3 = (const float3*) sampler->values.data();
-            if (sampler->interpolation == Sampler::CUBIC) {
-                float3 vert0 = srcVec3[prevIndex * 3 + 1];
-                float3 tang0 = srcVec3[prevIndex * 3 + 2];
-                float3 tang1 = srcVec3[nextIndex * 3];
-                float3 vert1 = srcVec3[nextIndex * 3 + 1];
-                translation = cubicSpline(vert0, tang0, vert1, tang1, t);
-            } else {
-                translation = ((1 - t) * srcVec3[prevIndex]) + (t * srcVec3[nextIndex]);
-            }
-            trsTransformManager->setTranslation(trsNode, translation);
-            break;
+        const int type = channel.transformType;
+        const size_t samplerIndex = channel.sourceData - samplers;
+        uint32_t& samplerSlot = samplerSlots[type][samplerIndex];
+        if (samplerSlot == ChannelBatch::NONE) {
+            samplerSlot = uint32_t(batch.samplers[type].size());
+            batch.samplers[type].push_back(uint32_t(samplerIndex));
         }
 
-        case Channel::ROTATION: {
-            quatf rotation;
-            const quatf* srcQuat = (const quatf*) sampler->values.data();
-            if (sampler->interpolation == Sampler::CUBIC) {
-                quatf vert0 = srcQuat[prevIndex * 3 + 1];
-                quatf tang0 = srcQuat[prevIndex * 3 + 2];
-                quatf tang1 = srcQuat[nextIndex * 3];
-                quatf vert1 = srcQuat[nextIndex * 3 + 1];
-                rotation = normalize(cubicSpline(vert0, tang0, vert1, tang1, t));
-            } else {
-                rotation = slerp(srcQuat[prevIndex], srcQuat[nextIndex], t);
+        auto [pos, inserted] = nodeSlots.emplace(channel.targetEntity, uint32_t(batch.nodes.size()));
+        if (inserted) {
+            batch.nodes.push_back(channel.targetEntity);
+            for (auto& values : batch.values) {
+                values.push_back(ChannelBatch::NONE);
             }
-            trsTransformManager->setRotation(trsNode, rotation);
-            break;
         }
 
-        case Channel::WEIGHTS: {
-            const float* const samplerValues = sampler->values.data();
-            assert(sampler->values.size() % times.size() == 0);
-            const int valuesPerKeyframe = sampler->values.size() / times.size();
-
-            if (sampler->interpolation == Sampler::CUBIC) {
-                assert(valuesPerKeyframe % 3 == 0);
-                const int numMorphTargets = valuesPerKeyframe / 3;
-                const float* const inTangents = samplerValues;
-                const float* const splineVerts = samplerValues + numMorphTargets;
-                const float* const outTangents = samplerValues + numMorphTargets * 2;
-
-                weights.resize(numMorphTargets);
-                for (int comp = 0; comp < numMorphTargets; ++comp) {
-                    float vert0 = splineVerts[comp + prevIndex * valuesPerKeyframe];
-                    float tang0 = outTangents[comp + prevIndex * valuesPerKeyframe];
-                    float tang1 = inTangents[comp + nextIndex * valuesPerKeyframe];
-                    float vert1 = splineVerts[comp + nextIndex * valuesPerKeyframe];
-                    weights[comp] = cubicSpline(vert0, tang0, vert1, tang1, t);
-                }
-            } else {
-                weights.resize(valuesPerKeyframe);
-                for (int comp = 0; comp < valuesPerKeyframe; ++comp) {
-                    float previous = samplerValues[comp + prevIndex * valuesPerKeyframe];
-                    float current = samplerValues[comp + nextIndex * valuesPerKeyframe];
-                    weights[comp] = (1 - t) * previous + t * current;
-                }
+        // if several channels target the same property of a node, the last one wins
+        batch.values[type][pos->second] = samplerSlot;
+    }
+}
+
+void AnimatorImpl::applyAnimation(Animation& anim, float time) {
+    if (anim.batch.dirty) {
+        createBatch(anim);
+    }
+    const ChannelBatch& batch = anim.batch;
+
+    // Find the keyframes once per sampler, they're shared by all the instances.
+    const Sampler* const samplers = anim.samplers.data();
+    keyframes.resize(anim.samplers.size());
+    for (size_t i = 0, n = anim.samplers.size(); i < n; ++i) {
+        if (samplers[i].times.size() >= 2) {
+            keyframes[i] = findKeyframes(samplers[i], time);
+        }
+    }
+
+    // Evaluate the TRS values once per sampler.
+    const auto& translationSamplers = batch.samplers[Channel::TRANSLATION];
+    const auto& rotationSamplers = batch.samplers[Channel::ROTATION];
+    const auto& scaleSamplers = batch.samplers[Channel::SCALE];
+    translations.resize(translationSamplers.size());
+    rotations.resize(rotationSamplers.size());
+    scales.resize(scaleSamplers.size());
+    for (size_t i = 0, n = translationSamplers.size(); i < n; ++i) {
+        const uint32_t s = translationSamplers[i];
+        translations[i] = evaluateFloat3(samplers[s], keyframes[s]);
+    }
+    for (size_t i = 0, n = rotationSamplers.size(); i < n; ++i) {
+        const uint32_t s = rotationSamplers[i];
+        rotations[i] = evaluateQuat(samplers[s], keyframes[s]);
+    }
+    for (size_t i = 0, n = scaleSamplers.size(); i < n; ++i) {
+        const uint32_t s = scaleSamplers[i];
+        scales[i] = evaluateFloat3(samplers[s], keyframes[s]);
+    }
+
+    // Resolve the instances, update the TRS components and compose the local transforms of all
+    // nodes, in parallel if there are many. Each node is visited once, so jobs never write to the
+    // same component.
+    transforms.resize(batch.nodes.size());
+    nodes.resize(batch.nodes.size());
+    FTrsTransformManager& trs = *downcast(trsTransformManager);
+    TransformManager& tm = *transformManager;
+    auto updateNodes = [this, &batch, &trs, &tm](uint32_t start, uint32_t count) {
+        const uint32_t* const translationIndices = batch.values[Channel::TRANSLATION].data();
+        const uint32_t* const rotationIndices = batch.values[Channel::ROTATION].data();
+        const uint32_t* const scaleIndices = batch.values[Channel::SCALE].data();
+        for (uint32_t i = start, end = start + count; i < end; ++i) {
+            const TrsTransformManager::Instance trsNode = trs.getInstance(batch.nodes[i]);
+            if (UTILS_UNLIKELY(!trsNode)) {
+                nodes[i] = {};
+                continue;
+            }
+            if (translationIndices[i] != ChannelBatch::NONE) {
+                trs.setTranslation(trsNode, translations[translationIndices[i]]);
             }
+            if (rotationIndices[i] != ChannelBatch::NONE) {
+                trs.setRotation(trsNode, rotations[rotationIndices[i]]);
+            }
+            if (scaleIndices[i] != ChannelBatch::NONE) {
+                trs.setScale(trsNode, scales[scaleIndices[i]]);
+            }
+            transforms[i] = trs.getTransform(trsNode);
+            nodes[i] = tm.getInstance(batch.nodes[i]);
+        }
+    };
 
-            auto ci = renderableManager->getInstance(channel.targetEntity);
-            renderableManager->setMorphWeights(ci, weights.data(), weights.size());
-            return;
+    // below this, the overhead of the JobSystem isn't worth it
+    constexpr size_t PARALLEL_THRESHOLD = 1024;
+    if (batch.nodes.size() >= PARALLEL_THRESHOLD) {
+        JobSystem& js = asset->mEngine->getJobSystem();
+        JobSystem::Job* job = jobs::parallel_for(js, nullptr, 0, uint32_t(batch.nodes.size()),
+                std::cref(updateNodes), jobs::CountSplitter<64>());
+        js.runAndWait(job);
+    } else {
+        updateNodes(0, uint32_t(batch.nodes.size()));
+    }
+
+    // TransformManager isn't thread-safe, set all the local transforms in a single transaction.
+    tm.openLocalTransformTransaction();
+    for (size_t i = 0, n = nodes.size(); i < n; ++i) {
+        if (nodes[i]) {
+            tm.setTransform(nodes[i], transforms[i]);
+        }
+    }
+    tm.commitLocalTransformTransaction();
+
+    for (const uint32_t channelIndex : batch.weights) {
+        const Channel& channel = anim.channels[channelIndex];
+        applyWeights(channel, keyframes[channel.sourceData - samplers]);
+    }
+}
+
+void AnimatorImpl::applyWeights(const Channel& channel, const Keyframes& keyframes) {
+    const Sampler* sampler = channel.sourceData;
+    const TimeValues& times = sampler->times;
+    const size_t prevIndex = keyframes.prevIndex;
+    const size_t nextIndex = keyframes.nextIndex;
+    const float t = keyframes.t;
+
+    const float* const samplerValues = sampler->values.data();
+    assert(sampler->values.size() % times.size() == 0);
+    const int valuesPerKeyframe = sampler->values.size() / times.size();
+
+    if (sampler->interpolation == Sampler::CUBIC) {
+        assert(valuesPerKeyframe % 3 == 0);
+        const int numMorphTargets = valuesPerKeyframe / 3;
+        const float* const inTangents = samplerValues;
+        const float* const splineVerts = samplerValues + numMorphTargets;
+        const float* const outTangents = samplerValues + numMorphTargets * 2;
+
+        weights.resize(numMorphTargets);
+        for (int comp = 0; comp < numMorphTargets; ++comp) {
+            float vert0 = splineVerts[comp + prevIndex * valuesPerKeyframe];
+            float tang0 = outTangents[comp + prevIndex * valuesPerKeyframe];
+            float tang1 = inTangents[comp + nextIndex * valuesPerKeyframe];
+            float vert1 = splineVerts[comp + nextIndex * valuesPerKeyframe];
+            weights[comp] = cubicSpline(vert0, tang0, vert1, tang1, t);
+        }
+    } else {
+        weights.resize(valuesPerKeyframe);
+        for (int comp = 0; comp < valuesPerKeyframe; ++comp) {
+            float previous = samplerValues[comp + prevIndex * valuesPerKeyframe];
+            float current = samplerValues[comp + nextIndex * valuesPerKeyframe];
+            weights[comp] = (1 - t) * previous + t * current;
         }
     }
 
-    transformManager->setTransform(node, trsTransformManager->getTransform(trsNode));
+    auto ci = renderableManager->getInstance(channel.targetEntity);
+    renderableManager->setMorphWeights(ci, weights.data(), weights.size());
 }
 
 void AnimatorImpl::resetBoneMatrices(FFilamentInstance* instance) {
@@ -16,10 +16,14 @@
 
 #include <gltfio/TextureProvider.h>
 
+#include <algorithm>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include <utils/JobSystem.h>
+#include <utils/Mutex.h>
 
 #include <filament/Engine.h>
 #include <filament/Texture.h>
@@ -47,6 +51,8 @@ public:
     void updateQueue() final;
     void waitForCompletion() final;
     void cancelDecoding() final;
+    void setPriority(Texture* texture, float priority) final;
+    void cancelTexture(Texture* texture) final;
     const char* getPushMessage() const final;
     const char* getPopMessage() const final;
     size_t getPushedCount() const final { return mPushedCount; }
@@ -70,10 +76,32 @@ private:
         ktxreader::Ktx2Reader::Async* async;
         QueueItemState state;
         atomic<TranscoderState> transcoderState;
-        JobSystem::Job* job;
+
+        // The following fields are protected by mPendingLock.
+        float priority = 0.0f;
+        size_t remainingLevels = 0; // levels not handed out yet
+        size_t inFlightLevels = 0;  // levels being transcoded
+        bool failed = false;        // a level failed, or the texture was cancelled
+    };
+
+    // A single mipmap level to transcode.
+    struct Work {
+        QueueItem* item;
+        size_t levelIndex;
     };
 
-    void transcodeSingleTexture();
+    QueueItem* findItem(Texture const* texture) const noexcept;
+
+    // Takes the next level of the highest priority texture. When there is no work left and
+    // retireWorker is true, the calling worker is retired atomically.
+    std::optional<Work> acquireWork(bool retireWorker);
+    void transcode(Work work);
+
+    // Removes the item's remaining levels from the pending work, must be called with the lock.
+    void cancelLocked(QueueItem* item);
+
+    void startWorkers();
+    void runWorker();
 
     size_t mPushedCount = 0;
     size_t mPoppedCount = 0;
@@ -84,6 +112,14 @@ private:
     std::string mRecentPopMessage;
     std::unique_ptr<ktxreader::Ktx2Reader> mKtxReader;
     Engine* const mEngine;
+
+    // Textures with levels left to transcode, in push order. Instead of creating a job per
+    // texture, which could neither be reordered nor cancelled, a bounded number of workers
+    // take one level at a time from here.
+    Mutex mPendingLock;
+    vector<QueueItem*> mPending;
+    size_t mWorkerCount = 0;
+    size_t mMaxWorkerCount = 1;
 };
 
 Texture* Ktx2Provider::pushTexture(const uint8_t* data, size_t byteCount,
@@ -106,23 +142,20 @@ Texture* Ktx2Provider::pushTexture(const uint8_t* data, size_t byteCount,
     item->async = async;
     item->state = QueueItemState::TRANSCODING;
     item->transcoderState.store(TranscoderState::NOT_STARTED);
+    item->remainingLevels = async->getLevelCount();
+
+    {
+        std::lock_guard<Mutex> const lock(mPendingLock);
+        mPending.push_back(item);
+    }
 
     // On single threaded systems, it is usually fine to create jobs because the job system will
     // simply execute serially. However in our case, we wish to amortize the decoder cost across
     // several frames, so we instead use the updateQueue() method to perform decoding.
-    if constexpr (!UTILS_HAS_THREADING) {
-        item->job = nullptr;
-        return async->getTexture();
+    if constexpr (UTILS_HAS_THREADING) {
+        startWorkers();
     }
 
-    JobSystem* js = &mEngine->getJobSystem();
-    item->job = jobs::createJob(*js, mDecoderRootJob, [item] {
-        using Result = ktxreader::Ktx2Reader::Result;
-        const bool success = Result::SUCCESS == item->async->doTranscoding();
-        item->transcoderState.store(success ? TranscoderState::SUCCESS : TranscoderState::ERROR);
-    });
-
-    js->runAndRetain(item->job);
     return async->getTexture();
 }
 
@@ -150,26 +183,23 @@ Texture* Ktx2Provider::popTexture() {
 }
 
 void Ktx2Provider::updateQueue() {
-    if (!UTILS_HAS_THREADING) {
-        transcodeSingleTexture();
+    if constexpr (!UTILS_HAS_THREADING) {
+        // transcode a single level per call
+        if (auto work = acquireWork(false)) {
+            transcode(*work);
+        }
     }
-    JobSystem* js = &mEngine->getJobSystem();
     for (auto& item : mQueueItems) {
         if (item->state != QueueItemState::TRANSCODING) {
             continue;
         }
-        item->async->getTexture();
+        // Nothing limits the LOD range sampled from the texture, which is already bound to
+        // material instances. Levels are therefore only uploaded once they are all available.
         const TranscoderState state = item->transcoderState.load();
         if (state != TranscoderState::NOT_STARTED) {
-            if (item->job) {
-                js->waitAndRelease(item->job);
-            }
-            if (state == TranscoderState::ERROR) {
-                item->state = QueueItemState::READY;
-                ++mDecodedCount;
-                continue;
+            if (state == TranscoderState::SUCCESS) {
+                item->async->uploadImages();
             }
-            item->async->uploadImages();
             item->state = QueueItemState::READY;
             ++mDecodedCount;
         }
@@ -184,18 +214,28 @@ void Ktx2Provider::updateQueue() {
 }
 
 void Ktx2Provider::waitForCompletion() {
-    JobSystem& js = mEngine->getJobSystem();
-    for (auto& item : mQueueItems) {
-        if (item->job) {
-            js.waitAndRelease(item->job);
+    if constexpr (!UTILS_HAS_THREADING) {
+        while (auto work = acquireWork(false)) {
+            transcode(*work);
         }
+        return;
     }
+    // Workers only retire when there is no work left, waiting for all of them therefore waits
+    // for all pending work.
+    JobSystem& js = mEngine->getJobSystem();
+    js.runAndWait(mDecoderRootJob);
+    mDecoderRootJob = js.createJob();
 }
 
 void Ktx2Provider::cancelDecoding() {
-    // TODO: Currently, Ktx2Provider runs jobs eagerly and JobSystem does not allow cancellation of
-    // in-flight jobs. We should consider throttling the number of simultaneous decoder jobs, which
-    // would allow for actual cancellation.
+    {
+        std::lock_guard<Mutex> const lock(mPendingLock);
+        while (!mPending.empty()) {
+            cancelLocked(mPending.back());
+        }
+    }
+
+    // This only waits for the levels that are being transcoded.
     waitForCompletion();
 
     // For cancelled jobs, we need to set the QueueItemState to POPPED and free the decoded data
@@ -210,6 +250,22 @@ void Ktx2Provider::cancelDecoding() {
     }
 }
 
+void Ktx2Provider::setPriority(Texture* texture, float priority) {
+    QueueItem* const item = findItem(texture);
+    if (item) {
+        std::lock_guard<Mutex> const lock(mPendingLock);
+        item->priority = priority;
+    }
+}
+
+void Ktx2Provider::cancelTexture(Texture* texture) {
+    QueueItem* const item = findItem(texture);
+    if (item) {
+        std::lock_guard<Mutex> const lock(mPendingLock);
+        cancelLocked(item);
+    }
+}
+
 const char* Ktx2Provider::getPushMessage() const {
     return mRecentPushMessage.empty() ? nullptr : mRecentPushMessage.c_str();
 }
@@ -218,20 +274,91 @@ const char* Ktx2Provider::getPopMessage() const {
     return mRecentPopMessage.empty() ? nullptr : mRecentPopMessage.c_str();
 }
 
-void Ktx2Provider::transcodeSingleTexture() {
-    assert_invariant(!UTILS_HAS_THREADING);
-    for (auto& item : mQueueItems) {
-        if (item->state == QueueItemState::TRANSCODING) {
-            using Result = ktxreader::Ktx2Reader::Result;
-            bool success = Result::SUCCESS == item->async->doTranscoding();
-            item->transcoderState.store(success ? TranscoderState::SUCCESS : TranscoderState::ERROR);
-            break;
+Ktx2Provider::QueueItem* Ktx2Provider::findItem(Texture const* texture) const noexcept {
+    for (auto const& item : mQueueItems) {
+        if (item->state != QueueItemState::POPPED && item->async->getTexture() == texture) {
+            return item.get();
         }
     }
+    return nullptr;
+}
+
+std::optional<Ktx2Provider::Work> Ktx2Provider::acquireWork(bool retireWorker) {
+    std::lock_guard<Mutex> const lock(mPendingLock);
+    if (mPending.empty()) {
+        if (retireWorker) {
+            --mWorkerCount;
+        }
+        return std::nullopt;
+    }
+
+    // the first texture with the highest priority, so that equal priorities are served in order
+    auto pos = mPending.begin();
+    for (auto it = mPending.begin(); it != mPending.end(); ++it) {
+        if ((*it)->priority > (*pos)->priority) {
+            pos = it;
+        }
+    }
+
+    QueueItem* const item = *pos;
+    size_t const levelIndex = --item->remainingLevels;
+    ++item->inFlightLevels;
+    if (item->remainingLevels == 0) {
+        mPending.erase(pos);
+    }
+    return Work{ item, levelIndex };
+}
+
+void Ktx2Provider::transcode(Work work) {
+    using Result = ktxreader::Ktx2Reader::Result;
+    QueueItem* const item = work.item;
+    const bool success = Result::SUCCESS == item->async->doTranscoding(work.levelIndex);
+
+    std::lock_guard<Mutex> const lock(mPendingLock);
+    --item->inFlightLevels;
+    if (!success) {
+        cancelLocked(item);
+    } else if (item->remainingLevels == 0 && item->inFlightLevels == 0) {
+        // the foreground thread can destroy the item as soon as this is set
+        item->transcoderState.store(item->failed ? TranscoderState::ERROR : TranscoderState::SUCCESS);
+    }
+}
+
+void Ktx2Provider::cancelLocked(QueueItem* item) {
+    if (item->remainingLevels) {
+        item->remainingLevels = 0;
+        mPending.erase(std::find(mPending.begin(), mPending.end(), item));
+    }
+    item->failed = true;
+    if (item->inFlightLevels == 0 &&
+            item->transcoderState.load() == TranscoderState::NOT_STARTED) {
+        item->transcoderState.store(TranscoderState::ERROR);
+    }
+}
+
+void Ktx2Provider::startWorkers() {
+    JobSystem& js = mEngine->getJobSystem();
+    std::unique_lock<Mutex> lock(mPendingLock);
+    size_t const needed = std::min(mMaxWorkerCount, mPending.size());
+    while (mWorkerCount < needed) {
+        ++mWorkerCount;
+        lock.unlock();
+        js.run(jobs::createJob(js, mDecoderRootJob, &Ktx2Provider::runWorker, this));
+        lock.lock();
+    }
+}
+
+void Ktx2Provider::runWorker() {
+    while (auto work = acquireWork(true)) {
+        transcode(*work);
+    }
 }
 
 Ktx2Provider::Ktx2Provider(Engine* engine) : mEngine(engine) {
-    mDecoderRootJob = mEngine->getJobSystem().createJob();
+    JobSystem& js = mEngine->getJobSystem();
+    mDecoderRootJob = js.createJob();
+    // leave some threads to the engine
+    mMaxWorkerCount = std::max(size_t(1), js.getThreadCount() / 2);
 #ifdef NDEBUG
     const bool quiet = true;
 #else
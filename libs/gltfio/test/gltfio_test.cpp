@@ -23,20 +23,31 @@
 #include <filament/RenderableManager.h>
 #include <filament/TransformManager.h>
 
+#include <gltfio/Animator.h>
 #include <gltfio/AssetLoader.h>
 #include <gltfio/FilamentAsset.h>
+#include <gltfio/FilamentInstance.h>
 #include <gltfio/ResourceLoader.h>
 #include <gltfio/TextureProvider.h>
 #include <gltfio/math.h>
 #include <math/mathfwd.h>
+#include <math/quat.h>
+#include <math/scalar.h>
+#include <math/vec3.h>
 #include <utils/EntityManager.h>
+#include <utils/JobSystem.h>
 #include <utils/NameComponentManager.h>
 #include <utils/Path.h>
 
 #include "materials/uberarchive.h"
 
+#include <algorithm>
 #include <fstream>
+#include <future>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 using namespace filament;
 using namespace backend;
@@ -44,6 +55,10 @@ using namespace gltfio;
 using namespace utils;
 
 char const* ANIMATED_MORPH_CUBE_GLB = "AnimatedMorphCube.glb";
+char const* COLOR_GRID_KTX2 = "color_grid_uastc_zstd.ktx2";
+
+// Additional KTX2 files given on the command line, used by the Ktx2Provider tests.
+static std::vector<std::string> sKtx2Corpus;
 
 static std::ifstream::pos_type getFileSize(const char* filename) {
     std::ifstream in(filename, std::ifstream::ate | std::ifstream::binary);
@@ -236,7 +251,357 @@ TEST_F(glTFIOTest, AnimatedMorphCubeRenderables) {
     EXPECT_EQ(morphTargetBuffer->getVertexCount(), 24u);
 }
 
+// An animated asset without meshes. Nodes A and B share the rotation sampler, and A and its
+// child C share the translation sampler. The scale sampler uses STEP interpolation.
+static char const* ANIMATED_TRS_GLTF = R"({
+    "asset": { "version": "2.0" },
+    "scene": 0,
+    "scenes": [ { "nodes": [ 0, 1 ] } ],
+    "nodes": [
+        { "name": "A", "children": [ 2 ] },
+        { "name": "B", "translation": [ 0, 5, 0 ] },
+        { "name": "C", "rotation": [ 0, 0, 0.6, 0.8 ] }
+    ],
+    "buffers": [ { "byteLength": 132, "uri": "data:application/octet-stream;base64,%s" } ],
+    "bufferViews": [
+        { "buffer": 0, "byteOffset": 0, "byteLength": 12 },
+        { "buffer": 0, "byteOffset": 12, "byteLength": 36 },
+        { "buffer": 0, "byteOffset": 48, "byteLength": 48 },
+        { "buffer": 0, "byteOffset": 96, "byteLength": 36 }
+    ],
+    "accessors": [
+        { "bufferView": 0, "componentType": 5126, "count": 3, "type": "SCALAR",
+          "min": [ 0 ], "max": [ 2 ] },
+        { "bufferView": 1, "componentType": 5126, "count": 3, "type": "VEC3" },
+        { "bufferView": 2, "componentType": 5126, "count": 3, "type": "VEC4" },
+        { "bufferView": 3, "componentType": 5126, "count": 3, "type": "VEC3" }
+    ],
+    "animations": [ {
+        "name": "trs",
+        "samplers": [
+            { "input": 0, "output": 1, "interpolation": "LINEAR" },
+            { "input": 0, "output": 2, "interpolation": "LINEAR" },
+            { "input": 0, "output": 3, "interpolation": "STEP" }
+        ],
+        "channels": [
+            { "sampler": 0, "target": { "node": 0, "path": "translation" } },
+            { "sampler": 1, "target": { "node": 0, "path": "rotation" } },
+            { "sampler": 1, "target": { "node": 1, "path": "rotation" } },
+            { "sampler": 2, "target": { "node": 1, "path": "scale" } },
+            { "sampler": 0, "target": { "node": 2, "path": "translation" } }
+        ]
+    } ]
+})";
+
+class AnimatorTest : public testing::Test {
+protected:
+    static constexpr size_t INSTANCE_COUNT = 3;
+    static constexpr size_t KEYFRAME_COUNT = 3;
+
+    struct Keyframes {
+        float times[KEYFRAME_COUNT];
+        math::float3 translations[KEYFRAME_COUNT];
+        math::quatf rotations[KEYFRAME_COUNT];
+        math::float3 scales[KEYFRAME_COUNT];
+    };
+
+    struct Node {
+        math::float3 translation;
+        math::quatf rotation;
+        math::float3 scale;
+    };
+
+    Engine* mEngine = nullptr;
+    NameComponentManager* mNameManager = nullptr;
+    MaterialProvider* mMaterialProvider = nullptr;
+    AssetLoader* mAssetLoader = nullptr;
+    ResourceLoader* mResourceLoader = nullptr;
+    FilamentAsset* mAsset = nullptr;
+    FilamentInstance* mInstances[INSTANCE_COUNT] = {};
+    Keyframes mKeyframes{};
+
+    void SetUp() override {
+        mEngine = Engine::Builder().backend(Backend::NOOP).build();
+        mNameManager = new NameComponentManager(EntityManager::get());
+        mMaterialProvider = createUbershaderProvider(mEngine, UBERARCHIVE_DEFAULT_DATA,
+                UBERARCHIVE_DEFAULT_SIZE);
+        mAssetLoader = AssetLoader::create({ mEngine, mMaterialProvider, mNameManager });
+        mResourceLoader = new ResourceLoader({ mEngine });
+
+        mKeyframes = {
+                { 0.0f, 1.0f, 2.0f },
+                { { 0, 0, 0 }, { 1, 2, 3 }, { -1, 0, 2 } },
+                {
+                        math::quatf::fromAxisAngle(math::float3{ 0, 1, 0 }, 0.0f),
+                        math::quatf::fromAxisAngle(math::float3{ 0, 1, 0 }, math::F_PI_2),
+                        math::quatf::fromAxisAngle(normalize(math::float3{ 1, 1, 0 }), 2.5f),
+                },
+                { { 1, 1, 1 }, { 2, 2, 2 }, { 0.5f, 1, 3 } },
+        };
+        static_assert(sizeof(Keyframes) == 132);
+
+        std::string const json = createJson();
+        mAsset = mAssetLoader->createInstancedAsset((uint8_t const*) json.data(),
+                uint32_t(json.size()), mInstances, INSTANCE_COUNT);
+        ASSERT_NE(mAsset, nullptr);
+        ASSERT_TRUE(mResourceLoader->loadResources(mAsset));
+    }
+
+    void TearDown() override {
+        if (mAsset) {
+            mAssetLoader->destroyAsset(mAsset);
+        }
+        delete mResourceLoader;
+        AssetLoader::destroy(&mAssetLoader);
+        mMaterialProvider->destroyMaterials();
+        Engine::destroy(&mEngine);
+
+        delete mMaterialProvider;
+        delete mNameManager;
+    }
+
+    // Embeds the keyframes in ANIMATED_TRS_GLTF as a base64 data URI.
+    std::string createJson() const {
+        static char const* const ALPHABET =
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        uint8_t const* const bytes = (uint8_t const*) &mKeyframes;
+        size_t const size = sizeof(mKeyframes);
+        std::string base64;
+        for (size_t i = 0; i < size; i += 3) {
+            uint32_t const n = bytes[i] << 16 |
+                    (i + 1 < size ? bytes[i + 1] << 8 : 0) |
+                    (i + 2 < size ? bytes[i + 2] : 0);
+            base64 += ALPHABET[(n >> 18) & 63];
+            base64 += ALPHABET[(n >> 12) & 63];
+            base64 += i + 1 < size ? ALPHABET[(n >> 6) & 63] : '=';
+            base64 += i + 2 < size ? ALPHABET[n & 63] : '=';
+        }
+        std::string json(ANIMATED_TRS_GLTF);
+        json.replace(json.find("%s"), 2, base64);
+        return json;
+    }
+
+    Entity findEntity(FilamentInstance* instance, std::string_view name) const {
+        Entity const* entities = instance->getEntities();
+        for (size_t i = 0, n = instance->getEntityCount(); i < n; i++) {
+            char const* entityName = mNameManager->getName(mNameManager->getInstance(entities[i]));
+            if (entityName && name == entityName) {
+                return entities[i];
+            }
+        }
+        return {};
+    }
+
+    // Evaluates the animation one channel at a time, the way Animator used to, and returns the
+    // local transform of the given node.
+    math::mat4f evaluate(std::string_view name, float time) const {
+        size_t prev = 0, next = 0;
+        float t = 0.0f;
+        float const* const times = mKeyframes.times;
+        float const* const iter = std::lower_bound(times, times + KEYFRAME_COUNT, time);
+        if (iter == times + KEYFRAME_COUNT) {
+            prev = next = KEYFRAME_COUNT - 1;
+        } else if (iter != times) {
+            next = iter - times;
+            prev = next - 1;
+            t = (time - times[prev]) / (times[next] - times[prev]);
+        }
+
+        auto const translate = [&](Node& node) {
+            node.translation = (1 - t) * mKeyframes.translations[prev] +
+                    t * mKeyframes.translations[next];
+        };
+        auto const rotate = [&](Node& node) {
+            node.rotation = slerp(mKeyframes.rotations[prev], mKeyframes.rotations[next], t);
+        };
+        auto const scale = [&](Node& node) {
+            node.scale = mKeyframes.scales[prev];   // STEP
+        };
+
+        Node node{ {}, { 1, 0, 0, 0 }, { 1, 1, 1 } };
+        if (name == "A") {
+            translate(node);
+            rotate(node);
+        } else if (name == "B") {
+            node.translation = { 0, 5, 0 };
+            rotate(node);
+            scale(node);
+        } else if (name == "C") {
+            node.rotation = { 0.8f, 0, 0, 0.6f };
+            translate(node);
+        }
+        return composeMatrix(node.translation, node.rotation, node.scale);
+    }
+};
+
+// Instances animated at different times get the same transforms as the per-channel evaluation.
+TEST_F(AnimatorTest, MultipleInstances) {
+    auto const& tm = mEngine->getTransformManager();
+    for (FilamentInstance* instance : mInstances) {
+        ASSERT_EQ(instance->getAnimator()->getAnimationCount(), 1u);
+        EXPECT_FLOAT_EQ(instance->getAnimator()->getAnimationDuration(0), 2.0f);
+    }
+
+    for (float time : { 0.0f, 0.25f, 1.0f, 1.3f, 1.75f, 2.0f }) {
+        // Each instance is offset in time so that they don't share keyframes.
+        float times[INSTANCE_COUNT];
+        for (size_t i = 0; i < INSTANCE_COUNT; i++) {
+            times[i] = std::min(time + 0.1f * float(i), 2.0f);
+            mInstances[i]->getAnimator()->applyAnimation(0, times[i]);
+        }
+        for (size_t i = 0; i < INSTANCE_COUNT; i++) {
+            for (char const* name : { "A", "B", "C" }) {
+                Entity const entity = findEntity(mInstances[i], name);
+                ASSERT_FALSE(entity.isNull()) << name;
+                math::mat4f const transform = tm.getTransform(tm.getInstance(entity));
+                SCOPED_TRACE(testing::Message() << name << " at " << times[i]);
+                EXPECT_MAT_NEAR(transform, evaluate(name, times[i]), 1e-5f);
+            }
+        }
+    }
+}
+
+class Ktx2ProviderTest : public testing::Test {
+protected:
+    Engine* mEngine = nullptr;
+    TextureProvider* mProvider = nullptr;
+    std::vector<std::vector<uint8_t>> mFiles;
+
+    // Held by holdWorkers(), see below.
+    JobSystem::Job* mHoldJob = nullptr;
+    std::promise<void> mHoldStarted;
+    std::promise<void> mHoldReleased;
+
+    void SetUp() override {
+        // A single JobSystem thread, so that holdWorkers() can stop all of the provider's workers.
+        Engine::Config config{};
+        config.jobSystemThreadCount = 1;
+        mEngine = Engine::Builder().backend(Backend::NOOP).config(&config).build();
+        mProvider = createKtx2Provider(mEngine);
+
+        std::vector<std::string> paths = sKtx2Corpus;
+        paths.push_back(Path::getCurrentExecutable().getParent() + Path(COLOR_GRID_KTX2));
+        for (std::string const& path : paths) {
+            std::ifstream in(path, std::ifstream::ate | std::ifstream::binary);
+            ASSERT_TRUE(in) << "Unable to open " << path;
+            std::vector<uint8_t>& file = mFiles.emplace_back(size_t(in.tellg()));
+            in.seekg(0);
+            in.read((char*) file.data(), std::streamsize(file.size()));
+        }
+    }
+
+    void TearDown() override {
+        delete mProvider;
+        Engine::destroy(&mEngine);
+    }
+
+    // Occupies the JobSystem's only thread until releaseWorkers() is called. The provider's
+    // workers can't start meanwhile, so the textures pushed in between are all pending when
+    // transcoding starts, and are transcoded one level at a time, in priority order.
+    void holdWorkers() {
+        JobSystem& js = mEngine->getJobSystem();
+        mHoldJob = js.runAndRetain(js.createJob(nullptr, [this](JobSystem&, JobSystem::Job*) {
+            mHoldStarted.set_value();
+            mHoldReleased.get_future().wait();
+        }));
+        mHoldStarted.get_future().wait();
+    }
+
+    void releaseWorkers() {
+        mHoldReleased.set_value();
+        mEngine->getJobSystem().waitAndRelease(mHoldJob);
+    }
+
+    // Pushes count textures, cycling through the files.
+    std::vector<Texture*> push(size_t count) {
+        std::vector<Texture*> textures;
+        for (size_t i = 0; i < count; i++) {
+            std::vector<uint8_t> const& file = mFiles[i % mFiles.size()];
+            Texture* texture = mProvider->pushTexture(file.data(), file.size(), "image/ktx2", {});
+            EXPECT_NE(texture, nullptr) << mProvider->getPushMessage();
+            textures.push_back(texture);
+        }
+        return textures;
+    }
+
+    // Pops every texture that is ready, and returns them along with their pop message.
+    std::vector<std::pair<Texture*, bool>> pop() {
+        std::vector<std::pair<Texture*, bool>> popped;
+        while (Texture* texture = mProvider->popTexture()) {
+            popped.emplace_back(texture, mProvider->getPopMessage() == nullptr);
+        }
+        return popped;
+    }
+
+    void destroy(std::vector<Texture*> const& textures) {
+        for (Texture* texture : textures) {
+            mEngine->destroy(texture);
+        }
+    }
+};
+
+TEST_F(Ktx2ProviderTest, Priority) {
+    constexpr size_t LOW_COUNT = 32;
+    holdWorkers();
+    std::vector<Texture*> textures = push(LOW_COUNT);
+    Texture* const high = push(1)[0];
+    mProvider->setPriority(high, 1.0f);
+    textures.push_back(high);
+    releaseWorkers();
+
+    // All the levels of the high priority texture are transcoded before any level of the
+    // others. A low priority texture can therefore only be popped along with, or after, it.
+    size_t poppedBeforeHigh = 0;
+    bool highPopped = false;
+    while (!highPopped) {
+        mProvider->updateQueue();
+        auto const popped = pop();
+        for (auto [texture, success] : popped) {
+            EXPECT_TRUE(success);
+            highPopped = highPopped || texture == high;
+        }
+        if (!highPopped) {
+            poppedBeforeHigh += popped.size();
+        }
+    }
+    EXPECT_EQ(poppedBeforeHigh, 0u);
+
+    mProvider->waitForCompletion();
+    mProvider->updateQueue();
+    pop();
+    EXPECT_EQ(mProvider->getPoppedCount(), LOW_COUNT + 1);
+    destroy(textures);
+}
+
+TEST_F(Ktx2ProviderTest, Cancellation) {
+    constexpr size_t TEXTURE_COUNT = 32;
+    holdWorkers();
+    std::vector<Texture*> const textures = push(TEXTURE_COUNT);
+    for (size_t i = TEXTURE_COUNT / 2; i < TEXTURE_COUNT; i++) {
+        mProvider->cancelTexture(textures[i]);
+    }
+    releaseWorkers();
+    mProvider->waitForCompletion();
+    mProvider->updateQueue();
+
+    // Cancelled textures are still popped, but incomplete. None of them had started.
+    size_t incomplete = 0;
+    for (auto [texture, success] : pop()) {
+        auto const pos = std::find(textures.begin(), textures.end(), texture);
+        ASSERT_NE(pos, textures.end());
+        bool const cancelled = size_t(pos - textures.begin()) >= TEXTURE_COUNT / 2;
+        EXPECT_EQ(success, !cancelled);
+        incomplete += success ? 0 : 1;
+    }
+    EXPECT_EQ(mProvider->getPoppedCount(), TEXTURE_COUNT);
+    EXPECT_EQ(incomplete, TEXTURE_COUNT / 2);
+    destroy(textures);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
+    for (int i = 1; i < argc; i++) {
+        sKtx2Corpus.emplace_back(argv[i]);
+    }
     return RUN_ALL_TESTS();
 }
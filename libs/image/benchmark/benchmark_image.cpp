@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <image/ImageOps.h>
+#include <image/ImageSampler.h>
+#include <image/LinearImage.h>
+
+#include <utils/JobSystem.h>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include <stdint.h>
+
+using namespace image;
+using namespace utils;
+
+/*
+ * state.range(0) is the size of the square source image, state.range(1) its number of channels
+ * and state.range(2) is non-zero to use the JobSystem.
+ */
+class ImageFixture : public benchmark::Fixture {
+protected:
+    JobSystem* js = nullptr;
+    LinearImage source;
+
+public:
+    void SetUp(benchmark::State const& state) override {
+        js = new JobSystem();
+        js->adopt();
+
+        uint32_t const size = uint32_t(state.range(0));
+        uint32_t const channels = uint32_t(state.range(1));
+        source = LinearImage(size, size, channels);
+        std::default_random_engine gen; // NOLINT
+        std::uniform_real_distribution<float> value(0.0f, 1.0f);
+        float* const pixels = source.getPixelRef();
+        for (size_t i = 0, c = size_t(size) * size * channels; i < c; i++) {
+            pixels[i] = value(gen);
+        }
+    }
+
+    void TearDown(benchmark::State const&) override {
+        source = {};
+        js->emancipate();
+        delete js;
+        js = nullptr;
+    }
+
+    void setProcessed(benchmark::State& state) const {
+        uint64_t const pixels = uint64_t(source.getWidth()) * source.getHeight();
+        state.SetItemsProcessed(int64_t(state.iterations() * pixels));
+        state.SetBytesProcessed(int64_t(state.iterations() * pixels * source.getChannels() *
+                sizeof(float)));
+    }
+};
+
+BENCHMARK_DEFINE_F(ImageFixture, resampleHalf)(benchmark::State& state) {
+    uint32_t const width = source.getWidth() / 2;
+    uint32_t const height = source.getHeight() / 2;
+    for (auto _ : state) {
+        LinearImage const result = state.range(2) ?
+                resampleImage(*js, source, width, height, Filter::LANCZOS) :
+                resampleImage(source, width, height, Filter::LANCZOS);
+        benchmark::DoNotOptimize(result.getPixelRef());
+    }
+    setProcessed(state);
+}
+
+BENCHMARK_DEFINE_F(ImageFixture, generateMipmaps)(benchmark::State& state) {
+    std::vector<LinearImage> mips(getMipmapCount(source));
+    for (auto _ : state) {
+        if (state.range(2)) {
+            generateMipmaps(*js, source, Filter::DEFAULT, mips.data(), mips.size());
+        } else {
+            generateMipmaps(source, Filter::DEFAULT, mips.data(), mips.size());
+        }
+        benchmark::DoNotOptimize(mips[0].getPixelRef());
+    }
+    setProcessed(state);
+}
+
+BENCHMARK_DEFINE_F(ImageFixture, transpose)(benchmark::State& state) {
+    for (auto _ : state) {
+        LinearImage const result = state.range(2) ? transpose(*js, source) : transpose(source);
+        benchmark::DoNotOptimize(result.getPixelRef());
+    }
+    setProcessed(state);
+}
+
+BENCHMARK_DEFINE_F(ImageFixture, computeCoordField)(benchmark::State& state) {
+    auto presence = [](const LinearImage& img, uint32_t col, uint32_t row, void*) {
+        return img.getPixelRef(col, row)[0] > 0.99f;
+    };
+    for (auto _ : state) {
+        LinearImage const result = state.range(2) ?
+                computeCoordField(*js, source, presence, nullptr) :
+                computeCoordField(source, presence, nullptr);
+        benchmark::DoNotOptimize(result.getPixelRef());
+    }
+    setProcessed(state);
+}
+
+static void imageArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "size", "channels", "jobs" });
+    for (int64_t const size : { 512, 2048 }) {
+        for (int64_t const channels : { 1, 4 }) {
+            for (int64_t const jobs : { 0, 1 }) {
+                b->Args({ size, channels, jobs });
+            }
+        }
+    }
+}
+
+static void coordFieldArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "size", "channels", "jobs" });
+    for (int64_t const size : { 512, 2048 }) {
+        for (int64_t const jobs : { 0, 1 }) {
+            b->Args({ size, 1, jobs });
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(ImageFixture, resampleHalf)
+        ->Apply(imageArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ImageFixture, generateMipmaps)
+        ->Apply(imageArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ImageFixture, transpose)
+        ->Apply(imageArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ImageFixture, computeCoordField)
+        ->Apply(coordFieldArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -24,6 +24,10 @@
 #include <cstddef>
 #include <initializer_list>
 
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace image {
 
 // Concatenates images horizontally to create a filmstrip atlas, similar to numpy's hstack.
@@ -52,6 +56,10 @@ UTILS_PUBLIC LinearImage combineChannels(LinearImage const* img, size_t count);
 // Generates a new image with rows & columns swapped.
 UTILS_PUBLIC LinearImage transpose(const LinearImage& image);
 
+// Same as transpose(), but processes tiles concurrently. The calling thread must have been adopted
+// by the JobSystem.
+UTILS_PUBLIC LinearImage transpose(utils::JobSystem& js, const LinearImage& image);
+
 // Extracts pixels by specifying a crop window where (0,0) is the top-left corner of the image.
 // The boundary is specified as Left Top Right Bottom.
 UTILS_PUBLIC
@@ -72,6 +80,13 @@ using PresenceCallback = bool(*)(const LinearImage& img, uint32_t col, uint32_t
 UTILS_PUBLIC
 LinearImage computeCoordField(const LinearImage& src, PresenceCallback presence, void* user);
 
+// Same as computeCoordField(), but processes rows concurrently, except for the presence callback
+// which is always called from the calling thread. The result is identical. The calling thread must
+// have been adopted by the JobSystem.
+UTILS_PUBLIC
+LinearImage computeCoordField(utils::JobSystem& js, const LinearImage& src,
+        PresenceCallback presence, void* user);
+
 // Generates a single-channel Euclidean distance field with positive values outside the region
 // of interest in the source image, and zero values inside. If sqrt is false, the computed
 // distances are squared. If signed distance (SDF) is desired, this function can be called a second
@@ -16,8 +16,11 @@
 
 #include <image/ImageOps.h>
 
+#include "ParallelFor.h"
+
 #include <math/vec3.h>
 #include <math/vec4.h>
+#include <utils/JobSystem.h>
 #include <utils/Panic.h>
 
 #include <algorithm>
@@ -25,6 +28,7 @@
 #include <ratio>
 
 using namespace filament::math;
+using namespace utils;
 
 namespace image {
 
@@ -192,30 +196,48 @@ LinearImage combineChannels(LinearImage const* img, size_t count) {
     return result;
 }
 
-// The transpose operation does not simply set a flag, it performs actual movement of data. This is
-// very handy for separable filters because it (a) improves cache coherency in the second pass, and
-// (b) allows the client to consume columns in the same way that it consumes rows. Our
-// implementation does not support in-place transposition but it is simple and robust for non-square
-// images.
-LinearImage transpose(const LinearImage& image) {
+static LinearImage transpose(JobSystem* js, const LinearImage& image) {
+    // Rows are processed by bands of TILE rows, and each band by tiles of TILE columns, so that
+    // both the source and target cache lines are reused.
+    constexpr uint32_t TILE = 32;
     const uint32_t width = image.getWidth();
     const uint32_t height = image.getHeight();
     const uint32_t channels = image.getChannels();
     LinearImage result(height, width, channels);
     float const* source = image.getPixelRef();
     float* target = result.getPixelRef();
-    for (uint32_t n = 0; n < width * height; ++n) {
-        const uint32_t i = n / width;
-        const uint32_t j = n % width;
-        float const* src = source + channels * n;
-        float* dst = target + channels * (height * j + i);
-        for (uint32_t c = 0; c < channels; ++c) {
-            dst[c] = src[c];
+    parallelFor(js, (height + TILE - 1) / TILE, [=](uint32_t begin, uint32_t count) {
+        const uint32_t rowBegin = begin * TILE;
+        const uint32_t rowEnd = std::min((begin + count) * TILE, height);
+        for (uint32_t col0 = 0; col0 < width; col0 += TILE) {
+            const uint32_t col1 = std::min(col0 + TILE, width);
+            for (uint32_t i = rowBegin; i < rowEnd; ++i) {
+                for (uint32_t j = col0; j < col1; ++j) {
+                    float const* src = source + channels * (width * i + j);
+                    float* dst = target + channels * (height * j + i);
+                    for (uint32_t c = 0; c < channels; ++c) {
+                        dst[c] = src[c];
+                    }
+                }
+            }
         }
-    }
+    });
     return result;
 }
 
+// The transpose operation does not simply set a flag, it performs actual movement of data. This is
+// very handy for separable filters because it (a) improves cache coherency in the second pass, and
+// (b) allows the client to consume columns in the same way that it consumes rows. Our
+// implementation does not support in-place transposition but it is simple and robust for non-square
+// images.
+LinearImage transpose(const LinearImage& image) {
+    return transpose(nullptr, image);
+}
+
+LinearImage transpose(JobSystem& js, const LinearImage& image) {
+    return transpose(&js, image);
+}
+
 LinearImage cropRegion(const LinearImage& image, uint32_t left, uint32_t top, uint32_t right,
         uint32_t bottom) {
     uint32_t width = right - left;
@@ -313,22 +335,24 @@ static void edt(const float* f, float* d, float* z, float* v, float* i, size_t n
     }
 }
 
-static LinearImage computeHorizontalEdt(const LinearImage& src, LinearImage cx) {
+static LinearImage computeHorizontalEdt(JobSystem* js, const LinearImage& src, LinearImage cx) {
     const uint32_t width = src.getWidth();
     const uint32_t height = src.getHeight();
     LinearImage tmp0(width + 1, height + 1, 1);
     LinearImage tmp1(width + 1, height + 1, 1);
     LinearImage dst(width, height, 1);
 
-    // TODO: use utils::job::parallel_for.
-    for (uint32_t row = 0; row < height; ++row) {
-        const float* f = src.getPixelRef(0, row);
-        float* d = dst.getPixelRef(0, row);
-        float* z = tmp0.getPixelRef(0, row);
-        float* v = tmp1.getPixelRef(0, row);
-        float* i = cx.getPixelRef(0, row);
-        edt(f, d, z, v, i, width);
-    }
+    // rows are independent, each has its own temporaries
+    parallelFor(js, height, [&](uint32_t begin, uint32_t count) {
+        for (uint32_t row = begin; row < begin + count; ++row) {
+            const float* f = src.getPixelRef(0, row);
+            float* d = dst.getPixelRef(0, row);
+            float* z = tmp0.getPixelRef(0, row);
+            float* v = tmp1.getPixelRef(0, row);
+            float* i = cx.getPixelRef(0, row);
+            edt(f, d, z, v, i, width);
+        }
+    });
 
     return dst;
 }
@@ -336,7 +360,8 @@ static LinearImage computeHorizontalEdt(const LinearImage& src, LinearImage cx)
 // Implements the paper 'Distance Transforms of Sampled Functions' by Felzenszwalb and Huttenlocher
 // but generalized to compute a coordinate field rather than a distance field. Coordinate fields are
 // more broadly useful and transforming them into distance fields is extremely cheap.
-LinearImage computeCoordField(const LinearImage& src, PresenceCallback presence, void* user) {
+static LinearImage computeCoordField(JobSystem* js, const LinearImage& src,
+        PresenceCallback presence, void* user) {
     const uint32_t width = src.getWidth();
     const uint32_t height = src.getHeight();
     LinearImage f0(width, height, 1);
@@ -350,28 +375,39 @@ LinearImage computeCoordField(const LinearImage& src, PresenceCallback presence,
     LinearImage cx(width, height, 1);
     LinearImage cy(height, width, 1);
 
-    f0 = computeHorizontalEdt(f0, cx);
-    f0 = transpose(f0);
-    f0 = computeHorizontalEdt(f0, cy);
-    f0 = transpose(f0);
+    f0 = computeHorizontalEdt(js, f0, cx);
+    f0 = transpose(js, f0);
+    f0 = computeHorizontalEdt(js, f0, cy);
+    f0 = transpose(js, f0);
 
     // NOTE: this could be extended to compute a volumetric distance field by transposing
     // X with Z at this point (rather than X with Y) and re-invoking computeHorizontalEdt.
 
     LinearImage coords(width, height, 2);
-    for (uint32_t row = 0; row < height; ++row) {
-        for (uint32_t col = 0; col < width; ++col) {
-            float y = cy.getPixelRef(row, col)[0];
-            float x = cx.getPixelRef(col, y)[0];
-            float* dst = coords.getPixelRef(col, row);
-            dst[0] = x;
-            dst[1] = y;
+    parallelFor(js, height, [&](uint32_t begin, uint32_t count) {
+        for (uint32_t row = begin; row < begin + count; ++row) {
+            for (uint32_t col = 0; col < width; ++col) {
+                float y = cy.getPixelRef(row, col)[0];
+                float x = cx.getPixelRef(col, y)[0];
+                float* dst = coords.getPixelRef(col, row);
+                dst[0] = x;
+                dst[1] = y;
+            }
         }
-    }
+    });
 
     return coords;
 }
 
+LinearImage computeCoordField(const LinearImage& src, PresenceCallback presence, void* user) {
+    return computeCoordField(nullptr, src, presence, user);
+}
+
+LinearImage computeCoordField(JobSystem& js, const LinearImage& src, PresenceCallback presence,
+        void* user) {
+    return computeCoordField(&js, src, presence, user);
+}
+
 LinearImage edtFromCoordField(const LinearImage& coordField, bool sqrt) {
     const uint32_t width = coordField.getWidth();
     const uint32_t height = coordField.getHeight();
@@ -17,18 +17,25 @@
 #include <image/ImageSampler.h>
 #include <image/ImageOps.h>
 
+#include "ParallelFor.h"
+
 #include <math/scalar.h>
+#include <math/vec2.h>
 #include <math/vec3.h>
 #include <math/vec4.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Panic.h>
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 using namespace image;
+using namespace utils;
 
 namespace {
 
@@ -134,6 +141,14 @@ void generateMadProgram(uint32_t ntarget, uint32_t nsource, float left, float ri
     // than necessary.
     const float filterBounds = domainScale * std::abs(filter.boundingRadius);
 
+    // The filter function is zero when t >= max(boundingRadius, 1) (NEAREST has a zero radius but
+    // uses the box function), i.e. outside of this half-width of the [left, right] range. Only the
+    // source samples within both bounds are visited: this skips the samples whose weight is zero,
+    // without changing the result. This doesn't apply to flipped ranges, where t is negative.
+    const bool hasSupport = domainScale > 0;
+    const float filterSupport = std::max(std::abs(filter.boundingRadius), 1.0f) / domainScale;
+    auto toSourceIndex = [=](float x) { return (left + x * (right - left)) * nsource - 0.5f; };
+
     // Iterate through target samples. "xtarget" points to the center of each target pixel.
     float xtarget = dtarget / 2.0f;
     for (uint32_t itarget = 0; itarget < ntarget; ++itarget, xtarget += dtarget) {
@@ -144,8 +159,14 @@ void generateMadProgram(uint32_t ntarget, uint32_t nsource, float left, float ri
         float sum = 0;
 
         // Iterate through source samples that lie within the bounded region.
-        const auto isource_lower = int32_t((xtarget - filterBounds) * nsource);
-        const auto isource_upper = int32_t(std::ceil((xtarget + filterBounds) * nsource));
+        auto isource_lower = int32_t((xtarget - filterBounds) * nsource);
+        auto isource_upper = int32_t(std::ceil((xtarget + filterBounds) * nsource));
+        if (hasSupport) {
+            isource_lower = std::max(isource_lower,
+                    int32_t(std::floor(toSourceIndex(xtarget - filterSupport))) - 1);
+            isource_upper = std::min(isource_upper,
+                    int32_t(std::ceil(toSourceIndex(xtarget + filterSupport))) + 1);
+        }
         for (int32_t isource = isource_lower; isource <= isource_upper; ++isource) {
             const float xsource = (((isource + 0.5f) / nsource) - left) / (right - left);
             const bool outside_image = isource < 0 || isource >= int32_t(nsource);
@@ -226,7 +247,59 @@ void normalize(LinearImage& image) {
     }
 }
 
-LinearImage resampleImage1D(const LinearImage& source, MadProgram* program,
+inline float minimum(float a, float b) {
+    return a < b ? a : b;
+}
+
+template<typename T>
+inline T minimum(T const& a, T const& b) {
+    return min(a, b);
+}
+
+// Executes a MAD program over a single row. T is either a float, or a vector with one component
+// per channel, which allows all channels to be processed at once; the result is the same.
+template<typename T>
+void resampleRow(MadProgram const& program, T const* UTILS_RESTRICT source,
+        T* UTILS_RESTRICT target) {
+    for (auto const& mad : program) {
+        target[mad.targetIndex] += source[mad.sourceIndex] * mad.weight;
+    }
+}
+
+// The MIN filter is special because it starts with non-zero values and ignores filter weights.
+template<typename T>
+void resampleRowMinimum(MadProgram const& program, T const* UTILS_RESTRICT source,
+        T* UTILS_RESTRICT target, uint32_t twidth) {
+    for (uint32_t n = 0; n < twidth; ++n) {
+        target[n] = T(std::numeric_limits<float>::max());
+    }
+    for (auto const& mad : program) {
+        target[mad.targetIndex] = minimum(target[mad.targetIndex], source[mad.sourceIndex]);
+    }
+}
+
+template<typename T>
+void resampleRows(JobSystem* js, MadProgram const& program, bool isMinimum,
+        LinearImage const& source, LinearImage& result) {
+    const uint32_t sstride = source.getWidth() * source.getChannels();
+    const uint32_t tstride = result.getWidth() * result.getChannels();
+    const uint32_t twidth = tstride * sizeof(float) / sizeof(T);
+    float const* const sourceData = source.getPixelRef();
+    float* const targetData = result.getPixelRef();
+    parallelFor(js, source.getHeight(), [&](uint32_t begin, uint32_t count) {
+        for (uint32_t row = begin; row < begin + count; ++row) {
+            T const* const sourceRow = (T const*)(sourceData + row * sstride);
+            T* const targetRow = (T*)(targetData + row * tstride);
+            if (isMinimum) {
+                resampleRowMinimum(program, sourceRow, targetRow, twidth);
+            } else {
+                resampleRow(program, sourceRow, targetRow);
+            }
+        }
+    });
+}
+
+LinearImage resampleImage1D(JobSystem* js, const LinearImage& source, MadProgram* program,
         uint32_t twidth, Filter filter, float left, float right, float filterRadiusMultiplier) {
     const uint32_t swidth = source.getWidth();
     const uint32_t sheight = source.getHeight();
@@ -238,37 +311,21 @@ LinearImage resampleImage1D(const LinearImage& source, MadProgram* program,
     // Generate a flat list of multiply-add (MAD) instructions.
     program->clear();
     generateMadProgram(twidth, swidth, left, right, hfn, filterRadiusMultiplier, program);
-    expandMadProgram(nchan, program);
 
     // Allocate the target image.
     LinearImage result(twidth, sheight, nchan);
-    float const* sourceRow = source.getPixelRef();
-    float* targetRow = result.getPixelRef();
-
-    // The MIN filter is special because it starts with non-zero values and ignores filter weights.
-    if (filter == Filter::MINIMUM) {
-        for (uint32_t n = 0; n < twidth * sheight * nchan; ++n) {
-            targetRow[n] = std::numeric_limits<float>::max();
-        }
-        for (uint32_t row = 0; row < sheight; ++row) {
-            for (auto mad : *program) {
-                const float a = sourceRow[mad.sourceIndex];
-                const float b = targetRow[mad.targetIndex];
-                targetRow[mad.targetIndex] = std::min(a, b);
-            }
-            targetRow += twidth * nchan;
-            sourceRow += swidth * nchan;
-        }
-        return result;
-    }
 
     // Resize the image horizontally by executing the MAD instructions over each row.
-    for (uint32_t row = 0; row < sheight; ++row) {
-        for (auto mad : *program) {
-            targetRow[mad.targetIndex] += sourceRow[mad.sourceIndex] * mad.weight;
-        }
-        targetRow += twidth * nchan;
-        sourceRow += swidth * nchan;
+    const bool isMinimum = filter == Filter::MINIMUM;
+    switch (nchan) {
+        case 1: resampleRows<float>(js, *program, isMinimum, source, result); break;
+        case 2: resampleRows<float2>(js, *program, isMinimum, source, result); break;
+        case 3: resampleRows<float3>(js, *program, isMinimum, source, result); break;
+        case 4: resampleRows<float4>(js, *program, isMinimum, source, result); break;
+        default:
+            expandMadProgram(nchan, program);
+            resampleRows<float>(js, *program, isMinimum, source, result);
+            break;
     }
 
     // Perform post processing for the current pass.
@@ -278,16 +335,8 @@ LinearImage resampleImage1D(const LinearImage& source, MadProgram* program,
     return result;
 }
 
-} // anonymous namespace
-
-namespace image {
-
-SingleSample::~SingleSample() {
-    delete[] data;
-}
-
-LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t height,
-        const ImageSampler& sampler) {
+LinearImage resample(JobSystem* js, const LinearImage& source, uint32_t width,
+        uint32_t height, const ImageSampler& sampler) {
     FILAMENT_CHECK_PRECONDITION(sampler.east.mode == Boundary::EXCLUDE &&
             sampler.north.mode == Boundary::EXCLUDE && sampler.west.mode == Boundary::EXCLUDE &&
             sampler.south.mode == Boundary::EXCLUDE)
@@ -301,11 +350,38 @@ LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t he
     const float bottom = sampler.sourceRegion.bottom;
     MadProgram program;
     LinearImage result;
-    result = transpose(resampleImage1D(source, &program, width, hfilter, left, right, radius));
-    result = transpose(resampleImage1D(result, &program, height, vfilter, top, bottom, radius));
+    auto transposeImage = [js](LinearImage const& image) {
+        return js ? transpose(*js, image) : transpose(image);
+    };
+    result = transposeImage(
+            resampleImage1D(js, source, &program, width, hfilter, left, right, radius));
+    result = transposeImage(
+            resampleImage1D(js, result, &program, height, vfilter, top, bottom, radius));
     return result;
 }
 
+// Generates the given level of a mipmap chain (0 being the first level after the base level)
+LinearImage generateMipmap(JobSystem* js, const LinearImage& source, Filter filter,
+        uint32_t level) {
+    const uint32_t width = std::max(source.getWidth() >> (level + 1u), 1u);
+    const uint32_t height = std::max(source.getHeight() >> (level + 1u), 1u);
+    return resample(js, source, width, height,
+            ImageSampler{ .horizontalFilter = filter, .verticalFilter = filter });
+}
+
+} // anonymous namespace
+
+namespace image {
+
+SingleSample::~SingleSample() {
+    delete[] data;
+}
+
+LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t height,
+        const ImageSampler& sampler) {
+    return resample(nullptr, source, width, height, sampler);
+}
+
 LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t height,
         Filter filter) {
     return resampleImage(source, width, height, ImageSampler {
@@ -314,6 +390,19 @@ LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t he
     });
 }
 
+LinearImage resampleImage(JobSystem& js, const LinearImage& source, uint32_t width,
+        uint32_t height, const ImageSampler& sampler) {
+    return resample(&js, source, width, height, sampler);
+}
+
+LinearImage resampleImage(JobSystem& js, const LinearImage& source, uint32_t width,
+        uint32_t height, Filter filter) {
+    return resample(&js, source, width, height, ImageSampler {
+        .horizontalFilter = filter,
+        .verticalFilter = filter
+    });
+}
+
 void computeSingleSample(const LinearImage& source, float x, float y, SingleSample* result,
         Filter filter) {
     const float radius = 1.0f;
@@ -322,8 +411,9 @@ void computeSingleSample(const LinearImage& source, float x, float y, SingleSamp
     const float right = x + radius / source.getWidth();
     const float bottom = y + radius / source.getHeight();
     MadProgram program;
-    LinearImage row = transpose(resampleImage1D(source, &program, 1, filter, left, right, radius));
-    row = resampleImage1D(row, &program, 1, filter, top, bottom, radius);
+    LinearImage row = transpose(
+            resampleImage1D(nullptr, source, &program, 1, filter, left, right, radius));
+    row = resampleImage1D(nullptr, row, &program, 1, filter, top, bottom, radius);
     if (!result->data) {
         result->data = new float[source.getChannels()];
     }
@@ -339,13 +429,22 @@ void computeSingleSample(const LinearImage& source, float x, float y, SingleSamp
 // image, under the premise that this produces a higher quality result.
 void generateMipmaps(const LinearImage& source, Filter filter, LinearImage* result, uint32_t mips) {
     mips = std::min(mips, getMipmapCount(source));
-    uint32_t width = source.getWidth();
-    uint32_t height = source.getHeight();
     for (uint32_t n = 0; n < mips; ++n) {
-        width = std::max(width >> 1u, 1u);
-        height = std::max(height >> 1u, 1u);
-        result[n] = resampleImage(source, width, height, filter);
+        result[n] = generateMipmap(nullptr, source, filter, n);
+    }
+}
+
+// Since all levels are generated from the original image, they're also generated concurrently.
+void generateMipmaps(JobSystem& js, const LinearImage& source, Filter filter,
+        LinearImage* result, uint32_t mips) {
+    mips = std::min(mips, getMipmapCount(source));
+    JobSystem::Job* root = js.createJob();
+    for (uint32_t n = 0; n < mips; ++n) {
+        js.run(jobs::createJob(js, root, [&js, &source, filter, result, n]() {
+            result[n] = generateMipmap(&js, source, filter, n);
+        }));
     }
+    js.runAndWait(root);
 }
 
 uint32_t getMipmapCount(const LinearImage& source) {
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IMAGE_PARALLELFOR_H
+#define IMAGE_PARALLELFOR_H
+
+#include <utils/JobSystem.h>
+
+#include <functional>
+
+#include <stdint.h>
+
+namespace image {
+
+// Calls work(begin, count) over ranges of [0, count), in parallel if a JobSystem is provided.
+template<typename T>
+inline void parallelFor(utils::JobSystem* js, uint32_t count, T const& work) {
+    if (!js) {
+        work(0, count);
+        return;
+    }
+    auto* job = utils::jobs::parallel_for(*js, nullptr, 0, count, std::cref(work),
+            utils::jobs::CountSplitter<16>());
+    js->runAndWait(job);
+}
+
+} // namespace image
+
+#endif // IMAGE_PARALLELFOR_H
@@ -26,12 +26,14 @@
 
 #include <gtest/gtest.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Panic.h>
 #include <utils/Path.h>
 
 #include <math/vec3.h>
 #include <math/vec4.h>
 
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <sstream>
@@ -362,6 +364,58 @@ TEST_F(ImageTest, Mipmaps) { // NOLINT
     }
 }
 
+TEST_F(ImageTest, ParallelOps) { // NOLINT
+    utils::JobSystem js;
+    js.adopt();
+
+    auto expectIdentical = [](LinearImage const& a, LinearImage const& b) {
+        ASSERT_EQ(a.getWidth(), b.getWidth());
+        ASSERT_EQ(a.getHeight(), b.getHeight());
+        ASSERT_EQ(a.getChannels(), b.getChannels());
+        size_t const size = a.getWidth() * a.getHeight() * a.getChannels() * sizeof(float);
+        EXPECT_EQ(0, memcmp(a.getPixelRef(), b.getPixelRef(), size));
+    };
+
+    // 1, 3, 4 and 5 channels, the latter doesn't fit in a vector
+    auto depths = createDepthMap(128);
+    auto normals = createNormalMap(128);
+    auto colors = resampleImage(createColorFromAscii("44444 41014 40704 41014 44444"),
+            129, 67, Filter::MITCHELL);
+    auto wide = combineChannels({ depths, extractChannel(normals, 0), extractChannel(normals, 1),
+            extractChannel(normals, 2), depths });
+    ASSERT_EQ(wide.getChannels(), 5);
+
+    for (auto const& src : { depths, normals, colors, wide }) {
+        for (Filter filter : { Filter::DEFAULT, Filter::BOX, Filter::NEAREST, Filter::HERMITE,
+                Filter::GAUSSIAN_SCALARS, Filter::MITCHELL, Filter::LANCZOS, Filter::MINIMUM }) {
+            expectIdentical(resampleImage(src, 61, 37, filter),
+                    resampleImage(js, src, 61, 37, filter));
+            expectIdentical(resampleImage(src, 150, 250, filter),
+                    resampleImage(js, src, 150, 250, filter));
+        }
+        expectIdentical(transpose(src), transpose(js, src));
+    }
+    expectIdentical(resampleImage(normals, 16, 16, Filter::GAUSSIAN_NORMALS),
+            resampleImage(js, normals, 16, 16, Filter::GAUSSIAN_NORMALS));
+
+    uint32_t const count = getMipmapCount(colors);
+    vector<LinearImage> mips(count);
+    vector<LinearImage> parallelMips(count);
+    generateMipmaps(colors, Filter::DEFAULT, mips.data(), count);
+    generateMipmaps(js, colors, Filter::DEFAULT, parallelMips.data(), count);
+    for (uint32_t index = 0; index < count; ++index) {
+        expectIdentical(mips[index], parallelMips[index]);
+    }
+
+    auto presence = [] (const LinearImage& img, uint32_t col, uint32_t row, void*) {
+        return img.getPixelRef(col, row)[0] > 0.5f;
+    };
+    expectIdentical(computeCoordField(depths, presence, nullptr),
+            computeCoordField(js, depths, presence, nullptr));
+
+    js.emancipate();
+}
+
 TEST_F(ImageTest, Ktx) { // NOLINT
     uint8_t foo[] = {1, 2, 3};
     uint8_t* data;
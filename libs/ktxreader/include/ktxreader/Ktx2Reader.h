@@ -131,6 +131,16 @@ class Ktx2Reader {
              */
             Result doTranscoding();
 
+            /**
+             * Transcodes a single mipmap level. Different levels can be transcoded concurrently
+             * from several threads, which allows the caller to schedule (and cancel) the work at
+             * level granularity.
+             */
+            Result doTranscoding(size_t levelIndex);
+
+            /** Number of mipmap levels in the texture. */
+            size_t getLevelCount() const noexcept;
+
             /**
              * Uploads pending mipmaps to the texture.
              *
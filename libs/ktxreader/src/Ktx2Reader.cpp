@@ -170,6 +170,8 @@ public:
             mSourceBuffer(std::move(buf)) {}
     Texture* getTexture() const noexcept { return mTexture; }
     Result doTranscoding();
+    Result doTranscoding(size_t levelIndex);
+    size_t getLevelCount() const noexcept { return mTranscoder->get_levels(); }
     void uploadImages();
 
 protected:
@@ -273,20 +275,29 @@ FAsync::~FAsync() {
 }
 
 Result FAsync::doTranscoding() {
-    ktx2_transcoder_state basisThreadState;
-    basisThreadState.clear();
-    for (uint32_t levelIndex = 0, n = mTranscoder->get_levels(); levelIndex < n; levelIndex++) {
-        Texture::PixelBufferDescriptor* pbd;
-        Result result = transcodeImageLevel(*mTranscoder, basisThreadState, mTexture->getFormat(),
-                levelIndex, &pbd);
+    for (size_t levelIndex = 0, n = mTranscoder->get_levels(); levelIndex < n; levelIndex++) {
+        Result const result = doTranscoding(levelIndex);
         if (UTILS_UNLIKELY(result != Result::SUCCESS)) {
             return result;
         }
-        mTranscoderResults[levelIndex].store(pbd);
     }
     return Result::SUCCESS;
 }
 
+Result FAsync::doTranscoding(size_t levelIndex) {
+    assert_invariant(levelIndex < mTranscoder->get_levels());
+    // transcode_image_level() is thread-safe as long as each thread uses its own state
+    ktx2_transcoder_state basisThreadState;
+    basisThreadState.clear();
+    Texture::PixelBufferDescriptor* pbd;
+    Result const result = transcodeImageLevel(*mTranscoder, basisThreadState,
+            mTexture->getFormat(), uint32_t(levelIndex), &pbd);
+    if (UTILS_LIKELY(result == Result::SUCCESS)) {
+        mTranscoderResults[levelIndex].store(pbd);
+    }
+    return result;
+}
+
 void FAsync::uploadImages() {
     size_t levelIndex = 0;
     UTILS_NOUNROLL
@@ -434,6 +445,14 @@ Result Async::doTranscoding() {
     return static_cast<FAsync*>(this)->doTranscoding();
 }
 
+Result Async::doTranscoding(size_t levelIndex) {
+    return static_cast<FAsync*>(this)->doTranscoding(levelIndex);
+}
+
+size_t Async::getLevelCount() const noexcept {
+    return static_cast<FAsync const*>(this)->getLevelCount();
+}
+
 void Async::uploadImages() {
     return static_cast<FAsync*>(this)->uploadImages();
 }
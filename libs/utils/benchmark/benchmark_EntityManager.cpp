@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <utils/Entity.h>
+#include <utils/EntityManager.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace utils;
+
+/*
+ * Each thread creates then destroys state.range(0) entities per iteration, with the global
+ * EntityManager. Batches smaller than 64 entities go through the per-thread caches.
+ */
+static void BM_EntityManager_createDestroy(benchmark::State& state) {
+    EntityManager& em = EntityManager::get();
+    std::vector<Entity> entities(size_t(state.range(0)));
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            em.create(entities.size(), entities.data());
+            em.destroy(entities.size(), entities.data());
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * entities.size()));
+}
+
+BENCHMARK(BM_EntityManager_createDestroy)
+    ->ArgName("batch")
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(256)
+    ->Threads(1)
+    ->Threads(2)
+    ->Threads(4)
+    ->Threads(8)
+    ->Threads(16)
+    ->UseRealTime();
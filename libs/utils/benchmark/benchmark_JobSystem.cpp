@@ -21,6 +21,8 @@
 
 #include <benchmark/benchmark.h>
 
+#include <vector>
+
 using namespace utils;
 
 
@@ -78,7 +80,117 @@ static void BM_JobSystemParallelFor(benchmark::State& state) {
     js.emancipate();
 }
 
+static void BM_JobSystemFanIn(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+
+    // measures the latency between the last of N predecessors completing and the successor
+    size_t const n = size_t(state.range(0));
+    std::vector<JobSystem::Job*> predecessors(n);
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            auto root = js.create(nullptr, &emptyJob);
+            auto successor = js.create(root, &emptyJob);
+            for (size_t i = 0; i < n; i++) {
+                predecessors[i] = js.create(root, &emptyJob);
+                js.addDependency(predecessors[i], successor);
+            }
+            js.run(successor);
+            for (size_t i = 0; i < n; i++) {
+                js.run(predecessors[i]);
+            }
+            js.runAndWait(root);
+        }
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * int64_t(n + 2));
+
+    js.emancipate();
+}
+
+static void BM_JobSystemFanOut(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+
+    size_t const n = size_t(state.range(0));
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            auto root = js.create(nullptr, &emptyJob);
+            auto predecessor = js.create(root, &emptyJob);
+            for (size_t i = 0; i < n; i++) {
+                auto successor = js.create(root, &emptyJob);
+                js.addDependency(predecessor, successor);
+                js.run(successor);
+            }
+            js.run(predecessor);
+            js.runAndWait(root);
+        }
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * int64_t(n + 2));
+
+    js.emancipate();
+}
+
+// Same graph as BM_JobSystemFanOut followed by BM_JobSystemFanIn, but with the calling thread
+// waiting in between, which is how this had to be expressed without dependencies.
+static void BM_JobSystemFanOutFanInWait(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+
+    size_t const n = size_t(state.range(0));
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            js.runAndWait(js.create(nullptr, &emptyJob));
+            auto parent = js.create(nullptr, &emptyJob);
+            for (size_t i = 0; i < n; i++) {
+                js.run(js.create(parent, &emptyJob));
+            }
+            js.runAndWait(parent);
+            js.runAndWait(js.create(nullptr, &emptyJob));
+        }
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * int64_t(n + 3));
+
+    js.emancipate();
+}
+
+static void BM_JobSystemFanOutFanIn(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+
+    size_t const n = size_t(state.range(0));
+    std::vector<JobSystem::Job*> jobs(n);
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            auto root = js.create(nullptr, &emptyJob);
+            auto first = js.create(root, &emptyJob);
+            auto last = js.create(root, &emptyJob);
+            for (size_t i = 0; i < n; i++) {
+                jobs[i] = js.create(root, &emptyJob);
+                js.addDependency(first, jobs[i]);
+                js.addDependency(jobs[i], last);
+            }
+            js.run(last);
+            for (size_t i = 0; i < n; i++) {
+                js.run(jobs[i]);
+            }
+            js.run(first);
+            js.runAndWait(root);
+        }
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * int64_t(n + 3));
+
+    js.emancipate();
+}
+
 
 BENCHMARK(BM_JobSystem);
 BENCHMARK(BM_JobSystemAsChildren4k);
 BENCHMARK(BM_JobSystemParallelFor);
+BENCHMARK(BM_JobSystemFanIn)->Arg(4)->Arg(64)->Arg(JobSystem::MAX_PREDECESSOR_COUNT);
+BENCHMARK(BM_JobSystemFanOut)->Arg(4)->Arg(64)->Arg(1024);
+BENCHMARK(BM_JobSystemFanOutFanInWait)->Arg(4)->Arg(64)->Arg(JobSystem::MAX_PREDECESSOR_COUNT);
+BENCHMARK(BM_JobSystemFanOutFanIn)->Arg(4)->Arg(64)->Arg(JobSystem::MAX_PREDECESSOR_COUNT);
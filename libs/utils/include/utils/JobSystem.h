@@ -46,8 +46,13 @@ namespace utils {
 class JobSystem {
     static constexpr size_t MAX_JOB_COUNT = 1 << 14; // 16384
     static constexpr uint32_t JOB_COUNT_MASK = MAX_JOB_COUNT - 1;
+    // Job::runningJobCount layout: job count | has successors | predecessor count | waiter count
+    static constexpr uint32_t HAS_SUCCESSORS_BIT = 1u << 14;
+    static constexpr uint32_t PREDECESSOR_COUNT_SHIFT = 15;
+    static constexpr uint32_t PREDECESSOR_COUNT_MASK = 0x1FF;
     static constexpr uint32_t WAITER_COUNT_SHIFT = 24;
     static_assert(MAX_JOB_COUNT <= 0x7FFE, "MAX_JOB_COUNT must be <= 0x7FFE");
+    static_assert(JOB_COUNT_MASK < HAS_SUCCESSORS_BIT, "job count overlaps with flags");
     using WorkQueue = WorkStealingDequeue<uint16_t, MAX_JOB_COUNT>;
     using Mutex = utils::Mutex;
     using Condition = utils::Condition;
@@ -57,6 +62,9 @@ public:
 
     using ThreadId = uint8_t;
 
+    // Maximum number of predecessors of a job, see addDependency()
+    static constexpr size_t MAX_PREDECESSOR_COUNT = PREDECESSOR_COUNT_MASK - 1;
+
     using JobFunc = void(*)(void*, JobSystem&, Job*);
 
     static constexpr ThreadId invalidThreadId = 0xff;
@@ -261,11 +269,31 @@ public:
 
     /*
      * Jobs are normally finished automatically, this can be used to cancel a job before it is run.
+     * The successors of a canceled job are run as if it had completed.
      *
-     * Never use this once a flavor of run() has been called.
+     * Never use this once a flavor of run() has been called, or on a job with predecessors.
      */
     void cancel(Job*& job) noexcept;
 
+    /*
+     * Makes `successor` wait for `predecessor` to complete (i.e. itself and all its children)
+     * before it starts. This allows to express a graph of jobs without blocking any thread.
+     *
+     * A job can have up to MAX_PREDECESSOR_COUNT predecessors and any number of successors.
+     * Neither job can have been run yet. A successor must still be run() as usual: it'll be
+     * queued automatically when both run() has been called and all its predecessors completed.
+     *
+     *  Job* a = js.createJob(root, ...);
+     *  Job* b = js.createJob(root, ...);
+     *  Job* c = js.createJob(root, ...);
+     *  js.addDependency(a, c);
+     *  js.addDependency(b, c);
+     *  js.run(c);  // c runs after a and b
+     *  js.run(a);
+     *  js.run(b);
+     */
+    void addDependency(Job* predecessor, Job* successor) noexcept;
+
     /*
      * Adds a reference to a Job.
      *
@@ -415,8 +443,16 @@ private:
 
     ThreadState& getState() noexcept;
 
+    // an edge of the job graph, see addDependency()
+    struct Edge {
+        Job* successor;
+        Edge* next;
+    };
+
     static void incRef(Job const* job) noexcept;
     void decRef(Job const* job) noexcept;
+    static bool removePredecessor(Job* job) noexcept;
+    void runSuccessors(ThreadState* state, Job* job) noexcept;
 
     Job* allocateJob() noexcept;
     JobSystem::ThreadState* getStateToStealFrom(JobSystem::ThreadState& state) noexcept;
@@ -429,7 +465,7 @@ private:
     void loop(ThreadState* state) noexcept;
     bool execute(JobSystem::ThreadState& state) noexcept;
     Job* steal(JobSystem::ThreadState& state) noexcept;
-    void finish(Job* job) noexcept;
+    void finish(Job* job, ThreadState* state) noexcept;
 
     void put(WorkQueue& workQueue, Job* job) noexcept;
     Job* pop(WorkQueue& workQueue) noexcept;
@@ -447,6 +483,7 @@ private:
 
     std::atomic<int32_t> mActiveJobs = { 0 };
     utils::Arena<utils::ObjectPoolAllocator<Job>, LockingPolicy::Mutex> mJobPool;
+    utils::Arena<utils::ObjectPoolAllocator<Edge>, LockingPolicy::Mutex> mEdgePool;
 
     template <typename T>
     using aligned_vector = std::vector<T, utils::STLAlignedAllocator<T>>;
@@ -465,6 +502,7 @@ private:
     uint16_t mThreadCount = 0;                          // total # of threads in the pool
     uint8_t mParallelSplitCount = 0;                    // # of split allowable in parallel_for
     Job* mRootJob = nullptr;
+    std::vector<Edge*> mSuccessors;                     // successors of each job, by job index
 
     Mutex mThreadMapLock; // this should have very little contention
     tsl::robin_map<std::thread::id, ThreadState *> mThreadMap;
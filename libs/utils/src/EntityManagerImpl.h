@@ -19,6 +19,7 @@
 
 #include <utils/EntityManager.h>
 
+#include <utils/architecture.h>
 #include <utils/compiler.h>
 #include <utils/Entity.h>
 #include <utils/Mutex.h>
@@ -31,6 +32,7 @@
 #include <tsl/robin_map.h>
 #endif
 
+#include <atomic>
 #include <deque>
 #include <mutex> // for std::lock_guard
 #include <vector>
@@ -50,82 +52,124 @@ public:
 
     UTILS_NOINLINE
     size_t getEntityCount() const noexcept {
-        std::lock_guard<Mutex> const lock(mFreeListLock);
-        if (mCurrentIndex < RAW_INDEX_COUNT) {
-            return (mCurrentIndex - 1) - mFreeList.size();
-        } else {
-            return getMaxEntityCount() - mFreeList.size();
-        }
+        return mEntityCount.load(std::memory_order_relaxed);
     }
 
     UTILS_NOINLINE
     void create(size_t n, Entity* entities) {
-        Entity::Type index{};
-        auto& freeList = mFreeList;
         uint8_t* const gens = mGens;
-
-        // this must be thread-safe, acquire the free-list mutex
-        std::lock_guard<Mutex> const lock(mFreeListLock);
-        Entity::Type currentIndex = mCurrentIndex;
-        for (size_t i = 0; i < n; i++) {
-            if (UTILS_UNLIKELY(currentIndex >= RAW_INDEX_COUNT || freeList.size() >= MIN_FREE_INDICES)) {
-
-                // this could only happen if we had gone through all the indices at least once
-                if (UTILS_UNLIKELY(freeList.empty())) {
+        size_t created = 0;
+
+        if (n < CACHE_SIZE) {
+            // small batches are served by this thread's cache
+            Cache& cache = getCache();
+            std::lock_guard<Mutex> const lock(cache.lock);
+            for (size_t i = 0; i < n; i++) {
+                if (UTILS_UNLIKELY(cache.availableBegin == cache.availableEnd)) {
+                    refill(cache);
+                    if (UTILS_UNLIKELY(cache.availableBegin == cache.availableEnd)) {
+                        // return the null entity
+                        entities[i] = {};
+                        continue;
+                    }
+                }
+                Entity::Type const index = cache.available[cache.availableBegin++];
+                entities[i] = Entity{ makeIdentity(gens[index], index) };
+                created++;
+            }
+        } else {
+            // this must be thread-safe, acquire the free-list mutex
+            std::lock_guard<Mutex> const lock(mFreeListLock);
+            for (size_t i = 0; i < n; i++) {
+                Entity::Type index;
+                if (UTILS_UNLIKELY(!allocateLocked(1, &index))) {
                     // return the null entity
                     entities[i] = {};
                     continue;
                 }
-
-                index = freeList.front();
-                freeList.pop_front();
-            } else {
-                index = currentIndex++;
+                entities[i] = Entity{ makeIdentity(gens[index], index) };
+                created++;
             }
-            entities[i] = Entity{ makeIdentity(gens[index], index) };
+        }
+
 #if FILAMENT_UTILS_TRACK_ENTITIES
-            mDebugActiveEntities.emplace(entities[i], CallStack::unwind(5));
-#endif
+        std::lock_guard<Mutex> const lock(mFreeListLock);
+        for (size_t i = 0; i < n; i++) {
+            if (entities[i]) {
+                mDebugActiveEntities.emplace(entities[i], CallStack::unwind(5));
+            }
         }
-        mCurrentIndex = currentIndex;
+#endif
+
+        mEntityCount.fetch_add(created, std::memory_order_relaxed);
     }
 
     UTILS_NOINLINE
     void destroy(size_t n, Entity* entities) noexcept {
-        auto& freeList = mFreeList;
         uint8_t* const gens = mGens;
+        size_t destroyed = 0;
 
-        std::unique_lock<Mutex> lock(mFreeListLock);
-        for (size_t i = 0; i < n; i++) {
-            if (!entities[i]) {
+        // Destroying the same Entity from two threads at the same time is an error, like
+        // destroying it twice.
+        auto release = [&](Entity const e, auto&& push) {
+            if (!e) {
                 // behave like free(), ok to free null Entity.
-                continue;
+                return;
             }
 
             // it's an error to delete an Entity twice...
-            assert(isAlive(entities[i]));
+            assert(isAlive(e));
 
             // ... deleting a dead Entity will corrupt the internal state, so we protect ourselves
             // against it. We don't guarantee anything about external state -- e.g. the listeners
             // will be called.
-            if (isAlive(entities[i])) {
-                Entity::Type const index = getIndex(entities[i]);
-                freeList.push_back(index);
+            if (isAlive(e)) {
+                Entity::Type const index = getIndex(e);
+                push(index);
 
                 // The generation update doesn't require the lock because it's only used for isAlive()
                 // and entities work as weak references -- it just means that isAlive() could return
                 // true a little longer than expected in some other threads.
-                // We do need a memory fence though, it is provided by the mFreeListLock.unlock() below.
+                // We do need a memory fence though, it is provided by the unlock() below.
                 gens[index]++;
+                destroyed++;
+            }
+        };
+
+        if (n < CACHE_SIZE) {
+            // small batches are returned to the free-list through this thread's cache
+            Cache& cache = getCache();
+            std::lock_guard<Mutex> const lock(cache.lock);
+            for (size_t i = 0; i < n; i++) {
+                release(entities[i], [&](Entity::Type const index) {
+                    if (UTILS_UNLIKELY(cache.releasedCount == CACHE_SIZE)) {
+                        std::lock_guard<Mutex> const freeListLock(mFreeListLock);
+                        flushReleasedLocked(cache);
+                    }
+                    cache.released[cache.releasedCount++] = index;
+                });
+            }
+        } else {
+            std::lock_guard<Mutex> const lock(mFreeListLock);
+            for (size_t i = 0; i < n; i++) {
+                release(entities[i], [&](Entity::Type const index) {
+                    mFreeList.push_back(index);
+                });
+            }
+        }
 
 #if FILAMENT_UTILS_TRACK_ENTITIES
+        {
+            std::lock_guard<Mutex> const lock(mFreeListLock);
+            for (size_t i = 0; i < n; i++) {
                 mDebugActiveEntities.erase(entities[i]);
-#endif
             }
         }
-        lock.unlock();
+#endif
 
-        // notify our listeners that some entities are being destroyed
+        mEntityCount.fetch_sub(destroyed, std::memory_order_relaxed);
+
+        // notify our listeners that some entities are being destroyed, once per batch
         auto listeners = getListeners();
         for (auto const& l : listeners) {
             l->onEntitiesDestroyed(n, entities);
@@ -162,6 +206,67 @@ public:
 #endif
 
 private:
+    // Creating or destroying fewer than CACHE_SIZE entities goes through a per-thread cache of
+    // indices, so that the free-list lock is only taken once every CACHE_SIZE entities. Threads
+    // are assigned one of CACHE_COUNT caches in turn. At most CACHE_COUNT * 2 * CACHE_SIZE free
+    // indices can be held in the caches.
+    static constexpr size_t CACHE_SIZE = 64;
+    static constexpr size_t CACHE_COUNT = 16;
+
+    struct alignas(CACHELINE_SIZE) Cache {
+        Mutex lock;
+        // indices ready to be handed out by create(), in [availableBegin, availableEnd)
+        uint32_t availableBegin = 0;
+        uint32_t availableEnd = 0;
+        // indices of destroyed entities, not yet in the free-list
+        uint32_t releasedCount = 0;
+        Entity::Type available[CACHE_SIZE];
+        Entity::Type released[CACHE_SIZE];
+    };
+
+    Cache& getCache() noexcept {
+        static std::atomic<uint32_t> sNextCache{ 0 };
+        static thread_local uint32_t const sCache =
+                sNextCache.fetch_add(1, std::memory_order_relaxed) % CACHE_COUNT;
+        return mCaches[sCache];
+    }
+
+    // Allocates up to n indices, returns how many were allocated. mFreeListLock must be held.
+    size_t allocateLocked(size_t n, Entity::Type* indices) noexcept {
+        auto& freeList = mFreeList;
+        Entity::Type currentIndex = mCurrentIndex;
+        size_t count = 0;
+        for (; count < n; count++) {
+            if (UTILS_UNLIKELY(currentIndex >= RAW_INDEX_COUNT || freeList.size() >= MIN_FREE_INDICES)) {
+                // this could only happen if we had gone through all the indices at least once
+                if (UTILS_UNLIKELY(freeList.empty())) {
+                    break;
+                }
+                indices[count] = freeList.front();
+                freeList.pop_front();
+            } else {
+                indices[count] = currentIndex++;
+            }
+        }
+        mCurrentIndex = currentIndex;
+        return count;
+    }
+
+    // mFreeListLock must be held.
+    void flushReleasedLocked(Cache& cache) noexcept {
+        mFreeList.insert(mFreeList.end(), cache.released, cache.released + cache.releasedCount);
+        cache.releasedCount = 0;
+    }
+
+    // cache.lock must be held.
+    void refill(Cache& cache) noexcept {
+        std::lock_guard<Mutex> const lock(mFreeListLock);
+        // the indices this thread released can be reused when all others are taken
+        flushReleasedLocked(cache);
+        cache.availableBegin = 0;
+        cache.availableEnd = uint32_t(allocateLocked(CACHE_SIZE, cache.available));
+    }
+
     utils::FixedCapacityVector<EntityManager::Listener*> getListeners() const noexcept {
         std::lock_guard<Mutex> const lock(mListenerLock);
         tsl::robin_set<Listener*> const& listeners = mListeners;
@@ -171,6 +276,11 @@ private:
         return result; // the c++ standard guarantees a move
     }
 
+    Cache mCaches[CACHE_COUNT];
+
+    std::atomic<size_t> mEntityCount{ 0 };
+
+    // mCurrentIndex and mFreeList are protected by mFreeListLock
     uint32_t mCurrentIndex = 1;
 
     // stores indices that got freed
@@ -172,7 +172,9 @@ void JobSystem::setThreadAffinityById(size_t id) noexcept {
 
 JobSystem::JobSystem(const size_t userThreadCount, const size_t adoptableThreadsCount) noexcept
     : mJobPool("JobSystem Job pool", MAX_JOB_COUNT * sizeof(Job)),
-      mJobStorageBase(static_cast<Job *>(mJobPool.getAllocator().getCurrent()))
+      mEdgePool("JobSystem Edge pool", MAX_JOB_COUNT * sizeof(Edge)),
+      mJobStorageBase(static_cast<Job *>(mJobPool.getAllocator().getCurrent())),
+      mSuccessors(MAX_JOB_COUNT, nullptr)
 {
     SYSTRACE_ENABLE();
 
@@ -254,6 +256,40 @@ void JobSystem::decRef(Job const* job) noexcept {
     }
 }
 
+// Removes a predecessor from a job, returns true if the job can be queued (i.e. it has no
+// predecessors left and it has been run()). Jobs without dependencies can always be queued.
+inline bool JobSystem::removePredecessor(Job* job) noexcept {
+    uint32_t const v = job->runningJobCount.load(std::memory_order_relaxed);
+    if (UTILS_LIKELY(!(v & (PREDECESSOR_COUNT_MASK << PREDECESSOR_COUNT_SHIFT)))) {
+        return true;
+    }
+    // std::memory_order_acq_rel here guarantees that the successor "sees" all changes made by
+    // its predecessors.
+    uint32_t const predecessorCount = (job->runningJobCount.fetch_sub(
+            1u << PREDECESSOR_COUNT_SHIFT, std::memory_order_acq_rel) >> PREDECESSOR_COUNT_SHIFT)
+                    & PREDECESSOR_COUNT_MASK;
+    assert_invariant(predecessorCount > 0);
+    return predecessorCount == 1;
+}
+
+UTILS_NOINLINE
+void JobSystem::runSuccessors(ThreadState* state, Job* job) noexcept {
+    size_t const index = job - mJobStorageBase;
+    Edge* edge = mSuccessors[index];
+    mSuccessors[index] = nullptr;
+    while (edge) {
+        if (removePredecessor(edge->successor)) {
+            if (!state) {
+                state = &getState();
+            }
+            put(state->workQueue, edge->successor);
+        }
+        Edge* const next = edge->next;
+        mEdgePool.destroy(edge);
+        edge = next;
+    }
+}
+
 void JobSystem::requestExit() noexcept {
     mExitRequested.store(true);
     std::lock_guard<Mutex> const lock(mWaiterLock);
@@ -432,7 +468,7 @@ bool JobSystem::execute(JobSystem::ThreadState& state) noexcept {
             job->function(job->storage, *this, job);
             job->id = invalidThreadId;
         }
-        finish(job);
+        finish(job, &state);
     }
     return job != nullptr;
 }
@@ -460,7 +496,7 @@ void JobSystem::loop(ThreadState* state) noexcept {
 }
 
 UTILS_NOINLINE
-void JobSystem::finish(Job* job) noexcept {
+void JobSystem::finish(Job* job, ThreadState* state) noexcept {
     HEAVY_SYSTRACE_CALL();
 
     bool notify = false;
@@ -480,6 +516,9 @@ void JobSystem::finish(Job* job) noexcept {
             if (waiters) {
                 notify = true;
             }
+            if (UTILS_UNLIKELY(v & HAS_SUCCESSORS_BIT)) {
+                runSuccessors(state, job);
+            }
             Job* const parent = job->parent == 0x7FFF ? nullptr : &storage[job->parent];
             decRef(job);
             job = parent;
@@ -525,10 +564,40 @@ JobSystem::Job* JobSystem::create(JobSystem::Job* parent, JobFunc func) noexcept
 }
 
 void JobSystem::cancel(Job*& job) noexcept {
-    finish(job);
+    // we can't cancel a job that's waiting for its predecessors
+    assert_invariant(!(job->runningJobCount.load(std::memory_order_relaxed) &
+            (PREDECESSOR_COUNT_MASK << PREDECESSOR_COUNT_SHIFT)));
+    finish(job, nullptr);
     job = nullptr;
 }
 
+void JobSystem::addDependency(Job* predecessor, Job* successor) noexcept {
+    assert_invariant(predecessor && successor && predecessor != successor);
+
+    // The first dependency also accounts for the pending run() of the successor, this way it
+    // is queued by whoever comes last: run() or its last predecessor.
+    // (the count can only decrease concurrently, so checking the loaded value is enough)
+    uint32_t const v = successor->runningJobCount.load(std::memory_order_relaxed);
+    uint32_t const predecessorCount = (v >> PREDECESSOR_COUNT_SHIFT) & PREDECESSOR_COUNT_MASK;
+    uint32_t const count = predecessorCount ? 1u : 2u;
+    FILAMENT_CHECK_PRECONDITION(predecessorCount + count <= MAX_PREDECESSOR_COUNT + 1)
+            << "Too many predecessors.";
+
+    Edge* const edge = mEdgePool.make<Edge>();
+    FILAMENT_CHECK_POSTCONDITION(edge) << "Too many job dependencies.";
+
+    size_t const index = predecessor - mJobStorageBase;
+    assert_invariant(index < MAX_JOB_COUNT);
+    edge->successor = successor;
+    edge->next = mSuccessors[index];
+    mSuccessors[index] = edge;
+
+    // memory_order_relaxed is safe because neither job is started yet
+    predecessor->runningJobCount.fetch_or(HAS_SUCCESSORS_BIT, std::memory_order_relaxed);
+    successor->runningJobCount.fetch_add(count << PREDECESSOR_COUNT_SHIFT,
+            std::memory_order_relaxed);
+}
+
 JobSystem::Job* JobSystem::retain(JobSystem::Job* job) noexcept {
     JobSystem::Job* retained = job;
     incRef(retained);
@@ -545,7 +614,10 @@ void JobSystem::run(Job*& job) noexcept {
 
     ThreadState& state(getState());
 
-    put(state.workQueue, job);
+    // if the job has predecessors, it is queued when the last one completes
+    if (removePredecessor(job)) {
+        put(state.workQueue, job);
+    }
 
     // after run() returns, the job is virtually invalid (it'll die on its own)
     job = nullptr;
@@ -557,7 +629,10 @@ void JobSystem::run(Job*& job, uint8_t id) noexcept {
     ThreadState& state = mThreadStates[id];
     assert_invariant(&state == &getState());
 
-    put(state.workQueue, job);
+    // if the job has predecessors, it is queued when the last one completes
+    if (removePredecessor(job)) {
+        put(state.workQueue, job);
+    }
 
     // after run() returns, the job is virtually invalid (it'll die on its own)
     job = nullptr;
@@ -17,6 +17,8 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "../src/EntityManagerImpl.h"
 #include <utils/NameComponentManager.h>
@@ -128,6 +130,49 @@ TEST(EntityTest, Lots) {
     // at this point, we should be getting indices from the free-list exclusively
 }
 
+TEST(EntityTest, Concurrent) {
+    EntityManagerImpl em;
+    constexpr size_t THREAD_COUNT = 8;
+    constexpr size_t ROUNDS = 100;
+    // a mix of batches served by the per-thread caches and of bulk batches
+    static constexpr size_t BATCH_SIZES[] = { 1, 7, 64, 200 };
+
+    std::vector<std::vector<Entity>> alive(THREAD_COUNT);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREAD_COUNT; t++) {
+        threads.emplace_back([&em, &entities = alive[t]]() {
+            for (size_t r = 0; r < ROUNDS; r++) {
+                for (size_t const n : BATCH_SIZES) {
+                    std::vector<Entity> batch(n);
+                    em.create(n, batch.data());
+                    entities.insert(entities.end(), batch.begin(), batch.end());
+                }
+                // destroy about half of what we have, keep the rest alive
+                size_t const count = entities.size() / 2;
+                em.destroy(count, entities.data());
+                entities.erase(entities.begin(), entities.begin() + count);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // all the entities still alive are distinct and accounted for
+    tsl::robin_set<uint32_t> ids;
+    for (auto const& entities : alive) {
+        for (Entity const e : entities) {
+            EXPECT_TRUE(em.isAlive(e));
+            EXPECT_TRUE(ids.insert(e.getId()).second);
+        }
+    }
+    EXPECT_EQ(em.getEntityCount(), ids.size());
+
+    for (auto& entities : alive) {
+        em.destroy(entities.size(), entities.data());
+    }
+    EXPECT_EQ(em.getEntityCount(), 0);
+}
 
 TEST(EntityTest, NameComponent) {
 
@@ -24,6 +24,7 @@
 
 #include <array>
 #include <thread>
+#include <vector>
 #include <utils/Allocator.h>
 
 using namespace utils;
@@ -342,5 +343,118 @@ TEST(JobSystem, JobSystemDelegates) {
     EXPECT_EQ(4, functor.result);
 
 
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemDependenciesFanIn) {
+    JobSystem js;
+    js.adopt();
+
+    for (bool runSuccessorFirst : { false, true }) {
+        std::atomic_int done = { 0 };
+        std::atomic_int seen = { -1 };
+
+        JobSystem::Job* root = js.createJob(nullptr);
+        JobSystem::Job* successor = jobs::createJob(js, root, [&done, &seen]() {
+            seen = done.load();
+        });
+
+        std::array<JobSystem::Job*, 64> predecessors;
+        for (auto& predecessor : predecessors) {
+            predecessor = jobs::createJob(js, root, [&done]() {
+                std::this_thread::yield();
+                done++;
+            });
+            js.addDependency(predecessor, successor);
+        }
+
+        if (runSuccessorFirst) {
+            js.run(successor);
+        }
+        for (auto* predecessor : predecessors) {
+            js.run(predecessor);
+        }
+        if (!runSuccessorFirst) {
+            js.run(successor);
+        }
+        js.runAndWait(root);
+
+        EXPECT_EQ(predecessors.size(), done.load());
+        EXPECT_EQ(predecessors.size(), seen.load());
+    }
+
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemDependenciesFanOut) {
+    JobSystem js;
+    js.adopt();
+
+    std::atomic_bool predecessorDone = { false };
+    std::atomic_int calls = { 0 };
+    std::atomic_int early = { 0 };
+
+    JobSystem::Job* root = js.createJob(nullptr);
+    JobSystem::Job* predecessor = jobs::createJob(js, root, [&predecessorDone]() {
+        predecessorDone = true;
+    });
+    for (int i = 0; i < 256; i++) {
+        JobSystem::Job* successor = jobs::createJob(js, root, [&]() {
+            early += predecessorDone ? 0 : 1;
+            calls++;
+        });
+        js.addDependency(predecessor, successor);
+        js.run(successor);
+    }
+    js.run(predecessor);
+    js.runAndWait(root);
+
+    EXPECT_EQ(256, calls.load());
+    EXPECT_EQ(0, early.load());
+
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemDependenciesChain) {
+    JobSystem js;
+    js.adopt();
+
+    // each link of the chain appends its index, the predecessor is a parallel_for whose
+    // children must all have completed before the chain starts
+    std::vector<int> order;
+    std::atomic_int processed = { 0 };
+    int seenByFirst = -1;
+
+    JobSystem::Job* root = js.createJob(nullptr);
+    JobSystem::Job* work = parallel_for(js, root, 0, 4096,
+            [&processed](uint32_t, uint32_t count) { processed += int(count); },
+            CountSplitter<64>());
+
+    JobSystem::Job* previous = work;
+    std::vector<JobSystem::Job*> chain;
+    for (int i = 0; i < 16; i++) {
+        JobSystem::Job* job = jobs::createJob(js, root, [&order, &processed, &seenByFirst, i]() {
+            if (i == 0) {
+                seenByFirst = processed.load();
+            }
+            order.push_back(i);
+        });
+        js.addDependency(previous, job);
+        chain.push_back(job);
+        previous = job;
+    }
+    // run the chain backward, it must still execute in order
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        js.run(*it);
+    }
+    js.run(work);
+    js.runAndWait(root);
+
+    EXPECT_EQ(4096, seenByFirst);
+    ASSERT_EQ(16, order.size());
+    for (int i = 0; i < 16; i++) {
+        EXPECT_EQ(i, order[i]);
+    }
+
     js.emancipate();
 }
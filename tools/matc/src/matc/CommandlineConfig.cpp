@@ -41,6 +41,7 @@ static void usage(char* name) {
             "\n"
             "Usages:\n"
             "    MATC [options] <input-file>\n"
+            "    MATC [options] --batch <list-file>\n"
             "\n"
             "Supported input formats:\n"
             "    Filament material definition (.mat)\n"
@@ -81,6 +82,17 @@ static void usage(char* name) {
             "           MATC -PflipUV=false -PshadingModel=lit -Pname=myMat ...\n\n"
             "   --reflect, -r\n"
             "       Reflect the specified metadata as JSON: parameters\n\n"
+            "   --batch <list-file>, -b <list-file>\n"
+            "       Compile many materials concurrently with the same options. Each line of\n"
+            "       <list-file> is an input file followed by its output file, separated by\n"
+            "       whitespace. Empty lines and lines starting with # are ignored.\n\n"
+            "   --cache <dir>, -c <dir>\n"
+            "       Cache the compiled shader of each variant in <dir>, so that variants whose\n"
+            "       generated code and options didn't change are not compiled again.\n"
+            "       The directory can be shared by concurrent invocations.\n\n"
+            "   --compress-spirv, -z\n"
+            "       Compress the SPIR-V shaders with zstd. The package is smaller, at the cost\n"
+            "       of a decompression when a shader is loaded.\n\n"
             "   --variant-filter=<filter>, -V <filter>\n"
             "       Filter out specified comma-separated variants:\n"
             "           directionalLighting, dynamicLighting, shadowReceiver, skinning, vsm, fog,"
@@ -181,7 +193,7 @@ static void parseDefine(std::string defineString, Config::StringReplacementMap&
 }
 
 bool CommandlineConfig::parse() {
-    static constexpr const char* OPTSTR = "hLxo:f:dm:a:l:p:D:T:P:OSEr:vV:gtwF1R";
+    static constexpr const char* OPTSTR = "hLxo:f:dm:a:l:p:D:T:P:OSEr:vV:gtwF1Rb:c:z";
     static const struct option OPTIONS[] = {
             { "help",                    no_argument, nullptr, 'h' },
             { "license",                 no_argument, nullptr, 'L' },
@@ -207,6 +219,9 @@ bool CommandlineConfig::parse() {
             { "raw",                     no_argument, nullptr, 'w' },
             { "no-sampler-validation",   no_argument, nullptr, 'F' },
             { "save-raw-variants",       no_argument, nullptr, 'R' },
+            { "batch",             required_argument, nullptr, 'b' },
+            { "cache",             required_argument, nullptr, 'c' },
+            { "compress-spirv",          no_argument, nullptr, 'z' },
             { nullptr, 0, nullptr, 0 }  // termination of the option list
     };
 
@@ -332,6 +347,15 @@ bool CommandlineConfig::parse() {
             case 'R':
                 mSaveRawVariants = true;
                 break;
+            case 'b':
+                mBatchFile = arg;
+                break;
+            case 'c':
+                mShaderCacheDirectory = arg;
+                break;
+            case 'z':
+                mCompressSpirv = true;
+                break;
         }
     }
 
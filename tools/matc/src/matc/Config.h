@@ -25,6 +25,7 @@
 #include <map>
 #include <memory>
 #include <ostream>
+#include <string>
 
 #include <utils/compiler.h>
 
@@ -115,6 +116,10 @@ public:
         return mSaveRawVariants;
     }
 
+    bool compressSpirv() const noexcept {
+        return mCompressSpirv;
+    }
+
     bool rawShaderMode() const noexcept {
         return mRawShaderMode;
     }
@@ -147,6 +152,16 @@ public:
         return mFeatureLevel;
     }
 
+    // File listing the materials to compile in batch mode, empty when not in batch mode.
+    const std::string& getBatchFile() const noexcept {
+        return mBatchFile;
+    }
+
+    // Directory of the post-processed shader cache, empty when there is no cache.
+    const std::string& getShaderCacheDirectory() const noexcept {
+        return mShaderCacheDirectory;
+    }
+
 protected:
     bool mDebug = false;
     bool mIsValid = true;
@@ -154,6 +169,7 @@ protected:
     bool mRawShaderMode = false;
     bool mNoSamplerValidation = false;
     bool mSaveRawVariants = false;
+    bool mCompressSpirv = false;
     Optimization mOptimizationLevel = Optimization::PERFORMANCE;
     Metadata mReflectionTarget = Metadata::NONE;
     Platform mPlatform = Platform::ALL;
@@ -165,6 +181,8 @@ protected:
     StringReplacementMap mMaterialParameters;
     filament::UserVariantFilterMask mVariantFilter = 0;
     bool mIncludeEssl1 = true;
+    std::string mBatchFile;
+    std::string mShaderCacheDirectory;
 };
 
 }
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DirShaderCache.h"
+
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+
+#include <stdio.h>
+
+namespace matc {
+
+DirShaderCache::DirShaderCache(utils::Path dir) noexcept
+        : mDirectory(std::move(dir)), mInstanceId(std::random_device{}()) {
+}
+
+utils::Path DirShaderCache::getEntryPath(std::string_view key) const noexcept {
+    // entries are spread over 256 sub-directories, named after the first two characters
+    std::string const name(key);
+    return mDirectory.concat(name.substr(0, 2)).concat(name);
+}
+
+bool DirShaderCache::get(std::string_view key, std::vector<uint8_t>& data) noexcept {
+    std::ifstream file(getEntryPath(key).getPath(), std::ios::binary);
+    if (!file) {
+        mMissCount++;
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (file.bad()) {
+        mMissCount++;
+        return false;
+    }
+    mHitCount++;
+    return true;
+}
+
+void DirShaderCache::put(std::string_view key, uint8_t const* data, size_t size) noexcept {
+    utils::Path const path = getEntryPath(key);
+    utils::Path const parent = path.getParent();
+    if (!parent.isDirectory()) {
+        // this can race with another writer, which is fine as long as the directory exists
+        parent.mkdirRecursive();
+    }
+
+    // the temporary name is unique to this process and entry
+    std::string const temporary = path.getPath() + "." + std::to_string(mInstanceId) + "." +
+            std::to_string(mTemporaryId++) + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        if (!file || !file.write(reinterpret_cast<char const*>(data), std::streamsize(size))) {
+            file.close();
+            remove(temporary.c_str());
+            return;
+        }
+    }
+    if (rename(temporary.c_str(), path.getPath().c_str()) != 0) {
+        // on some platforms rename() can't replace an existing file, another writer already
+        // stored the same content in that case.
+        remove(temporary.c_str());
+    }
+}
+
+} // namespace matc
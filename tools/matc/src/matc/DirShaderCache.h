@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_DIRSHADERCACHE_H_
+#define TNT_DIRSHADERCACHE_H_
+
+#include <filamat/ShaderCache.h>
+
+#include <utils/Path.h>
+
+#include <atomic>
+#include <string_view>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace matc {
+
+// ShaderCache storing each entry in its own file of a directory, which can be shared by several
+// matc processes. Entries are written to a temporary file first and then renamed, so a reader
+// never sees a partial entry.
+class DirShaderCache final : public filamat::ShaderCache {
+public:
+    explicit DirShaderCache(utils::Path dir) noexcept;
+
+    bool get(std::string_view key, std::vector<uint8_t>& data) noexcept override;
+    void put(std::string_view key, uint8_t const* data, size_t size) noexcept override;
+
+    size_t getHitCount() const noexcept { return mHitCount; }
+    size_t getMissCount() const noexcept { return mMissCount; }
+
+private:
+    utils::Path getEntryPath(std::string_view key) const noexcept;
+
+    utils::Path mDirectory;
+    std::atomic<size_t> mHitCount = 0;
+    std::atomic<size_t> mMissCount = 0;
+    uint32_t const mInstanceId;
+    std::atomic<uint32_t> mTemporaryId = 0;
+};
+
+} // namespace matc
+
+#endif // TNT_DIRSHADERCACHE_H_
@@ -16,9 +16,14 @@
 
 #include "MaterialCompiler.h"
 
+#include <algorithm>
+#include <fstream>
 #include <memory>
 #include <iostream>
+#include <sstream>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include <filamat/MaterialBuilder.h>
 
@@ -28,6 +33,7 @@
 #include <utils/JobSystem.h>
 
 #include "DirIncluder.h"
+#include "DirShaderCache.h"
 #include "MaterialLexeme.h"
 #include "MaterialLexer.h"
 #include "JsonishLexer.h"
@@ -289,7 +295,100 @@ bool MaterialCompiler::isValidJsonStart(const char* buffer, size_t size) const n
 }
 
 bool MaterialCompiler::run(const Config& config) {
-    Config::Input* input = config.getInput();
+    std::unique_ptr<DirShaderCache> shaderCache;
+    if (!config.getShaderCacheDirectory().empty()) {
+        shaderCache = std::make_unique<DirShaderCache>(
+                utils::Path(config.getShaderCacheDirectory()).getAbsolutePath());
+    }
+
+    if (!config.getBatchFile().empty()) {
+        return runBatch(config, shaderCache.get());
+    }
+
+    bool const isRawShader = config.rawShaderMode();
+    if (!isRawShader) {
+        MaterialBuilder::init();
+    }
+
+    JobSystem js;
+    js.adopt();
+
+    bool const success = compileMaterial(config, config.getInput(), config.getOutput(), js,
+            shaderCache.get());
+
+    js.emancipate();
+
+    if (!isRawShader) {
+        MaterialBuilder::shutdown();
+    }
+    return success;
+}
+
+bool MaterialCompiler::runBatch(const Config& config, DirShaderCache* shaderCache) {
+    std::ifstream list(config.getBatchFile());
+    if (!list) {
+        std::cerr << "Unable to open batch file '" << config.getBatchFile() << "'" << std::endl;
+        return false;
+    }
+
+    std::vector<std::unique_ptr<FilesystemInput>> inputs;
+    std::vector<std::unique_ptr<FilesystemOutput>> outputs;
+    std::string line;
+    while (std::getline(list, line)) {
+        std::istringstream fields(line);
+        std::string inputPath;
+        std::string outputPath;
+        if (!(fields >> inputPath) || inputPath[0] == '#') {
+            continue;
+        }
+        if (!(fields >> outputPath)) {
+            std::cerr << "Missing output filename for '" << inputPath << "'" << std::endl;
+            return false;
+        }
+        inputs.push_back(std::make_unique<FilesystemInput>(inputPath.c_str()));
+        outputs.push_back(std::make_unique<FilesystemOutput>(outputPath.c_str()));
+    }
+
+    if (inputs.empty()) {
+        return true;
+    }
+
+    MaterialBuilder::init();
+
+    JobSystem js;
+    js.adopt();
+
+    // The first material is compiled on its own, because glslang performs unguarded global
+    // operations on first use. All the others are then compiled concurrently, each of them
+    // also compiling its variants concurrently, through the same JobSystem.
+    std::vector<uint8_t> results(inputs.size(), false);
+    results[0] = compileMaterial(config, inputs[0].get(), outputs[0].get(), js, shaderCache);
+
+    JobSystem::Job* parent = js.createJob();
+    for (size_t i = 1; i < inputs.size(); i++) {
+        js.run(jobs::createJob(js, parent, [&, i]() {
+            results[i] = compileMaterial(config, inputs[i].get(), outputs[i].get(), js,
+                    shaderCache);
+        }));
+    }
+    js.runAndWait(parent);
+
+    js.emancipate();
+    MaterialBuilder::shutdown();
+
+    size_t const failureCount = std::count(results.begin(), results.end(), false);
+    std::cout << "Compiled " << inputs.size() - failureCount << " of " << inputs.size()
+            << " materials";
+    if (shaderCache) {
+        std::cout << ", " << shaderCache->getHitCount() << " shaders reused from the cache, "
+                << shaderCache->getMissCount() << " compiled";
+    }
+    std::cout << std::endl;
+    return failureCount == 0;
+}
+
+bool MaterialCompiler::compileMaterial(const Config& config, Config::Input* input,
+        Config::Output* output, JobSystem& js, ShaderCache* shaderCache) const {
     ssize_t size = input->open();
     if (size <= 0) {
         std::cerr << "Input file is empty" << std::endl;
@@ -363,13 +462,12 @@ bool MaterialCompiler::run(const Config& config) {
     if (config.rawShaderMode()) {
         const std::string extension = materialFilePath.getExtension();
         glslang::InitializeProcess();
-        bool const success = compileRawShader(buffer.get(), size, config.isDebug(), config.getOutput(),
+        bool const success = compileRawShader(buffer.get(), size, config.isDebug(), output,
                 extension.c_str());
         glslang::FinalizeProcess();
         return success;
     }
 
-    MaterialBuilder::init();
     MaterialBuilder builder;
     // Before attempting an expensive lex, let's find out if we were sent pure JSON.
     bool parsed;
@@ -404,6 +502,7 @@ bool MaterialCompiler::run(const Config& config) {
         .noSamplerValidation(config.noSamplerValidation())
         .includeEssl1(config.includeEssl1())
         .includeCallback(includer)
+        .shaderCache(shaderCache)
         .fileName(materialFilePath.getName().c_str())
         .platform(config.getPlatform())
         .targetApi(config.getTargetApi())
@@ -411,6 +510,7 @@ bool MaterialCompiler::run(const Config& config) {
         .printShaders(config.printShaders())
         .saveRawVariants(config.saveRawVariants())
         .generateDebugInfo(config.isDebug())
+        .compressSpirv(config.compressSpirv())
         .variantFilter(config.getVariantFilter() | builder.getVariantFilter());
 
     for (const auto& define : config.getDefines()) {
@@ -422,23 +522,29 @@ bool MaterialCompiler::run(const Config& config) {
         return false;
     }
 
-    JobSystem js;
-    js.adopt();
-
     // Write builder.build() to output.
     Package const package = builder.build(js);
 
-    js.emancipate();
-    MaterialBuilder::shutdown();
-
     if (!package.isValid()) {
         std::cerr << "Could not compile material " << input->getName() << std::endl;
         return false;
     }
-    return writePackage(package, config);
+    return writePackage(package, config, output);
 }
 
 bool MaterialCompiler::checkParameters(const Config& config) {
+    if (!config.getBatchFile().empty()) {
+        if (config.getInput() || config.getOutput()) {
+            std::cerr << "Input and output files are given by the batch file." << std::endl;
+            return false;
+        }
+        if (config.rawShaderMode() || config.getReflectionTarget() != Config::Metadata::NONE) {
+            std::cerr << "Batch mode only supports compiling materials." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
     // Check for input file.
     if (config.getInput() == nullptr) {
         std::cerr << "Missing input filename." << std::endl;
@@ -25,11 +25,16 @@
 
 namespace filamat {
 class MaterialBuilder;
+class ShaderCache;
+}
+namespace utils {
+class JobSystem;
 }
 class TestMaterialCompiler;
 
 namespace matc {
 
+class DirShaderCache;
 class JsonishValue;
 class MaterialCompiler final: public Compiler {
 public:
@@ -42,6 +47,11 @@ public:
 private:
     friend class ::TestMaterialCompiler;
 
+    bool runBatch(const Config& config, DirShaderCache* shaderCache);
+
+    bool compileMaterial(const Config& config, Config::Input* input, Config::Output* output,
+            utils::JobSystem& js, filamat::ShaderCache* shaderCache) const;
+
     bool parseMaterial(const char* buffer, size_t size,
             filamat::MaterialBuilder& builder) const noexcept;
     bool processMaterial(const MaterialLexeme&,
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <matc/DirShaderCache.h>
+
+#include <filamat/MaterialBuilder.h>
+#include <filamat/Package.h>
+
+#include <utils/JobSystem.h>
+#include <utils/Path.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(WIN32)
+#include <direct.h>
+#define rmdir _rmdir
+#else
+#include <unistd.h>
+#endif
+
+using namespace utils;
+
+// A cache directory that is deleted, with its content, at the end of the test.
+class TemporaryCacheDirectory {
+public:
+    TemporaryCacheDirectory()
+            : mPath(Path::getTemporaryDirectory().concat(
+                    "matc_shader_cache_" + std::to_string(std::random_device{}()))) {
+    }
+
+    ~TemporaryCacheDirectory() {
+        removeRecursive(mPath);
+    }
+
+    Path const& getPath() const noexcept { return mPath; }
+
+private:
+    static void removeRecursive(Path path) {
+        if (path.isDirectory()) {
+            for (Path const& child : path.listContents()) {
+                removeRecursive(child);
+            }
+            rmdir(path.c_str());
+        } else {
+            path.unlinkFile();
+        }
+    }
+
+    Path const mPath;
+};
+
+TEST(DirShaderCache, PutAndGet) {
+    TemporaryCacheDirectory const temporary;
+    Path const& dir = temporary.getPath();
+    matc::DirShaderCache cache(dir);
+
+    std::string const key = "0123456789abcdef0123456789abcdef";
+    std::vector<uint8_t> data;
+    EXPECT_FALSE(cache.get(key, data));
+
+    std::vector<uint8_t> const content = { 1, 2, 3, 4, 5 };
+    cache.put(key, content.data(), content.size());
+    EXPECT_TRUE(cache.get(key, data));
+    EXPECT_EQ(data, content);
+
+    // a second cache on the same directory sees the same entries
+    matc::DirShaderCache other(dir);
+    data.clear();
+    EXPECT_TRUE(other.get(key, data));
+    EXPECT_EQ(data, content);
+
+    // entries are replaced
+    std::vector<uint8_t> const replaced = { 6, 7 };
+    cache.put(key, replaced.data(), replaced.size());
+    EXPECT_TRUE(other.get(key, data));
+    EXPECT_EQ(data, replaced);
+
+    EXPECT_EQ(cache.getHitCount(), 1);
+    EXPECT_EQ(cache.getMissCount(), 1);
+    EXPECT_EQ(other.getHitCount(), 2);
+}
+
+// Building with a cache, whether it's empty or already holds every variant, produces exactly
+// the same package as building without one.
+TEST(DirShaderCache, CachedBuildIsIdentical) {
+    TemporaryCacheDirectory const temporary;
+    matc::DirShaderCache cache(temporary.getPath());
+
+    filamat::MaterialBuilder::init();
+    JobSystem js;
+    js.adopt();
+
+    auto build = [&js](filamat::ShaderCache* shaderCache) {
+        filamat::MaterialBuilder builder;
+        builder.name("cached")
+                .targetApi(filamat::MaterialBuilder::TargetApi::ALL)
+                .platform(filamat::MaterialBuilder::Platform::ALL)
+                .shading(filamat::MaterialBuilder::Shading::LIT)
+                .shaderCache(shaderCache)
+                .material(R"(
+                    void material(inout MaterialInputs material) {
+                        prepareMaterial(material);
+                        material.baseColor = vec4(0.8, 0.2, 0.2, 1.0);
+                        material.roughness = 0.5;
+                    }
+                )");
+        return builder.build(js);
+    };
+
+    filamat::Package const uncached = build(nullptr);
+    filamat::Package const cold = build(&cache);
+    size_t const coldMisses = cache.getMissCount();
+    size_t const coldHits = cache.getHitCount();
+    filamat::Package const warm = build(&cache);
+
+    js.emancipate();
+    filamat::MaterialBuilder::shutdown();
+
+    ASSERT_TRUE(uncached.isValid());
+    ASSERT_TRUE(cold.isValid());
+    ASSERT_TRUE(warm.isValid());
+
+    // the first cached build fills the cache, all the lookups of the second one hit
+    size_t const lookups = coldMisses + coldHits;
+    EXPECT_GT(coldMisses, 0u);
+    EXPECT_EQ(cache.getMissCount(), coldMisses);
+    EXPECT_EQ(cache.getHitCount(), coldHits + lookups);
+
+    ASSERT_EQ(cold.getSize(), uncached.getSize());
+    ASSERT_EQ(warm.getSize(), uncached.getSize());
+    EXPECT_EQ(0, memcmp(cold.getData(), uncached.getData(), uncached.getSize()));
+    EXPECT_EQ(0, memcmp(warm.getData(), uncached.getData(), uncached.getSize()));
+}